@@ -26,6 +26,8 @@
 #include <cstdint>
 #include <iostream>
 #include <map>
+#include <mutex>
+#include <vector>
 
 /*
   Helper class to be extended to make ring nodes.
@@ -34,6 +36,10 @@
 struct ATSConsistentHashNode {
   std::atomic<bool> available;
   char *name;
+
+  // Maintained by ATSConsistentHash when its load is bounded.
+  std::atomic<uint32_t> load; ///< Recent lookups that selected this node.
+  float share;                ///< Fraction of the ring owned by this node.
 };
 
 std::ostream &operator<<(std::ostream &os, ATSConsistentHashNode &thing);
@@ -54,10 +60,43 @@ struct ATSConsistentHash {
   ATSConsistentHashNode *lookup_available(const char *url = nullptr, ATSConsistentHashIter *i = nullptr, bool *w = nullptr,
                                           ATSHash64 *h = nullptr);
   ATSConsistentHashNode *lookup_by_hashval(uint64_t hashval, ATSConsistentHashIter *i = nullptr, bool *w = nullptr);
+
+  /** Bound the load of the nodes (consistent hashing with bounded loads).
+   *
+   * lookup_by_hashval() then skips nodes which got more than @a factor times their share of the recent lookups, so a hot
+   * key spills over to the following nodes of the ring. Shares are proportional to the node weights, with equal weights
+   * the bound is @a factor times the mean load. A @a factor of 0 (the default) disables the bound.
+   */
+  void set_load_bound(float factor);
+  float
+  get_load_bound() const
+  {
+    return load_bound;
+  }
+
   ~ATSConsistentHash();
 
+  /// Lookups after which the node loads are halved, per node.
+  static constexpr uint64_t LOAD_DECAY_LOOKUPS = 1024;
+
 private:
+  ATSConsistentHashIter find(uint64_t hashval);
+  void build_index();
+  bool overloaded(const ATSConsistentHashNode *node, uint64_t total) const;
+  void add_load(ATSConsistentHashNode *node);
+
   int replicas;
   ATSHash64 *hash;
   std::map<uint64_t, ATSConsistentHashNode *> NodeMap;
+  std::vector<ATSConsistentHashNode *> nodes;
+
+  // Ring position of the first entry of each range of hash values, so lookups do not walk the map from its root.
+  // Built on the first lookup after inserting.
+  std::vector<ATSConsistentHashIter> index;
+  int index_shift = 63;
+  std::atomic<bool> index_built{false};
+  std::mutex index_mutex;
+
+  float load_bound = 0;
+  std::atomic<uint64_t> total_load{0};
 };
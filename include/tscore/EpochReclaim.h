@@ -0,0 +1,67 @@
+/** @file
+
+  Epoch based reclamation for structures read without locks.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace ts
+{
+/** Epoch based reclamation.
+
+    Readers of a structure that is modified without their knowledge hold a
+    @c Guard while they look at it. A writer that unlinks an object from the
+    structure tags it with the epoch returned by @c retire, and may free it
+    once @c is_reclaimable says that no reader that could have seen it is
+    still around.
+
+    The epochs are process wide, guards are cheap and may be nested.
+ */
+class EpochReclaim
+{
+public:
+  class Guard
+  {
+  public:
+    Guard();
+    ~Guard();
+
+    Guard(const Guard &) = delete;
+    Guard &operator=(const Guard &) = delete;
+  };
+
+  /// The epoch to tag an object with, it must be unlinked before the call.
+  static uint64_t retire();
+
+  /// The smallest epoch a reader may still be in. Objects tagged with an
+  /// earlier epoch can be freed.
+  static uint64_t safe_epoch();
+
+  static bool
+  is_reclaimable(uint64_t epoch, uint64_t safe)
+  {
+    return epoch < safe;
+  }
+};
+
+} // namespace ts
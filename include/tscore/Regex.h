@@ -41,6 +41,7 @@ enum REFlags {
   RE_CASE_INSENSITIVE = 0x0001, ///< Ignore case (default: case sensitive).
   RE_UNANCHORED       = 0x0002, ///< Unanchored (DFA defaults to anchored).
   RE_ANCHORED         = 0x0004, ///< Anchored (Regex defaults to unanchored).
+  RE_NO_CAPTURE       = 0x0008, ///< Plain parentheses do not capture.
 };
 
 /** Wrapper for PCRE evaluation.
@@ -102,6 +103,9 @@ private:
  *
  * This contains a set of patterns (which may be of size 1) and matches if any of the patterns
  * match.
+ *
+ * Consecutive patterns are also compiled together into a single alternation, so that a string
+ * which matches none of them is rejected with one evaluation per group instead of one per pattern.
  */
 class DFA
 {
@@ -123,11 +127,31 @@ public:
    */
   int match(std::string_view const &str) const;
 
+  /** Match @a str against the internal patterns, starting with the pattern at index @a start.
+   *
+   * @param str String to match.
+   * @param start Index of the first pattern to try.
+   * @return Index of the matched pattern, -1 if no match.
+   */
+  int match(std::string_view const &str, size_t start) const;
+
+  /// Maximum number of patterns compiled into a single group.
+  static constexpr size_t MAX_GROUP_SIZE = 32;
+
 private:
   struct Pattern {
-    Pattern(Regex &&rxp, std::string &&s) : _re(std::move(rxp)), _p(std::move(s)) {}
-    Regex _re;      ///< The compile pattern.
-    std::string _p; ///< The original pattern.
+    Pattern(Regex &&rxp, std::string &&s, unsigned f) : _re(std::move(rxp)), _p(std::move(s)), _flags(f) {}
+    Regex _re;       ///< The compile pattern.
+    std::string _p;  ///< The original pattern.
+    unsigned _flags; ///< Compilation flags.
+  };
+
+  /// A run of consecutive patterns and, if there is more than one, their alternation.
+  struct Group {
+    Group(size_t first, size_t count) : _first(first), _count(count) {}
+    Regex _re;
+    size_t _first;
+    size_t _count;
   };
 
   /** Compile @a pattern and add it to the pattern set.
@@ -138,5 +162,9 @@ private:
    */
   bool build(std::string_view const &pattern, unsigned flags = 0);
 
+  /// Rebuild the pattern groups after patterns were added.
+  void build_groups();
+
   std::vector<Pattern> _patterns;
+  std::vector<Group> _groups;
 };
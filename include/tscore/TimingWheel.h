@@ -0,0 +1,203 @@
+/** @file
+
+  Hierarchical timing wheel.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "tscore/ink_assert.h"
+
+namespace ts
+{
+/** Intrusive hierarchical timing wheel.
+
+    Elements are filed by an integer deadline, in ticks, and handed back once
+    the wheel has been advanced past it. Insertion and removal are constant
+    time, and advancing by one tick only touches one slot, except every
+    SLOTS ticks, when the slot of the next level is spread over the level
+    below.
+
+    The element type is described by the linkage @a L, which must provide
+
+    - @c value_type, the element type.
+    - <tt>static value_type *& next_ptr(value_type *)</tt>
+    - <tt>static value_type *& prev_ptr(value_type *)</tt>
+    - <tt>static int & slot_ref(value_type *)</tt>, zero if the element is not in a wheel.
+    - <tt>static int64_t deadline_of(value_type *)</tt>
+
+    Deadlines further than the range of the wheel are capped, the element is
+    filed again when its slot comes up.
+ */
+template <typename L> class TimingWheel
+{
+public:
+  using value_type = typename L::value_type;
+
+  static constexpr int SLOT_BITS = 6;
+  static constexpr int SLOTS     = 1 << SLOT_BITS;
+  static constexpr int LEVELS    = 4;
+  static constexpr int64_t RANGE = int64_t(1) << (SLOT_BITS * LEVELS);
+
+  explicit TimingWheel(int64_t now = 0) : _now(now) {}
+
+  /// The tick the wheel was last advanced to.
+  int64_t
+  now() const
+  {
+    return _now;
+  }
+
+  size_t
+  count() const
+  {
+    return _count;
+  }
+
+  bool
+  contains(value_type *v) const
+  {
+    return L::slot_ref(v) != 0;
+  }
+
+  /// File @a v by its deadline, a deadline that has passed is due at the next tick.
+  void
+  insert(value_type *v)
+  {
+    ink_assert(!this->contains(v));
+    this->_place(v, std::max(L::deadline_of(v), _now + 1));
+    ++_count;
+  }
+
+  void
+  erase(value_type *v)
+  {
+    ink_assert(this->contains(v));
+    this->_unlink(v);
+    --_count;
+  }
+
+  /** Advance the wheel to @a now, calling @a expired with each element whose
+      deadline is reached. The element is out of the wheel when @a expired is
+      called, which may insert elements but must not erase other elements.
+   */
+  template <typename F>
+  void
+  advance(int64_t now, F &&expired)
+  {
+    while (_now < now) {
+      if (_count == 0) {
+        _now = now;
+        break;
+      }
+      ++_now;
+      // Spread the slots of the upper levels that start at this tick.
+      for (int level = 1; level < LEVELS && (_now & ((int64_t(1) << (SLOT_BITS * level)) - 1)) == 0; ++level) {
+        value_type *v = this->_take(level, (_now >> (SLOT_BITS * level)) & (SLOTS - 1));
+        while (v) {
+          value_type *next = L::next_ptr(v);
+          this->_place(v, std::max(L::deadline_of(v), _now));
+          v = next;
+        }
+      }
+      value_type *v = this->_take(0, _now & (SLOTS - 1));
+      while (v) {
+        value_type *next = L::next_ptr(v);
+        --_count;
+        if (L::deadline_of(v) > _now) {
+          // capped deadline, file it again.
+          this->_place(v, L::deadline_of(v));
+          ++_count;
+        } else {
+          expired(v);
+        }
+        v = next;
+      }
+    }
+  }
+
+private:
+  static int
+  _slot_index(int level, int slot)
+  {
+    return level * SLOTS + slot + 1; // zero means no slot
+  }
+
+  void
+  _place(value_type *v, int64_t deadline)
+  {
+    int64_t delta = std::min(deadline - _now, RANGE - 1);
+    deadline      = _now + delta;
+    int level     = 0;
+    while (level < LEVELS - 1 && delta >= (int64_t(1) << (SLOT_BITS * (level + 1)))) {
+      ++level;
+    }
+    int slot = (deadline >> (SLOT_BITS * level)) & (SLOTS - 1);
+
+    value_type *&head = _slots[level][slot];
+    L::prev_ptr(v)    = nullptr;
+    L::next_ptr(v)    = head;
+    if (head) {
+      L::prev_ptr(head) = v;
+    }
+    head           = v;
+    L::slot_ref(v) = _slot_index(level, slot);
+  }
+
+  void
+  _unlink(value_type *v)
+  {
+    int idx          = L::slot_ref(v) - 1;
+    value_type *next = L::next_ptr(v);
+    value_type *prev = L::prev_ptr(v);
+    if (prev) {
+      L::next_ptr(prev) = next;
+    } else {
+      _slots[idx / SLOTS][idx % SLOTS] = next;
+    }
+    if (next) {
+      L::prev_ptr(next) = prev;
+    }
+    L::next_ptr(v) = L::prev_ptr(v) = nullptr;
+    L::slot_ref(v)                  = 0;
+  }
+
+  /// Detach the list of a slot, the elements are marked as out of the wheel.
+  value_type *
+  _take(int level, int slot)
+  {
+    value_type *head    = _slots[level][slot];
+    _slots[level][slot] = nullptr;
+    for (value_type *v = head; v; v = L::next_ptr(v)) {
+      L::slot_ref(v) = 0;
+    }
+    return head;
+  }
+
+  int64_t _now;
+  size_t _count = 0;
+  value_type *_slots[LEVELS][SLOTS] = {};
+};
+
+} // namespace ts
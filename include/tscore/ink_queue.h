@@ -173,6 +173,7 @@ struct _InkFreeList {
   uint32_t type_size, chunk_size, used, allocated, alignment;
   uint32_t allocated_base, used_base;
   int advice;
+  struct InkSlabCache *slab; // slab allocator state, see ink_slab.h
 };
 
 typedef struct ink_freelist_ops InkFreeListOps;
@@ -180,7 +181,9 @@ typedef struct _InkFreeList InkFreeList;
 
 const InkFreeListOps *ink_freelist_malloc_ops();
 const InkFreeListOps *ink_freelist_freelist_ops();
+const InkFreeListOps *ink_freelist_slab_ops();
 void ink_freelist_init_ops(int nofl_class, int nofl_proxy);
+void ink_freelist_set_ops(const InkFreeListOps *ops);
 
 /*
  * alignment must be a power of 2
@@ -196,6 +199,7 @@ void ink_freelist_free_bulk(InkFreeList *f, void *head, void *tail, size_t num_i
 void ink_freelists_dump(FILE *f);
 void ink_freelists_dump_baselinerel(FILE *f);
 void ink_freelists_snap_baseline();
+void ink_freelists_reclaim();
 
 struct InkAtomicList {
   InkAtomicList() {}
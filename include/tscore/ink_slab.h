@@ -0,0 +1,41 @@
+/** @file
+
+  Slab allocator with per-thread magazines for the freelists
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/ink_queue.h"
+
+/*
+  The slab allocator behind the freelists when built with --enable-slab-allocator (see ink_freelist_slab_ops).
+
+  The items of a freelist are cut from slabs of its own size. Each thread caches items in two magazines per freelist
+  and exchanges whole magazines with a depot per NUMA node, so the depot lock is taken once per magazine instead of the
+  global CAS per item of the freelist. Unlike the freelist, memory goes back to the OS: ink_slab_reclaim returns the
+  items of the magazines the depot did not need since the previous call to their slabs, and unmaps the slabs that
+  stayed free since then.
+ */
+
+void *ink_slab_new(InkFreeList *f);
+void ink_slab_free(InkFreeList *f, void *item);
+void ink_slab_free_bulk(InkFreeList *f, void *head, void *tail, size_t num_item);
+void ink_slab_reclaim(InkFreeList *f);
@@ -0,0 +1,122 @@
+/**
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+
+/**
+ * @file TransformationPipeline.h
+ * @brief Runs several transformations of a body in a single TransformationPlugin.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "tscpp/api/TransformationPlugin.h"
+
+namespace atscppapi
+{
+class TransformationPipeline;
+
+/**
+ * @brief One step of a TransformationPipeline.
+ *
+ * A stage has the same interface as a TransformationPlugin but it is not hooked into
+ * the transaction itself, the data it produces is handed to the next stage with a
+ * direct call to its consume(). Data is passed as views, a stage that produces slices
+ * of its input unchanged lets the pipeline pass those slices downstream without copying them.
+ *
+ * @see TransformationPipeline
+ */
+class TransformationStage
+{
+public:
+  /**
+   * Fired when the previous stage, or the pipeline input for the first stage, has produced output.
+   * The data is only valid until this method returns.
+   */
+  virtual void consume(std::string_view data) = 0;
+
+  /**
+   * Fired when the previous stage has completed its output. The default implementation
+   * completes the output of this stage.
+   */
+  virtual void handleInputComplete();
+
+  virtual ~TransformationStage() = default;
+
+protected:
+  /**
+   * Hands output to the next stage, or to the downstream transformation if this is the last stage.
+   */
+  void produce(std::string_view data);
+
+  /**
+   * Call this when the stage has no more output.
+   */
+  void setOutputComplete();
+
+  /**
+   * Returns the pipeline that is running this stage, to pause() the transformation for example.
+   */
+  TransformationPipeline &pipeline() const;
+
+private:
+  friend class TransformationPipeline;
+  TransformationPipeline *pipeline_ = nullptr;
+  TransformationStage *next_        = nullptr;
+};
+
+/**
+ * @brief A TransformationPlugin that runs a chain of TransformationStage objects.
+ *
+ * Each TransformationPlugin added to a transaction is a separate transformation with
+ * its own buffers and events. Transformations that always run together can instead be
+ * added as stages of one pipeline, the body then goes through all of them in a single
+ * call for each block of input.
+ *
+ * \code
+ * TransformationPipeline *pipeline = new TransformationPipeline(transaction, TransformationPlugin::RESPONSE_TRANSFORMATION);
+ * pipeline->addStage(std::make_unique<RewriteLinksStage>());
+ * pipeline->addStage(std::make_unique<InsertBannerStage>());
+ * transaction.addPlugin(pipeline);
+ * \endcode
+ *
+ * @see TransformationStage
+ */
+class TransformationPipeline : public TransformationPlugin
+{
+public:
+  TransformationPipeline(Transaction &transaction, TransformationPlugin::Type type);
+
+  /**
+   * Appends a stage to the pipeline, stages must all be added before any body data arrives.
+   */
+  void addStage(std::unique_ptr<TransformationStage> stage);
+
+  void consume(std::string_view data) override;
+  void handleInputComplete() override;
+
+  ~TransformationPipeline() override;
+
+private:
+  friend class TransformationStage;
+  std::vector<std::unique_ptr<TransformationStage>> stages_;
+};
+
+} // namespace atscppapi
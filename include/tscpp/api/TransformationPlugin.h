@@ -93,6 +93,11 @@ public:
   /**
    * A method that you must implement when writing a TransformationPlugin, this method will be
    * fired whenever an upstream TransformationPlugin has produced output.
+   *
+   * Each call gets all of the input that arrived since the previous one. The data is only
+   * valid until this method returns. When the input is in a single block of the input buffer,
+   * passing data, or a slice of it, to produce() unchanged shares the block with the downstream
+   * transformation instead of copying the bytes.
    */
   virtual void consume(std::string_view data) = 0;
 
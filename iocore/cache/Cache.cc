@@ -460,6 +460,14 @@ CacheVC::set_http_info(CacheHTTPInfo *ainfo)
 
   alternate.copy_shallow(ainfo);
   ainfo->clear();
+
+  // readers waiting for the headers can choose this writer now.
+  if (od) {
+    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    if (lock.is_locked()) {
+      od->signal_readers(vol);
+    }
+  }
 }
 
 bool
@@ -3109,6 +3117,8 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("frags_per_doc.3+", cache_three_plus_plus_fragment_document_count_stat);
   REG_INT("read_busy.success", cache_read_busy_success_stat);
   REG_INT("read_busy.failure", cache_read_busy_failure_stat);
+  REG_INT("read_busy.wakeups", cache_read_busy_wakeup_stat);
+  REG_INT("read_busy.wait_timeouts", cache_read_busy_wait_timeout_stat);
   REG_INT("write_bytes_stat", cache_write_bytes_stat);
   REG_INT("vector_marshals", cache_hdr_vector_marshal_stat);
   REG_INT("hdr_marshals", cache_hdr_marshal_stat);
@@ -57,11 +57,6 @@ Dir empty_dir;
 
 // OpenDir
 
-OpenDir::OpenDir()
-{
-  SET_HANDLER(&OpenDir::signal_readers);
-}
-
 /*
    If allow_if_writers is false, open_write fails if there are other writers.
    max_writers sets the maximum number of concurrent writers that are
@@ -105,44 +100,18 @@ OpenDir::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
   return 1;
 }
 
-int
-OpenDir::signal_readers(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
-{
-  Queue<CacheVC, Link_CacheVC_opendir_link> newly_delayed_readers;
-  EThread *t = mutex->thread_holding;
-  CacheVC *c = nullptr;
-  while ((c = delayed_readers.dequeue())) {
-    CACHE_TRY_LOCK(lock, c->mutex, t);
-    if (lock.is_locked()) {
-      c->f.open_read_timeout = 0;
-      c->handleEvent(EVENT_IMMEDIATE, nullptr);
-      continue;
-    }
-    newly_delayed_readers.push(c);
-  }
-  if (newly_delayed_readers.head) {
-    delayed_readers = newly_delayed_readers;
-    EThread *t1     = newly_delayed_readers.head->mutex->thread_holding;
-    if (!t1) {
-      t1 = mutex->thread_holding;
-    }
-    t1->schedule_in(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
-  }
-  return 0;
-}
-
 int
 OpenDir::close_write(CacheVC *cont)
 {
   ink_assert(cont->vol->mutex->thread_holding == this_ethread());
   cont->od->writers.remove(cont);
   cont->od->num_writers--;
+  // the readers may be waiting for this writer in particular.
+  cont->od->signal_readers(cont->vol);
   if (!cont->od->writers.head) {
     unsigned int h = cont->first_key.slice32(0);
     int b          = h % OPEN_DIR_BUCKETS;
     bucket[b].remove(cont->od);
-    delayed_readers.append(cont->od->readers);
-    signal_readers(0, nullptr);
     cont->od->vector.clear();
     THREAD_FREE(cont->od, openDirEntryAllocator, cont->mutex->thread_holding);
   }
@@ -163,17 +132,48 @@ OpenDir::open_read(const CryptoHash *key)
   return nullptr;
 }
 
+/*
+   Put a reader on the wait list until the writers make progress, a
+   header, a fragment or a close, see signal_readers(). The reader is
+   also scheduled after msec in case that is missed, in which case it
+   is still on the list and must leave it with stop_waiting_for_writer().
+   */
 int
 OpenDirEntry::wait(CacheVC *cont, int msec)
 {
   ink_assert(cont->vol->mutex->thread_holding == this_ethread());
-  cont->f.open_read_timeout = 1;
-  ink_assert(!cont->trigger);
-  cont->trigger = cont->vol->mutex->thread_holding->schedule_in_local(cont, HRTIME_MSECONDS(msec));
+  ink_assert(!cont->trigger && !cont->wait_od);
+  cont->trigger = cont->mutex->thread_holding->schedule_in_local(cont, HRTIME_MSECONDS(msec));
+  cont->wait_od = this;
   readers.push(cont);
   return EVENT_CONT;
 }
 
+/*
+   Wake the readers waiting for the writers, called by a writer holding
+   the volume lock. A reader is rescheduled on its own thread, if its
+   lock is busy it is running already or gets woken by its timeout.
+   */
+void
+OpenDirEntry::signal_readers(Vol *vol)
+{
+  EThread *t = this_ethread();
+  CacheVC *c = nullptr;
+
+  ink_assert(vol->mutex->thread_holding == t);
+  while ((c = readers.pop())) {
+    c->wait_od = nullptr;
+    CACHE_TRY_LOCK(lock, c->mutex, t);
+    if (lock.is_locked() && c->trigger) {
+      EThread *home = c->trigger->ethread;
+      c->trigger->cancel_action();
+      // EVENT_INTERVAL like the timeout, openReadReadDone ignores EVENT_IMMEDIATE.
+      c->trigger = home->schedule_imm(c, EVENT_INTERVAL);
+      CACHE_SUM_DYN_STAT_THREAD(cache_read_busy_wakeup_stat, 1);
+    }
+  }
+}
+
 //
 // Cache Directory
 //
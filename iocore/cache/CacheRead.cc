@@ -313,14 +313,18 @@ CacheVC::openReadFromWriter(int event, Event *e)
   cancel_trigger();
   intptr_t err = ECACHE_DOC_BUSY;
   DDebug("cache_read_agg", "%p: key: %X In openReadFromWriter", this, first_key.slice32(1));
-  if (_action.cancelled) {
-    od = nullptr; // only open for read so no need to close
-    return free_CacheVC(this);
-  }
   CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
   if (!lock.is_locked()) {
     VC_SCHED_LOCK_RETRY();
   }
+  if (stop_waiting_for_writer()) {
+    CACHE_INCREMENT_DYN_STAT(cache_read_busy_wait_timeout_stat);
+  }
+  if (_action.cancelled) {
+    MUTEX_RELEASE(lock);
+    od = nullptr; // only open for read so no need to close
+    return free_CacheVC(this);
+  }
   od = vol->open_read(&first_key); // recheck in case the lock failed
   if (!od) {
     MUTEX_RELEASE(lock);
@@ -341,9 +345,10 @@ CacheVC::openReadFromWriter(int event, Event *e)
       SET_HANDLER(&CacheVC::openReadStartHead);
       return openReadStartHead(event, e);
     } else if (ret == EVENT_CONT) {
+      // the writer has not set the headers yet.
       ink_assert(!write_vc);
       if (writer_lock_retry < cache_config_read_while_writer_max_retries) {
-        VC_SCHED_WRITER_RETRY();
+        VC_WAIT_WRITER(vol->open_read(&first_key));
       } else {
         return openReadFromWriterFailure(CACHE_EVENT_OPEN_READ_FAILED, (Event *)-err);
       }
@@ -380,7 +385,7 @@ CacheVC::openReadFromWriter(int event, Event *e)
     }
     DDebug("cache_read_agg", "%p: key: %X writer: closed:%d, fragment:%d, retry: %d", this, first_key.slice32(1), write_vc->closed,
            write_vc->fragment, writer_lock_retry);
-    VC_SCHED_WRITER_RETRY();
+    VC_WAIT_WRITER(cod);
   }
 
   CACHE_TRY_LOCK(writer_lock, write_vc->mutex, mutex->thread_holding);
@@ -535,6 +540,7 @@ CacheVC::openReadClose(int event, Event * /* e ATS_UNUSED */)
   if (!lock.is_locked()) {
     VC_SCHED_LOCK_RETRY();
   }
+  stop_waiting_for_writer();
   if (f.hit_evacuate && dir_valid(vol, &first_dir) && closed > 0) {
     if (f.single_fragment) {
       vol->force_evacuate_head(&first_dir, dir_pinned(&first_dir));
@@ -562,6 +568,9 @@ CacheVC::openReadReadDone(int event, Event *e)
     if (!lock.is_locked()) {
       VC_SCHED_LOCK_RETRY();
     }
+    if (stop_waiting_for_writer()) {
+      CACHE_INCREMENT_DYN_STAT(cache_read_busy_wait_timeout_stat);
+    }
     if (event == AIO_EVENT_DONE && !io.ok()) {
       goto Lerror;
     }
@@ -606,7 +615,7 @@ CacheVC::openReadReadDone(int event, Event *e)
       }
       if (writer_lock_retry < cache_config_read_while_writer_max_retries) {
         DDebug("cache_read_agg", "%p: key: %X ReadRead retrying: %d", this, first_key.slice32(1), (int)vio.ndone);
-        VC_SCHED_WRITER_RETRY(); // wait for writer
+        VC_WAIT_WRITER(vol->open_read(&first_key)); // wait for writer
       } else {
         DDebug("cache_read_agg", "%p: key: %X ReadRead retries exhausted, bailing..: %d", this, first_key.slice32(1),
                (int)vio.ndone);
@@ -806,6 +815,9 @@ Lread : {
     SET_HANDLER(&CacheVC::openReadMain);
     VC_SCHED_LOCK_RETRY();
   }
+  if (stop_waiting_for_writer()) {
+    CACHE_INCREMENT_DYN_STAT(cache_read_busy_wait_timeout_stat);
+  }
   if (dir_probe(&key, vol, &dir, &last_collision)) {
     SET_HANDLER(&CacheVC::openReadReadDone);
     int ret = do_read_call(&key);
@@ -828,7 +840,7 @@ Lread : {
     }
     DDebug("cache_read_agg", "%p: key: %X ReadMain retrying: %d", this, first_key.slice32(1), (int)vio.ndone);
     SET_HANDLER(&CacheVC::openReadMain);
-    VC_SCHED_WRITER_RETRY();
+    VC_WAIT_WRITER(vol->open_read(&first_key));
   }
   if (is_action_tag_set("cache")) {
     ink_release_assert(false);
@@ -1395,6 +1395,10 @@ CacheVC::openWriteWriteDone(int event, Event *e)
     DDebug("cache_insert", "WriteDone: %X, %X, %d", key.slice32(0), first_key.slice32(0), write_len);
     blocks = iobufferblock_skip(blocks.get(), &offset, &length, write_len);
     next_CacheKey(&key, &key);
+    // the fragment can be read now.
+    if (od) {
+      od->signal_readers(vol);
+    }
   }
   if (closed) {
     return die();
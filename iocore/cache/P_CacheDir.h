@@ -219,7 +219,7 @@ struct FreeDir {
 LINK_FORWARD_DECLARATION(CacheVC, opendir_link) // forward declaration
 struct OpenDirEntry {
   DLL<CacheVC, Link_CacheVC_opendir_link> writers; // list of all the current writers
-  DLL<CacheVC, Link_CacheVC_opendir_link> readers; // list of all the current readers - not used
+  DLL<CacheVC, Link_CacheVC_opendir_link> readers; // readers waiting for the writers, see wait()
   CacheHTTPInfoVector vector;                      // Vector for the http document. Each writer
                                                    // maintains a pointer to this vector and
                                                    // writes it down to disk.
@@ -237,6 +237,7 @@ struct OpenDirEntry {
   LINK(OpenDirEntry, link);
 
   int wait(CacheVC *c, int msec);
+  void signal_readers(Vol *vol);
 
   bool
   has_multiple_writers()
@@ -246,15 +247,11 @@ struct OpenDirEntry {
 };
 
 struct OpenDir : public Continuation {
-  Queue<CacheVC, Link_CacheVC_opendir_link> delayed_readers;
   DLL<OpenDirEntry> bucket[OPEN_DIR_BUCKETS];
 
   int open_write(CacheVC *c, int allow_if_writers, int max_writers);
   int close_write(CacheVC *c);
   OpenDirEntry *open_read(const CryptoHash *key);
-  int signal_readers(int event, Event *e);
-
-  OpenDir();
 };
 
 struct CacheSync : public Continuation {
@@ -84,15 +84,15 @@ struct EvacuationBlock;
 
 #define CONT_SCHED_LOCK_RETRY(_c) _c->mutex->thread_holding->schedule_in_local(_c, HRTIME_MSECONDS(cache_config_mutex_retry_delay))
 
-#define VC_SCHED_WRITER_RETRY()                                           \
-  do {                                                                    \
-    ink_assert(!trigger);                                                 \
-    writer_lock_retry++;                                                  \
-    ink_hrtime _t = HRTIME_MSECONDS(cache_read_while_writer_retry_delay); \
-    if (writer_lock_retry > 2)                                            \
-      _t = HRTIME_MSECONDS(cache_read_while_writer_retry_delay) * 2;      \
-    trigger = mutex->thread_holding->schedule_in_local(this, _t);         \
-    return EVENT_CONT;                                                    \
+// Wait for the writers of _od to make progress, or for the read while writer
+// retry delay to pass. Needs the volume lock.
+#define VC_WAIT_WRITER(_od)                                          \
+  do {                                                               \
+    writer_lock_retry++;                                             \
+    int _msec = cache_read_while_writer_retry_delay;                 \
+    if (writer_lock_retry > 2)                                       \
+      _msec = cache_read_while_writer_retry_delay * 2;               \
+    return (_od)->wait(this, _msec);                                 \
   } while (0)
 
 // cache stats definitions
@@ -135,6 +135,8 @@ enum {
   cache_three_plus_plus_fragment_document_count_stat,
   cache_read_busy_success_stat,
   cache_read_busy_failure_stat,
+  cache_read_busy_wakeup_stat,
+  cache_read_busy_wait_timeout_stat,
   cache_gc_bytes_evacuated_stat,
   cache_gc_frags_evacuated_stat,
   cache_write_bytes_stat,
@@ -385,6 +387,7 @@ struct CacheVC : public CacheVConnection {
   int evacuateReadHead(int event, Event *e);
 
   void cancel_trigger();
+  bool stop_waiting_for_writer();
   int64_t get_object_size() override;
   void set_http_info(CacheHTTPInfo *info) override;
   void get_http_info(CacheHTTPInfo **info) override;
@@ -481,6 +484,7 @@ struct CacheVC : public CacheVConnection {
   int fragment;
   int scan_msec_delay;
   CacheVC *write_vc;
+  OpenDirEntry *wait_od; // set while on the readers list of wait_od, protected by the volume lock
   char *hostname;
   int host_len;
   int header_to_write_len;
@@ -589,6 +593,7 @@ free_CacheVC(CacheVC *cont)
   }
   ink_assert(!cont->is_io_in_progress());
   ink_assert(!cont->od);
+  ink_assert(!cont->wait_od);
   /* calling cont->io.action = nullptr causes compile problem on 2.6 solaris
      release build....weird??? For now, null out continuation and mutex
      of the action separately */
@@ -683,6 +688,20 @@ CacheVC::cancel_trigger()
   }
 }
 
+// Leave the readers list of the writers, needs the volume lock. Returns
+// true if the reader was still waiting, i.e. it was woken by its timeout
+// rather than by a writer.
+TS_INLINE bool
+CacheVC::stop_waiting_for_writer()
+{
+  if (!wait_od) {
+    return false;
+  }
+  wait_od->readers.remove(this);
+  wait_od = nullptr;
+  return true;
+}
+
 TS_INLINE int
 CacheVC::die()
 {
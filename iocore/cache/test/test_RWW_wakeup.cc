@@ -0,0 +1,152 @@
+/** @file
+
+  Read while writer readers are woken by the writer rather than by their timeout
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define SMALL_FILE 10 * 1024
+
+// Long enough that a reader that waited for its timeout fails the test.
+#define RETRY_DELAY_MSEC 5000
+// How long the writer holds back its headers after opening.
+#define HEADERS_DELAY_MSEC 100
+
+#define DEFAULT_URL "http://www.scw00.com/"
+
+#include "main.h"
+
+static int64_t
+cache_stat(int id)
+{
+  int64_t sum = 0;
+
+  // the test runs on a thread of its own, which is not among the event threads.
+  RecGetRawStatSum(cache_rsb, id, &sum);
+  return sum + raw_stat_get_tlp(cache_rsb, id, this_ethread())->sum;
+}
+
+/*
+  The reader opens the object right after the writer, before the writer has
+  set its headers, and waits for them. It then waits for the writer to close
+  since the object is a single fragment.
+ */
+class CacheRWWWakeupTest : public CacheTestHandler
+{
+public:
+  CacheRWWWakeupTest(size_t size, const char *url = DEFAULT_URL) : CacheTestHandler()
+  {
+    this->_rt = new CacheReadTest(size, this, url);
+    this->_wt = new CacheWriteTest(size, this, url);
+
+    this->_rt->mutex = this->mutex;
+    this->_wt->mutex = this->mutex;
+
+    SET_HANDLER(&CacheRWWWakeupTest::start_test);
+  }
+
+  int
+  start_test(int event, void *e)
+  {
+    REQUIRE(event == EVENT_IMMEDIATE);
+    this_ethread()->schedule_imm(this->_wt);
+    return 0;
+  }
+
+  int
+  write_headers(int event, void *e)
+  {
+    REQUIRE(event == EVENT_INTERVAL);
+    this->_wt->do_io_write();
+    return 0;
+  }
+
+  void
+  handle_cache_event(int event, CacheTestBase *base) override
+  {
+    REQUIRE(base != nullptr);
+
+    switch (event) {
+    case CACHE_EVENT_OPEN_WRITE:
+      this->_start = Thread::get_hrtime_updated();
+      this_ethread()->schedule_imm(this->_rt);
+      SET_HANDLER(&CacheRWWWakeupTest::write_headers);
+      this_ethread()->schedule_in(this, HRTIME_MSECONDS(HEADERS_DELAY_MSEC));
+      break;
+    case CACHE_EVENT_OPEN_READ:
+      CHECK(ink_hrtime_to_msec(Thread::get_hrtime_updated() - this->_start) < RETRY_DELAY_MSEC);
+      base->do_io_read();
+      break;
+    case VC_EVENT_READ_READY:
+    case VC_EVENT_WRITE_READY:
+      base->reenable();
+      break;
+    case VC_EVENT_WRITE_COMPLETE:
+      this->_wt->close();
+      this->_wt = nullptr;
+      break;
+    case VC_EVENT_READ_COMPLETE:
+      CHECK(ink_hrtime_to_msec(Thread::get_hrtime_updated() - this->_start) < RETRY_DELAY_MSEC);
+      this->_rt->close();
+      this->_rt = nullptr;
+      break;
+    default:
+      REQUIRE(event == 0);
+      break;
+    }
+
+    if (this->_wt == nullptr && this->_rt == nullptr) {
+      CHECK(cache_stat(cache_read_busy_wakeup_stat) > 0);
+      CHECK(cache_stat(cache_read_busy_wait_timeout_stat) == 0);
+      delete this;
+    }
+  }
+
+private:
+  ink_hrtime _start = 0;
+};
+
+class CacheRWWWakeupCacheInit : public CacheInit
+{
+public:
+  CacheRWWWakeupCacheInit() {}
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    cache_config_read_while_writer             = 1;
+    cache_config_read_while_writer_max_retries = 10;
+    cache_read_while_writer_retry_delay        = RETRY_DELAY_MSEC;
+    CacheRWWWakeupTest *crww                   = new CacheRWWWakeupTest(SMALL_FILE);
+    TerminalTest *tt                           = new TerminalTest();
+
+    crww->add(tt);
+    this_ethread()->schedule_imm(crww);
+    delete this;
+    return 0;
+  }
+};
+
+TEST_CASE("cache rww wakeup", "cache")
+{
+  init_cache(256 * 1024 * 1024);
+  CacheRWWWakeupCacheInit *init = new CacheRWWWakeupCacheInit();
+
+  this_ethread()->schedule_imm(init);
+  this_ethread()->execute();
+}
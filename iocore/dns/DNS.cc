@@ -21,6 +21,9 @@
   limitations under the License.
  */
 
+#include <algorithm>
+#include <functional>
+
 #include "P_DNS.h"
 #include "tscore/ink_inet.h"
 
@@ -46,14 +49,15 @@ int dns_failover_try_period          = DEFAULT_FAILOVER_TRY_PERIOD;
 int dns_max_dns_in_flight            = MAX_DNS_IN_FLIGHT;
 int dns_max_tcp_continuous_failures  = MAX_DNS_TCP_CONTINUOUS_FAILURES;
 int dns_validate_qname               = 0;
-unsigned int dns_handler_initialized = 0;
 int dns_ns_rr                        = 0;
-int dns_ns_rr_init_down              = 1;
+int dns_ns_rtt_select                = 0;
 char *dns_ns_list                    = nullptr;
 char *dns_resolv_conf                = nullptr;
 char *dns_local_ipv6                 = nullptr;
 char *dns_local_ipv4                 = nullptr;
 int dns_thread                       = 0;
+int dns_handler_threads              = 1;
+int dns_udp_sockets                  = 1;
 int dns_prefer_ipv6                  = 0;
 DNS_CONN_MODE dns_conn_mode          = DNS_CONN_MODE::UDP_ONLY;
 
@@ -83,17 +87,12 @@ ClassAllocator<HostEnt> dnsBufAllocator("dnsBufAllocator", 2);
 //
 // Function Prototypes
 //
-static bool dns_process(DNSHandler *h, HostEnt *ent, int len);
-static DNSEntry *get_dns(DNSHandler *h, uint16_t id);
+static bool dns_process(DNSHandler *h, DNSConnection *dnsc, HostEnt *ent, int len);
+static DNSEntry *get_dns(DNSHandler *h, int key);
 // returns true when e is done
 static void dns_result(DNSHandler *h, DNSEntry *e, HostEnt *ent, bool retry, bool tcp_retry = false);
 static void write_dns(DNSHandler *h, bool tcp_retry = false);
 static bool write_dns_event(DNSHandler *h, DNSEntry *e, bool over_tcp = false);
-// "reliable" name to try. need to build up first.
-static int try_servers         = 0;
-static int local_num_entries   = 1;
-static int attempt_num_entries = 1;
-char try_server_names[DEFAULT_NUM_TRY_SERVER][MAXDNAME];
 
 static inline char *
 strnchr(char *s, char c, int len)
@@ -224,21 +223,30 @@ DNSProcessor::start(int, size_t stacksize)
   REC_ReadConfigStringAlloc(dns_local_ipv6, "proxy.config.dns.local_ipv6");
   REC_ReadConfigStringAlloc(dns_resolv_conf, "proxy.config.dns.resolv_conf");
   REC_EstablishStaticConfigInt32(dns_thread, "proxy.config.dns.dedicated_thread");
+  REC_EstablishStaticConfigInt32(dns_handler_threads, "proxy.config.dns.handler_threads");
+  REC_EstablishStaticConfigInt32(dns_udp_sockets, "proxy.config.dns.udp_sockets_per_nameserver");
+  REC_EstablishStaticConfigInt32(dns_ns_rtt_select, "proxy.config.dns.select_nameserver_by_rtt");
   int dns_conn_mode_i = 0;
   REC_EstablishStaticConfigInt32(dns_conn_mode_i, "proxy.config.dns.connection_mode");
   dns_conn_mode = static_cast<DNS_CONN_MODE>(dns_conn_mode_i);
 
+  dns_handler_threads = std::clamp(dns_handler_threads, 1, MAX_DNS_HANDLER_THREADS);
+  dns_udp_sockets     = std::clamp(dns_udp_sockets, 1, MAX_DNS_UDP_SOCKETS);
+
   if (dns_thread > 0) {
-    // TODO: Hmmm, should we just get a single thread some other way?
     ET_DNS                                  = eventProcessor.register_event_type("ET_DNS");
     NetHandler::active_thread_types[ET_DNS] = true;
     eventProcessor.schedule_spawn(&initialize_thread_for_net, ET_DNS);
-    eventProcessor.spawn_event_threads(ET_DNS, 1, stacksize);
+    eventProcessor.spawn_event_threads(ET_DNS, dns_handler_threads, stacksize);
   } else {
-    // Initialize the first event thread for DNS.
+    // Initialize the first event threads for DNS.
     ET_DNS = ET_CALL;
   }
-  thread = eventProcessor.thread_group[ET_DNS]._thread[0];
+  auto &group = eventProcessor.thread_group[ET_DNS];
+  for (int i = 0; i < dns_handler_threads && i < group._count; ++i) {
+    threads.push_back(group._thread[i]);
+  }
+  thread = threads[0];
 
   dns_failover_try_period = dns_timeout + 1; // Modify the "default" accordingly
 
@@ -258,25 +266,42 @@ DNSProcessor::start(int, size_t stacksize)
 void
 DNSProcessor::open(sockaddr const *target)
 {
-  DNSHandler *h = new DNSHandler;
-
-  h->mutex = thread->mutex;
-  h->m_res = &l_res;
-  ats_ip_copy(&h->local_ipv4.sa, &local_ipv4.sa);
-  ats_ip_copy(&h->local_ipv6.sa, &local_ipv6.sa);
+  for (EThread *t : threads) {
+    DNSHandler *h = new DNSHandler;
+
+    h->mutex  = t->mutex;
+    h->thread = t;
+    // Each handler runs on its own thread, they do not share the resolver state.
+    h->res   = l_res;
+    h->m_res = &h->res;
+    ats_ip_copy(&h->local_ipv4.sa, &local_ipv4.sa);
+    ats_ip_copy(&h->local_ipv6.sa, &local_ipv6.sa);
+
+    if (target) {
+      ats_ip_copy(&h->ip, target);
+    } else {
+      ats_ip_invalidate(&h->ip); // marked to use default.
+    }
 
-  if (target) {
-    ats_ip_copy(&h->ip, target);
-  } else {
-    ats_ip_invalidate(&h->ip); // marked to use default.
+    handlers.push_back(h);
+    SET_CONTINUATION_HANDLER(h, &DNSHandler::startEvent);
+    t->schedule_imm(h);
   }
+  handler = handlers[0];
+}
 
-  if (!dns_handler_initialized) {
-    handler = h;
-  }
+/** The handler for @a name.
 
-  SET_CONTINUATION_HANDLER(h, &DNSHandler::startEvent);
-  thread->schedule_imm(h);
+    Queries are spread over the handlers by name so that the queries for
+    the same name meet on one handler and are collapsed there.
+*/
+DNSHandler *
+DNSProcessor::handler_for(std::string_view name) const
+{
+  if (handlers.size() <= 1) {
+    return handler;
+  }
+  return handlers[std::hash<std::string_view>{}(name) % handlers.size()];
 }
 
 //
@@ -285,8 +310,6 @@ DNSProcessor::open(sockaddr const *target)
 void
 DNSProcessor::dns_init()
 {
-  gethostname(try_server_names[0], 255);
-  Debug("dns", "localhost=%s", try_server_names[0]);
   Debug("dns", "Round-robin nameservers = %d", dns_ns_rr);
 
   IpEndpoint nameserver[MAX_NAMED];
@@ -416,16 +439,6 @@ DNSEntry::init(DNSQueryData target, int qtype_arg, Continuation *acont, DNSProce
   action        = acont;
   submit_thread = acont->mutex->thread_holding;
 
-  if (SplitDNSConfig::gsplit_dns_enabled) {
-    dnsH = opt.handler ? opt.handler : dnsProcessor.handler;
-  } else {
-    dnsH = dnsProcessor.handler;
-  }
-
-  dnsH->txn_lookup_timeout = opt.timeout;
-
-  mutex = dnsH->mutex;
-
   if (is_addr_query(qtype) || qtype == T_SRV) {
     auto name = target.name.substr(0, MAXDNAME); // be sure of safe copy into @a qname
     memcpy(qname, name);
@@ -442,6 +455,16 @@ DNSEntry::init(DNSQueryData target, int qtype_arg, Continuation *acont, DNSProce
     }
   }
 
+  if (SplitDNSConfig::gsplit_dns_enabled && opt.handler) {
+    dnsH = opt.handler;
+  } else {
+    dnsH = dnsProcessor.handler_for(std::string_view(qname, orig_qname_len));
+  }
+
+  dnsH->txn_lookup_timeout = opt.timeout;
+
+  mutex = dnsH->mutex;
+
   SET_HANDLER((DNSEntryHandler)&DNSEntry::mainEvent);
 }
 
@@ -489,8 +512,7 @@ bool
 DNSHandler::open_con(sockaddr const *target, bool failed, int icon, bool over_tcp)
 {
   ip_port_text_buffer ip_text;
-  PollDescriptor *pd = get_PollDescriptor(dnsProcessor.thread);
-  bool ret           = false;
+  PollDescriptor *pd = get_PollDescriptor(thread);
 
   ink_assert(target != &ip.sa);
 
@@ -499,42 +521,61 @@ DNSHandler::open_con(sockaddr const *target, bool failed, int icon, bool over_tc
   } else if (!target) {
     target = &ip.sa;
   }
-  DNSConnection &cur_con = over_tcp ? tcpcon[icon] : udpcon[icon];
 
   Debug("dns", "open_con: opening connection %s", ats_ip_nptop(target, ip_text, sizeof ip_text));
 
-  if (cur_con.fd != NO_FD) { // Remove old FD from epoll fd
-    cur_con.close();
-  }
+  // one TCP connection, or all the UDP sockets, each bound to its own port.
+  int n_sock = over_tcp ? 1 : n_udp;
+  for (int i = 0; i < n_sock; ++i) {
+    DNSConnection &cur_con = over_tcp ? tcpcon[icon] : udpcon[icon][i];
 
-  if (cur_con.connect(target, DNSConnection::Options()
-                                .setNonBlockingConnect(true)
-                                .setNonBlockingIo(true)
-                                .setUseTcp(over_tcp)
-                                .setBindRandomPort(true)
-                                .setLocalIpv6(&local_ipv6.sa)
-                                .setLocalIpv4(&local_ipv4.sa)) < 0) {
-    Debug("dns", "opening connection %s FAILED for %d", ip_text, icon);
-    if (!failed) {
-      if (dns_ns_rr) {
-        rr_failure(icon);
-      } else {
-        failover();
+    if (cur_con.fd != NO_FD) { // Remove old FD from epoll fd
+      cur_con.close();
+    }
+
+    if (cur_con.connect(target, DNSConnection::Options()
+                                  .setNonBlockingConnect(true)
+                                  .setNonBlockingIo(true)
+                                  .setUseTcp(over_tcp)
+                                  .setBindRandomPort(true)
+                                  .setLocalIpv6(&local_ipv6.sa)
+                                  .setLocalIpv4(&local_ipv4.sa)) < 0) {
+      Debug("dns", "opening connection %s FAILED for %d", ip_text, icon);
+      if (!failed) {
+        if (dns_ns_rr) {
+          rr_failure(icon);
+        } else {
+          failover();
+        }
       }
+      return false;
     }
-    return false;
-  } else {
+
     ns_down[icon] = 0;
     if (cur_con.eio.start(pd, &cur_con, EVENTIO_READ) < 0) {
       Error("[iocore_dns] open_con: Failed to add %d server to epoll list\n", icon);
     } else {
-      cur_con.num = icon;
+      cur_con.num      = icon;
+      cur_con.sock_num = i;
       Debug("dns", "opening connection %s SUCCEEDED for %d", ip_text, icon);
     }
-    ret = true;
   }
 
-  return ret;
+  return true;
+}
+
+/** Close the connections to nameserver @a ndx that are in use in this connection mode. */
+void
+DNSHandler::close_cons(int ndx)
+{
+  if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
+    for (int i = 0; i < n_udp; ++i) {
+      udpcon[ndx][i].close();
+    }
+  }
+  if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
+    tcpcon[ndx].close();
+  }
 }
 
 void
@@ -563,57 +604,48 @@ DNSHandler::startEvent(int /* event ATS_UNUSED */, Event *e)
 
   this->validate_ip();
 
-  if (!dns_handler_initialized) {
-    //
-    // If we are THE handler, open connection and configure for
-    // periodic execution.
-    //
-    dns_handler_initialized = 1;
-    SET_HANDLER(&DNSHandler::mainEvent);
-    if (dns_ns_rr) {
-      /* Round Robin mode:
-       *   Establish a connection to each DNS server to make it a connection pool.
-       *   For each DNS Request, a connection is picked up from the pool by round robin method.
-       *
-       *   The first DNS server is assigned to DNSHandler::ip within open_con() function.
-       */
-      int max_nscount = m_res->nscount;
-      if (max_nscount > MAX_NAMED) {
-        max_nscount = MAX_NAMED;
-      }
-      n_con = 0;
-      for (int i = 0; i < max_nscount; i++) {
-        ip_port_text_buffer buff;
-        sockaddr *sa = &m_res->nsaddr_list[i].sa;
-        if (ats_is_ip(sa)) {
-          open_cons(sa, false, n_con);
-          ++n_con;
-          Debug("dns_pas", "opened connection to %s, n_con = %d", ats_ip_nptop(sa, buff, sizeof(buff)), n_con);
-        }
+  // Open the connections and configure for periodic execution.
+  SET_HANDLER(&DNSHandler::mainEvent);
+  if (dns_ns_rr) {
+    /* Round Robin mode:
+     *   Establish a connection to each DNS server to make it a connection pool.
+     *   For each DNS Request, a connection is picked up from the pool by round robin method.
+     *
+     *   The first DNS server is assigned to DNSHandler::ip within open_con() function.
+     */
+    int max_nscount = m_res->nscount;
+    if (max_nscount > MAX_NAMED) {
+      max_nscount = MAX_NAMED;
+    }
+    n_con = 0;
+    for (int i = 0; i < max_nscount; i++) {
+      ip_port_text_buffer buff;
+      sockaddr *sa = &m_res->nsaddr_list[i].sa;
+      if (ats_is_ip(sa)) {
+        open_cons(sa, false, n_con);
+        ++n_con;
+        Debug("dns_pas", "opened connection to %s, n_con = %d", ats_ip_nptop(sa, buff, sizeof(buff)), n_con);
       }
-      dns_ns_rr_init_down = 0;
-    } else {
-      /* Primary - Secondary mode:
-       *   Establish a connection to the Primary DNS server.
-       *   It always send DNS requests to the Primary DNS server.
-       *   If the Primary DNS server dies,
-       *     - it will attempt to send DNS requests to the secondary DNS server until the Primary DNS server is back.
-       *     - and keep to detect the health of the Primary DNS server.
-       *   If DNSHandler::recv_dns() got a valid DNS response from the Primary DNS server,
-       *     - it means that the Primary DNS server returns.
-       *     - it send all DNS requests to the Primary DNS server.
-       *
-       *   The first DNS server is the Primary DNS server, and it is assigned to DNSHandler::ip within validate_ip() function.
-       */
-      open_cons(nullptr); // use current target address.
-      n_con = 1;
     }
-
-    return EVENT_CONT;
+    rr_init_down = false;
   } else {
-    ink_assert(false); // I.e. this should never really happen
-    return EVENT_DONE;
+    /* Primary - Secondary mode:
+     *   Establish a connection to the Primary DNS server.
+     *   It always send DNS requests to the Primary DNS server.
+     *   If the Primary DNS server dies,
+     *     - it will attempt to send DNS requests to the secondary DNS server until the Primary DNS server is back.
+     *     - and keep to detect the health of the Primary DNS server.
+     *   If DNSHandler::recv_dns() got a valid DNS response from the Primary DNS server,
+     *     - it means that the Primary DNS server returns.
+     *     - it send all DNS requests to the Primary DNS server.
+     *
+     *   The first DNS server is the Primary DNS server, and it is assigned to DNSHandler::ip within validate_ip() function.
+     */
+    open_cons(nullptr); // use current target address.
+    n_con = 1;
   }
+
+  return EVENT_CONT;
 }
 
 /**
@@ -659,16 +691,11 @@ DNSHandler::retry_named(int ndx, ink_hrtime t, bool reopen)
   if (reopen && ((t - last_primary_reopen) > DNS_PRIMARY_REOPEN_PERIOD)) {
     Debug("dns", "retry_named: reopening DNS connection for index %d", ndx);
     last_primary_reopen = t;
-    if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
-      udpcon[ndx].close();
-    }
-    if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
-      tcpcon[ndx].close();
-    }
+    close_cons(ndx);
     open_cons(&m_res->nsaddr_list[ndx].sa, true, ndx);
   }
   bool over_tcp = dns_conn_mode == DNS_CONN_MODE::TCP_ONLY;
-  int con_fd    = over_tcp ? tcpcon[ndx].fd : udpcon[ndx].fd;
+  int con_fd    = over_tcp ? tcpcon[ndx].fd : udpcon[ndx][0].fd;
   unsigned char buffer[MAX_DNS_REQUEST_LEN];
   Debug("dns", "trying to resolve '%s' from DNS connection, ndx %d", try_server_names[try_servers], ndx);
   int r       = _ink_res_mkquery(m_res, try_server_names[try_servers], T_A, buffer, over_tcp);
@@ -692,7 +719,7 @@ DNSHandler::try_primary_named(bool reopen)
   if ((t - last_primary_retry) > DNS_PRIMARY_RETRY_PERIOD) {
     unsigned char buffer[MAX_DNS_REQUEST_LEN];
     bool over_tcp      = dns_conn_mode == DNS_CONN_MODE::TCP_ONLY;
-    int con_fd         = over_tcp ? tcpcon[0].fd : udpcon[0].fd;
+    int con_fd         = over_tcp ? tcpcon[0].fd : udpcon[0][0].fd;
     last_primary_retry = t;
     Debug("dns", "trying to resolve '%s' from primary DNS connection", try_server_names[try_servers]);
     int r = _ink_res_mkquery(m_res, try_server_names[try_servers], T_A, buffer, over_tcp);
@@ -757,12 +784,7 @@ DNSHandler::failover()
     }
     switch_named(name_server);
   } else {
-    if (dns_conn_mode != DNS_CONN_MODE::TCP_ONLY) {
-      udpcon[0].close();
-    }
-    if (dns_conn_mode != DNS_CONN_MODE::UDP_ONLY) {
-      tcpcon[0].close();
-    }
+    close_cons(0);
     ip_text_buffer buff;
     Warning("failover: connection to DNS server %s lost, retrying", ats_ip_ntop(&ip.sa, buff, sizeof(buff)));
   }
@@ -796,7 +818,7 @@ DNSHandler::rr_failure(int ndx)
     }
   }
 
-  if (all_down && !dns_ns_rr_init_down) {
+  if (all_down && !rr_init_down) {
     Warning("connection to all DNS servers lost, retrying");
     // actual retries will be done in retry_named called from mainEvent
     // mark any outstanding requests as not sent for later retry
@@ -885,6 +907,7 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
         buf = dnsc->tcp_data.buf_ptr;
         res = dnsc->tcp_data.total_length;
         dnsc->tcp_data.reset();
+        dnsc->answered = true;
         goto Lsuccess;
       }
 
@@ -900,6 +923,17 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
       if (res <= 0) {
       Lerror:
         Debug("dns", "named error: %d", res);
+        if (res == 0 && dnsc->opt._use_tcp) {
+          // The nameserver closed the connection, queries still in flight on it time out and are retried.
+          if (tcp_closed(dnsc->num, dnsc->answered)) {
+            Debug("dns", "nameserver %d closed the TCP connection, reopening", dnsc->num);
+            reset_tcp_conn(dnsc->num);
+            break;
+          }
+          // It keeps closing the connection without answering, stop reading it and fail it.
+          Debug("dns", "nameserver %d closed the TCP connection without answering", dnsc->num);
+          dnsc->close();
+        }
         if (dns_ns_rr) {
           rr_failure(dnsc->num);
         } else if (dnsc->num == name_server) {
@@ -941,7 +975,7 @@ DNSHandler::recv_dns(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
           }
         }
       }
-      if (dns_process(this, buf.get(), res)) {
+      if (dns_process(this, dnsc, buf.get(), res)) {
         if (dnsc->num == name_server) {
           received_one(name_server);
         }
@@ -971,6 +1005,9 @@ DNSHandler::check_and_reset_tcp_conn()
 int
 DNSHandler::mainEvent(int event, Event *e)
 {
+  if (e && e == write_retry) {
+    write_retry = nullptr;
+  }
   recv_dns(event, e);
   if (dns_ns_rr) {
     if (DNS_CONN_MODE::TCP_RETRY == dns_conn_mode) {
@@ -1024,14 +1061,14 @@ DNSHandler::mainEvent(int event, Event *e)
   return EVENT_CONT;
 }
 
-/** Find a DNSEntry by id. */
+/** Find a DNSEntry by query key. */
 inline static DNSEntry *
-get_dns(DNSHandler *h, uint16_t id)
+get_dns(DNSHandler *h, int key)
 {
   for (DNSEntry *e = h->entries.head; e; e = static_cast<DNSEntry *>(e->link.next)) {
     if (e->once_written_flag) {
       for (int j : e->id) {
-        if (j == id) {
+        if (j == key) {
           return e;
         } else if (j < 0) {
           goto Lnext;
@@ -1095,6 +1132,10 @@ write_dns(DNSHandler *h, bool tcp_retry)
           do {
             h->name_server = (h->name_server + 1) % max_nscount;
           } while (h->ns_down[h->name_server] && h->name_server != ns_start);
+          // keep the round robin pick now and then so that the estimates of the others stay fresh.
+          if (dns_ns_rtt_select && ++h->rtt_probe % DNS_RTT_PROBE_INTERVAL != 0) {
+            h->name_server = h->fastest_named(max_nscount, h->name_server);
+          }
         }
         if (h->ns_down[h->name_server] || !write_dns_event(h, e, over_tcp)) {
           break;
@@ -1109,37 +1150,18 @@ write_dns(DNSHandler *h, bool tcp_retry)
   h->in_write_dns = false;
 }
 
-uint16_t
-DNSHandler::get_query_id()
+/** The live nameserver with the smallest response time, or @a candidate if none is faster. */
+int
+DNSHandler::fastest_named(int max_nscount, int candidate)
 {
-  uint16_t q1, q2;
-  q2 = q1 = static_cast<uint16_t>(generator.random() & 0xFFFF);
-  if (query_id_in_use(q2)) {
-    uint16_t i = q2 >> 6;
-    while (qid_in_flight[i] == UINT64_MAX) {
-      if (++i == sizeof(qid_in_flight) / sizeof(uint64_t)) {
-        i = 0;
-      }
-      if (i == q1 >> 6) {
-        Error("[iocore_dns] get_query_id: Exhausted all DNS query ids");
-        return q1;
-      }
-    }
-    i <<= 6;
-    q2 &= 0x3F;
-    while (query_id_in_use(i + q2)) {
-      ++q2;
-      q2 &= 0x3F;
-      if (q2 == (q1 & 0x3F)) {
-        Error("[iocore_dns] get_query_id: Exhausted all DNS query ids");
-        return q1;
-      }
+  int best = candidate;
+  for (int i = 0; i < max_nscount; ++i) {
+    // a nameserver that has not answered yet has no estimate and is tried first.
+    if (!ns_down[i] && srtt[i] < srtt[best]) {
+      best = i;
     }
-    q2 += i;
   }
-
-  set_query_id_in_use(q2);
-  return q2;
+  return best;
 }
 
 /**
@@ -1163,20 +1185,41 @@ write_dns_event(DNSHandler *h, DNSEntry *e, bool over_tcp)
     return true;
   }
 
-  uint16_t i = h->get_query_id();
-  header->id = htons(i);
+  // TCP responses are matched in the id space of the first UDP socket.
+  int key;
+  if (over_tcp) {
+    key = h->get_query_id(0, 1);
+  } else {
+    key         = h->get_query_id(h->next_udp, h->n_udp);
+    h->next_udp = ((key >> 16) + 1) % h->n_udp;
+  }
+  header->id = htons(static_cast<uint16_t>(key & 0xFFFF));
   if (e->id[dns_retries - e->retries] >= 0) {
     // clear previous id in case named was switched or domain was expanded
     h->release_query_id(e->id[dns_retries - e->retries]);
   }
-  e->id[dns_retries - e->retries] = i;
-  int con_fd                      = over_tcp ? h->tcpcon[h->name_server].fd : h->udpcon[h->name_server].fd;
+  e->id[dns_retries - e->retries] = key;
+  int con_fd                      = over_tcp ? h->tcpcon[h->name_server].fd : h->udpcon[h->name_server][key >> 16].fd;
   Debug("dns", "send query (qtype=%d) for %s to fd %d", e->qtype, e->qname, con_fd);
 
   int s = socketManager.send(con_fd, buffer, r, 0);
+  if (s == -EAGAIN) {
+    // The socket buffer is full, typically a TCP connection with many queries pipelined on it.
+    // That is not a failure of the nameserver, try again shortly.
+    Debug("dns", "send() would block: qname = %s, nameserver = %d", e->qname, h->name_server);
+    if (!h->write_retry) {
+      h->write_retry = h->thread->schedule_in(h, DNS_WRITE_RETRY_PERIOD);
+    }
+    return false;
+  }
   if (s != r) {
     Debug("dns", "send() failed: qname = %s, %d != %d, nameserver= %d", e->qname, s, r, h->name_server);
 
+    if (over_tcp && s > 0) {
+      // Part of the query is on the stream, the queries after it would be misread.
+      h->reset_tcp_conn(h->name_server);
+    }
+
     if (over_tcp) {
       // add the counter for tcp connection failed
       Debug("dns", "tcp query failed: name_server = %d, tcp_continuous_failures = %d", h->name_server,
@@ -1247,7 +1290,7 @@ DNSEntry::mainEvent(int event, Event *e)
     return EVENT_DONE;
   case EVENT_IMMEDIATE: {
     if (!dnsH) {
-      dnsH = dnsProcessor.handler;
+      dnsH = dnsProcessor.handler_for(std::string_view(qname, orig_qname_len));
     }
     if (!dnsH) {
       Debug("dns", "handler not found, retrying...");
@@ -1276,7 +1319,7 @@ DNSEntry::mainEvent(int event, Event *e)
     } else {
       Debug("dns", "adding first to collapsing queue");
       dnsH->entries.enqueue(this);
-      dnsProcessor.thread->schedule_imm(dnsH);
+      dnsH->thread->schedule_imm(dnsH);
     }
     return EVENT_DONE;
   }
@@ -1288,6 +1331,10 @@ DNSEntry::mainEvent(int event, Event *e)
       return EVENT_DONE;
     }
     if (written_flag) {
+      // a timeout counts as a response that took the whole timeout.
+      if (which_ns != NO_NAMESERVER_SELECTED) {
+        dnsH->sample_rtt(which_ns, HRTIME_SECONDS(dns_timeout));
+      }
       Debug("dns", "marking %s as not-written", qname);
       written_flag = false;
       --(dnsH->in_flight);
@@ -1316,7 +1363,7 @@ DNSProcessor::getby(DNSQueryData x, int type, Continuation *cont, Options const
   e->init(x, type, cont, opt);
   MUTEX_TRY_LOCK(lock, e->mutex, this_ethread());
   if (!lock.is_locked()) {
-    thread->schedule_imm(e);
+    e->dnsH->thread->schedule_imm(e);
   } else {
     e->handleEvent(EVENT_IMMEDIATE, nullptr);
   }
@@ -1509,11 +1556,11 @@ DNSEntry::postOneEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 
 /** Decode the reply from "named". */
 static bool
-dns_process(DNSHandler *handler, HostEnt *buf, int len)
+dns_process(DNSHandler *handler, DNSConnection *dnsc, HostEnt *buf, int len)
 {
   ProxyMutex *mutex = handler->mutex.get();
   HEADER *h         = reinterpret_cast<HEADER *>(buf->buf);
-  DNSEntry *e       = get_dns(handler, static_cast<uint16_t>(ntohs(h->id)));
+  DNSEntry *e       = get_dns(handler, DNSHandler::query_key(dnsc->sock_num, ntohs(h->id)));
   bool retry        = false;
   bool tcp_retry    = false;
   bool server_ok    = true;
@@ -1534,6 +1581,10 @@ dns_process(DNSHandler *handler, HostEnt *buf, int len)
   DNS_DECREMENT_DYN_STAT(dns_in_flight_stat);
 
   DNS_SUM_DYN_STAT(dns_response_time_stat, Thread::get_hrtime() - e->send_time);
+  // an answer to an earlier try that went to another nameserver says nothing about this one.
+  if (e->which_ns == dnsc->num) {
+    handler->sample_rtt(dnsc->num, Thread::get_hrtime() - e->send_time);
+  }
 
   // retrying over TCP when truncated is set
   if (dns_conn_mode == DNS_CONN_MODE::TCP_RETRY && h->tc == 1) {
@@ -1648,17 +1699,17 @@ dns_process(DNSHandler *handler, HostEnt *buf, int len)
     // Once it's full, a new entry get inputted into try_server_names round-
     // robin style every 50 success dns response.
 
-    if (local_num_entries >= DEFAULT_NUM_TRY_SERVER) {
-      if ((attempt_num_entries % 50) == 0) {
-        try_servers = (try_servers + 1) % countof(try_server_names);
-        ink_strlcpy(try_server_names[try_servers], e->qname, MAXDNAME);
-        attempt_num_entries = 0;
+    if (handler->local_num_entries >= DEFAULT_NUM_TRY_SERVER) {
+      if ((handler->attempt_num_entries % 50) == 0) {
+        handler->try_servers = (handler->try_servers + 1) % countof(handler->try_server_names);
+        ink_strlcpy(handler->try_server_names[handler->try_servers], e->qname, MAXDNAME);
+        handler->attempt_num_entries = 0;
       }
-      ++attempt_num_entries;
+      ++handler->attempt_num_entries;
     } else {
       // fill up try_server_names for try_primary_named
-      try_servers = local_num_entries++;
-      ink_strlcpy(try_server_names[try_servers], e->qname, MAXDNAME);
+      handler->try_servers = handler->local_num_entries++;
+      ink_strlcpy(handler->try_server_names[handler->try_servers], e->qname, MAXDNAME);
     }
 
     /* added for SRV support [ebalsa]
@@ -92,7 +92,8 @@ DNSConnection::connect(sockaddr const *addr, Options const &opt)
 {
   ink_assert(fd == NO_FD);
   ink_assert(ats_is_ip(addr));
-  this->opt = opt;
+  this->opt      = opt;
+  this->answered = false;
   this->tcp_data.reset();
 
   int res = 0;
@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "tscore/ink_resolver.h"
 #include "SRV.h"
 
@@ -130,15 +132,21 @@ struct DNSProcessor : public Processor {
   int start(int no_of_extra_dns_threads = 0, size_t stacksize = DEFAULT_STACKSIZE) override;
 
   // Open/close a link to a 'named' (done in start())
+  // This opens a handler on each of the DNS threads.
   //
   void open(sockaddr const *ns = nullptr);
 
+  /// The handler for queries for @a name.
+  DNSHandler *handler_for(std::string_view name) const;
+
   DNSProcessor();
 
   // private:
   //
   EThread *thread     = nullptr;
-  DNSHandler *handler = nullptr;
+  DNSHandler *handler = nullptr; ///< The handler of @a thread.
+  std::vector<EThread *> threads;
+  std::vector<DNSHandler *> handlers;
   ts_imp_res_state l_res;
   IpEndpoint local_ipv6;
   IpEndpoint local_ipv4;
@@ -75,7 +75,9 @@ struct DNSConnection {
 
   int fd;
   IpEndpoint ip;
-  int num = 0;
+  int num       = 0;     ///< Index of the nameserver.
+  int sock_num  = 0;     ///< Which of the UDP sockets to the nameserver this is.
+  bool answered = false; ///< A response was read since the connection was opened.
   Options opt;
   LINK(DNSConnection, link);
   EventIO eio;
@@ -23,9 +23,13 @@
 
 #pragma once
 
+#include <memory>
+
 #include "I_EventSystem.h"
 
 #define MAX_NAMED 32
+#define MAX_DNS_UDP_SOCKETS 8
+#define MAX_DNS_HANDLER_THREADS 64
 #define DEFAULT_DNS_RETRIES 5
 #define MAX_DNS_RETRIES 9
 #define DEFAULT_DNS_TIMEOUT 30
@@ -39,6 +43,8 @@
 #define DEFAULT_DNS_SEARCH 1
 #define FAILOVER_SOON_RETRY 5
 #define NO_NAMESERVER_SELECTED -1
+// every this many queries the RTT based selection goes round robin instead
+#define DNS_RTT_PROBE_INTERVAL 16
 
 //
 // Config
@@ -51,6 +57,9 @@ extern int dns_failover_period;
 extern int dns_failover_try_period;
 extern int dns_max_dns_in_flight;
 extern int dns_max_tcp_continuous_failures;
+extern int dns_handler_threads;
+extern int dns_udp_sockets;
+extern int dns_ns_rtt_select;
 extern unsigned int dns_sequence_number;
 
 //
@@ -62,6 +71,7 @@ extern unsigned int dns_sequence_number;
 #define DNS_SEQUENCE_NUMBER_RESTART_OFFSET 4000
 #define DNS_PRIMARY_RETRY_PERIOD HRTIME_SECONDS(5)
 #define DNS_PRIMARY_REOPEN_PERIOD HRTIME_SECONDS(60)
+#define DNS_WRITE_RETRY_PERIOD HRTIME_MSECONDS(5)
 #define BAD_DNS_RESULT (reinterpret_cast<HostEnt *>((uintptr_t)-1))
 #define DEFAULT_NUM_TRY_SERVER 8
 
@@ -112,7 +122,7 @@ extern RecRawStatBlock *dns_rsb;
 
 */
 struct DNSEntry : public Continuation {
-  int id[MAX_DNS_RETRIES];
+  int id[MAX_DNS_RETRIES]; ///< Query keys, see @c DNSHandler::get_query_id.
   int qtype                   = 0;             ///< Type of query to send.
   HostResStyle host_res_style = HOST_RES_NONE; ///< Preferred IP address family.
   int retries                 = DEFAULT_DNS_RETRIES;
@@ -154,8 +164,13 @@ typedef int (DNSEntry::*DNSEntryHandler)(int, void *);
 struct DNSEntry;
 
 /**
-  One DNSHandler is allocated to handle all DNS traffic by polling a
-  UDP port.
+  A DNSHandler handles the DNS traffic of one event thread by polling its
+  connections to the nameservers. The processor runs one per DNS thread
+  and spreads the queries over them by name.
+
+  There are @c n_udp UDP sockets to each nameserver, each bound to its own
+  source port and with its own space of query ids, so that a busy handler
+  does not run out of ids.
 
 */
 struct DNSHandler : public Continuation {
@@ -165,13 +180,19 @@ struct DNSHandler : public Continuation {
   IpEndpoint local_ipv4; ///< Local V4 address if set.
   int ifd[MAX_NAMED];
   int n_con = 0;
+  int n_udp = 1; ///< UDP sockets per nameserver.
   DNSConnection tcpcon[MAX_NAMED];
-  DNSConnection udpcon[MAX_NAMED];
+  std::unique_ptr<DNSConnection[]> udpcon[MAX_NAMED];
   Queue<DNSEntry> entries;
   Queue<DNSConnection> triggered;
+  EThread *thread        = nullptr; ///< The thread the handler runs on.
   int in_flight          = 0;
   int name_server        = 0;
   int in_write_dns       = 0;
+  int next_udp           = 0;
+  unsigned rtt_probe     = 0;
+  bool rr_init_down      = true;
+  Event *write_retry     = nullptr;
   HostEnt *hostent_cache = nullptr;
 
   int ns_down[MAX_NAMED];
@@ -179,15 +200,26 @@ struct DNSHandler : public Continuation {
   int failover_soon_number[MAX_NAMED];
   int tcp_continuous_failures[MAX_NAMED];
   ink_hrtime crossed_failover_number[MAX_NAMED];
+  ink_hrtime srtt[MAX_NAMED]; ///< Smoothed response time, 0 until the first response.
   ink_hrtime last_primary_retry  = 0;
   ink_hrtime last_primary_reopen = 0;
 
   ink_res_state m_res    = nullptr;
   int txn_lookup_timeout = 0;
+  /// Copy of the processor resolver state, building a query bumps its id.
+  ts_imp_res_state res;
+
+  // names already resolved, used to check whether a nameserver is back.
+  char try_server_names[DEFAULT_NUM_TRY_SERVER][MAXDNAME];
+  int try_servers         = 0;
+  int local_num_entries   = 1;
+  int attempt_num_entries = 1;
 
   InkRand generator;
-  // bitmap of query ids in use
-  uint64_t qid_in_flight[(USHRT_MAX + 1) / 64];
+  // bitmap of query ids in use, one id space per UDP socket
+  std::unique_ptr<uint64_t[]> qid_in_flight;
+
+  static constexpr int QID_WORDS = (USHRT_MAX + 1) / 64;
 
   void
   received_one(int i)
@@ -195,13 +227,46 @@ struct DNSHandler : public Continuation {
     failover_number[i] = failover_soon_number[i] = crossed_failover_number[i] = 0;
   }
 
+  /// Fold a response time into the estimate for nameserver @a i.
+  void
+  sample_rtt(int i, ink_hrtime rtt)
+  {
+    srtt[i] = srtt[i] ? srtt[i] + (rtt - srtt[i]) / 8 : rtt;
+  }
+
+  /// Count a query to nameserver @a i that is not answered yet.
+  void
+  unanswered_one(int i)
+  {
+    ++failover_number[i];
+    Debug("dns", "unanswered_one: failover_number for resolver %d is %d", i, failover_number[i]);
+    if (failover_number[i] >= dns_failover_number && !crossed_failover_number[i])
+      crossed_failover_number[i] = Thread::get_hrtime();
+  }
+
   void
   sent_one()
   {
-    ++failover_number[name_server];
-    Debug("dns", "sent_one: failover_number for resolver %d is %d", name_server, failover_number[name_server]);
-    if (failover_number[name_server] >= dns_failover_number && !crossed_failover_number[name_server])
-      crossed_failover_number[name_server] = Thread::get_hrtime();
+    unanswered_one(name_server);
+  }
+
+  /** Count the close of the TCP connection to nameserver @a i by the nameserver.
+
+      A connection that @a answered was closed while idle and is reopened. A
+      connection closed before it answered counts as an unanswered query, and
+      is only reopened until enough of them would fail the nameserver over, so
+      that a nameserver that keeps closing it is not reopened forever.
+
+      @return @c true if the connection is to be reopened.
+   */
+  bool
+  tcp_closed(int i, bool answered)
+  {
+    if (answered) {
+      return true;
+    }
+    unanswered_one(i);
+    return failover_number[i] < dns_failover_number;
   }
 
   bool
@@ -231,30 +296,87 @@ struct DNSHandler : public Continuation {
 
   void open_cons(sockaddr const *addr, bool failed = false, int icon = 0);
   bool open_con(sockaddr const *addr, bool failed = false, int icon = 0, bool over_tcp = false);
+  void close_cons(int ndx);
+  bool reset_tcp_conn(int ndx);
   void failover();
   void rr_failure(int ndx);
   void recover();
   void retry_named(int ndx, ink_hrtime t, bool reopen = true);
   void try_primary_named(bool reopen = true);
   void switch_named(int ndx);
-  uint16_t get_query_id();
+  int fastest_named(int max_nscount, int candidate);
+
+  /** Allocate a query id.
+
+      The id is taken from the space of UDP socket @a sock, or of the next
+      of the first @a n_sock sockets that has a free id. The returned key
+      holds the socket in the bits above the 16 bit id, the id to put on
+      the wire is the low 16 bits.
+   */
+  int
+  get_query_id(int sock, int n_sock)
+  {
+    uint16_t q1 = static_cast<uint16_t>(generator.random() & 0xFFFF);
+
+    for (int k = 0; k < n_sock; ++k) {
+      int s          = (sock + k) % n_sock;
+      uint64_t *bits = qid_in_flight.get() + s * QID_WORDS;
+      uint16_t q2    = q1;
+      if (query_id_in_use(query_key(s, q2))) {
+        uint16_t i = q2 >> 6;
+        while (bits[i] == UINT64_MAX) {
+          if (++i == QID_WORDS) {
+            i = 0;
+          }
+          if (i == q1 >> 6) {
+            break;
+          }
+        }
+        if (bits[i] == UINT64_MAX) {
+          continue; // this socket is out of ids, try the next one.
+        }
+        i <<= 6;
+        q2 &= 0x3F;
+        while (query_id_in_use(query_key(s, i + q2))) {
+          ++q2;
+          q2 &= 0x3F;
+        }
+        q2 += i;
+      }
+
+      set_query_id_in_use(query_key(s, q2));
+      return query_key(s, q2);
+    }
+
+    Error("[iocore_dns] get_query_id: Exhausted all DNS query ids");
+    return query_key(sock, q1);
+  }
+
+  static int
+  query_key(int sock, uint16_t qid)
+  {
+    return (sock << 16) | qid;
+  }
 
   void
-  release_query_id(uint16_t qid)
+  release_query_id(int key)
   {
-    qid_in_flight[qid >> 6] &= (uint64_t) ~(0x1ULL << (qid & 0x3F));
+    uint16_t qid = key & 0xFFFF;
+    qid_in_flight[(key >> 16) * QID_WORDS + (qid >> 6)] &= (uint64_t) ~(0x1ULL << (qid & 0x3F));
   };
 
   void
-  set_query_id_in_use(uint16_t qid)
+  set_query_id_in_use(int key)
   {
-    qid_in_flight[qid >> 6] |= (uint64_t)(0x1ULL << (qid & 0x3F));
+    uint16_t qid = key & 0xFFFF;
+    qid_in_flight[(key >> 16) * QID_WORDS + (qid >> 6)] |= (uint64_t)(0x1ULL << (qid & 0x3F));
   };
 
   bool
-  query_id_in_use(uint16_t qid)
+  query_id_in_use(int key)
   {
-    return (qid_in_flight[(uint16_t)(qid) >> 6] & (uint64_t)(0x1ULL << ((uint16_t)(qid)&0x3F))) != 0;
+    uint16_t qid = key & 0xFFFF;
+    return (qid_in_flight[(key >> 16) * QID_WORDS + (qid >> 6)] & (uint64_t)(0x1ULL << (qid & 0x3F))) != 0;
   };
 
   DNSHandler();
@@ -264,7 +386,6 @@ private:
   void validate_ip();
   // Check tcp connection for TCP_RETRY mode
   void check_and_reset_tcp_conn();
-  bool reset_tcp_conn(int ndx);
 };
 
 /* --------------------------------------------------------------
@@ -295,6 +416,7 @@ TS_INLINE
 DNSHandler::DNSHandler()
   : Continuation(nullptr),
 
+    n_udp(dns_udp_sockets),
     generator((uint32_t)((uintptr_t)time(nullptr) ^ (uintptr_t)this))
 {
   ats_ip_invalidate(&ip);
@@ -304,11 +426,18 @@ DNSHandler::DNSHandler()
     failover_soon_number[i]    = 0;
     crossed_failover_number[i] = 0;
     tcp_continuous_failures[i] = 0;
+    srtt[i]                    = 0;
     ns_down[i]                 = 1;
     tcpcon[i].handler          = this;
-    udpcon[i].handler          = this;
+    udpcon[i].reset(new DNSConnection[n_udp]);
+    for (int j = 0; j < n_udp; j++) {
+      udpcon[i][j].handler = this;
+    }
   }
-  memset(&qid_in_flight, 0, sizeof(qid_in_flight));
+  ink_zero(res);
+  memset(try_server_names, 0, sizeof(try_server_names));
+  gethostname(try_server_names[0], MAXDNAME);
+  qid_in_flight.reset(new uint64_t[n_udp * QID_WORDS]());
   SET_HANDLER(&DNSHandler::startEvent);
   Debug("net_epoll", "inline DNSHandler::DNSHandler()");
 }
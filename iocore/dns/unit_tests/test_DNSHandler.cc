@@ -0,0 +1,249 @@
+/** @file
+
+  Unit tests for the query ids and the nameserver failure counts of DNSHandler.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <set>
+
+#include "tscore/I_Layout.h"
+
+#include "P_DNS.h"
+
+#include "diags.i"
+
+// DNS.cc is not linked in, these are the parts of it the handler uses.
+int dns_failover_number = DEFAULT_FAILOVER_NUMBER;
+int dns_udp_sockets     = 1;
+
+int
+DNSHandler::startEvent(int, Event *)
+{
+  return EVENT_DONE;
+}
+
+namespace
+{
+constexpr int N_UDP = 4;
+
+struct Handler {
+  Handler() : Handler(N_UDP) {}
+  explicit Handler(int n_udp)
+  {
+    dns_udp_sockets = n_udp;
+    h               = new DNSHandler;
+  }
+  ~Handler() { delete h; }
+
+  // take every id of socket @a sock
+  void
+  fill(int sock)
+  {
+    for (int qid = 0; qid <= USHRT_MAX; qid++) {
+      h->set_query_id_in_use(DNSHandler::query_key(sock, qid));
+    }
+  }
+
+  DNSHandler *h;
+};
+} // namespace
+
+TEST_CASE("DNSHandler query keys", "[dns]")
+{
+  SECTION("the socket is above the id")
+  {
+    for (int sock : {0, 1, N_UDP - 1}) {
+      for (int qid : {0, 1, 0x1234, USHRT_MAX}) {
+        int key = DNSHandler::query_key(sock, qid);
+        CHECK(key >> 16 == sock);
+        CHECK((key & 0xFFFF) == qid);
+      }
+    }
+    // TCP and a single socket use the bare id
+    CHECK(DNSHandler::query_key(0, 0xBEEF) == 0xBEEF);
+  }
+
+  SECTION("each socket has its own ids")
+  {
+    Handler handler;
+    DNSHandler *h = handler.h;
+    REQUIRE(h->n_udp == N_UDP);
+
+    h->set_query_id_in_use(DNSHandler::query_key(1, 42));
+    CHECK(h->query_id_in_use(DNSHandler::query_key(1, 42)));
+    for (int sock : {0, 2, 3}) {
+      CHECK_FALSE(h->query_id_in_use(DNSHandler::query_key(sock, 42)));
+    }
+    CHECK_FALSE(h->query_id_in_use(DNSHandler::query_key(1, 43)));
+    CHECK_FALSE(h->query_id_in_use(DNSHandler::query_key(1, 41)));
+
+    h->release_query_id(DNSHandler::query_key(1, 42));
+    CHECK_FALSE(h->query_id_in_use(DNSHandler::query_key(1, 42)));
+  }
+}
+
+TEST_CASE("DNSHandler get_query_id", "[dns]")
+{
+  Handler handler;
+  DNSHandler *h = handler.h;
+
+  SECTION("ids are taken from the socket asked for")
+  {
+    for (int sock = 0; sock < N_UDP; sock++) {
+      int key = h->get_query_id(sock, N_UDP);
+      CHECK(key >> 16 == sock);
+      CHECK(h->query_id_in_use(key));
+    }
+  }
+
+  SECTION("ids in flight are not handed out again")
+  {
+    // more than a word of the bitmap, for a socket and across the sockets
+    std::set<int> keys;
+    for (int i = 0; i < 5000; i++) {
+      int key = h->get_query_id(2, N_UDP);
+      CHECK(key >> 16 == 2);
+      keys.insert(key);
+    }
+    CHECK(keys.size() == 5000);
+
+    for (int i = 0; i < 5000; i++) {
+      keys.insert(h->get_query_id(i % N_UDP, N_UDP));
+    }
+    CHECK(keys.size() == 10000);
+
+    // a released id can be taken again
+    int key = *keys.begin();
+    h->release_query_id(key);
+    CHECK_FALSE(h->query_id_in_use(key));
+  }
+
+  SECTION("the last free id of a socket is found")
+  {
+    handler.fill(0);
+    h->release_query_id(DNSHandler::query_key(0, 12345));
+    CHECK(h->get_query_id(0, 1) == DNSHandler::query_key(0, 12345));
+
+    h->release_query_id(DNSHandler::query_key(0, 0));
+    CHECK(h->get_query_id(0, 1) == DNSHandler::query_key(0, 0));
+
+    h->release_query_id(DNSHandler::query_key(0, USHRT_MAX));
+    CHECK(h->get_query_id(0, 1) == DNSHandler::query_key(0, USHRT_MAX));
+  }
+
+  SECTION("a socket out of ids moves on to the next one")
+  {
+    handler.fill(1);
+    for (int i = 0; i < 100; i++) {
+      CHECK(h->get_query_id(1, N_UDP) >> 16 == 2);
+    }
+
+    // and wraps around to the first sockets
+    handler.fill(2);
+    handler.fill(3);
+    CHECK(h->get_query_id(3, N_UDP) >> 16 == 0);
+
+    // with every id in flight the key still names the socket asked for
+    handler.fill(0);
+    CHECK(h->get_query_id(1, N_UDP) >> 16 == 1);
+  }
+
+  SECTION("TCP only uses the ids of the first socket")
+  {
+    for (int i = 0; i < 1000; i++) {
+      int key = h->get_query_id(0, 1);
+      CHECK(key >> 16 == 0);
+      CHECK_FALSE(h->query_id_in_use(DNSHandler::query_key(1, key & 0xFFFF)));
+    }
+  }
+}
+
+TEST_CASE("DNSHandler TCP connection closed by the nameserver", "[dns]")
+{
+  Handler handler(1);
+  DNSHandler *h = handler.h;
+
+  SECTION("an idle connection is reopened")
+  {
+    for (int i = 0; i < 10 * dns_failover_number; i++) {
+      CHECK(h->tcp_closed(0, true));
+    }
+    CHECK(h->failover_number[0] == 0);
+    CHECK(h->crossed_failover_number[0] == 0);
+  }
+
+  SECTION("a connection closed before answering counts toward failing over")
+  {
+    for (int i = 1; i < dns_failover_number; i++) {
+      CHECK(h->tcp_closed(0, false));
+      CHECK(h->failover_number[0] == i);
+      CHECK(h->crossed_failover_number[0] == 0);
+    }
+    CHECK_FALSE(h->tcp_closed(0, false));
+    CHECK(h->crossed_failover_number[0] != 0);
+    // it is not reopened again until the nameserver answers
+    CHECK_FALSE(h->tcp_closed(0, false));
+
+    h->received_one(0);
+    CHECK(h->tcp_closed(0, false));
+  }
+
+  SECTION("unanswered queries and closes add up")
+  {
+    for (int i = 1; i < dns_failover_number; i++) {
+      h->sent_one();
+    }
+    CHECK_FALSE(h->tcp_closed(0, false));
+  }
+
+  SECTION("the counts are per nameserver")
+  {
+    for (int i = 0; i < dns_failover_number; i++) {
+      h->tcp_closed(1, false);
+    }
+    CHECK(h->crossed_failover_number[1] != 0);
+    CHECK(h->failover_number[0] == 0);
+    CHECK(h->tcp_closed(0, false));
+  }
+}
+
+struct EventProcessorListener : Catch::TestEventListenerBase {
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void
+  testRunStarting(Catch::TestRunInfo const &testRunInfo) override
+  {
+    Layout::create();
+    init_diags("", nullptr);
+    RecProcessInit(RECM_STAND_ALONE);
+
+    ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+
+    EThread *main_thread = new EThread;
+    main_thread->set_specific();
+    // the failure counts are stamped with the time of the event loop
+    Thread::get_hrtime_updated();
+  }
+};
+
+CATCH_REGISTER_LISTENER(EventProcessorListener);
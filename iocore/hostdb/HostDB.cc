@@ -61,6 +61,7 @@ static char hostdb_filename[PATH_NAME_MAX]         = DEFAULT_HOST_DB_FILENAME;
 int hostdb_max_count                               = DEFAULT_HOST_DB_SIZE;
 char hostdb_hostfile_path[PATH_NAME_MAX]           = "";
 int hostdb_sync_frequency                          = 0;
+int hostdb_journal_frequency                       = 5;
 int hostdb_disable_reverse_lookup                  = 0;
 int hostdb_max_iobuf_index                         = BUFFER_SIZE_INDEX_32K;
 
@@ -258,52 +259,6 @@ HostDBProcessor::cache()
   return &hostDB;
 }
 
-struct HostDBBackgroundTask : public Continuation {
-  int frequency;
-  ink_hrtime start_time;
-
-  virtual int sync_event(int event, void *edata) = 0;
-  int wait_event(int event, void *edata);
-
-  HostDBBackgroundTask(int frequency);
-};
-
-HostDBBackgroundTask::HostDBBackgroundTask(int frequency) : Continuation(new_ProxyMutex()), frequency(frequency), start_time(0)
-{
-  SET_HANDLER(&HostDBBackgroundTask::sync_event);
-}
-
-int
-HostDBBackgroundTask::wait_event(int, void *)
-{
-  ink_hrtime next_sync = HRTIME_SECONDS(this->frequency) - (Thread::get_hrtime() - start_time);
-
-  SET_HANDLER(&HostDBBackgroundTask::sync_event);
-  if (next_sync > HRTIME_MSECONDS(100)) {
-    eventProcessor.schedule_in(this, next_sync, ET_TASK);
-  } else {
-    eventProcessor.schedule_imm(this, ET_TASK);
-  }
-  return EVENT_DONE;
-}
-
-struct HostDBSync : public HostDBBackgroundTask {
-  std::string storage_path;
-  std::string full_path;
-  HostDBSync(int frequency, const std::string &storage_path, const std::string &full_path)
-    : HostDBBackgroundTask(frequency), storage_path(std::move(storage_path)), full_path(std::move(full_path)){};
-  int
-  sync_event(int, void *) override
-  {
-    SET_HANDLER(&HostDBSync::wait_event);
-    start_time = Thread::get_hrtime();
-
-    new RefCountCacheSerializer<HostDBInfo>(this, hostDBProcessor.cache()->refcountcache, this->frequency, this->storage_path,
-                                            this->full_path);
-    return EVENT_DONE;
-  }
-};
-
 int
 HostDBCache::start(int flags)
 {
@@ -329,6 +284,8 @@ HostDBCache::start(int flags)
   REC_ReadConfigInt32(hostdb_partitions, "proxy.config.hostdb.partitions");
   // how often to sync hostdb to disk
   REC_EstablishStaticConfigInt32(hostdb_sync_frequency, "proxy.config.cache.hostdb.sync_frequency");
+  // how often to append the changes to the journal
+  REC_EstablishStaticConfigInt32(hostdb_journal_frequency, "proxy.config.cache.hostdb.journal_frequency");
 
   REC_EstablishStaticConfigInt32(hostdb_max_iobuf_index, "proxy.config.hostdb.io.max_buffer_index");
 
@@ -366,12 +323,12 @@ HostDBCache::start(int flags)
 
     Debug("hostdb", "Opening %s, partitions=%d storage_size=%" PRIu64 " items=%d", full_path, hostdb_partitions, hostdb_max_size,
           hostdb_max_count);
-    int load_ret = LoadRefCountCacheFromPath<HostDBInfo>(*this->refcountcache, full_path, HostDBInfo::unmarshall);
+    auto journal = new RefCountCacheJournal<HostDBInfo>(this->refcountcache, std::max(hostdb_journal_frequency, 1),
+                                                        hostdb_sync_frequency, storage_path, full_path);
+    int load_ret = journal->start(HostDBInfo::unmarshall);
     if (load_ret != 0) {
       Warning("Error loading cache from %s: %d", full_path, load_ret);
     }
-
-    eventProcessor.schedule_imm(new HostDBSync(hostdb_sync_frequency, storage_path, full_path), ET_TASK);
   }
 
   this->pending_dns       = new Queue<HostDBContinuation, Continuation::Link_link>[hostdb_partitions];
@@ -419,6 +376,16 @@ HostDBProcessor::start(int, size_t)
   //
   hostdb_current_interval = ink_time();
 
+  int refresh_ahead_min_hits     = 0;
+  int refresh_ahead_lead_percent = 10;
+  int refresh_ahead_max_hosts    = 10000;
+  REC_ReadConfigInt32(refresh_ahead_min_hits, "proxy.config.hostdb.refresh_ahead.min_hits");
+  REC_ReadConfigInt32(refresh_ahead_lead_percent, "proxy.config.hostdb.refresh_ahead.lead_percent");
+  REC_ReadConfigInt32(refresh_ahead_max_hosts, "proxy.config.hostdb.refresh_ahead.max_hosts");
+  if (refresh_ahead_min_hits > 0) {
+    hostDB.refresh_ahead = new HostDBRefreshAhead(refresh_ahead_min_hits, refresh_ahead_lead_percent, refresh_ahead_max_hosts);
+  }
+
   HostDBContinuation *b = hostDBContAllocator.alloc();
   SET_CONTINUATION_HANDLER(b, (HostDBContHandler)&HostDBContinuation::backgroundEvent);
   b->mutex = new_ProxyMutex();
@@ -550,10 +517,9 @@ probe(const Ptr<ProxyMutex> &mutex, HostDBHash const &hash, bool ignore_timeout)
   }
 
   // Otherwise HostDB is enabled, so we'll do our thing
-  ink_assert(this_ethread() == hostDB.refcountcache->lock_for_key(hash.hash.fold())->thread_holding);
   uint64_t folded_hash = hash.hash.fold();
 
-  // get the item from cache
+  // get the item from cache, this does not need the partition lock
   Ptr<HostDBInfo> r = hostDB.refcountcache->get(folded_hash);
   // If there was nothing in the cache-- this is a miss
   if (r.get() == nullptr) {
@@ -571,6 +537,21 @@ probe(const Ptr<ProxyMutex> &mutex, HostDBHash const &hash, bool ignore_timeout)
 
   // If the record is stale, but we want to revalidate-- lets start that up
   if ((!ignore_timeout && r->is_ip_stale() && !r->reverse_dns) || (r->is_ip_timeout() && r->serve_stale_but_revalidate())) {
+    // The pending DNS queue of the partition needs its lock, if another thread
+    // has it the refresh is started from the partition instead of waiting.
+    Ptr<ProxyMutex> bucket_mutex = hostDB.refcountcache->lock_for_key(folded_hash);
+    MUTEX_TRY_LOCK(lock, bucket_mutex, this_ethread());
+    if (!lock.is_locked()) {
+      Debug("hostdb", "stale %u %u %u, using it and scheduling a refresh", r->ip_interval(), r->ip_timestamp,
+            r->ip_timeout_interval);
+      HostDBContinuation *c = hostDBContAllocator.alloc();
+      HostDBContinuation::Options copt;
+      copt.host_res_style = host_res_style_for(r->ip());
+      c->init(hash, copt);
+      SET_CONTINUATION_HANDLER(c, (HostDBContHandler)&HostDBContinuation::refreshEvent);
+      eventProcessor.schedule_imm(c, ET_DNS);
+      return r;
+    }
     if (hostDB.is_pending_dns_for_hash(hash.hash)) {
       Debug("hostdb", "stale %u %u %u, using it and pending to refresh it", r->ip_interval(), r->ip_timestamp,
             r->ip_timeout_interval);
@@ -653,37 +634,35 @@ HostDBProcessor::getby(Continuation *cont, cb_process_result_pfn cb_process_resu
     bool loop = lock.is_locked();
     while (loop) {
       loop = false; // Only loop on explicit set for retry.
-      // find the partition lock
-      Ptr<ProxyMutex> bucket_mutex = hostDB.refcountcache->lock_for_key(hash.hash.fold());
-      MUTEX_TRY_LOCK(lock2, bucket_mutex, thread);
-      if (lock2.is_locked()) {
-        // If we can get the lock and a level 1 probe succeeds, return
-        Ptr<HostDBInfo> r = probe(bucket_mutex, hash, false);
-        if (r) {
-          // fail, see if we should retry with alternate
-          if (hash.db_mark != HOSTDB_MARK_SRV && r->is_failed() && hash.host_name) {
-            loop = check_for_retry(hash.db_mark, opt.host_res_style);
+      // A level 1 probe reads the table without the partition lock, if it succeeds, return
+      Ptr<HostDBInfo> r = probe(mutex, hash, false);
+      if (r) {
+        // fail, see if we should retry with alternate
+        if (hash.db_mark != HOSTDB_MARK_SRV && r->is_failed() && hash.host_name) {
+          loop = check_for_retry(hash.db_mark, opt.host_res_style);
+        }
+        if (!loop) {
+          // No retry -> final result. Return it.
+          if (hash.db_mark == HOSTDB_MARK_SRV) {
+            Debug("hostdb", "immediate SRV answer for %.*s from hostdb", hash.host_len, hash.host_name);
+            Debug("dns_srv", "immediate SRV answer for %.*s from hostdb", hash.host_len, hash.host_name);
+          } else if (hash.host_name) {
+            Debug("hostdb", "immediate answer for %.*s", hash.host_len, hash.host_name);
+          } else {
+            Debug("hostdb", "immediate answer for %s", hash.ip.isValid() ? hash.ip.toString(ipb, sizeof ipb) : "<null>");
           }
-          if (!loop) {
-            // No retry -> final result. Return it.
-            if (hash.db_mark == HOSTDB_MARK_SRV) {
-              Debug("hostdb", "immediate SRV answer for %.*s from hostdb", hash.host_len, hash.host_name);
-              Debug("dns_srv", "immediate SRV answer for %.*s from hostdb", hash.host_len, hash.host_name);
-            } else if (hash.host_name) {
-              Debug("hostdb", "immediate answer for %.*s", hash.host_len, hash.host_name);
-            } else {
-              Debug("hostdb", "immediate answer for %s", hash.ip.isValid() ? hash.ip.toString(ipb, sizeof ipb) : "<null>");
-            }
-            HOSTDB_INCREMENT_DYN_STAT(hostdb_total_hits_stat);
-            if (cb_process_result) {
-              (cont->*cb_process_result)(r.get());
-            } else {
-              reply_to_cont(cont, r.get());
-            }
-            return ACTION_RESULT_DONE;
+          HOSTDB_INCREMENT_DYN_STAT(hostdb_total_hits_stat);
+          if (hostDB.refresh_ahead) {
+            hostDB.refresh_ahead->touch(hash, r.get());
           }
-          hash.refresh(); // only on reloop, because we've changed the family.
+          if (cb_process_result) {
+            (cont->*cb_process_result)(r.get());
+          } else {
+            reply_to_cont(cont, r.get());
+          }
+          return ACTION_RESULT_DONE;
         }
+        hash.refresh(); // only on reloop, because we've changed the family.
       }
     }
   }
@@ -949,6 +928,18 @@ HostDBContinuation::setbyEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUS
   return EVENT_DONE;
 }
 
+// Refresh a record in the background, for a stale record whose partition was busy and for refresh ahead.
+int
+HostDBContinuation::refreshEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  if (hostDB.is_pending_dns_for_hash(hash.hash)) {
+    hostdb_cont_free(this);
+    return EVENT_DONE;
+  }
+  do_dns();
+  return EVENT_DONE;
+}
+
 // Lookup done, insert into the local table, return data to the
 // calling continuation.
 // NOTE: if "i" exists it means we already allocated the space etc, just return
@@ -1412,22 +1403,12 @@ HostDBContinuation::iterateEvent(int event, Event *e)
   // let's iterate through another record and then reschedule ourself.
   if (current_iterate_pos < hostDB.refcountcache->partition_count()) {
     // TODO: configurable number at a time?
-    Ptr<ProxyMutex> bucket_mutex = hostDB.refcountcache->get_partition(current_iterate_pos).lock;
-    MUTEX_TRY_LOCK(lock_bucket, bucket_mutex, t);
-    if (!lock_bucket.is_locked()) {
-      // we couldn't get the bucket lock, let's just reschedule and try later.
-      Debug("hostdb", "iterateEvent event=%d eventp=%p: reschedule due to not getting bucket mutex", event, e);
-      mutex->thread_holding->schedule_in(this, HOST_DB_RETRY_PERIOD);
-      return EVENT_CONT;
-    }
-
-    IntrusiveHashMap<RefCountCacheLinkage> &partMap = hostDB.refcountcache->get_partition(current_iterate_pos).get_map();
-    for (const auto &it : partMap) {
-      HostDBInfo *r = static_cast<HostDBInfo *>(it.item.get());
+    // The partition is read without its lock.
+    hostDB.refcountcache->get_partition(current_iterate_pos).for_each([this](HostDBInfo *r) {
       if (r && !r->is_failed()) {
         action.continuation->handleEvent(EVENT_INTERVAL, static_cast<void *>(r));
       }
-    }
+    });
     current_iterate_pos++;
   }
 
@@ -1493,6 +1474,9 @@ HostDBContinuation::probeEvent(int /* event ATS_UNUSED */, Event *e)
 
     if (r) {
       HOSTDB_INCREMENT_DYN_STAT(hostdb_total_hits_stat);
+      if (hostDB.refresh_ahead) {
+        hostDB.refresh_ahead->touch(hash, r.get());
+      }
     }
 
     if (action.continuation && r) {
@@ -1634,13 +1618,21 @@ HostDBContinuation::do_dns()
 int
 HostDBContinuation::backgroundEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
+  // Remove the records whose time to live, stale serving included, has passed.
+  hostDB.refcountcache->expire(ink_time());
+
+  // The record times are relative to this, it must move on even without a hosts file.
+  hostdb_current_interval = ink_time();
+
+  if (hostDB.refresh_ahead) {
+    hostDB.refresh_ahead->advance(hostdb_current_interval);
+  }
+
   // No nothing if hosts file checking is not enabled.
   if (hostdb_hostfile_check_interval == 0) {
     return EVENT_CONT;
   }
 
-  hostdb_current_interval = ink_time();
-
   if ((hostdb_current_interval - hostdb_last_interval) > hostdb_hostfile_check_interval) {
     bool update_p = false; // do we need to reparse the file and update?
     struct stat info;
@@ -1679,6 +1671,29 @@ HostDBContinuation::backgroundEvent(int /* event ATS_UNUSED */, Event * /* e ATS
   return EVENT_CONT;
 }
 
+void
+HostDBRefreshAhead::advance(ink_time_t now)
+{
+  std::vector<Host> due;
+  this->select(now, due);
+
+  for (Host &h : due) {
+    Debug("hostdb", "refreshing %s ahead of its expiry", h.name.c_str());
+    HostDBHash hash;
+    hash.set_host(h.name.c_str(), h.name.size());
+    hash.port    = h.port;
+    hash.db_mark = h.db_mark;
+    hash.hash    = h.hash;
+
+    HostDBContinuation::Options copt;
+    copt.host_res_style   = host_res_style_for(h.db_mark);
+    HostDBContinuation *c = hostDBContAllocator.alloc();
+    c->init(hash, copt);
+    SET_CONTINUATION_HANDLER(c, (HostDBContHandler)&HostDBContinuation::refreshEvent);
+    eventProcessor.schedule_imm(c, ET_DNS);
+  }
+}
+
 char *
 HostDBInfo::hostname() const
 {
@@ -2094,6 +2109,15 @@ ink_hostdb_init(ts::ModuleVersion v)
   RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.insert_duplicate_to_pending_dns", RECD_INT, RECP_PERSISTENT,
                      (int)hostdb_insert_duplicate_to_pending_dns_stat, RecRawStatSyncSum);
 
+  RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.refresh_ahead.started", RECD_INT, RECP_PERSISTENT,
+                     (int)hostdb_refresh_ahead_started_stat, RecRawStatSyncSum);
+
+  RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.refresh_ahead.hits", RECD_INT, RECP_PERSISTENT,
+                     (int)hostdb_refresh_ahead_hits_stat, RecRawStatSyncSum);
+
+  RecRegisterRawStat(hostdb_rsb, RECT_PROCESS, "proxy.process.hostdb.refresh_ahead.wasted", RECD_INT, RECP_PERSISTENT,
+                     (int)hostdb_refresh_ahead_wasted_stat, RecRawStatSyncSum);
+
   ts_host_res_global_init();
 }
 
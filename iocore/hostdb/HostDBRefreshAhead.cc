@@ -0,0 +1,120 @@
+/** @file
+
+  Selection of the HostDB names to refresh ahead of their expiry.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_HostDB.h"
+
+#include <algorithm>
+
+HostDBRefreshAhead::HostDBRefreshAhead(unsigned min_hits, unsigned lead_percent, size_t max_hosts)
+  : min_hits(std::max(min_hits, 1u)), lead_percent(std::min(lead_percent, 100u)), max_hosts_per_shard(max_hosts / N_SHARDS + 1)
+{
+}
+
+// The time a record is due for a refresh, the lead is at least a second.
+ink_time_t
+HostDBRefreshAhead::refresh_time(HostDBInfo *r) const
+{
+  unsigned lead = std::max(r->ip_timeout_interval * lead_percent / 100, 1u);
+  return r->ip_timestamp + r->ip_timeout_interval - std::min(lead, r->ip_timeout_interval);
+}
+
+void
+HostDBRefreshAhead::touch(HostDBHash const &hash, HostDBInfo *r)
+{
+  // Only names that resolved are refreshed.
+  if (!hash.host_name || r->is_failed() || r->reverse_dns) {
+    return;
+  }
+
+  uint64_t key = hash.hash.fold();
+  Shard &shard = shards[key % N_SHARDS];
+  std::unique_lock<std::mutex> lock(shard.mutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+
+  Host *h   = nullptr;
+  auto spot = shard.hosts.find(key);
+  if (spot == shard.hosts.end()) {
+    if (shard.hosts.size() >= max_hosts_per_shard) {
+      return;
+    }
+    h          = new Host;
+    h->hash    = hash.hash;
+    h->name    = std::string(hash.host_name, hash.host_len);
+    h->port    = hash.port;
+    h->db_mark = hash.db_mark;
+    shard.hosts.emplace(key, std::unique_ptr<Host>(h));
+  } else {
+    h = spot->second.get();
+  }
+
+  h->hits++;
+  if (h->refreshed_at) {
+    if (r->ip_timestamp < h->refreshed_at) {
+      // The refresh has not landed yet, it is checked when it was going to be.
+      return;
+    }
+    // The refresh landed before this lookup needed it.
+    HOSTDB_INCREMENT_THREAD_DYN_STAT(hostdb_refresh_ahead_hits_stat, this_ethread());
+    h->refreshed_at = 0;
+  }
+
+  // File the name again when its record changed.
+  ink_time_t deadline = this->refresh_time(r);
+  if (h->deadline != deadline || !shard.wheel.contains(h)) {
+    if (shard.wheel.contains(h)) {
+      shard.wheel.erase(h);
+    }
+    h->ttl      = r->ip_timeout_interval;
+    h->deadline = deadline;
+    shard.wheel.insert(h);
+  }
+}
+
+void
+HostDBRefreshAhead::select(ink_time_t now, std::vector<Host> &due)
+{
+  for (Shard &shard : shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.wheel.advance(now, [&](Host *h) {
+      if (h->refreshed_at) {
+        // Nobody looked the last refresh up.
+        HOSTDB_INCREMENT_THREAD_DYN_STAT(hostdb_refresh_ahead_wasted_stat, this_ethread());
+        shard.hosts.erase(h->hash.fold());
+        return;
+      }
+      if (h->hits < min_hits) {
+        shard.hosts.erase(h->hash.fold());
+        return;
+      }
+      HOSTDB_INCREMENT_THREAD_DYN_STAT(hostdb_refresh_ahead_started_stat, this_ethread());
+      h->hits         = 0;
+      h->refreshed_at = now;
+      due.emplace_back(*h);
+      // Until a lookup sees the new record, it is checked again a time to live later.
+      h->deadline = now + std::max(h->ttl, 1u);
+      shard.wheel.insert(h);
+    });
+  }
+}
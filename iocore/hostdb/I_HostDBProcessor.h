@@ -108,11 +108,14 @@ union HostDBApplicationInfo {
   //                      we tried the server & failed    //
   // fail_count         - Number of times we tried and    //
   //                       and failed to contact the host //
+  // connect_rtt        - Smoothed connect time, see      //
+  //                       HappyEyeballsAlgorithm.h       //
   //////////////////////////////////////////////////////////
   struct http_server_attr {
     uint32_t last_failure;
     HTTPVersion http_version;
     uint8_t fail_count;
+    uint8_t connect_rtt;
     http_server_attr() : http_version() {}
   } http_data;
 
@@ -430,7 +433,6 @@ Action *iterate(Continuation *cont);
 
 /** The Host Database access interface. */
 struct HostDBProcessor : public Processor {
-  friend struct HostDBSync;
   // Public Interface
 
   // Lookup Hostinfo by name
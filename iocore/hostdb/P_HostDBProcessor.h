@@ -29,6 +29,13 @@
 
 #include "I_HostDBProcessor.h"
 #include "tscore/TsBuffer.h"
+#include "tscore/TimingWheel.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 //
 // Data
@@ -52,6 +59,7 @@ extern int hostdb_srv_enabled;
 
 // extern int hostdb_timestamp;
 extern int hostdb_sync_frequency;
+extern int hostdb_journal_frequency;
 extern int hostdb_disable_reverse_lookup;
 
 // Static configuration information
@@ -141,6 +149,9 @@ enum HostDB_Stats {
   hostdb_ttl_expires_stat, // D == TTL Expires
   hostdb_re_dns_on_reload_stat,
   hostdb_insert_duplicate_to_pending_dns_stat,
+  hostdb_refresh_ahead_started_stat, // refreshes started before the record expired
+  hostdb_refresh_ahead_hits_stat,    // lookups answered by a record refreshed ahead
+  hostdb_refresh_ahead_wasted_stat,  // refreshes ahead whose record was not looked up
   HostDB_Stat_Count
 };
 
@@ -185,6 +196,90 @@ struct RefCountedHostsFileMap : public RefCountObj {
   ats_scoped_str HostFileText;
 };
 
+struct HostDBHash;
+
+/** Refresh ahead of expiry for the host names that are looked up often.
+
+    The names answered from HostDB are tracked with the number of lookups since
+    their record was last refreshed. Each name is filed in a timing wheel by the
+    time its record is due for a refresh, a share of its time to live before it
+    expires. If the name was looked up often enough by then it is resolved again
+    in the background, otherwise it is no longer tracked.
+
+    Lookups only count when the shard of the name is not busy, which is close
+    enough to find the hot names.
+ */
+class HostDBRefreshAhead
+{
+public:
+  /// A name that is tracked.
+  struct Host {
+    CryptoHash hash;
+    std::string name;
+    in_port_t port      = 0;
+    HostDBMark db_mark  = HOSTDB_MARK_GENERIC;
+    unsigned ttl        = 0;
+    unsigned hits       = 0;
+    ink_time_t deadline = 0;
+    /// When the refresh that was started has not been looked up yet.
+    ink_time_t refreshed_at = 0;
+
+    Host *next     = nullptr;
+    Host *prev     = nullptr;
+    int wheel_slot = 0;
+  };
+
+  HostDBRefreshAhead(unsigned min_hits, unsigned lead_percent, size_t max_hosts);
+
+  /// Count a lookup of @a hash answered by @a r.
+  void touch(HostDBHash const &hash, HostDBInfo *r);
+  /// Add to @a due the names to refresh at @a now, the other names whose refresh time has passed are dropped.
+  void select(ink_time_t now, std::vector<Host> &due);
+  /// Refresh the names whose refresh time has passed at @a now.
+  void advance(ink_time_t now);
+
+private:
+  struct Linkage {
+    using value_type = Host;
+
+    static Host *&
+    next_ptr(Host *h)
+    {
+      return h->next;
+    }
+    static Host *&
+    prev_ptr(Host *h)
+    {
+      return h->prev;
+    }
+    static int &
+    slot_ref(Host *h)
+    {
+      return h->wheel_slot;
+    }
+    static int64_t
+    deadline_of(Host *h)
+    {
+      return h->deadline;
+    }
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::unique_ptr<Host>> hosts;
+    ts::TimingWheel<Linkage> wheel{hostdb_current_interval};
+  };
+
+  static constexpr int N_SHARDS = 16;
+
+  ink_time_t refresh_time(HostDBInfo *r) const;
+
+  unsigned min_hits;
+  unsigned lead_percent;
+  size_t max_hosts_per_shard;
+  Shard shards[N_SHARDS];
+};
+
 //
 // HostDBCache (Private)
 //
@@ -194,6 +289,8 @@ struct HostDBCache {
   Ptr<RefCountedHostsFileMap> hosts_file_ptr;
   // TODO: make ATS call a close() method or something on shutdown (it does nothing of the sort today)
   RefCountCache<HostDBInfo> *refcountcache = nullptr;
+  // Only set if refresh ahead is enabled.
+  HostDBRefreshAhead *refresh_ahead = nullptr;
 
   // TODO configurable number of items in the cache
   Queue<HostDBContinuation, Continuation::Link_link> *pending_dns = nullptr;
@@ -460,6 +557,7 @@ struct HostDBContinuation : public Continuation {
   int backgroundEvent(int event, Event *e);
   int retryEvent(int event, Event *e);
   int setbyEvent(int event, Event *e);
+  int refreshEvent(int event, Event *e);
 
   /// Recompute the hash and update ancillary values.
   void refresh_hash();
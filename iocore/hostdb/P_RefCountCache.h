@@ -25,14 +25,19 @@
 #include <I_EventSystem.h>
 #include <P_EventSystem.h> // TODO: less? just need ET_TASK
 
-#include "tscore/IntrusiveHashMap.h"
-#include "tscore/PriorityQueue.h"
+#include "tscore/EpochReclaim.h"
+#include "tscore/TimingWheel.h"
 
 #include "tscore/List.h"
 #include "tscore/ink_hrtime.h"
 
 #include "tscore/I_Version.h"
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 #define REFCOUNT_CACHE_EVENT_SYNC REFCOUNT_CACHE_EVENT_EVENTS_START
 
@@ -50,6 +55,7 @@ enum RefCountCache_Stats {
   refcountcache_total_failed_inserts_stat, // total items unable to insert
   refcountcache_total_lookups_stat,        // total get() calls
   refcountcache_total_hits_stat,           // total hits
+  refcountcache_total_expired_stat,        // total items removed by the expiry wheel
 
   // Persistence metrics
   refcountcache_last_sync_time,   // seconds since epoch of last successful sync
@@ -75,9 +81,10 @@ class RefCountCacheHashEntry
 {
 public:
   Ptr<RefCountObj> item;
+  // expiry wheel linkage
   RefCountCacheHashEntry *_next{nullptr};
   RefCountCacheHashEntry *_prev{nullptr};
-  PriorityQueueEntry<RefCountCacheHashEntry *> *expiry_entry = nullptr;
+  int _wheel_slot = 0;
   RefCountCacheItemMeta meta;
 
   // Need a no-argument constructor to use the classAllocator
@@ -113,11 +120,7 @@ public:
   }
 };
 
-// Since the hashing values are all fixed size, we can simply use a classAllocator to avoid mallocs
-extern ClassAllocator<PriorityQueueEntry<RefCountCacheHashEntry *>> expiryQueueEntry;
-
-struct RefCountCacheLinkage {
-  using key_type   = uint64_t const;
+struct RefCountCacheExpiryLinkage {
   using value_type = RefCountCacheHashEntry;
 
   static value_type *&
@@ -130,48 +133,95 @@ struct RefCountCacheLinkage {
   {
     return value->_prev;
   }
-  static uint64_t
-  hash_of(key_type key)
-  {
-    return key;
-  }
-  static key_type
-  key_of(value_type *v)
+  static int &
+  slot_ref(value_type *value)
   {
-    return v->meta.key;
+    return value->_wheel_slot;
   }
-  static bool
-  equal(key_type lhs, key_type rhs)
+  static int64_t
+  deadline_of(value_type *value)
   {
-    return lhs == rhs;
+    return value->meta.expiry_time;
   }
 };
 
 // The RefCountCachePartition is simply a map of key -> Ptr<YourClass>
-// We partition the cache to reduce lock contention
+// We partition the cache to reduce contention between writers.
+//
+// Items are kept in an open addressed table that is read without locks: a
+// reader only enters an epoch (ts::EpochReclaim), and the entries and
+// tables that writers unlink are only released once no reader can still
+// see them. Writers are serialized by a mutex internal to the partition,
+// `lock` is left to the users of the cache to serialize their own work.
+//
+// Items with an expiry time are filed in a timing wheel, and removed by
+// expire() once their time has passed.
+//
+// Once the journal is enabled the partition keeps a record of the items put
+// and erased, that RefCountCacheJournal takes and appends to disk. Expired
+// items are not recorded, their expiry time is persisted with them.
 template <class C> class RefCountCachePartition
 {
 public:
-  using hash_type = IntrusiveHashMap<RefCountCacheLinkage>;
-
   RefCountCachePartition(unsigned int part_num, uint64_t max_size, unsigned int max_items, RecRawStatBlock *rsb = nullptr);
+  ~RefCountCachePartition();
+
   Ptr<C> get(uint64_t key);
   void put(uint64_t key, C *item, int size = 0, int expire_time = 0);
   void erase(uint64_t key, ink_time_t expiry_time = -1);
+  void expire(ink_time_t now);
 
   void clear();
   bool is_full() const;
   bool make_space_for(unsigned int);
-  void dealloc_entry(hash_type::iterator ptr);
 
   size_t count() const;
   void copy(std::vector<RefCountCacheHashEntry *> &items);
 
-  hash_type &get_map();
+  // Call `func` with every item of the partition, without locking it.
+  template <typename F> void for_each(F &&func);
+
+  void enable_journal();
+  // Move the changes recorded since the last call to `records`, an entry with no item is an erase.
+  void take_journal(std::vector<RefCountCacheHashEntry *> &records);
 
   Ptr<ProxyMutex> lock; // Lock
 
 private:
+  struct Table {
+    explicit Table(unsigned bits)
+      : bits(bits), mask((size_t(1) << bits) - 1), slots(new std::atomic<RefCountCacheHashEntry *>[mask + 1])
+    {
+      for (size_t i = 0; i <= mask; i++) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    // fibonacci hashing, the low bits of the key pick the partition.
+    size_t
+    index(uint64_t key) const
+    {
+      return (key * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+    }
+
+    unsigned bits;
+    size_t mask;
+    std::unique_ptr<std::atomic<RefCountCacheHashEntry *>[]> slots;
+  };
+
+  static RefCountCacheHashEntry *
+  tombstone()
+  {
+    static RefCountCacheHashEntry entry;
+    return &entry;
+  }
+
+  void expire_entries(ink_time_t now);
+  void insert_entry(RefCountCacheHashEntry *val);
+  void remove_entry(size_t idx, RefCountCacheHashEntry *val);
+  void journal_record(uint64_t key, RefCountObj *item, unsigned int size, ink_time_t expiry_time);
+  void grow();
+  void reclaim(bool all = false);
   void metric_inc(RefCountCache_Stats metric_enum, int64_t data);
 
   unsigned int part_num;
@@ -180,46 +230,96 @@ private:
   uint64_t size;
   unsigned int items;
 
-  hash_type item_map;
+  std::mutex write_mutex;
+  std::atomic<Table *> table;
+  size_t used = 0; // slots that are not empty, tombstones included
+
+  ts::TimingWheel<RefCountCacheExpiryLinkage> expiry_wheel;
+
+  std::vector<std::pair<uint64_t, RefCountCacheHashEntry *>> retired_entries;
+  std::vector<std::pair<uint64_t, Table *>> retired_tables;
+
+  bool journaling = false;
+  std::vector<RefCountCacheHashEntry *> journal;
 
-  PriorityQueue<RefCountCacheHashEntry *> expiry_queue;
   RecRawStatBlock *rsb;
 };
 
 template <class C>
 RefCountCachePartition<C>::RefCountCachePartition(unsigned int part_num, uint64_t max_size, unsigned int max_items,
                                                   RecRawStatBlock *rsb)
-  : lock(new_ProxyMutex()), part_num(part_num), max_size(max_size), max_items(max_items), size(0), items(0), rsb(rsb)
+  : lock(new_ProxyMutex()),
+    part_num(part_num),
+    max_size(max_size),
+    max_items(max_items),
+    size(0),
+    items(0),
+    table(new Table(4)),
+    expiry_wheel(ink_time()),
+    rsb(rsb)
 {
 }
 
+template <class C> RefCountCachePartition<C>::~RefCountCachePartition()
+{
+  this->clear();
+  this->reclaim(true);
+  delete this->table.load();
+  for (auto &entry : this->journal) {
+    RefCountCacheHashEntry::free<C>(entry);
+  }
+}
+
 template <class C>
 Ptr<C>
 RefCountCachePartition<C>::get(uint64_t key)
 {
   this->metric_inc(refcountcache_total_lookups_stat, 1);
-  if (auto it = this->item_map.find(key); it != this->item_map.end()) {
-    // found
-    this->metric_inc(refcountcache_total_hits_stat, 1);
-    return make_ptr(static_cast<C *>(it->item.get()));
-  } else {
-    return Ptr<C>();
+
+  ts::EpochReclaim::Guard guard;
+  Table *t = this->table.load(std::memory_order_acquire);
+  for (size_t i = t->index(key), n = 0; n <= t->mask; i = (i + 1) & t->mask, n++) {
+    RefCountCacheHashEntry *val = t->slots[i].load(std::memory_order_acquire);
+    if (val == nullptr) {
+      break;
+    }
+    if (val != tombstone() && val->meta.key == key) {
+      // found, the entry holds a reference until it is reclaimed so the item is alive.
+      this->metric_inc(refcountcache_total_hits_stat, 1);
+      return make_ptr(static_cast<C *>(val->item.get()));
+    }
   }
+  return Ptr<C>();
 }
 
 template <class C>
 void
 RefCountCachePartition<C>::put(uint64_t key, C *item, int size, int expire_time)
 {
+  std::lock_guard<std::mutex> lock(this->write_mutex);
+
   this->metric_inc(refcountcache_total_inserts_stat, 1);
   size += sizeof(C);
   // Remove any colliding entries
-  this->erase(key);
+  Table *t = this->table.load(std::memory_order_relaxed);
+  for (size_t i = t->index(key), n = 0; n <= t->mask; i = (i + 1) & t->mask, n++) {
+    RefCountCacheHashEntry *val = t->slots[i].load(std::memory_order_relaxed);
+    if (val == nullptr) {
+      break;
+    }
+    if (val != tombstone() && val->meta.key == key) {
+      this->remove_entry(i, val);
+      break;
+    }
+  }
 
   // if we are full, and can't make space-- then don't store the item
   if (this->is_full() && !this->make_space_for(size)) {
     Debug("refcountcache", "partition %d is full-- not storing item key=%" PRIu64, this->part_num, key);
     this->metric_inc(refcountcache_total_failed_inserts_stat, 1);
+    // a previous item for the key may have been removed
+    this->journal_record(key, nullptr, 0, 0);
+    this->reclaim();
     return;
   }
 
@@ -227,74 +327,197 @@ RefCountCachePartition<C>::put(uint64_t key, C *item, int size, int expire_time)
   RefCountCacheHashEntry *val = RefCountCacheHashEntry::alloc();
   val->set(item, key, size, expire_time);
 
-  // add expiry_entry to expiry queue, if the expire time is positive (otherwise it means don't expire)
+  // add the entry to the expiry wheel, if the expire time is positive (otherwise it means don't expire)
   if (expire_time >= 0) {
     Debug("refcountcache", "partition %d adding entry with expire_time=%d\n", this->part_num, expire_time);
-    PriorityQueueEntry<RefCountCacheHashEntry *> *expiry_entry = expiryQueueEntry.alloc();
-    new ((void *)expiry_entry) PriorityQueueEntry<RefCountCacheHashEntry *>(val);
-    expiry_queue.push(expiry_entry);
-    val->expiry_entry = expiry_entry;
+    this->expiry_wheel.insert(val);
   }
 
   // add the item to the map
-  this->item_map.insert(val);
+  this->insert_entry(val);
   this->size += val->meta.size;
   this->items++;
   this->metric_inc(refcountcache_current_size_stat, (int64_t)val->meta.size);
   this->metric_inc(refcountcache_current_items_stat, 1);
+  this->journal_record(key, item, val->meta.size, val->meta.expiry_time);
+
+  this->reclaim();
 }
 
 template <class C>
 void
 RefCountCachePartition<C>::erase(uint64_t key, ink_time_t expiry_time)
 {
-  if (auto it = this->item_map.find(key); it != this->item_map.end()) {
-    if (expiry_time >= 0 && it->meta.expiry_time != expiry_time) {
+  std::lock_guard<std::mutex> lock(this->write_mutex);
+
+  Table *t = this->table.load(std::memory_order_relaxed);
+  for (size_t i = t->index(key), n = 0; n <= t->mask; i = (i + 1) & t->mask, n++) {
+    RefCountCacheHashEntry *val = t->slots[i].load(std::memory_order_relaxed);
+    if (val == nullptr) {
+      break;
+    }
+    if (val != tombstone() && val->meta.key == key) {
+      if (expiry_time >= 0 && val->meta.expiry_time != expiry_time) {
+        break;
+      }
+      this->remove_entry(i, val);
+      this->journal_record(key, nullptr, 0, 0);
+      break;
+    }
+  }
+  this->reclaim();
+}
+
+// Remove the items whose expiry time is before `now`.
+template <class C>
+void
+RefCountCachePartition<C>::expire(ink_time_t now)
+{
+  std::lock_guard<std::mutex> lock(this->write_mutex);
+  this->expire_entries(now);
+  this->reclaim();
+}
+
+// Must be called with the write mutex held.
+template <class C>
+void
+RefCountCachePartition<C>::expire_entries(ink_time_t now)
+{
+  Table *t = this->table.load(std::memory_order_relaxed);
+  this->expiry_wheel.advance(now, [this, t](RefCountCacheHashEntry *val) {
+    for (size_t i = t->index(val->meta.key);; i = (i + 1) & t->mask) {
+      if (t->slots[i].load(std::memory_order_relaxed) == val) {
+        Debug("refcountcache", "partition %d expiring item key=%" PRIu64, this->part_num, val->meta.key);
+        this->metric_inc(refcountcache_total_expired_stat, 1);
+        this->remove_entry(i, val);
+        break;
+      }
+    }
+  });
+}
+
+// Must be called with the write mutex held.
+template <class C>
+void
+RefCountCachePartition<C>::insert_entry(RefCountCacheHashEntry *val)
+{
+  if ((this->used + 1) * 4 > (this->table.load(std::memory_order_relaxed)->mask + 1) * 3) {
+    this->grow();
+  }
+
+  Table *t = this->table.load(std::memory_order_relaxed);
+  for (size_t i = t->index(val->meta.key);; i = (i + 1) & t->mask) {
+    RefCountCacheHashEntry *cur = t->slots[i].load(std::memory_order_relaxed);
+    if (cur == nullptr || cur == tombstone()) {
+      if (cur == nullptr) {
+        this->used++;
+      }
+      t->slots[i].store(val, std::memory_order_release);
       return;
     }
-    this->item_map.erase(it);
-    this->dealloc_entry(it);
   }
 }
 
+// Must be called with the write mutex held. The entry is released once no reader can see it.
 template <class C>
 void
-RefCountCachePartition<C>::dealloc_entry(hash_type::iterator ptr)
+RefCountCachePartition<C>::remove_entry(size_t idx, RefCountCacheHashEntry *val)
 {
-  // decrement usage are not cleaned up. The values are not touched in this method, therefore it is safe
-  // counters
-  this->size -= ptr->meta.size;
+  this->table.load(std::memory_order_relaxed)->slots[idx].store(tombstone(), std::memory_order_release);
+
+  this->size -= val->meta.size;
   this->items--;
 
-  this->metric_inc(refcountcache_current_size_stat, -((int64_t)ptr->meta.size));
+  this->metric_inc(refcountcache_current_size_stat, -((int64_t)val->meta.size));
   this->metric_inc(refcountcache_current_items_stat, -1);
 
-  // remove from expiry queue
-  if (ptr->expiry_entry != nullptr) {
-    Debug("refcountcache", "partition %d deleting item from expiry_queue idx=%d", this->part_num, ptr->expiry_entry->index);
+  if (this->expiry_wheel.contains(val)) {
+    this->expiry_wheel.erase(val);
+  }
+
+  this->retired_entries.emplace_back(ts::EpochReclaim::retire(), val);
+}
+
+// Must be called with the write mutex held.
+template <class C>
+void
+RefCountCachePartition<C>::journal_record(uint64_t key, RefCountObj *item, unsigned int size, ink_time_t expiry_time)
+{
+  if (this->journaling) {
+    RefCountCacheHashEntry *record = RefCountCacheHashEntry::alloc();
+    record->set(item, key, size, expiry_time);
+    this->journal.push_back(record);
+  }
+}
+
+// Rebuild the table, without the tombstones and at most half full.
+template <class C>
+void
+RefCountCachePartition<C>::grow()
+{
+  Table *old_table = this->table.load(std::memory_order_relaxed);
+  unsigned bits    = 4;
+  while ((size_t(1) << bits) < (this->items + 1) * 2) {
+    bits++;
+  }
 
-    this->expiry_queue.erase(ptr->expiry_entry);
-    expiryQueueEntry.free(ptr->expiry_entry);
-    ptr->expiry_entry = nullptr; // To avoid the destruction of `l` calling the destructor again-- and causing issues
+  Table *t = new Table(bits);
+  for (size_t i = 0; i <= old_table->mask; i++) {
+    RefCountCacheHashEntry *val = old_table->slots[i].load(std::memory_order_relaxed);
+    if (val != nullptr && val != tombstone()) {
+      size_t j = t->index(val->meta.key);
+      while (t->slots[j].load(std::memory_order_relaxed) != nullptr) {
+        j = (j + 1) & t->mask;
+      }
+      t->slots[j].store(val, std::memory_order_relaxed);
+    }
   }
+  this->used = this->items;
 
-  RefCountCacheHashEntry::free<C>(ptr);
+  this->table.store(t, std::memory_order_release);
+  this->retired_tables.emplace_back(ts::EpochReclaim::retire(), old_table);
 }
 
+// Release what was removed before the oldest epoch a reader is in.
 template <class C>
 void
-RefCountCachePartition<C>::clear()
+RefCountCachePartition<C>::reclaim(bool all)
 {
-  // Since the hash nodes embed the list pointers, you can't iterate over the
-  // hash elements and deallocate them, let alone remove them from the hash.
-  // Hence, this monstrosity.
-  auto it = this->item_map.begin();
-  while (it != this->item_map.end()) {
-    auto cur = it++;
+  if (this->retired_entries.empty() && this->retired_tables.empty()) {
+    return;
+  }
+
+  uint64_t safe = all ? UINT64_MAX : ts::EpochReclaim::safe_epoch();
+  auto entry    = this->retired_entries.begin();
+  while (entry != this->retired_entries.end() && ts::EpochReclaim::is_reclaimable(entry->first, safe)) {
+    RefCountCacheHashEntry::free<C>(entry->second);
+    ++entry;
+  }
+  this->retired_entries.erase(this->retired_entries.begin(), entry);
 
-    this->item_map.erase(cur);
-    this->dealloc_entry(cur);
+  auto table = this->retired_tables.begin();
+  while (table != this->retired_tables.end() && ts::EpochReclaim::is_reclaimable(table->first, safe)) {
+    delete table->second;
+    ++table;
   }
+  this->retired_tables.erase(this->retired_tables.begin(), table);
+}
+
+template <class C>
+void
+RefCountCachePartition<C>::clear()
+{
+  std::lock_guard<std::mutex> lock(this->write_mutex);
+
+  Table *t = this->table.load(std::memory_order_relaxed);
+  for (size_t i = 0; i <= t->mask; i++) {
+    RefCountCacheHashEntry *val = t->slots[i].load(std::memory_order_relaxed);
+    if (val != nullptr && val != tombstone()) {
+      this->journal_record(val->meta.key, nullptr, 0, 0);
+      this->remove_entry(i, val);
+    }
+  }
+  this->reclaim();
 }
 
 // Are we full?
@@ -307,27 +530,14 @@ RefCountCachePartition<C>::is_full() const
   return (this->max_items > 0 && this->items >= this->max_items) || (this->max_size > 0 && this->size >= this->max_size);
 }
 
-// Attempt to make space for item of `size`
+// Attempt to make space for item of `size`, only expired items are evicted.
+// Must be called with the write mutex held.
 template <class C>
 bool
 RefCountCachePartition<C>::make_space_for(unsigned int size)
 {
-  ink_time_t now = ink_time();
-  while (this->is_full() || (size > 0 && this->size + size > this->max_size)) {
-    PriorityQueueEntry<RefCountCacheHashEntry *> *top_item = expiry_queue.top();
-    // if there is nothing in the expiry queue, then we can't make space
-    if (top_item == nullptr) {
-      return false;
-    }
-
-    // If the first item has expired, lets evict it, and then go around again
-    if (top_item->node->meta.expiry_time < now) {
-      this->erase(top_item->node->meta.key);
-    } else { // if the first item isn't expired-- the rest won't be either (queue is sorted)
-      return false;
-    }
-  }
-  return true;
+  this->expire_entries(ink_time());
+  return !this->is_full() && (this->max_size == 0 || this->size + size <= this->max_size);
 }
 
 template <class C>
@@ -341,27 +551,57 @@ template <class C>
 void
 RefCountCachePartition<C>::copy(std::vector<RefCountCacheHashEntry *> &items)
 {
-  for (auto &&it : this->item_map) {
-    RefCountCacheHashEntry *val = RefCountCacheHashEntry::alloc();
-    val->set(it.item.get(), it.meta.key, it.meta.size, it.meta.expiry_time);
-    items.push_back(val);
+  ts::EpochReclaim::Guard guard;
+  Table *t = this->table.load(std::memory_order_acquire);
+  for (size_t i = 0; i <= t->mask; i++) {
+    RefCountCacheHashEntry *it = t->slots[i].load(std::memory_order_acquire);
+    if (it != nullptr && it != tombstone()) {
+      RefCountCacheHashEntry *val = RefCountCacheHashEntry::alloc();
+      val->set(it->item.get(), it->meta.key, it->meta.size, it->meta.expiry_time);
+      items.push_back(val);
+    }
   }
 }
 
 template <class C>
+template <typename F>
 void
-RefCountCachePartition<C>::metric_inc(RefCountCache_Stats metric_enum, int64_t data)
+RefCountCachePartition<C>::for_each(F &&func)
 {
-  if (this->rsb) {
-    RecIncrGlobalRawStatCount(this->rsb, metric_enum, data);
+  ts::EpochReclaim::Guard guard;
+  Table *t = this->table.load(std::memory_order_acquire);
+  for (size_t i = 0; i <= t->mask; i++) {
+    RefCountCacheHashEntry *val = t->slots[i].load(std::memory_order_acquire);
+    if (val != nullptr && val != tombstone()) {
+      func(static_cast<C *>(val->item.get()));
+    }
   }
 }
 
 template <class C>
-IntrusiveHashMap<RefCountCacheLinkage> &
-RefCountCachePartition<C>::get_map()
+void
+RefCountCachePartition<C>::enable_journal()
+{
+  std::lock_guard<std::mutex> lock(this->write_mutex);
+  this->journaling = true;
+}
+
+template <class C>
+void
+RefCountCachePartition<C>::take_journal(std::vector<RefCountCacheHashEntry *> &records)
 {
-  return this->item_map;
+  ink_assert(records.empty());
+  std::lock_guard<std::mutex> lock(this->write_mutex);
+  records.swap(this->journal);
+}
+
+template <class C>
+void
+RefCountCachePartition<C>::metric_inc(RefCountCache_Stats metric_enum, int64_t data)
+{
+  if (this->rsb) {
+    RecIncrGlobalRawStatCount(this->rsb, metric_enum, data);
+  }
 }
 
 // The header for the cache, this is used to check if the serialized cache is compatible
@@ -384,9 +624,9 @@ public:
 // This cache may be Persisted (RefCountCacheSync) as well as loaded from disk (LoadRefCountCacheFromPath).
 // This class will optionally emit metrics at the given `metrics_prefix`.
 //
-// Note: although this cache does allow you to set expiry times this cache does not actively GC itself-- meaning
-// it will only remove expired items once the space is required. So to ensure that the cache is bounded either a
-// size or an item limit must be set-- otherwise the cache will not GC.
+// Items put with an expiry time are removed when the space is required, or when expire() is called past their
+// expiry time. So to ensure that the cache is bounded either expire() must be called periodically, or a
+// size or an item limit must be set.
 //
 // Also note, that if keys collide the previous
 // entry for a given key will be removed, so this "leak" concern is assuming you don't have sufficient space to store
@@ -405,6 +645,8 @@ public:
   void put(uint64_t key, C *item, int size = 0, ink_time_t expiry_time = -1);
   void erase(uint64_t key);
   void clear();
+  // Remove the items whose expiry time is before `now`.
+  void expire(ink_time_t now);
 
   // Some methods to get some internal state
   int partition_for_key(uint64_t key);
@@ -455,6 +697,9 @@ RefCountCache<C>::RefCountCache(unsigned int num_partitions, int size, int items
     RecRegisterRawStat(this->rsb, RECT_PROCESS, (metrics_prefix + "total_hits").c_str(), RECD_INT, RECP_NON_PERSISTENT,
                        (int)refcountcache_total_hits_stat, RecRawStatSyncCount);
 
+    RecRegisterRawStat(this->rsb, RECT_PROCESS, (metrics_prefix + "total_expired").c_str(), RECD_INT, RECP_NON_PERSISTENT,
+                       (int)refcountcache_total_expired_stat, RecRawStatSyncCount);
+
     RecRegisterRawStat(this->rsb, RECT_PROCESS, (metrics_prefix + "last_sync.time").c_str(), RECD_INT, RECP_NON_PERSISTENT,
                        (int)refcountcache_last_sync_time, RecRawStatSyncCount);
 
@@ -555,6 +800,15 @@ RefCountCache<C>::erase(uint64_t key)
   this->partitions[this->partition_for_key(key)]->erase(key);
 }
 
+template <class C>
+void
+RefCountCache<C>::expire(ink_time_t now)
+{
+  for (unsigned int i = 0; i < this->num_partitions; i++) {
+    this->partitions[i]->expire(now);
+  }
+}
+
 template <class C>
 void
 RefCountCache<C>::clear()
@@ -565,12 +819,19 @@ RefCountCache<C>::clear()
 }
 
 // Fill `cache` with items in file `filepath` using `load_func` to unmarshall the record.
+// A record with a zero size erases the key, as written by the journal (RefCountCacheJournal).
+// The file is mapped rather than read, and if `valid_length` is given it is set to the length of
+// the file up to the first incomplete record.
 // Errors are -1
 template <typename CacheEntryType>
 int
 LoadRefCountCacheFromPath(RefCountCache<CacheEntryType> &cache, const std::string &filepath,
-                          CacheEntryType *(*load_func)(char *, unsigned int))
+                          CacheEntryType *(*load_func)(char *, unsigned int), size_t *valid_length = nullptr)
 {
+  if (valid_length) {
+    *valid_length = 0;
+  }
+
   // If we have no load method, then we can't load anything so lets just stop right here
   if (load_func == nullptr) {
     return -1; // TODO: some specific error code
@@ -582,39 +843,57 @@ LoadRefCountCacheFromPath(RefCountCache<CacheEntryType> &cache, const std::strin
     return -1;
   }
 
-  // read in the header
-  RefCountCacheHeader tmpHeader = RefCountCacheHeader();
-  int read_ret                  = read(fd, (char *)&tmpHeader, sizeof(RefCountCacheHeader));
-  if (read_ret != sizeof(RefCountCacheHeader)) {
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(RefCountCacheHeader))) {
     socketManager.close(fd);
-    Warning("Error reading cache header from disk (expected %ld): %d", sizeof(RefCountCacheHeader), read_ret);
+    Warning("Error reading cache header from disk (expected %ld): %s", sizeof(RefCountCacheHeader), filepath.c_str());
     return -1;
   }
+
+  size_t length = st.st_size;
+  void *map     = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  socketManager.close(fd);
+  if (map == MAP_FAILED) {
+    Warning("Unable to map file %s; [Error]: %s", filepath.c_str(), strerror(errno));
+    return -1;
+  }
+  madvise(map, length, MADV_SEQUENTIAL);
+
+  // check the header
+  const char *buf               = static_cast<const char *>(map);
+  RefCountCacheHeader tmpHeader = RefCountCacheHeader();
+  memcpy(&tmpHeader, buf, sizeof(RefCountCacheHeader));
   if (!cache.get_header().compatible(&tmpHeader)) {
-    socketManager.close(fd);
+    munmap(map, length);
     Warning("Incompatible cache at %s, not loading.", filepath.c_str());
     return -1; // TODO: specific code for incompatible
   }
 
+  // The records are not aligned, the metadata is copied out and the item is unmarshalled in place.
   RefCountCacheItemMeta tmpValue = RefCountCacheItemMeta(0, 0);
-  while (true) { // TODO: better loop
-    read_ret = read(fd, (char *)&tmpValue, sizeof(tmpValue));
-    if (read_ret != sizeof(tmpValue)) {
-      break;
-    }
-    char buf[tmpValue.size];
-    read_ret = read(fd, (char *)&buf, tmpValue.size);
-    if (read_ret != (int)tmpValue.size) {
-      Warning("Encountered error reading item from cache: %d", read_ret);
+  size_t offset                  = sizeof(RefCountCacheHeader);
+  while (length - offset >= sizeof(tmpValue)) {
+    memcpy(&tmpValue, buf + offset, sizeof(tmpValue));
+    if (length - offset - sizeof(tmpValue) < tmpValue.size) {
+      Warning("Encountered truncated item in %s at offset %zu", filepath.c_str(), offset);
       break;
     }
+    char *item_buf = const_cast<char *>(buf) + offset + sizeof(tmpValue);
+    offset += sizeof(tmpValue) + tmpValue.size;
 
-    CacheEntryType *newItem = load_func((char *)&buf, tmpValue.size);
+    if (tmpValue.size == 0) {
+      cache.erase(tmpValue.key);
+      continue;
+    }
+    CacheEntryType *newItem = load_func(item_buf, tmpValue.size);
     if (newItem != nullptr) {
-      cache.put(tmpValue.key, newItem, tmpValue.size - sizeof(CacheEntryType));
+      cache.put(tmpValue.key, newItem, tmpValue.size - sizeof(CacheEntryType), tmpValue.expiry_time);
     }
-  };
+  }
 
-  socketManager.close(fd);
+  if (valid_length) {
+    *valid_length = offset;
+  }
+  munmap(map, length);
   return 0;
 }
@@ -38,6 +38,9 @@
 //
 // This way we only have to hold the lock on the partition for the
 // time it takes to get Ptr<>s to all items in the partition
+//
+// Once the new file is in place `obsolete_filename`, if any, is removed. This is
+// how RefCountCacheJournal drops the part of the journal the new file contains.
 template <class C> class RefCountCacheSerializer : public Continuation
 {
 public:
@@ -57,7 +60,8 @@ public:
   // helper method to spin on writes to disk
   int write_to_disk(const void *, size_t);
 
-  RefCountCacheSerializer(Continuation *acont, RefCountCache<C> *cc, int frequency, std::string dirname, std::string filename);
+  RefCountCacheSerializer(Continuation *acont, RefCountCache<C> *cc, int frequency, std::string dirname, std::string filename,
+                          std::string obsolete_filename = std::string());
   ~RefCountCacheSerializer() override;
 
 private:
@@ -68,6 +72,7 @@ private:
   std::string dirname;
   std::string filename;
   std::string tmp_filename;
+  std::string obsolete_filename;
 
   ink_hrtime time_per_partition;
   ink_hrtime start;
@@ -80,7 +85,7 @@ private:
 
 template <class C>
 RefCountCacheSerializer<C>::RefCountCacheSerializer(Continuation *acont, RefCountCache<C> *cc, int frequency, std::string dirname,
-                                                    std::string filename)
+                                                    std::string filename, std::string obsolete_filename)
   : Continuation(nullptr),
     partition(0),
     cache(cc),
@@ -88,6 +93,7 @@ RefCountCacheSerializer<C>::RefCountCacheSerializer(Continuation *acont, RefCoun
     fd(-1),
     dirname(std::move(dirname)),
     filename(std::move(filename)),
+    obsolete_filename(std::move(obsolete_filename)),
     time_per_partition(HRTIME_SECONDS(frequency) / cc->partition_count()),
     start(Thread::get_hrtime()),
     total_items(0),
@@ -292,6 +298,12 @@ RefCountCacheSerializer<C>::finalize_sync()
     return error;
   }
 
+  // Only now that the rename is persisted can the obsolete file go, if its removal is lost it
+  // is read again on load, which is harmless.
+  if (!this->obsolete_filename.empty() && unlink(this->obsolete_filename.c_str()) != 0 && errno != ENOENT) {
+    Warning("Unable to remove %s: %s", this->obsolete_filename.c_str(), strerror(errno));
+  }
+
   // Don't bother checking for errors on the close since there's nothing we can do about it at
   // this point anyway.
   socketManager.close(dirfd);
@@ -324,3 +336,269 @@ RefCountCacheSerializer<C>::write_to_disk(const void *ptr, size_t n_bytes)
   }
   return 0;
 }
+
+// This continuation persists RefCountCache incrementally. Every `frequency` seconds the changes
+// recorded by the partitions are appended to a journal next to the file RefCountCacheSerializer
+// writes, so that the cost of persisting follows the rate of change and not the size of the cache.
+//
+// Once the journal is larger than the file, and at most every `compact_frequency` seconds, it is
+// compacted: the journal is moved aside to "<filename>.journal.old", a new one is started and the
+// file is rewritten by RefCountCacheSerializer, which then removes the old journal. Since the last
+// change to a key wins, replaying changes that the file already has is harmless, and on load the
+// file, the old journal and the journal are read in that order.
+template <class C> class RefCountCacheJournal : public Continuation
+{
+public:
+  RefCountCacheJournal(RefCountCache<C> *cc, int frequency, int compact_frequency, std::string dirname, std::string filename);
+  ~RefCountCacheJournal() override;
+
+  // Load the cache from disk and start the journal, the result is that of loading the file.
+  int start(C *(*load_func)(char *, unsigned int));
+
+  int flush_event(int event, Event *e);
+
+private:
+  // Open the journal, keeping the first `valid_length` bytes if it has a header.
+  int open_journal(size_t valid_length);
+  int flush();
+  void compact();
+
+  // helper method to spin on writes to disk
+  int write_to_disk(const void *, size_t);
+
+  static constexpr size_t MIN_COMPACT_SIZE = 1 << 20;
+  static constexpr size_t WRITE_SIZE       = 1 << 20;
+
+  RefCountCache<C> *cache;
+  int frequency;
+  int compact_frequency;
+
+  std::string dirname;
+  std::string filename;
+  std::string journal_filename;
+  std::string old_journal_filename;
+
+  int fd = -1; // fd of the journal
+
+  size_t journal_size = 0;
+  size_t file_size    = 0;
+
+  bool compacting            = false;
+  ink_hrtime last_compaction = 0;
+
+  std::vector<RefCountCacheHashEntry *> records;
+  std::string buffer;
+};
+
+template <class C>
+RefCountCacheJournal<C>::RefCountCacheJournal(RefCountCache<C> *cc, int frequency, int compact_frequency, std::string dirname,
+                                              std::string filename)
+  : Continuation(new_ProxyMutex()),
+    cache(cc),
+    frequency(frequency),
+    compact_frequency(compact_frequency),
+    dirname(std::move(dirname)),
+    filename(std::move(filename))
+{
+  this->journal_filename     = this->filename + ".journal";
+  this->old_journal_filename = this->filename + ".journal.old";
+  SET_HANDLER(&RefCountCacheJournal::flush_event);
+}
+
+template <class C> RefCountCacheJournal<C>::~RefCountCacheJournal()
+{
+  if (this->fd != -1) {
+    socketManager.close(this->fd);
+  }
+}
+
+template <class C>
+int
+RefCountCacheJournal<C>::start(C *(*load_func)(char *, unsigned int))
+{
+  struct stat st;
+  int ret = -1;
+
+  if (stat(this->filename.c_str(), &st) == 0) {
+    this->file_size = st.st_size;
+    ret             = LoadRefCountCacheFromPath<C>(*this->cache, this->filename, load_func);
+  }
+  if (access(this->old_journal_filename.c_str(), F_OK) == 0) {
+    LoadRefCountCacheFromPath<C>(*this->cache, this->old_journal_filename, load_func);
+  }
+  size_t valid_length = 0;
+  if (access(this->journal_filename.c_str(), F_OK) == 0) {
+    LoadRefCountCacheFromPath<C>(*this->cache, this->journal_filename, load_func, &valid_length);
+  }
+  Debug("refcountcache", "loaded %zu items from %s and its journal", this->cache->count(), this->filename.c_str());
+
+  // Drop any incomplete record at the end of the journal before appending to it.
+  this->open_journal(valid_length);
+  for (size_t i = 0; i < this->cache->partition_count(); i++) {
+    this->cache->get_partition(i).enable_journal();
+  }
+
+  this->last_compaction = Thread::get_hrtime();
+  eventProcessor.schedule_every(this, HRTIME_SECONDS(this->frequency), ET_TASK);
+  return ret;
+}
+
+template <class C>
+int
+RefCountCacheJournal<C>::open_journal(size_t valid_length)
+{
+  this->fd = socketManager.open(this->journal_filename.c_str(), O_RDWR | O_CREAT, 0644); // TODO: configurable perms
+  if (this->fd < 0) {
+    Warning("Unable to open journal %s, changes will only be persisted by compaction: %s", this->journal_filename.c_str(),
+            strerror(errno));
+    this->fd = -1;
+    return -errno;
+  }
+
+  int ret;
+  if (valid_length < sizeof(RefCountCacheHeader)) {
+    if (ftruncate(this->fd, 0) != 0) {
+      ret = -errno;
+    } else {
+      ret = this->write_to_disk(&this->cache->get_header(), sizeof(RefCountCacheHeader));
+    }
+    this->journal_size = sizeof(RefCountCacheHeader);
+  } else {
+    ret                = ftruncate(this->fd, valid_length) == 0 && lseek(this->fd, 0, SEEK_END) >= 0 ? 0 : -errno;
+    this->journal_size = valid_length;
+  }
+
+  if (ret < 0) {
+    Warning("Error starting journal %s: %s", this->journal_filename.c_str(), strerror(-ret));
+    socketManager.close(this->fd);
+    this->fd = -1;
+  }
+  return ret;
+}
+
+template <class C>
+int
+RefCountCacheJournal<C>::flush_event(int event, Event * /* e */)
+{
+  if (event == REFCOUNT_CACHE_EVENT_SYNC) {
+    // compaction is over, whether it succeeded or not.
+    struct stat st;
+    if (stat(this->filename.c_str(), &st) == 0) {
+      this->file_size = st.st_size;
+    }
+    this->compacting = false;
+    return EVENT_DONE;
+  }
+
+  this->flush();
+
+  ink_hrtime now = Thread::get_hrtime();
+  if (!this->compacting && now - this->last_compaction >= HRTIME_SECONDS(this->compact_frequency) &&
+      (this->fd < 0 || this->journal_size > std::max(this->file_size, MIN_COMPACT_SIZE))) {
+    this->last_compaction = now;
+    this->compact();
+  }
+  return EVENT_CONT;
+}
+
+// Append the changes of all partitions to the journal.
+template <class C>
+int
+RefCountCacheJournal<C>::flush()
+{
+  int ret         = 0;
+  size_t appended = 0;
+
+  auto write_buffer = [this, &ret, &appended]() {
+    if (ret == 0 && this->fd >= 0 && !this->buffer.empty()) {
+      ret = this->write_to_disk(this->buffer.data(), this->buffer.size());
+      if (ret == 0) {
+        appended += this->buffer.size();
+      }
+    }
+    this->buffer.clear();
+  };
+
+  for (size_t i = 0; i < this->cache->partition_count(); i++) {
+    this->cache->get_partition(i).take_journal(this->records);
+    for (auto &entry : this->records) {
+      // An erase is written as a record with no item.
+      this->buffer.append(reinterpret_cast<char *>(&entry->meta), sizeof(entry->meta));
+      if (entry->item) {
+        this->buffer.append(reinterpret_cast<char *>(entry->item.get()), entry->meta.size);
+      }
+      RefCountCacheHashEntry::free<C>(entry);
+    }
+    this->records.clear();
+
+    if (this->buffer.size() >= WRITE_SIZE) {
+      write_buffer();
+    }
+  }
+  write_buffer();
+
+  if (ret == 0 && appended > 0) {
+    ret = socketManager.fsync(this->fd);
+  }
+  if (ret < 0) {
+    // Cut off what was partially written, or give up on the journal until the next compaction.
+    Warning("Error writing journal %s: %s", this->journal_filename.c_str(), strerror(-ret));
+    if (ftruncate(this->fd, this->journal_size) != 0 || lseek(this->fd, 0, SEEK_END) < 0) {
+      socketManager.close(this->fd);
+      this->fd = -1;
+    }
+    return ret;
+  }
+
+  this->journal_size += appended;
+  return 0;
+}
+
+// Start a new journal and rewrite the file, the old journal is removed once the file is in place.
+template <class C>
+void
+RefCountCacheJournal<C>::compact()
+{
+  // If an old journal is left over from a failed compaction, it is still needed and the current
+  // journal carries on after it.
+  if (access(this->old_journal_filename.c_str(), F_OK) != 0) {
+    if (this->fd >= 0) {
+      socketManager.close(this->fd);
+      this->fd = -1;
+      if (rename(this->journal_filename.c_str(), this->old_journal_filename.c_str()) != 0) {
+        Warning("Unable to move journal %s aside: %s", this->journal_filename.c_str(), strerror(errno));
+        this->open_journal(this->journal_size);
+        return;
+      }
+    }
+    this->open_journal(0);
+  } else if (this->fd < 0) {
+    this->open_journal(0);
+  }
+
+  Debug("refcountcache", "compacting %s, journal size=%zu file size=%zu", this->filename.c_str(), this->journal_size,
+        this->file_size);
+  this->compacting = true;
+  new RefCountCacheSerializer<C>(this, this->cache, this->compact_frequency, this->dirname, this->filename,
+                                 this->old_journal_filename);
+}
+
+// Write *i to this->fd, if there is an error we'll just stop this continuation
+template <class C>
+int
+RefCountCacheJournal<C>::write_to_disk(const void *ptr, size_t n_bytes)
+{
+  size_t written = 0;
+  while (written < n_bytes) {
+    int ret = socketManager.write(this->fd, (char *)ptr + written, n_bytes - written);
+    if (ret < 0) {
+      return ret;
+    } else if (ret == 0) {
+      // Nothing was written, the records would be lost
+      return -EIO;
+    } else {
+      written += ret;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,272 @@
+/** @file
+
+  Unit tests for the selection of HostDB names to refresh ahead of their expiry
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <iostream>
+#include "P_HostDB.h"
+#include "tscore/I_Layout.h"
+#include <diags.i>
+#include <vector>
+
+// HostDB.cc is not linked in, these are the parts of it the selection uses.
+ink_time_t hostdb_current_interval = 0;
+RecRawStatBlock *hostdb_rsb        = nullptr;
+
+HostDBHash::HostDBHash() {}
+
+HostDBHash::~HostDBHash() {}
+
+using Host = HostDBRefreshAhead::Host;
+
+static const ink_time_t START = 1000;
+
+// A name, the key picks its shard.
+struct Name {
+  Name(const char *name, uint64_t key, in_port_t port = 80)
+  {
+    hash.host_name   = name;
+    hash.host_len    = strlen(name);
+    hash.port        = port;
+    hash.db_mark     = HOSTDB_MARK_IPV4;
+    hash.hash.u64[0] = key;
+  }
+
+  HostDBHash hash;
+};
+
+// A record that resolved at `timestamp`.
+struct Record {
+  Record(ink_time_t timestamp, unsigned ttl)
+  {
+    info.ip_timestamp        = timestamp;
+    info.ip_timeout_interval = ttl;
+    info.is_srv              = 0;
+    info.reverse_dns         = 0;
+    info.round_robin         = 0;
+    info.round_robin_elt     = 0;
+    ats_ip_pton("10.0.0.1", &info.data.ip);
+  }
+
+  HostDBInfo info;
+};
+
+static void
+touch(HostDBRefreshAhead &refresh, Name &name, Record &record, int times = 1)
+{
+  for (int i = 0; i < times; i++) {
+    refresh.touch(name.hash, &record.info);
+  }
+}
+
+static std::vector<Host>
+due_at(HostDBRefreshAhead &refresh, ink_time_t now)
+{
+  std::vector<Host> due;
+  refresh.select(now, due);
+  return due;
+}
+
+static int64_t
+stat_sum(HostDB_Stats id)
+{
+  return raw_stat_get_tlp(hostdb_rsb, id, this_ethread())->sum;
+}
+
+// Only the names looked up often enough are refreshed, a share of their time to live before expiry
+int
+testSelection()
+{
+  int ret = 0;
+  HostDBRefreshAhead refresh(2, 10, 1000);
+  Name hot("hot.example.com", 1, 8080);
+  Name cold("cold.example.com", 2);
+  Record record(START, 100);
+
+  touch(refresh, hot, record, 3);
+  touch(refresh, cold, record);
+
+  // 10% of 100 seconds before the expiry at 1100
+  ret |= !due_at(refresh, START + 89).empty();
+  std::vector<Host> due = due_at(refresh, START + 90);
+  ret |= due.size() != 1;
+  if (due.size() == 1) {
+    ret |= due[0].name != "hot.example.com";
+    ret |= due[0].port != 8080;
+    ret |= due[0].db_mark != HOSTDB_MARK_IPV4;
+    ret |= due[0].hash != hot.hash.hash;
+  }
+  printf("selection ret=%d\n", ret);
+
+  // The cold name was dropped, it starts over from its next lookup
+  Record later(START + 90, 100);
+  touch(refresh, cold, later);
+  // The hot name needs as many lookups of the refreshed record again
+  Record refreshed(START + 95, 100);
+  touch(refresh, hot, refreshed, 2);
+  due = due_at(refresh, START + 185);
+  ret |= due.size() != 1 || due[0].name != "hot.example.com";
+  printf("refreshed ret=%d\n", ret);
+
+  // Nobody looked up the second refresh, the name is dropped a time to live later
+  ret |= !due_at(refresh, START + 285).empty();
+  // and it starts over from its next lookup
+  touch(refresh, hot, refreshed);
+  ret |= !due_at(refresh, START + 400).empty();
+  printf("dropped ret=%d\n", ret);
+
+  return ret;
+}
+
+// A record from before the refresh does not count as a hit of the refresh
+int
+testStats()
+{
+  int ret = 0;
+  HostDBRefreshAhead refresh(1, 10, 1000);
+  Name name("stats.example.com", 3);
+  Record record(START, 100);
+
+  int64_t started = stat_sum(hostdb_refresh_ahead_started_stat);
+  int64_t hits    = stat_sum(hostdb_refresh_ahead_hits_stat);
+  int64_t wasted  = stat_sum(hostdb_refresh_ahead_wasted_stat);
+
+  touch(refresh, name, record);
+  ret |= due_at(refresh, START + 90).size() != 1;
+  ret |= stat_sum(hostdb_refresh_ahead_started_stat) != started + 1;
+
+  // Lookups until the refresh lands leave the name to be checked a time to live later
+  touch(refresh, name, record);
+  ret |= stat_sum(hostdb_refresh_ahead_hits_stat) != hits;
+  ret |= !due_at(refresh, START + 91).empty();
+  ret |= stat_sum(hostdb_refresh_ahead_wasted_stat) != wasted;
+  Record refreshed(START + 90, 100);
+  touch(refresh, name, refreshed);
+  ret |= stat_sum(hostdb_refresh_ahead_hits_stat) != hits + 1;
+
+  // The second refresh is not looked up
+  ret |= due_at(refresh, START + 180).size() != 1;
+  ret |= !due_at(refresh, START + 280).empty();
+  ret |= stat_sum(hostdb_refresh_ahead_started_stat) != started + 2;
+  ret |= stat_sum(hostdb_refresh_ahead_wasted_stat) != wasted + 1;
+  printf("stats ret=%d\n", ret);
+
+  return ret;
+}
+
+// The lead is at least a second and at most the time to live
+int
+testLead()
+{
+  int ret = 0;
+  HostDBRefreshAhead short_lead(1, 10, 1000);
+  HostDBRefreshAhead whole_ttl(1, 200, 1000);
+  Name name("lead.example.com", 4);
+  Record record(START, 5);
+
+  touch(short_lead, name, record);
+  ret |= !due_at(short_lead, START + 3).empty();
+  ret |= due_at(short_lead, START + 4).size() != 1;
+
+  // Due as soon as it resolved, that is at the next tick
+  touch(whole_ttl, name, record);
+  ret |= due_at(whole_ttl, START + 1).size() != 1;
+  printf("lead ret=%d\n", ret);
+
+  return ret;
+}
+
+// Only names that resolved are tracked, up to the limit of their shard
+int
+testTracked()
+{
+  int ret = 0;
+  HostDBRefreshAhead refresh(1, 10, 0);
+  Record record(START, 100);
+
+  Name failed("failed.example.com", 5);
+  Record failed_record(START, 100);
+  failed_record.info.data.ip.sa.sa_family = AF_UNSPEC;
+  touch(refresh, failed, failed_record);
+
+  Name reverse("reverse.example.com", 6);
+  Record reverse_record(START, 100);
+  reverse_record.info.reverse_dns = 1;
+  touch(refresh, reverse, reverse_record);
+
+  Name address("", 7);
+  address.hash.host_name = nullptr;
+  touch(refresh, address, record);
+
+  ret |= !due_at(refresh, START + 90).empty();
+
+  // With no limit a shard still holds a name, the keys 8 and 24 share a shard
+  Name first("first.example.com", 8);
+  Name second("second.example.com", 24);
+  Name other("other.example.com", 9);
+  touch(refresh, first, record);
+  touch(refresh, second, record);
+  touch(refresh, other, record);
+  std::vector<Host> due = due_at(refresh, START + 190);
+  ret |= due.size() != 2;
+  for (Host &h : due) {
+    ret |= h.name == "second.example.com";
+  }
+  printf("tracked ret=%d\n", ret);
+
+  return ret;
+}
+
+int
+main()
+{
+  RecModeT mode_type = RECM_STAND_ALONE;
+  Layout::create();
+  init_diags("", nullptr);
+  RecProcessInit(mode_type);
+  ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+
+  // The stats are counted in the thread, allocate them first.
+  hostdb_rsb           = RecAllocateRawStatBlock(static_cast<int>(HostDB_Stat_Count));
+  EThread *main_thread = new EThread;
+  main_thread->set_specific();
+
+  // The wheels start at the current interval
+  hostdb_current_interval = START;
+
+  int ret = 0;
+
+  printf("Testing selection\n");
+  ret |= testSelection();
+
+  printf("Testing stats\n");
+  ret |= testStats();
+
+  printf("Testing lead\n");
+  ret |= testLead();
+
+  printf("Testing tracked names\n");
+  ret |= testTracked();
+
+  printf("TestRun: %d\n", ret);
+
+  return ret;
+}
@@ -28,8 +28,6 @@
 #include <diags.i>
 #include <set>
 
-// TODO: add tests with expiry_time
-
 class ExampleStruct : public RefCountObj
 {
 public:
@@ -197,6 +195,43 @@ testclear()
   return ret;
 }
 
+int
+testexpiry()
+{
+  int ret = 0;
+
+  RefCountCache<ExampleStruct> *cache = new RefCountCache<ExampleStruct>(4);
+  ink_time_t now                      = ink_time();
+
+  ExampleStruct *soon  = ExampleStruct::alloc();
+  ExampleStruct *later = ExampleStruct::alloc();
+  cache->put(1, soon, 0, now + 5);
+  cache->put(2, later, 0, now + 100);
+
+  // Nothing is removed before its expiry time
+  cache->expire(now + 4);
+  ret |= cache->get(1).get() != soon;
+  ret |= cache->count() != 2;
+
+  cache->expire(now + 5);
+  ret |= cache->get(1).get() != nullptr;
+  ret |= cache->get(2).get() != later;
+  ret |= soon->idx != -1;
+
+  // Replacing an item drops the expiry time of the old one
+  ExampleStruct *replaced = ExampleStruct::alloc();
+  cache->put(2, replaced, 0, now + 300);
+  cache->expire(now + 200);
+  ret |= cache->get(2).get() != replaced;
+
+  cache->expire(now + 300);
+  ret |= cache->count() != 0;
+
+  delete cache;
+
+  return ret;
+}
+
 int
 test()
 {
@@ -215,6 +250,10 @@ test()
   ret |= testRefcounting();
   printf("refcount ret %d\n", ret);
 
+  printf("Testing expiry\n");
+  ret |= testexpiry();
+  printf("expiry ret %d\n", ret);
+
   // Initialize our cache
   int cachePartitions                 = 4;
   RefCountCache<ExampleStruct> *cache = new RefCountCache<ExampleStruct>(cachePartitions);
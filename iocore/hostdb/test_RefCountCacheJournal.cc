@@ -0,0 +1,328 @@
+/** @file
+
+  Unit tests for RefCountCacheJournal
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <iostream>
+#include <RefCountCache.cc>
+#include <P_RefCountCacheSerializer.h>
+#include <I_EventSystem.h>
+#include "tscore/I_Layout.h"
+#include <diags.i>
+#include <string>
+
+class JournalItem : public RefCountObj
+{
+public:
+  int idx;
+
+  static JournalItem *
+  alloc(int size = 0)
+  {
+    return new (malloc(sizeof(JournalItem) + size)) JournalItem();
+  }
+
+  void
+  free() override
+  {
+    this->~JournalItem();
+    ::free(this);
+  }
+
+  static JournalItem *
+  unmarshall(char *buf, unsigned int size)
+  {
+    if (size < sizeof(JournalItem)) {
+      return nullptr;
+    }
+    JournalItem *ret = JournalItem::alloc(size - sizeof(JournalItem));
+    memcpy((void *)ret, buf, size);
+    // Reset the refcount back to 0
+    ret = new (ret) JournalItem();
+    return ret;
+  }
+};
+
+// Length of the journal record of an item with `payload` bytes after it, an erase has no item.
+static const size_t ERASE_RECORD = sizeof(RefCountCacheItemMeta);
+
+static size_t
+record_size(int payload)
+{
+  return sizeof(RefCountCacheItemMeta) + sizeof(JournalItem) + payload;
+}
+
+static void
+put_item(RefCountCache<JournalItem> *cache, uint64_t key, int idx, int payload)
+{
+  JournalItem *item = JournalItem::alloc(payload);
+  item->idx         = idx;
+  memset(reinterpret_cast<char *>(item) + sizeof(JournalItem), 'x', payload);
+  // Items that have expired are not written out by compaction
+  cache->put(key, item, payload, ink_time() + 3600);
+}
+
+// -1 if the key is not in the cache
+static int
+item_idx(RefCountCache<JournalItem> *cache, uint64_t key)
+{
+  Ptr<JournalItem> item = cache->get(key);
+  return item ? item->idx : -1;
+}
+
+static off_t
+file_size(const std::string &path)
+{
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+static void
+remove_files(const std::string &path)
+{
+  for (const char *suffix : {"", ".journal", ".journal.old", ".syncing"}) {
+    unlink((path + suffix).c_str());
+  }
+}
+
+// The journals are only flushed by the tests, and are left behind as they are scheduled.
+static RefCountCacheJournal<JournalItem> *
+start_journal(RefCountCache<JournalItem> *cache, const std::string &dir, const std::string &path, int compact_frequency = 3600)
+{
+  auto journal = new RefCountCacheJournal<JournalItem>(cache, 3600, compact_frequency, dir, path);
+  journal->start(JournalItem::unmarshall);
+  return journal;
+}
+
+static void
+flush(RefCountCacheJournal<JournalItem> *journal)
+{
+  SCOPED_MUTEX_LOCK(lock, journal->mutex, this_ethread());
+  journal->flush_event(EVENT_INTERVAL, nullptr);
+}
+
+// Write changes to the journal and replay them into another cache
+int
+testReplay(const std::string &dir)
+{
+  int ret                  = 0;
+  std::string path         = dir + "/replay";
+  std::string journal_path = path + ".journal";
+
+  RefCountCache<JournalItem> *cache = new RefCountCache<JournalItem>(4);
+  auto journal                      = start_journal(cache, dir, path);
+  // A new journal only has the header
+  ret |= file_size(journal_path) != static_cast<off_t>(sizeof(RefCountCacheHeader));
+
+  for (int i = 0; i < 100; i++) {
+    put_item(cache, i, i, 16);
+  }
+  flush(journal);
+  off_t size = sizeof(RefCountCacheHeader) + 100 * record_size(16);
+  ret |= file_size(journal_path) != size;
+  printf("put ret=%d size=%ld\n", ret, file_size(journal_path));
+
+  // An erase is a record with a zero size and no item
+  cache->erase(7);
+  cache->erase(8);
+  // Erasing a key that is not there writes nothing
+  cache->erase(1000);
+  flush(journal);
+  size += 2 * ERASE_RECORD;
+  ret |= file_size(journal_path) != size;
+  printf("erase ret=%d size=%ld\n", ret, file_size(journal_path));
+
+  // The last change to a key wins
+  put_item(cache, 9, 1009, 32);
+  flush(journal);
+  size += record_size(32);
+  ret |= file_size(journal_path) != size;
+
+  // Nothing changed, nothing is written
+  flush(journal);
+  ret |= file_size(journal_path) != size;
+
+  RefCountCache<JournalItem> *replayed = new RefCountCache<JournalItem>(4);
+  start_journal(replayed, dir, path);
+  ret |= replayed->count() != 98;
+  ret |= item_idx(replayed, 7) != -1;
+  ret |= item_idx(replayed, 8) != -1;
+  ret |= item_idx(replayed, 9) != 1009;
+  ret |= item_idx(replayed, 42) != 42;
+  // A complete journal is kept as it is
+  ret |= file_size(journal_path) != size;
+  printf("replay ret=%d count=%zu\n", ret, replayed->count());
+
+  remove_files(path);
+  return ret;
+}
+
+// Replay a journal whose last record was cut off by a crash
+int
+testTruncated(const std::string &dir)
+{
+  int ret                  = 0;
+  std::string path         = dir + "/truncated";
+  std::string journal_path = path + ".journal";
+
+  // A single partition keeps the records in the order of the changes
+  RefCountCache<JournalItem> *cache = new RefCountCache<JournalItem>(1);
+  auto journal                      = start_journal(cache, dir, path);
+  for (int i = 0; i < 10; i++) {
+    put_item(cache, i, i, 64);
+  }
+  flush(journal);
+  off_t size = sizeof(RefCountCacheHeader) + 10 * record_size(64);
+  ret |= file_size(journal_path) != size;
+
+  // Cut the last item in the middle of its record
+  ret |= truncate(journal_path.c_str(), size - 5) != 0;
+
+  RefCountCache<JournalItem> *replayed = new RefCountCache<JournalItem>(1);
+  auto replayed_journal                = start_journal(replayed, dir, path);
+  ret |= replayed->count() != 9;
+  ret |= item_idx(replayed, 8) != 8;
+  ret |= item_idx(replayed, 9) != -1;
+  // The partial record is dropped before appending to the journal
+  size -= record_size(64);
+  ret |= file_size(journal_path) != size;
+  printf("truncated item ret=%d size=%ld\n", ret, file_size(journal_path));
+
+  // Cut an erase record in the middle of its metadata
+  replayed->erase(3);
+  flush(replayed_journal);
+  ret |= truncate(journal_path.c_str(), size + ERASE_RECORD / 2) != 0;
+
+  // The records written after a cut are replayed
+  RefCountCache<JournalItem> *again = new RefCountCache<JournalItem>(1);
+  auto again_journal                = start_journal(again, dir, path);
+  ret |= again->count() != 9;
+  ret |= item_idx(again, 3) != 3;
+  ret |= file_size(journal_path) != size;
+  put_item(again, 10, 10, 64);
+  flush(again_journal);
+
+  RefCountCache<JournalItem> *after = new RefCountCache<JournalItem>(1);
+  start_journal(after, dir, path);
+  ret |= after->count() != 10;
+  ret |= item_idx(after, 9) != -1;
+  ret |= item_idx(after, 10) != 10;
+  printf("truncated erase ret=%d count=%zu\n", ret, after->count());
+
+  // A journal cut in its header is started over
+  ret |= truncate(journal_path.c_str(), sizeof(RefCountCacheHeader) / 2) != 0;
+  RefCountCache<JournalItem> *empty = new RefCountCache<JournalItem>(1);
+  start_journal(empty, dir, path);
+  ret |= empty->count() != 0;
+  ret |= file_size(journal_path) != static_cast<off_t>(sizeof(RefCountCacheHeader));
+  printf("truncated header ret=%d\n", ret);
+
+  remove_files(path);
+  return ret;
+}
+
+// Rewrite the file once the journal is large, and replay the file and the new journal
+int
+testCompaction(const std::string &dir)
+{
+  int ret                      = 0;
+  std::string path             = dir + "/compacted";
+  std::string journal_path     = path + ".journal";
+  std::string old_journal_path = path + ".journal.old";
+  const int count              = 1200;
+
+  RefCountCache<JournalItem> *cache = new RefCountCache<JournalItem>(4);
+  auto journal                      = start_journal(cache, dir, path, 0);
+  ret |= file_size(path) != -1;
+
+  // More than the 1MB a journal may have before it is compacted
+  for (int i = 0; i < count; i++) {
+    put_item(cache, i, i, 1024);
+  }
+  for (int i = 0; i < 100; i++) {
+    cache->erase(i);
+  }
+  flush(journal);
+
+  // The changes went to the journal moved aside, and the file is written from the cache
+  for (int i = 0; i < 100 && (access(old_journal_path.c_str(), F_OK) == 0 || file_size(path) < 0); i++) {
+    usleep(100000);
+  }
+  ret |= access(old_journal_path.c_str(), F_OK) == 0;
+  ret |= file_size(path) != static_cast<off_t>(sizeof(RefCountCacheHeader) + (count - 100) * record_size(1024));
+  ret |= file_size(journal_path) != static_cast<off_t>(sizeof(RefCountCacheHeader));
+  printf("compaction ret=%d size=%ld\n", ret, file_size(path));
+
+  // Later changes go to the new journal, an erase there removes an item of the file
+  cache->erase(100);
+  put_item(cache, 5000, 5000, 1024);
+  flush(journal);
+  ret |= file_size(journal_path) != static_cast<off_t>(sizeof(RefCountCacheHeader) + ERASE_RECORD + record_size(1024));
+
+  RefCountCache<JournalItem> *replayed = new RefCountCache<JournalItem>(4);
+  start_journal(replayed, dir, path);
+  ret |= replayed->count() != static_cast<size_t>(count - 100);
+  ret |= item_idx(replayed, 50) != -1;
+  ret |= item_idx(replayed, 100) != -1;
+  ret |= item_idx(replayed, 200) != 200;
+  ret |= item_idx(replayed, 5000) != 5000;
+  printf("compaction replay ret=%d count=%zu\n", ret, replayed->count());
+
+  remove_files(path);
+  return ret;
+}
+
+int
+main()
+{
+  RecModeT mode_type = RECM_STAND_ALONE;
+  Layout::create();
+  init_diags("", nullptr);
+  RecProcessInit(mode_type);
+  ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+  eventProcessor.start(2);
+
+  EThread *main_thread = new EThread;
+  main_thread->set_specific();
+
+  char dir_template[] = "/tmp/refcountcache_journal.XXXXXX";
+  char *dir           = mkdtemp(dir_template);
+  if (dir == nullptr) {
+    printf("Unable to create a directory: %s\n", strerror(errno));
+    return 1;
+  }
+
+  int ret = 0;
+
+  printf("Testing replay\n");
+  ret |= testReplay(dir);
+
+  printf("Testing truncated journal\n");
+  ret |= testTruncated(dir);
+
+  printf("Testing compaction\n");
+  ret |= testCompaction(dir);
+
+  rmdir(dir);
+  printf("TestRun: %d\n", ret);
+
+  return ret;
+}
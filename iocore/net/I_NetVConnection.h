@@ -590,6 +590,21 @@ public:
    */
   virtual void trapWriteBufferEmpty(int event = VC_EVENT_WRITE_READY);
 
+  /** Move the bytes read from this connection to @a dst through a kernel pipe.
+
+      The bytes are not copied into the read buffer, but the read VIO of this connection and the
+      write VIO of @a dst still count them and signal the usual events. Bytes already in the write
+      buffer of @a dst are sent first. Both VIOs must be set up by the same continuation. This stays
+      in effect until the next @c do_io_read on this connection or @c do_io_write on @a dst.
+
+      @return @c true if both connections support it, otherwise nothing is changed.
+   */
+  virtual bool
+  splice_to(NetVConnection * /* dst ATS_UNUSED */)
+  {
+    return false;
+  }
+
   /** Returns local sockaddr storage. */
   sockaddr const *get_local_addr();
   IpEndpoint const &get_local_endpoint();
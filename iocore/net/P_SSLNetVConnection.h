@@ -450,6 +450,13 @@ protected:
 
   void _fire_ssl_servername_event() override;
 
+  // The socket carries TLS records, and handshake data may be buffered in the SSL object.
+  bool
+  _is_spliceable() const override
+  {
+    return false;
+  }
+
 private:
   std::string_view map_tls_protocol_to_tag(const char *proto_string) const;
   bool update_rbio(bool move_to_socket);
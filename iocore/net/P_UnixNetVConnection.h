@@ -88,6 +88,33 @@ NetVCOptions::set_sock_param(int _recv_bufsize, int _send_bufsize, unsigned long
 
 enum tcp_congestion_control_t { CLIENT_SIDE, SERVER_SIDE };
 
+/** The kernel pipe between two spliced connections, see @c UnixNetVConnection::splice_to.
+
+    The kernel does not report how much a pipe holds, so the bytes in flight are counted here. The
+    pipe is only used under the mutex of the VIOs on both ends.
+ */
+struct NetSplicePipe : public RefCountObj {
+  NetSplicePipe();
+  ~NetSplicePipe() override;
+
+  bool
+  is_open() const
+  {
+    return fd[0] != NO_FD;
+  }
+
+  /** Move up to @a towrite bytes from the pipe to the socket @a to_fd.
+
+      @a total_written is increased by the bytes moved. Returns the result of the last splice, or
+      -EAGAIN if nothing could be moved, never 0.
+   */
+  int64_t write_to(int to_fd, int64_t towrite, int64_t &total_written);
+
+  int fd[2]        = {NO_FD, NO_FD};
+  int64_t capacity = 0; ///< Bytes the pipe can hold.
+  int64_t fill     = 0; ///< Bytes read into the pipe and not yet written out.
+};
+
 class UnixNetVConnection : public NetVConnection, public NetEvent
 {
 public:
@@ -267,8 +294,24 @@ public:
   int set_tcp_congestion_control(int side) override;
   void apply_options() override;
 
+  bool splice_to(NetVConnection *dst) override;
+  int64_t load_buffer_and_splice(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs);
+
+  /// Set while the bytes read go to a pipe instead of the read buffer.
+  Ptr<NetSplicePipe> read_splice;
+  /// Set while the bytes to write also come from a pipe, after those in the write buffer.
+  Ptr<NetSplicePipe> write_splice;
+
   friend void write_to_net_io(NetHandler *, UnixNetVConnection *, EThread *);
 
+protected:
+  /// Whether the socket carries the payload as is, so that it can be spliced.
+  virtual bool
+  _is_spliceable() const
+  {
+    return con.sock_type == SOCK_STREAM;
+  }
+
 private:
   virtual void *_prepareForMigration();
   virtual NetProcessor *_getNetProcessor();
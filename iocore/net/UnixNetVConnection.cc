@@ -27,6 +27,9 @@
 #include "Log.h"
 
 #include <termios.h>
+#if HAVE_SPLICE
+#include <fcntl.h>
+#endif
 
 #define STATE_VIO_OFFSET ((uintptr_t) & ((NetState *)0)->vio)
 #define STATE_FROM_VIO(_x) ((NetState *)(((char *)(_x)) - STATE_VIO_OFFSET))
@@ -181,6 +184,102 @@ write_signal_error(NetHandler *nh, UnixNetVConnection *vc, int lerrno)
   return write_signal_done(VC_EVENT_ERROR, nh, vc);
 }
 
+#if HAVE_SPLICE
+// Read for a UnixNetVConnection that is spliced to another one. The data
+// goes to the splice pipe instead of the read buffer, the VIO is updated
+// and signalled the same way as in read_from_net.
+static void
+splice_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
+{
+  NetState *s         = &vc->read;
+  NetSplicePipe *pipe = vc->read_splice.get();
+  ProxyMutex *mutex   = thread->mutex.get();
+
+  MUTEX_TRY_LOCK(lock, s->vio.mutex, thread);
+
+  if (!lock.is_locked()) {
+    read_reschedule(nh, vc);
+    return;
+  }
+  if (vc->closed) {
+    vc->nh->free_netevent(vc);
+    return;
+  }
+  if (!s->enabled || s->vio.op != VIO::READ || s->vio.is_disabled()) {
+    read_disable(nh, vc);
+    return;
+  }
+
+  // if there is nothing to do or the pipe is full, disable connection. The
+  // VIO is reenabled once the writer has drained the pipe.
+  int64_t toread = std::min(s->vio.ntodo(), pipe->capacity - pipe->fill);
+  if (toread <= 0) {
+    read_disable(nh, vc);
+    return;
+  }
+
+  int64_t r = ::splice(vc->con.fd, nullptr, pipe->fd[1], nullptr, toread, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (r < 0) {
+    r = -errno;
+  }
+  NET_INCREMENT_DYN_STAT(net_calls_to_read_stat);
+
+  // check for errors
+  if (r <= 0) {
+    if (r == -EAGAIN || r == -ENOTCONN) {
+      NET_INCREMENT_DYN_STAT(net_calls_to_read_nodata_stat);
+      if (pipe->fill > 0) {
+        // The pipe may be out of buffers rather than the socket out of data,
+        // leave the socket triggered and wait for the writer.
+        read_disable(nh, vc);
+        return;
+      }
+      vc->read.triggered = 0;
+      nh->read_ready_list.remove(vc);
+      return;
+    }
+
+    if (!r || r == -ECONNRESET) {
+      vc->read.triggered = 0;
+      nh->read_ready_list.remove(vc);
+      read_signal_done(VC_EVENT_EOS, nh, vc);
+      return;
+    }
+    vc->read.triggered = 0;
+    read_signal_error(nh, vc, static_cast<int>(-r));
+    return;
+  }
+  NET_SUM_DYN_STAT(net_read_bytes_stat, r);
+
+  pipe->fill += r;
+  s->vio.ndone += r;
+  net_activity(vc, thread);
+
+  // If there are no more bytes to read, signal read complete
+  if (s->vio.ntodo() <= 0) {
+    read_signal_done(VC_EVENT_READ_COMPLETE, nh, vc);
+    Debug("iocore_net", "splice_from_net, read finished - signal done");
+    return;
+  }
+  if (read_signal_and_update(VC_EVENT_READ_READY, vc) != EVENT_CONT) {
+    return;
+  }
+
+  // change of lock... don't look at shared variables!
+  if (lock.get_mutex() != s->vio.mutex.get()) {
+    read_reschedule(nh, vc);
+    return;
+  }
+
+  if (!s->enabled) {
+    read_disable(nh, vc);
+    return;
+  }
+
+  read_reschedule(nh, vc);
+}
+#endif
+
 // Read the data for a UnixNetVConnection.
 // Rescheduling the UnixNetVConnection by moving the VC
 // onto or off of the ready_list.
@@ -192,6 +291,13 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   ProxyMutex *mutex = thread->mutex.get();
   int64_t r         = 0;
 
+#if HAVE_SPLICE
+  if (vc->read_splice) {
+    splice_from_net(nh, vc, thread);
+    return;
+  }
+#endif
+
   MUTEX_TRY_LOCK(lock, s->vio.mutex, thread);
 
   if (!lock.is_locked()) {
@@ -341,6 +447,18 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   read_reschedule(nh, vc);
 }
 
+// Bytes waiting to be written, including those in the splice pipe.
+static inline int64_t
+write_avail_to_net(UnixNetVConnection *vc, MIOBufferAccessor &buf)
+{
+  int64_t avail = buf.reader()->read_avail();
+
+  if (vc->write_splice) {
+    avail += vc->write_splice->fill;
+  }
+  return avail;
+}
+
 //
 // Write the data for a UnixNetVConnection.
 // Rescheduling the UnixNetVConnection when necessary.
@@ -434,7 +552,7 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
   ink_assert(buf.writer());
 
   // Calculate the amount to write.
-  int64_t towrite = buf.reader()->read_avail();
+  int64_t towrite = write_avail_to_net(vc, buf);
   if (towrite > ntodo) {
     towrite = ntodo;
   }
@@ -456,7 +574,7 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     signalled = 1;
 
     // Recalculate amount to write
-    towrite = buf.reader()->read_avail();
+    towrite = write_avail_to_net(vc, buf);
     if (towrite > ntodo) {
       towrite = ntodo;
     }
@@ -471,7 +589,8 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
 
   int needs             = 0;
   int64_t total_written = 0;
-  int64_t r             = vc->load_buffer_and_write(towrite, buf, total_written, needs);
+  int64_t r             = vc->write_splice ? vc->load_buffer_and_splice(towrite, buf, total_written, needs) :
+                                       vc->load_buffer_and_write(towrite, buf, total_written, needs);
 
   if (total_written > 0) {
     NET_SUM_DYN_STAT(net_write_bytes_stat, total_written);
@@ -508,7 +627,7 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
     int wbe_event = vc->write_buffer_empty_event; // save so we can clear if needed.
 
     // If the empty write buffer trap is set, clear it.
-    if (!(buf.reader()->is_read_avail_more_than(0))) {
+    if (write_avail_to_net(vc, buf) <= 0) {
       vc->write_buffer_empty_event = 0;
     }
 
@@ -544,7 +663,7 @@ write_to_net_io(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
       read_reschedule(nh, vc);
     }
 
-    if (!(buf.reader()->is_read_avail_more_than(0))) {
+    if (write_avail_to_net(vc, buf) <= 0) {
       write_disable(nh, vc);
       return;
     }
@@ -590,6 +709,7 @@ UnixNetVConnection::do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf)
     Error("do_io_read invoked on closed vc %p, cont %p, nbytes %" PRId64 ", buf %p", this, c, nbytes, buf);
     return nullptr;
   }
+  read_splice        = nullptr;
   read.vio.op        = VIO::READ;
   read.vio.mutex     = c ? c->mutex : this->mutex;
   read.vio.cont      = c;
@@ -615,6 +735,7 @@ UnixNetVConnection::do_io_write(Continuation *c, int64_t nbytes, IOBufferReader
     Error("do_io_write invoked on closed vc %p, cont %p, nbytes %" PRId64 ", reader %p", this, c, nbytes, reader);
     return nullptr;
   }
+  write_splice        = nullptr;
   write.vio.op        = VIO::WRITE;
   write.vio.mutex     = c ? c->mutex : this->mutex;
   write.vio.cont      = c;
@@ -948,6 +1069,118 @@ UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &bu
   return r;
 }
 
+// Write the bytes in the write buffer, which were there before the splice
+// started, and then move the bytes in the splice pipe to the socket.
+int64_t
+UnixNetVConnection::load_buffer_and_splice(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs)
+{
+  int64_t r        = 0;
+  int64_t buffered = std::min(buf.reader()->read_avail(), towrite);
+
+  if (buffered > 0) {
+    r = load_buffer_and_write(buffered, buf, total_written, needs);
+    if (total_written < buffered) {
+      return r;
+    }
+  }
+
+  if (total_written < towrite) {
+    ProxyMutex *mutex = thread->mutex.get();
+    int64_t written   = total_written;
+    int64_t spliced   = write_splice->write_to(con.fd, towrite - total_written, total_written);
+
+    // Keep the result of the write buffer if nothing came from the pipe.
+    if (spliced != -EAGAIN || total_written > written || r <= 0) {
+      r = spliced;
+    }
+    NET_INCREMENT_DYN_STAT(net_calls_to_write_stat);
+  }
+
+  needs |= EVENTIO_WRITE;
+
+  return r;
+}
+
+NetSplicePipe::NetSplicePipe()
+{
+#if HAVE_SPLICE
+  if (pipe2(fd, O_NONBLOCK | O_CLOEXEC) < 0) {
+    fd[0] = fd[1] = NO_FD;
+    return;
+  }
+  capacity = fcntl(fd[0], F_GETPIPE_SZ);
+  if (capacity <= 0) {
+    capacity = 65536;
+  }
+#endif
+}
+
+int64_t
+NetSplicePipe::write_to(int to_fd, int64_t towrite, int64_t &total_written)
+{
+  int64_t r        = -EAGAIN;
+  int64_t tosplice = std::min(fill, towrite);
+
+#if HAVE_SPLICE
+  while (tosplice > 0) {
+    r = ::splice(fd[0], nullptr, to_fd, nullptr, tosplice, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (r < 0) {
+      r = -errno;
+    }
+    if (r <= 0) {
+      break;
+    }
+    fill -= r;
+    total_written += r;
+    tosplice -= r;
+  }
+#endif
+
+  // Nothing moved, either the pipe is drained or the socket is full: the
+  // caller has to wait for the socket like for a writev that would block.
+  if (r == 0) {
+    r = -EAGAIN;
+  }
+  return r;
+}
+
+NetSplicePipe::~NetSplicePipe()
+{
+  if (is_open()) {
+    ::close(fd[0]);
+    ::close(fd[1]);
+  }
+}
+
+bool
+UnixNetVConnection::splice_to(NetVConnection *dst)
+{
+#if HAVE_SPLICE
+  UnixNetVConnection *peer = dynamic_cast<UnixNetVConnection *>(dst);
+
+  // The pipe is only touched under the VIO mutex, so both ends have to be
+  // driven by the same continuation.
+  if (peer == nullptr || peer == this || !this->_is_spliceable() || !peer->_is_spliceable() || closed || peer->closed ||
+      read.vio.op != VIO::READ || peer->write.vio.op != VIO::WRITE || read.vio.cont == nullptr ||
+      read.vio.cont != peer->write.vio.cont || read_splice || peer->write_splice) {
+    return false;
+  }
+
+  Ptr<NetSplicePipe> pipe = make_ptr(new NetSplicePipe());
+  if (!pipe->is_open()) {
+    Debug("iocore_net", "unable to create a splice pipe: %s", strerror(errno));
+    return false;
+  }
+
+  Debug("iocore_net", "splicing vc %p to vc %p, pipe capacity %" PRId64, this, peer, pipe->capacity);
+  read_splice        = pipe;
+  peer->write_splice = pipe;
+  return true;
+#else
+  return false;
+#endif
+}
+
 void
 UnixNetVConnection::readDisable(NetHandler *nh)
 {
@@ -1269,6 +1502,8 @@ UnixNetVConnection::clear()
   write.vio.cont      = nullptr;
   read.vio.vc_server  = nullptr;
   write.vio.vc_server = nullptr;
+  read_splice         = nullptr;
+  write_splice        = nullptr;
   options.reset();
   if (netvc_context == NET_VCONNECTION_OUT) {
     read.vio.buffer.clear();
@@ -407,6 +407,12 @@ QUICStreamManager::set_default_application(QUICApplication *app)
   this->_app_map->set_default(app);
 }
 
+void
+QUICStreamManager::set_stream_scheduler(QUICStreamScheduler *scheduler)
+{
+  this->_stream_scheduler = scheduler;
+}
+
 bool
 QUICStreamManager::will_generate_frame(QUICEncryptionLevel level, size_t current_packet_size, bool ack_eliciting, uint32_t seq_num)
 {
@@ -448,14 +454,25 @@ QUICStreamManager::generate_frame(uint8_t *buf, QUICEncryptionLevel level, uint6
     return frame;
   }
 
-  // FIXME We should pick a stream based on priority
-  for (QUICStream *s = this->stream_list.head; s; s = s->link.next) {
-    frame = s->generate_frame(buf, level, connection_credit, maximum_frame_size, current_packet_size, seq_num);
-    if (frame) {
-      break;
+  if (this->_stream_scheduler) {
+    // Unidirectional streams carry the control data of the application, send it before the data the scheduler orders
+    for (QUICStream *s = this->stream_list.head; s && frame == nullptr; s = s->link.next) {
+      if (!s->is_bidirectional()) {
+        frame = s->generate_frame(buf, level, connection_credit, maximum_frame_size, current_packet_size, seq_num);
+      }
+    }
+    if (frame == nullptr) {
+      frame = this->_stream_scheduler->generate_frame([&](QUICStream &s) {
+        return s.generate_frame(buf, level, connection_credit, maximum_frame_size, current_packet_size, seq_num);
+      });
     }
   }
 
+  // Streams the scheduler doesn't order, e.g. requests whose header is not decoded yet, go in the order they were opened
+  for (QUICStream *s = this->stream_list.head; s && frame == nullptr; s = s->link.next) {
+    frame = s->generate_frame(buf, level, connection_credit, maximum_frame_size, current_packet_size, seq_num);
+  }
+
   if (frame != nullptr && frame->type() == QUICFrameType::STREAM) {
     this->_add_total_offset_sent(static_cast<QUICStreamFrame *>(frame)->data_length());
   }
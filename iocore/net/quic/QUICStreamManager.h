@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "QUICTypes.h"
 #include "QUICBidirectionalStream.h"
 #include "QUICUnidirectionalStream.h"
@@ -36,6 +38,20 @@
 
 class QUICTransportParameters;
 
+/**
+ * Orders the streams of an application that prioritizes them, e.g. HTTP/3 with the Extensible Priorities of RFC 9218.
+ */
+class QUICStreamScheduler
+{
+public:
+  virtual ~QUICStreamScheduler() {}
+
+  /**
+   * Calls @a generate for the streams it orders, the most urgent first, until it returns a frame, and returns that frame.
+   */
+  virtual QUICFrame *generate_frame(const std::function<QUICFrame *(QUICStream &)> &generate) = 0;
+};
+
 class QUICStreamManager : public QUICFrameHandler, public QUICFrameGenerator, public QUICStreamStateListener
 {
 public:
@@ -57,6 +73,7 @@ public:
   void reset_stream(QUICStreamId stream_id, QUICStreamErrorUPtr error);
 
   void set_default_application(QUICApplication *app);
+  void set_stream_scheduler(QUICStreamScheduler *scheduler);
 
   DLL<QUICStream> stream_list;
 
@@ -90,6 +107,7 @@ private:
 
   QUICContext *_context                                       = nullptr;
   QUICApplicationMap *_app_map                                = nullptr;
+  QUICStreamScheduler *_stream_scheduler                      = nullptr;
   std::shared_ptr<const QUICTransportParameters> _local_tp    = nullptr;
   std::shared_ptr<const QUICTransportParameters> _remote_tp   = nullptr;
   QUICStreamId _local_max_streams_bidi                        = 0;
@@ -0,0 +1,92 @@
+/** @file
+
+  Catch based unit tests for the splice pipe of UnixNetVConnection
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include "P_Net.h"
+
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if HAVE_SPLICE
+
+TEST_CASE("NetSplicePipe write_to", "[net][splice]")
+{
+  Ptr<NetSplicePipe> pipe = make_ptr(new NetSplicePipe);
+  REQUIRE(pipe->is_open());
+
+  int sock[2];
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sock) == 0);
+  fcntl(sock[0], F_SETFL, O_NONBLOCK);
+  fcntl(sock[1], F_SETFL, O_NONBLOCK);
+
+  int64_t total_written = 0;
+  char buf[16];
+
+  SECTION("an empty pipe would block")
+  {
+    CHECK(pipe->write_to(sock[0], 10, total_written) == -EAGAIN);
+    CHECK(total_written == 0);
+  }
+
+  SECTION("bytes in the pipe go to the socket")
+  {
+    REQUIRE(write(pipe->fd[1], "hello", 5) == 5);
+    pipe->fill = 5;
+
+    CHECK(pipe->write_to(sock[0], 3, total_written) == 3);
+    CHECK(total_written == 3);
+    CHECK(pipe->fill == 2);
+
+    CHECK(pipe->write_to(sock[0], 10, total_written) == 2);
+    CHECK(total_written == 5);
+    CHECK(pipe->fill == 0);
+
+    REQUIRE(read(sock[1], buf, sizeof(buf)) == 5);
+    CHECK(memcmp(buf, "hello", 5) == 0);
+
+    // Drained, the next write has to wait instead of reporting 0 bytes.
+    CHECK(pipe->write_to(sock[0], 10, total_written) == -EAGAIN);
+    CHECK(total_written == 5);
+  }
+
+  SECTION("a full socket would block")
+  {
+    while (write(sock[0], buf, sizeof(buf)) > 0) {
+    }
+    REQUIRE(errno == EAGAIN);
+
+    REQUIRE(write(pipe->fd[1], "hello", 5) == 5);
+    pipe->fill = 5;
+
+    CHECK(pipe->write_to(sock[0], 5, total_written) == -EAGAIN);
+    CHECK(total_written == 0);
+    CHECK(pipe->fill == 5);
+  }
+
+  close(sock[0]);
+  close(sock[1]);
+}
+
+#endif
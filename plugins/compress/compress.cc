@@ -1,6 +1,6 @@
 /** @file
 
-  Transforms content using gzip, deflate or brotli
+  Transforms content using gzip, deflate, brotli or zstd
 
   @section license License
 
@@ -21,6 +21,7 @@
   limitations under the License.
  */
 
+#include <cinttypes>
 #include <cstring>
 #include <zlib.h>
 
@@ -30,6 +31,10 @@
 #include <brotli/encode.h>
 #endif
 
+#if HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
 #include "ts/ts.h"
 #include "tscore/ink_defs.h"
 
@@ -44,7 +49,6 @@ using namespace Gzip;
 // FIXME: custom dictionaries would be nice. configurable/content-type?
 // a GPRS device might benefit from a higher compression ratio, whereas a desktop w. high bandwidth
 // might be served better with little or no compression at all
-// FIXME: look into compressing from the task thread pool
 // FIXME: make normalizing accept encoding configurable
 
 // from mod_deflate:
@@ -64,6 +68,20 @@ const int BROTLI_COMPRESSION_LEVEL = 6;
 const int BROTLI_LGW               = 16;
 #endif
 
+const char *TS_HTTP_VALUE_ZSTD = "zstd";
+const int TS_HTTP_LEN_ZSTD     = 4;
+
+// zstd compression level 1-19, '6' compresses text about as well as brotli
+// at '6' for much less CPU.
+#if HAVE_ZSTD_H
+const int ZSTD_COMPRESSION_LEVEL = 6;
+#endif
+
+// Limit on the chunks being compressed on task threads at once, further
+// chunks are compressed on the net thread rather than queue behind them.
+const int COMPRESS_TASK_LIMIT = 256;
+static int compress_tasks     = 0;
+
 static const char *global_hidden_header_name = nullptr;
 
 static TSMutex compress_config_mutex = TSMutexCreate();
@@ -82,6 +100,7 @@ data_alloc(int compression_type, int compression_algorithms)
   data->downstream_vio         = nullptr;
   data->downstream_buffer      = nullptr;
   data->downstream_reader      = nullptr;
+  data->output_buffer          = nullptr;
   data->downstream_length      = 0;
   data->state                  = transform_state_initialized;
   data->compression_type       = compression_type;
@@ -132,6 +151,27 @@ data_alloc(int compression_type, int compression_algorithms)
     data->bstrm.total_out = 0;
   }
 #endif
+#if HAVE_ZSTD_H
+  data->zstd.cctx      = nullptr;
+  data->zstd.total_in  = 0;
+  data->zstd.total_out = 0;
+  if (compression_type & COMPRESSION_TYPE_ZSTD) {
+    debug("zstd compression. Create zstd compression context.");
+    data->zstd.cctx = ZSTD_createCCtx();
+    if (!data->zstd.cctx) {
+      fatal("zstd compression context creation failed");
+    }
+    ZSTD_CCtx_setParameter(data->zstd.cctx, ZSTD_c_compressionLevel, ZSTD_COMPRESSION_LEVEL);
+  }
+#endif
+  data->contp              = nullptr;
+  data->task_contp         = nullptr;
+  data->thread             = nullptr;
+  data->task               = task_state_idle;
+  data->task_input         = nullptr;
+  data->task_input_reader  = nullptr;
+  data->task_output        = nullptr;
+  data->task_output_reader = nullptr;
   return data;
 }
 
@@ -152,6 +192,15 @@ data_destroy(Data *data)
 #if HAVE_BROTLI_ENCODE_H
   BrotliEncoderDestroyInstance(data->bstrm.br);
 #endif
+#if HAVE_ZSTD_H
+  ZSTD_freeCCtx(data->zstd.cctx);
+#endif
+
+  if (data->task_contp) {
+    TSContDestroy(data->task_contp);
+    TSIOBufferDestroy(data->task_input);
+    TSIOBufferDestroy(data->task_output);
+  }
 
   TSfree(data);
 }
@@ -164,7 +213,10 @@ content_encoding_header(TSMBuffer bufp, TSMLoc hdr_loc, const int compression_ty
   const char *value = nullptr;
   int value_len     = 0;
   // Delete Content-Encoding if present???
-  if (compression_type & COMPRESSION_TYPE_BROTLI && (algorithm & ALGORITHM_BROTLI)) {
+  if (compression_type & COMPRESSION_TYPE_ZSTD && (algorithm & ALGORITHM_ZSTD)) {
+    value     = TS_HTTP_VALUE_ZSTD;
+    value_len = TS_HTTP_LEN_ZSTD;
+  } else if (compression_type & COMPRESSION_TYPE_BROTLI && (algorithm & ALGORITHM_BROTLI)) {
     value     = TS_HTTP_VALUE_BROTLI;
     value_len = TS_HTTP_LEN_BROTLI;
   } else if (compression_type & COMPRESSION_TYPE_GZIP && (algorithm & ALGORITHM_GZIP)) {
@@ -295,6 +347,7 @@ compress_transform_init(TSCont contp, Data *data)
     data->downstream_buffer = TSIOBufferCreate();
     data->downstream_reader = TSIOBufferReaderAlloc(data->downstream_buffer);
     data->downstream_vio    = TSVConnWrite(downstream_conn, contp, data->downstream_reader, INT64_MAX);
+    data->output_buffer     = data->downstream_buffer;
   }
 
   TSHandleMLocRelease(bufp, TS_NULL_MLOC, hdr_loc);
@@ -310,7 +363,7 @@ gzip_transform_one(Data *data, const char *upstream_buffer, int64_t upstream_len
   data->zstrm.avail_in = upstream_length;
 
   while (data->zstrm.avail_in > 0) {
-    downstream_blkp         = TSIOBufferStart(data->downstream_buffer);
+    downstream_blkp         = TSIOBufferStart(data->output_buffer);
     char *downstream_buffer = TSIOBufferBlockWriteStart(downstream_blkp, &downstream_length);
 
     data->zstrm.next_out  = reinterpret_cast<unsigned char *>(downstream_buffer);
@@ -327,7 +380,7 @@ gzip_transform_one(Data *data, const char *upstream_buffer, int64_t upstream_len
     }
 
     if (downstream_length > data->zstrm.avail_out) {
-      TSIOBufferProduce(data->downstream_buffer, downstream_length - data->zstrm.avail_out);
+      TSIOBufferProduce(data->output_buffer, downstream_length - data->zstrm.avail_out);
       data->downstream_length += (downstream_length - data->zstrm.avail_out);
     }
 
@@ -351,7 +404,7 @@ brotli_compress_operation(Data *data, const char *upstream_buffer, int64_t upstr
 
   bool ok = true;
   while (ok) {
-    downstream_blkp         = TSIOBufferStart(data->downstream_buffer);
+    downstream_blkp         = TSIOBufferStart(data->output_buffer);
     char *downstream_buffer = TSIOBufferBlockWriteStart(downstream_blkp, &downstream_length);
 
     data->bstrm.next_out  = reinterpret_cast<unsigned char *>(downstream_buffer);
@@ -367,7 +420,7 @@ brotli_compress_operation(Data *data, const char *upstream_buffer, int64_t upstr
       return false;
     }
 
-    TSIOBufferProduce(data->downstream_buffer, downstream_length - data->bstrm.avail_out);
+    TSIOBufferProduce(data->output_buffer, downstream_length - data->bstrm.avail_out);
     data->downstream_length += (downstream_length - data->bstrm.avail_out);
     if (data->bstrm.avail_in || BrotliEncoderHasMoreOutput(data->bstrm.br)) {
       continue;
@@ -402,6 +455,52 @@ brotli_transform_one(Data *data, const char *upstream_buffer, int64_t upstream_l
 }
 #endif
 
+#if HAVE_ZSTD_H
+static bool
+zstd_compress_operation(Data *data, const char *upstream_buffer, int64_t upstream_length, ZSTD_EndDirective op)
+{
+  TSIOBufferBlock downstream_blkp;
+  int64_t downstream_length;
+  ZSTD_inBuffer input = {upstream_buffer, static_cast<size_t>(upstream_length), 0};
+
+  for (;;) {
+    downstream_blkp         = TSIOBufferStart(data->output_buffer);
+    char *downstream_buffer = TSIOBufferBlockWriteStart(downstream_blkp, &downstream_length);
+    ZSTD_outBuffer output   = {downstream_buffer, static_cast<size_t>(downstream_length), 0};
+
+    size_t remaining = ZSTD_compressStream2(data->zstd.cctx, &output, &input, op);
+    if (ZSTD_isError(remaining)) {
+      error("ZSTD_compressStream2(%d) call failed: %s", op, ZSTD_getErrorName(remaining));
+      return false;
+    }
+
+    TSIOBufferProduce(data->output_buffer, output.pos);
+    data->downstream_length += output.pos;
+    data->zstd.total_out += output.pos;
+
+    // a flush or end is complete once nothing remains to be written out.
+    if (op == ZSTD_e_continue ? input.pos == input.size : remaining == 0) {
+      break;
+    }
+  }
+
+  data->zstd.total_in += upstream_length;
+  return true;
+}
+
+static void
+zstd_transform_one(Data *data, const char *upstream_buffer, int64_t upstream_length)
+{
+  if (!zstd_compress_operation(data, upstream_buffer, upstream_length, ZSTD_e_continue)) {
+    return;
+  }
+
+  if (data->hc->flush()) {
+    zstd_compress_operation(data, nullptr, 0, ZSTD_e_flush);
+  }
+}
+#endif
+
 static void
 compress_transform_one(Data *data, TSIOBufferReader upstream_reader, int amount)
 {
@@ -424,8 +523,13 @@ compress_transform_one(Data *data, TSIOBufferReader upstream_reader, int amount)
       upstream_length = amount;
     }
 
+#if HAVE_ZSTD_H
+    if (data->compression_type & COMPRESSION_TYPE_ZSTD && (data->compression_algorithms & ALGORITHM_ZSTD)) {
+      zstd_transform_one(data, upstream_buffer, upstream_length);
+    } else
+#endif
 #if HAVE_BROTLI_ENCODE_H
-    if (data->compression_type & COMPRESSION_TYPE_BROTLI && (data->compression_algorithms & ALGORITHM_BROTLI)) {
+      if (data->compression_type & COMPRESSION_TYPE_BROTLI && (data->compression_algorithms & ALGORITHM_BROTLI)) {
       brotli_transform_one(data, upstream_buffer, upstream_length);
     } else
 #endif
@@ -451,7 +555,7 @@ gzip_transform_finish(Data *data)
     data->state = transform_state_finished;
 
     for (;;) {
-      downstream_blkp = TSIOBufferStart(data->downstream_buffer);
+      downstream_blkp = TSIOBufferStart(data->output_buffer);
 
       char *downstream_buffer = TSIOBufferBlockWriteStart(downstream_blkp, &downstream_length);
       data->zstrm.next_out    = reinterpret_cast<unsigned char *>(downstream_buffer);
@@ -460,7 +564,7 @@ gzip_transform_finish(Data *data)
       int err = deflate(&data->zstrm, Z_FINISH);
 
       if (downstream_length > static_cast<int64_t>(data->zstrm.avail_out)) {
-        TSIOBufferProduce(data->downstream_buffer, downstream_length - data->zstrm.avail_out);
+        TSIOBufferProduce(data->output_buffer, downstream_length - data->zstrm.avail_out);
         data->downstream_length += (downstream_length - data->zstrm.avail_out);
       }
 
@@ -508,11 +612,40 @@ brotli_transform_finish(Data *data)
 }
 #endif
 
+#if HAVE_ZSTD_H
+static void
+zstd_transform_finish(Data *data)
+{
+  if (data->state != transform_state_output) {
+    return;
+  }
+
+  data->state = transform_state_finished;
+
+  if (!zstd_compress_operation(data, nullptr, 0, ZSTD_e_end)) {
+    return;
+  }
+
+  if (data->downstream_length != static_cast<int64_t>(data->zstd.total_out)) {
+    error("zstd-transform: output lengths don't match (%d, %ld)", data->downstream_length, data->zstd.total_out);
+  }
+
+  debug("zstd-transform: Finished zstd");
+  log_compression_ratio(data->zstd.total_in, data->downstream_length);
+}
+#endif
+
 static void
 compress_transform_finish(Data *data)
 {
+#if HAVE_ZSTD_H
+  if (data->compression_type & COMPRESSION_TYPE_ZSTD && data->compression_algorithms & ALGORITHM_ZSTD) {
+    zstd_transform_finish(data);
+    debug("compress_transform_finish: zstd compression finish");
+  } else
+#endif
 #if HAVE_BROTLI_ENCODE_H
-  if (data->compression_type & COMPRESSION_TYPE_BROTLI && data->compression_algorithms & ALGORITHM_BROTLI) {
+    if (data->compression_type & COMPRESSION_TYPE_BROTLI && data->compression_algorithms & ALGORITHM_BROTLI) {
     brotli_transform_finish(data);
     debug("compress_transform_finish: brotli compression finish");
   } else
@@ -526,6 +659,83 @@ compress_transform_finish(Data *data)
   }
 }
 
+static int
+compress_task(TSCont contp, TSEvent /* event ATS_UNUSED */, void * /* edata ATS_UNUSED */)
+{
+  Data *data    = static_cast<Data *>(TSContDataGet(contp));
+  TSMutex mutex = TSContMutexGet(data->contp);
+
+  compress_transform_one(data, data->task_input_reader, TSIOBufferReaderAvail(data->task_input_reader));
+
+  // Hand the output back with the transaction locked, so that the transform
+  // can't be destroyed between marking the task done and rescheduling it.
+  TSMutexLock(mutex);
+  data->task = task_state_done;
+  TSContScheduleOnThread(data->contp, 0, data->thread);
+  TSMutexUnlock(mutex);
+
+  __sync_fetch_and_sub(&compress_tasks, 1);
+  return 0;
+}
+
+// Compresses a chunk of at least task-threshold bytes on a task thread,
+// returns false if the chunk should be compressed on this thread instead.
+static bool
+compress_task_dispatch(TSCont contp, Data *data, TSIOBufferReader upstream_reader, int64_t amount)
+{
+  unsigned int threshold = data->hc->task_threshold();
+
+  if (threshold == 0 || amount < threshold) {
+    return false;
+  }
+
+  if (__sync_fetch_and_add(&compress_tasks, 1) >= COMPRESS_TASK_LIMIT) {
+    __sync_fetch_and_sub(&compress_tasks, 1);
+    debug("compress_task_dispatch: %d tasks are running, compressing inline", COMPRESS_TASK_LIMIT);
+    return false;
+  }
+
+  // The task gets a mutex of its own, the transaction mutex is only taken to
+  // hand the output back. It is released along with the task continuation.
+  if (!data->task_contp) {
+    data->task_contp         = TSContCreate(compress_task, TSMutexCreate());
+    data->task_input         = TSIOBufferCreate();
+    data->task_input_reader  = TSIOBufferReaderAlloc(data->task_input);
+    data->task_output        = TSIOBufferCreate();
+    data->task_output_reader = TSIOBufferReaderAlloc(data->task_output);
+    TSContDataSet(data->task_contp, data);
+  }
+
+  // The task reads its own references to the upstream blocks, the upstream
+  // buffer itself is only touched with the transaction locked.
+  TSIOBufferCopy(data->task_input, upstream_reader, amount, 0);
+  TSIOBufferReaderConsume(upstream_reader, amount);
+
+  data->contp         = contp;
+  data->thread        = TSEventThreadSelf();
+  data->output_buffer = data->task_output;
+  data->task          = task_state_running;
+  TSContScheduleOnPool(data->task_contp, 0, TS_THREAD_POOL_TASK);
+
+  debug("compress_task_dispatch: compressing %" PRId64 " bytes on a task thread", amount);
+  return true;
+}
+
+static void
+compress_task_collect(Data *data)
+{
+  int64_t avail = TSIOBufferReaderAvail(data->task_output_reader);
+
+  if (avail > 0) {
+    TSIOBufferCopy(data->downstream_buffer, data->task_output_reader, avail, 0);
+    TSIOBufferReaderConsume(data->task_output_reader, avail);
+    TSVIOReenable(data->downstream_vio);
+  }
+
+  data->output_buffer = data->downstream_buffer;
+  data->task          = task_state_idle;
+}
+
 static void
 compress_transform_do(TSCont contp)
 {
@@ -539,6 +749,14 @@ compress_transform_do(TSCont contp)
     compress_transform_init(contp, data);
   }
 
+  // No more input is taken while a task compresses the previous chunk, the
+  // upstream buffer fills up and holds back the producer.
+  if (data->task == task_state_running) {
+    return;
+  } else if (data->task == task_state_done) {
+    compress_task_collect(data);
+  }
+
   upstream_vio             = TSVConnWriteVIOGet(contp);
   downstream_bytes_written = data->downstream_length;
 
@@ -563,19 +781,21 @@ compress_transform_do(TSCont contp)
     }
 
     if (upstream_todo > 0) {
-      compress_transform_one(data, TSVIOReaderGet(upstream_vio), upstream_todo);
+      if (!compress_task_dispatch(contp, data, TSVIOReaderGet(upstream_vio), upstream_todo)) {
+        compress_transform_one(data, TSVIOReaderGet(upstream_vio), upstream_todo);
+      }
       TSVIONDoneSet(upstream_vio, TSVIONDoneGet(upstream_vio) + upstream_todo);
     }
   }
 
   if (TSVIONTodoGet(upstream_vio) > 0) {
     if (upstream_todo > 0) {
-      if (data->downstream_length > downstream_bytes_written) {
+      if (data->task == task_state_idle && data->downstream_length > downstream_bytes_written) {
         TSVIOReenable(data->downstream_vio);
       }
       TSContCall(TSVIOContGet(upstream_vio), TS_EVENT_VCONN_WRITE_READY, upstream_vio);
     }
-  } else {
+  } else if (data->task == task_state_idle) {
     compress_transform_finish(data);
     TSVIONBytesSet(data->downstream_vio, data->downstream_length);
 
@@ -591,8 +811,12 @@ static int
 compress_transform(TSCont contp, TSEvent event, void * /* edata ATS_UNUSED */)
 {
   if (TSVConnClosedGet(contp)) {
-    data_destroy(static_cast<Data *>(TSContDataGet(contp)));
-    TSContDestroy(contp);
+    Data *data = static_cast<Data *>(TSContDataGet(contp));
+    // a running task reschedules the transform once it is done with data.
+    if (data->task != task_state_running) {
+      data_destroy(data);
+      TSContDestroy(contp);
+    }
     return 0;
   } else {
     switch (event) {
@@ -707,7 +931,12 @@ transformable(TSHttpTxn txnp, bool server, HostConfiguration *host_configuration
         continue;
       }
 
-      if (strncasecmp(value, "br", sizeof("br") - 1) == 0) {
+      if (strncasecmp(value, "zstd", sizeof("zstd") - 1) == 0) {
+        if (*algorithms & ALGORITHM_ZSTD) {
+          compression_acceptable = 1;
+        }
+        *compress_type |= COMPRESSION_TYPE_ZSTD;
+      } else if (strncasecmp(value, "br", sizeof("br") - 1) == 0) {
         if (*algorithms & ALGORITHM_BROTLI) {
           compression_acceptable = 1;
         }
@@ -790,14 +1019,21 @@ transformable(TSHttpTxn txnp, bool server, HostConfiguration *host_configuration
 }
 
 static void
-compress_transform_add(TSHttpTxn txnp, HostConfiguration *hc, int compress_type, int algorithms)
+compress_transform_add(TSHttpTxn txnp, bool server, HostConfiguration *hc, int compress_type, int algorithms)
 {
   TSVConn connp;
   Data *data;
 
   TSHttpTxnUntransformedRespCache(txnp, 1);
 
-  if (!hc->cache()) {
+  if (hc->precompress()) {
+    // The origin response is cached as is, each encoding is cached as an
+    // alternate the first time it is compressed from the cache so that later
+    // hits are served without compressing.
+    debug("precompress enabled, caching the %s response", server ? "untransformed" : "transformed");
+    TSHttpTxnUntransformedRespCache(txnp, server ? 1 : 0);
+    TSHttpTxnTransformedRespCache(txnp, server ? 0 : 1);
+  } else if (!hc->cache()) {
     debug("TransformedRespCache  not enabled");
     TSHttpTxnTransformedRespCache(txnp, 0);
   } else {
@@ -860,7 +1096,7 @@ transform_plugin(TSCont contp, TSEvent event, void *edata)
       }
 
       if (transformable(txnp, true, hc, &compress_type, &algorithms)) {
-        compress_transform_add(txnp, hc, compress_type, algorithms);
+        compress_transform_add(txnp, true, hc, compress_type, algorithms);
       }
     }
     break;
@@ -888,7 +1124,7 @@ transform_plugin(TSCont contp, TSEvent event, void *edata)
       if (hc != nullptr) {
         info("handling compression of cached object");
         if (transformable(txnp, false, hc, &compress_type, &algorithms)) {
-          compress_transform_add(txnp, hc, compress_type, algorithms);
+          compress_transform_add(txnp, false, hc, compress_type, algorithms);
         }
       }
     } else {
@@ -108,7 +108,9 @@ enum ParserState {
   kParseRangeRequest,
   kParseFlush,
   kParseAllow,
-  kParseMinimumContentLength
+  kParseMinimumContentLength,
+  kParsePrecompress,
+  kParseTaskThreshold
 };
 
 void
@@ -234,13 +236,19 @@ HostConfiguration::add_compression_algorithms(string &line)
       compression_algorithms_ |= ALGORITHM_BROTLI;
 #else
       error("supported-algorithms: brotli support not compiled in.");
+#endif
+    } else if (token == "zstd") {
+#ifdef HAVE_ZSTD_H
+      compression_algorithms_ |= ALGORITHM_ZSTD;
+#else
+      error("supported-algorithms: zstd support not compiled in.");
 #endif
     } else if (token == "gzip") {
       compression_algorithms_ |= ALGORITHM_GZIP;
     } else if (token == "deflate") {
       compression_algorithms_ |= ALGORITHM_DEFLATE;
     } else {
-      error("Unknown compression type. Supported compression-algorithms <br,gzip,deflate>.");
+      error("Unknown compression type. Supported compression-algorithms <zstd,br,gzip,deflate>.");
     }
   }
 }
@@ -362,6 +370,10 @@ Configuration::Parse(const char *path)
           state = kParseStart;
         } else if (token == "minimum-content-length") {
           state = kParseMinimumContentLength;
+        } else if (token == "precompress") {
+          state = kParsePrecompress;
+        } else if (token == "task-threshold") {
+          state = kParseTaskThreshold;
         } else {
           warning("failed to interpret \"%s\" at line %zu", token.c_str(), lineno);
         }
@@ -398,6 +410,14 @@ Configuration::Parse(const char *path)
         current_host_configuration->set_minimum_content_length(strtoul(token.c_str(), nullptr, 10));
         state = kParseStart;
         break;
+      case kParsePrecompress:
+        current_host_configuration->set_precompress(token == "true");
+        state = kParseStart;
+        break;
+      case kParseTaskThreshold:
+        current_host_configuration->set_task_threshold(strtoul(token.c_str(), nullptr, 10));
+        state = kParseStart;
+        break;
       }
     }
   }
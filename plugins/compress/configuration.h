@@ -38,7 +38,8 @@ enum CompressionAlgorithm {
   ALGORITHM_DEFAULT = 0,
   ALGORITHM_DEFLATE = 1,
   ALGORITHM_GZIP    = 2,
-  ALGORITHM_BROTLI  = 4 // For bit manipulations
+  ALGORITHM_BROTLI  = 4, // For bit manipulations
+  ALGORITHM_ZSTD    = 8
 };
 
 class HostConfiguration : private atscppapi::noncopyable
@@ -51,8 +52,10 @@ public:
       range_request_(false),
       remove_accept_encoding_(false),
       flush_(false),
+      precompress_(false),
       compression_algorithms_(ALGORITHM_GZIP),
-      minimum_content_length_(1024)
+      minimum_content_length_(1024),
+      task_threshold_(0)
   {
   }
 
@@ -97,6 +100,16 @@ public:
     flush_ = x;
   }
   bool
+  precompress()
+  {
+    return precompress_;
+  }
+  void
+  set_precompress(bool x)
+  {
+    precompress_ = x;
+  }
+  bool
   remove_accept_encoding()
   {
     return remove_accept_encoding_;
@@ -127,6 +140,16 @@ public:
   {
     minimum_content_length_ = x;
   }
+  unsigned int
+  task_threshold() const
+  {
+    return task_threshold_;
+  }
+  void
+  set_task_threshold(unsigned int x)
+  {
+    task_threshold_ = x;
+  }
 
   void update_defaults();
   void add_allow(const std::string &allow);
@@ -145,8 +168,10 @@ private:
   bool range_request_;
   bool remove_accept_encoding_;
   bool flush_;
+  bool precompress_;
   int compression_algorithms_;
   unsigned int minimum_content_length_;
+  unsigned int task_threshold_;
 
   StringContainer compressible_content_types_;
   StringContainer allows_;
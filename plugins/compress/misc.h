@@ -32,6 +32,10 @@
 #include <brotli/encode.h>
 #endif
 
+#if HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
 #include "configuration.h"
 
 using namespace Gzip;
@@ -46,7 +50,8 @@ enum CompressionType {
   COMPRESSION_TYPE_DEFAULT = 0,
   COMPRESSION_TYPE_DEFLATE = 1,
   COMPRESSION_TYPE_GZIP    = 2,
-  COMPRESSION_TYPE_BROTLI  = 4
+  COMPRESSION_TYPE_BROTLI  = 4,
+  COMPRESSION_TYPE_ZSTD    = 8
 };
 
 // this one is used to rename the accept encoding header
@@ -60,6 +65,13 @@ enum transform_state {
   transform_state_finished,
 };
 
+// state of the compression of a body chunk on a task thread
+enum task_state {
+  task_state_idle,
+  task_state_running,
+  task_state_done,
+};
+
 #if HAVE_BROTLI_ENCODE_H
 typedef struct {
   BrotliEncoderState *br;
@@ -72,12 +84,21 @@ typedef struct {
 } b_stream;
 #endif
 
+#if HAVE_ZSTD_H
+typedef struct {
+  ZSTD_CCtx *cctx;
+  size_t total_in;
+  size_t total_out;
+} zstd_stream;
+#endif
+
 typedef struct {
   TSHttpTxn txn;
   HostConfiguration *hc;
   TSVIO downstream_vio;
   TSIOBuffer downstream_buffer;
   TSIOBufferReader downstream_reader;
+  TSIOBuffer output_buffer; // where the compressors write, the downstream buffer or task_output
   int downstream_length;
   z_stream zstrm;
   enum transform_state state;
@@ -86,6 +107,19 @@ typedef struct {
 #if HAVE_BROTLI_ENCODE_H
   b_stream bstrm;
 #endif
+#if HAVE_ZSTD_H
+  zstd_stream zstd;
+#endif
+  // large chunks are compressed on a task thread, the transform takes no more
+  // input until the task is done.
+  TSCont contp;
+  TSCont task_contp;
+  TSEventThread thread;
+  enum task_state task;
+  TSIOBuffer task_input;
+  TSIOBufferReader task_input_reader;
+  TSIOBuffer task_output;
+  TSIOBufferReader task_output_reader;
 } Data;
 
 voidpf gzip_alloc(voidpf opaque, uInt items, uInt size);
@@ -40,6 +40,7 @@ ParentConsistentHash::ParentConsistentHash(ParentRecord *parent_record)
   for (i = 0; i < parent_record->num_parents; i++) {
     chash[PRIMARY]->insert(&(parent_record->parents[i]), parent_record->parents[i].weight, (ATSHash64 *)&hash[PRIMARY]);
   }
+  chash[PRIMARY]->set_load_bound(parent_record->hash_load_bound);
 
   if (parent_record->num_secondary_parents > 0) {
     Debug("parent_select", "ParentConsistentHash(): initializing the secondary parents hash.");
@@ -49,6 +50,7 @@ ParentConsistentHash::ParentConsistentHash(ParentRecord *parent_record)
       chash[SECONDARY]->insert(&(parent_record->secondary_parents[i]), parent_record->secondary_parents[i].weight,
                                (ATSHash64 *)&hash[SECONDARY]);
     }
+    chash[SECONDARY]->set_load_bound(parent_record->hash_load_bound);
   } else {
     chash[SECONDARY] = nullptr;
   }
@@ -757,6 +757,14 @@ ParentRecord::Init(matcher_line *line_info)
         ignore_self_detect = false;
       }
       used = true;
+    } else if (strcasecmp(label, "hash_load_bound") == 0) {
+      float v = atof(val);
+      if (v == 0 || v >= 1) {
+        hash_load_bound = v;
+        used            = true;
+      } else {
+        errPtr = "invalid argument to hash_load_bound.  Argument must be 0 or at least 1.";
+      }
     }
     // Report errors generated by ProcessParents();
     if (errPtr != nullptr) {
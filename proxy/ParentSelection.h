@@ -47,6 +47,7 @@
 struct RequestData;
 struct matcher_line;
 struct ParentResult;
+struct HostRecord;
 struct OverridableHttpConfigParams;
 class ParentRecord;
 class ParentSelectionStrategy;
@@ -232,6 +233,7 @@ public:
   int max_unavailable_server_retries                                 = 1;
   int secondary_mode                                                 = 1;
   bool ignore_self_detect                                            = false;
+  float hash_load_bound                                              = 0;
 };
 
 // If the parent was set by the external customer api,
@@ -255,6 +257,8 @@ struct ParentResult {
   bool chash_init[MAX_GROUP_RINGS] = {false};
   TSHostStatus first_choice_status = TSHostStatus::TS_HOST_STATUS_INIT;
   bool do_not_cache_response       = false;
+  // next hop whose latency the current attempt is accounted to, see HttpTransact::next_hop_attempt_complete().
+  HostRecord *latency_host = nullptr;
 
   void
   reset()
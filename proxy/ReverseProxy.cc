@@ -45,6 +45,7 @@
 // Global Ptrs
 static Ptr<ProxyMutex> reconfig_mutex;
 UrlRewrite *rewrite_table                             = nullptr;
+RecRawStatBlock *url_remap_rsb                        = nullptr;
 thread_local PluginThreadContext *pluginThreadContext = nullptr;
 
 // Tokens for the Callback function
@@ -65,6 +66,18 @@ init_reverse_proxy()
   reconfig_mutex = new_ProxyMutex();
   rewrite_table  = new UrlRewrite();
 
+  url_remap_rsb = RecAllocateRawStatBlock(static_cast<int>(url_remap_stat_count));
+  RecRegisterRawStat(url_remap_rsb, RECT_PROCESS, "proxy.process.url_remap.reload_count", RECD_INT, RECP_NON_PERSISTENT,
+                     static_cast<int>(url_remap_reload_count_stat), RecRawStatSyncSum);
+  RecRegisterRawStat(url_remap_rsb, RECT_PROCESS, "proxy.process.url_remap.reload_failures", RECD_INT, RECP_NON_PERSISTENT,
+                     static_cast<int>(url_remap_reload_failures_stat), RecRawStatSyncSum);
+  RecRegisterRawStat(url_remap_rsb, RECT_PROCESS, "proxy.process.url_remap.reload_time", RECD_INT, RECP_NON_PERSISTENT,
+                     static_cast<int>(url_remap_reload_time_stat), RecRawStatSyncSum);
+  RecRegisterRawStat(url_remap_rsb, RECT_PROCESS, "proxy.process.url_remap.reload_last_time", RECD_INT, RECP_NON_PERSISTENT,
+                     static_cast<int>(url_remap_reload_last_time_stat), RecRawStatSyncSum);
+  RecRegisterRawStat(url_remap_rsb, RECT_PROCESS, "proxy.process.url_remap.reload_reused_plugin_instances", RECD_INT,
+                     RECP_NON_PERSISTENT, static_cast<int>(url_remap_reload_reused_plugin_instances_stat), RecRawStatSyncSum);
+
   Note("%s loading ...", ts::filename::REMAP);
   if (!rewrite_table->load()) {
     Warning("%s failed to load", ts::filename::REMAP);
@@ -132,13 +145,30 @@ bool
 reloadUrlRewrite()
 {
   UrlRewrite *newTable, *oldTable;
+  int reuse_instances = 0;
+  ink_hrtime start    = Thread::get_hrtime_updated();
+
+  REC_ReadConfigInteger(reuse_instances, "proxy.config.url_remap.reload_reuse_plugin_instances");
 
   Note("%s loading ...", ts::filename::REMAP);
   Debug("url_rewrite", "%s updated, reloading...", ts::filename::REMAP);
   newTable = new UrlRewrite();
-  if (newTable->load()) {
+  // The current table can not go away while loading, its lease is only released by this function.
+  bool loaded = newTable->load(reuse_instances ? rewrite_table : nullptr);
+
+  ink_hrtime elapsed = ink_hrtime_to_msec(Thread::get_hrtime_updated() - start);
+  RecIncrGlobalRawStatSum(url_remap_rsb, url_remap_reload_count_stat, 1);
+  RecIncrGlobalRawStatSum(url_remap_rsb, url_remap_reload_time_stat, elapsed);
+  RecSetGlobalRawStatSum(url_remap_rsb, url_remap_reload_last_time_stat, elapsed);
+
+  if (loaded) {
     static const char *msg_format = "%s finished loading";
 
+    RecIncrGlobalRawStatSum(url_remap_rsb, url_remap_reload_reused_plugin_instances_stat,
+                            newTable->pluginFactory.reusedInstanceCount());
+    Debug("url_rewrite", "reload took %" PRId64 " ms, reused %d plugin instances", elapsed,
+          newTable->pluginFactory.reusedInstanceCount());
+
     // Hold at least one lease, until we reload the configuration
     newTable->acquire();
 
@@ -156,6 +186,7 @@ reloadUrlRewrite()
   } else {
     static const char *msg_format = "%s failed to load";
 
+    RecIncrGlobalRawStatSum(url_remap_rsb, url_remap_reload_failures_stat, 1);
     delete newTable;
     Debug("url_rewrite", msg_format, ts::filename::REMAP);
     Error(msg_format, ts::filename::REMAP);
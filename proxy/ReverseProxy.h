@@ -47,6 +47,18 @@ struct host_hdr_info;
 
 extern UrlRewrite *rewrite_table;
 
+// Stats
+enum {
+  url_remap_reload_count_stat,
+  url_remap_reload_failures_stat,
+  url_remap_reload_time_stat,
+  url_remap_reload_last_time_stat,
+  url_remap_reload_reused_plugin_instances_stat,
+  url_remap_stat_count
+};
+
+extern RecRawStatBlock *url_remap_rsb;
+
 // API Functions
 int init_reverse_proxy();
 
@@ -0,0 +1,453 @@
+/** @file
+
+  Happy Eyeballs (RFC 8305) origin connection racing
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "HappyEyeballs.h"
+#include "HttpSM.h"
+#include "HttpConfig.h"
+#include "P_Net.h"
+
+#define HEDebug(fmt, ...) SpecificDebug(_sm->debug_on, "http_happy_eyeballs", "[%" PRId64 "] " fmt, _sm->sm_id, ##__VA_ARGS__)
+
+using namespace HappyEyeballs;
+
+ClassAllocator<HappyEyeballsSM, true> happyEyeballsSMAllocator("happyEyeballsSMAllocator");
+
+HappyEyeballsSM::HappyEyeballsSM(HttpSM *sm, const NetVCOptions &opt, bool tls, ink_hrtime delay)
+  : Continuation(sm->mutex), _sm(sm), _tls(tls), _delay(delay)
+{
+  SET_HANDLER(&HappyEyeballsSM::state_race);
+
+  _action = sm;
+  _opt    = opt;
+  _port   = sm->t_state.current.server->dst_addr.host_order_port();
+
+  _host                = sm->t_state.current.server->name;
+  _down_server_timeout = static_cast<int32_t>(sm->t_state.txn_conf->down_server_timeout);
+  _connect_timeout     = sm->get_server_connect_timeout();
+
+  for (auto &a : _attempts) {
+    a.he    = this;
+    a.mutex = mutex;
+  }
+}
+
+Action *
+HappyEyeballsSM::start(HttpSM *sm, const NetVCOptions &opt, bool tls, HostResStyle alternate_style)
+{
+  HttpTransact::State &s = sm->t_state;
+  HappyEyeballsSM *he =
+    happyEyeballsSMAllocator.alloc(sm, opt, tls, HRTIME_MSECONDS(s.http_config_param->happy_eyeballs_delay));
+
+  he->_enter();
+  he->_records[PRIMARY] = s.hostdb_entry;
+  he->_add_candidates(PRIMARY, s.hostdb_entry.get(), &s.current.server->dst_addr.sa);
+
+  // The lookup calls back before returning when the other family is cached, so the order of the families is known
+  // before the first connect most of the time.
+  if (alternate_style != HOST_RES_NONE && s.dns_info.lookup_name != nullptr) {
+    HostDBProcessor::Options hopt;
+    hopt.port           = he->_port;
+    hopt.host_res_style = alternate_style;
+
+    he->_lookup_name    = s.dns_info.lookup_name;
+    he->_lookup_pending = true;
+    Action *action      = hostDBProcessor.getbyname_re(he, he->_lookup_name.c_str(), 0, hopt);
+    if (action != ACTION_RESULT_DONE) {
+      he->_lookup_action = action;
+    }
+  }
+
+  HTTP_INCREMENT_DYN_STAT(http_happy_eyeballs_races_stat);
+
+  he->_timer = this_ethread()->schedule_every(he, he->_delay);
+  he->_start_next();
+
+  Action *result = he->_done ? ACTION_RESULT_DONE : &he->_action;
+  he->_leave();
+
+  return result;
+}
+
+/**
+   Queue the addresses of a HostDB record that are up and allowed, @a first is the address to start the family with.
+ */
+void
+HappyEyeballsSM::_add_candidates(Family family, HostDBInfo *r, const sockaddr *first)
+{
+  HostDBRoundRobin *rr = (r && r->round_robin) ? r->rr() : nullptr;
+  ink_time_t now       = ink_local_time();
+
+  if (rr == nullptr) {
+    if (first != nullptr) {
+      _add_candidate(family, first, -1, r);
+    } else if (r != nullptr && r->is_alive(now, _down_server_timeout) && _sm->is_server_addr_allowed(r->ip())) {
+      _add_candidate(family, r->ip(), -1, r);
+    }
+    return;
+  }
+  if (rr->good <= 0) {
+    return;
+  }
+
+  int start = rr->current % rr->good;
+  if (first != nullptr) {
+    int idx = rr->index_of(first);
+    _add_candidate(family, first, idx, idx < 0 ? nullptr : &rr->info(idx));
+    start = std::max(idx, 0);
+  }
+
+  for (int i = 0; i < rr->good; ++i) {
+    int idx          = (start + i) % rr->good;
+    HostDBInfo &info = rr->info(idx);
+    if ((first != nullptr && ats_ip_addr_eq(info.ip(), first)) || !info.is_alive(now, _down_server_timeout) ||
+        !_sm->is_server_addr_allowed(info.ip())) {
+      continue;
+    }
+    _add_candidate(family, info.ip(), idx, &info);
+  }
+}
+
+void
+HappyEyeballsSM::_add_candidate(Family family, const sockaddr *addr, short rr_index, const HostDBInfo *info)
+{
+  Candidate c;
+
+  c.addr.assign(addr);
+  c.addr.port() = htons(_port);
+  c.family      = family;
+  c.rr_index    = rr_index;
+
+  if (!_has_family[family]) {
+    _has_family[family] = true;
+    _first_rtt[family]  = info ? info->app.http_data.connect_rtt : RTT_UNKNOWN;
+  }
+  _candidates.push(family, c);
+}
+
+HostDBInfo *
+HappyEyeballsSM::_info(const Candidate &c) const
+{
+  HostDBInfo *r = _records[c.family].get();
+
+  if (r == nullptr || !r->round_robin) {
+    return r;
+  }
+
+  return c.rr_index < 0 ? nullptr : &r->rr()->info(c.rr_index);
+}
+
+void
+HappyEyeballsSM::_start_next()
+{
+  if (_candidates.empty() || _n_attempts >= MAX_ATTEMPTS) {
+    return;
+  }
+
+  Attempt *a    = &_attempts[_n_attempts++];
+  a->candidate  = _candidates.pop();
+  a->state      = Attempt::CONNECTING;
+  a->start_time = Thread::get_hrtime();
+  _last_start   = a->start_time;
+  ++_in_flight;
+
+  if (is_debug_tag_set("http_happy_eyeballs")) {
+    ip_port_text_buffer ipb;
+    HEDebug("connect to %s", ats_ip_nptop(&a->candidate.addr.sa, ipb, sizeof(ipb)));
+  }
+
+  _opt.ip_family = a->candidate.addr.family();
+
+  // NET_EVENT_OPEN or NET_EVENT_OPEN_FAILED may be signaled before connect_re returns.
+  Action *action = _tls ? sslNetProcessor.connect_re(a, &a->candidate.addr.sa, &_opt) :
+                          netProcessor.connect_re(a, &a->candidate.addr.sa, &_opt);
+  if (action != ACTION_RESULT_DONE && a->state == Attempt::CONNECTING) {
+    a->pending_action = action;
+  }
+}
+
+int
+HappyEyeballsSM::Attempt::state_connect(int event, void *data)
+{
+  he->_attempt_event(this, event, data);
+
+  return EVENT_DONE;
+}
+
+void
+HappyEyeballsSM::_attempt_event(Attempt *a, int event, void *data)
+{
+  _enter();
+
+  // Track the connection before anything else, so that a torn down race closes it.
+  if (event == NET_EVENT_OPEN) {
+    a->state          = Attempt::OPEN;
+    a->pending_action = nullptr;
+    a->netvc          = static_cast<NetVConnection *>(data);
+  } else if (event == NET_EVENT_OPEN_FAILED) {
+    a->pending_action = nullptr;
+  }
+
+  // HttpSM may be gone once the action is cancelled.
+  if (!_done && _action.cancelled) {
+    Debug("http_happy_eyeballs", "race cancelled");
+    _teardown();
+  }
+
+  if (!_done) {
+    switch (event) {
+    case NET_EVENT_OPEN:
+      // VC_EVENT_WRITE_READY is signaled once the TCP or TLS handshake is done
+      a->write_buf = new_MIOBuffer(BUFFER_SIZE_INDEX_128);
+      a->netvc->set_inactivity_timeout(_connect_timeout);
+      a->netvc->do_io_write(a, 1, a->write_buf->alloc_reader());
+      break;
+    case VC_EVENT_WRITE_READY:
+    case VC_EVENT_WRITE_COMPLETE:
+      _win(a);
+      break;
+    case NET_EVENT_OPEN_FAILED:
+      _fail(a, -static_cast<int>(reinterpret_cast<intptr_t>(data)));
+      break;
+    case VC_EVENT_INACTIVITY_TIMEOUT:
+    case VC_EVENT_ACTIVE_TIMEOUT:
+      _fail(a, ETIMEDOUT);
+      break;
+    case VC_EVENT_EOS:
+    case VC_EVENT_ERROR:
+      _fail(a, a->netvc->lerrno ? a->netvc->lerrno : EIO);
+      break;
+    default:
+      ink_release_assert(!"unexpected event");
+      break;
+    }
+  }
+
+  _leave();
+}
+
+int
+HappyEyeballsSM::state_race(int event, void *data)
+{
+  _enter();
+
+  // HttpSM may be gone once the action is cancelled.
+  if (!_done && _action.cancelled) {
+    Debug("http_happy_eyeballs", "race cancelled");
+    _teardown();
+  }
+
+  switch (event) {
+  case EVENT_INTERVAL:
+    if (!_done && Thread::get_hrtime() - _last_start >= _delay) {
+      _start_next();
+    }
+    break;
+  case EVENT_HOST_DB_LOOKUP: {
+    _lookup_action  = nullptr;
+    _lookup_pending = false;
+    if (_done) {
+      break;
+    }
+
+    HostDBInfo *r = static_cast<HostDBInfo *>(data);
+    if (r != nullptr && !r->is_failed()) {
+      _records[ALTERNATE] = Ptr<HostDBInfo>(r);
+      _add_candidates(ALTERNATE, r, nullptr);
+
+      // Start with the other family if it connected faster, unless a connect is under way already.
+      if (_n_attempts == 0 && _candidates.size(ALTERNATE) > 0 && prefer_alternate(_first_rtt[PRIMARY], _first_rtt[ALTERNATE])) {
+        HEDebug("prefer the other address family");
+        _candidates.prefer(ALTERNATE);
+      }
+    }
+    // The first family failed meanwhile.
+    if (_n_attempts > 0 && _in_flight == 0) {
+      _start_next();
+      _fail(nullptr, _last_error);
+    }
+    break;
+  }
+  default:
+    ink_release_assert(!"unexpected event");
+    break;
+  }
+
+  _leave();
+
+  return EVENT_DONE;
+}
+
+/**
+   Close a failed attempt and go on with the next address, HttpSM is called back once there is none left.
+ */
+void
+HappyEyeballsSM::_fail(Attempt *a, int err)
+{
+  if (a != nullptr) {
+    if (is_debug_tag_set("http_happy_eyeballs")) {
+      ip_port_text_buffer ipb;
+      HEDebug("connect to %s failed: %s", ats_ip_nptop(&a->candidate.addr.sa, ipb, sizeof(ipb)), strerror(err));
+    }
+    _close(a);
+    _update_rtt(a->candidate, RTT_FAILED, false);
+    _last_error = err;
+
+    // A failure starts the next address without waiting for the delay.
+    _start_next();
+  }
+
+  if (_in_flight > 0 || _lookup_pending || _done) {
+    return;
+  }
+
+  HEDebug("all addresses failed");
+  _teardown();
+  _sm->t_state.set_connect_fail(_last_error);
+  _sm->handleEvent(NET_EVENT_OPEN_FAILED, reinterpret_cast<void *>(-static_cast<intptr_t>(_last_error)));
+}
+
+void
+HappyEyeballsSM::_win(Attempt *a)
+{
+  const ink_hrtime now  = Thread::get_hrtime();
+  NetVConnection *netvc = a->netvc;
+
+  if (is_debug_tag_set("http_happy_eyeballs")) {
+    ip_port_text_buffer ipb;
+    HEDebug("connected to %s in %" PRId64 " ms", ats_ip_nptop(&a->candidate.addr.sa, ipb, sizeof(ipb)),
+            ink_hrtime_to_msec(now - a->start_time));
+  }
+
+  // Detach the connection from the attempt before the others are closed.
+  netvc->do_io_write(nullptr, 0, nullptr);
+  free_MIOBuffer(a->write_buf);
+  a->write_buf = nullptr;
+  a->netvc     = nullptr;
+  a->state     = Attempt::CLOSED;
+  --_in_flight;
+
+  _update_rtt(a->candidate, encode_rtt(now - a->start_time), false);
+  for (int i = 0; i < _n_attempts; ++i) {
+    Attempt *loser = &_attempts[i];
+    if (loser->state == Attempt::CONNECTING || loser->state == Attempt::OPEN) {
+      _update_rtt(loser->candidate, encode_rtt(now - loser->start_time), true);
+    }
+  }
+  if (a->candidate.family == ALTERNATE) {
+    HTTP_INCREMENT_DYN_STAT(http_happy_eyeballs_alternate_wins_stat);
+  }
+
+  HttpTransact::State &s = _sm->t_state;
+  ats_ip_copy(&s.current.server->dst_addr, &a->candidate.addr);
+  if (HostDBInfo *info = _info(a->candidate); info != nullptr) {
+    s.host_db_info = *info;
+  }
+  _sm->milestones[TS_MILESTONE_SERVER_CONNECT] = a->start_time;
+
+  _teardown();
+
+  // HttpSM checks that the connection comes from the action it was given.
+  netvc->set_action(_sm);
+  _sm->handleEvent(NET_EVENT_OPEN, netvc);
+}
+
+void
+HappyEyeballsSM::_close(Attempt *a)
+{
+  if (a->state != Attempt::CONNECTING && a->state != Attempt::OPEN) {
+    return;
+  }
+
+  if (a->pending_action != nullptr) {
+    a->pending_action->cancel();
+    a->pending_action = nullptr;
+  }
+  if (a->netvc != nullptr) {
+    a->netvc->do_io_close();
+    a->netvc = nullptr;
+  }
+  if (a->write_buf != nullptr) {
+    free_MIOBuffer(a->write_buf);
+    a->write_buf = nullptr;
+  }
+  a->state = Attempt::CLOSED;
+  --_in_flight;
+}
+
+/**
+   Keep the connect time of an address in HostDB. The time of a connect that lost the race is only a lower bound.
+ */
+void
+HappyEyeballsSM::_update_rtt(const Candidate &c, uint8_t sample, bool lower_bound)
+{
+  HostDBInfo *info = _info(c);
+
+  if (info == nullptr) {
+    return;
+  }
+
+  HostDBApplicationInfo app = info->app;
+  uint8_t rtt               = app.http_data.connect_rtt;
+
+  app.http_data.connect_rtt = lower_bound ? smooth_rtt_lower_bound(rtt, sample) : smooth_rtt(rtt, sample);
+  if (app.http_data.connect_rtt != rtt) {
+    hostDBProcessor.setby(_host.c_str(), _host.size(), &c.addr.sa, &app);
+  }
+}
+
+void
+HappyEyeballsSM::_teardown()
+{
+  _done = true;
+
+  if (_timer != nullptr) {
+    _timer->cancel();
+    _timer = nullptr;
+  }
+  if (_lookup_action != nullptr) {
+    _lookup_action->cancel();
+    _lookup_action = nullptr;
+  }
+  _lookup_pending = false;
+
+  for (int i = 0; i < _n_attempts; ++i) {
+    _close(&_attempts[i]);
+  }
+}
+
+void
+HappyEyeballsSM::_enter()
+{
+  ++_depth;
+}
+
+/**
+   Free the state machine once it is done and none of its handlers is on the stack.
+ */
+void
+HappyEyeballsSM::_leave()
+{
+  if (--_depth == 0 && _done) {
+    happyEyeballsSMAllocator.free(this);
+  }
+}
@@ -0,0 +1,139 @@
+/** @file
+
+  Happy Eyeballs (RFC 8305) origin connection racing
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "P_EventSystem.h"
+#include "I_NetVConnection.h"
+#include "I_HostDBProcessor.h"
+#include "HappyEyeballsAlgorithm.h"
+
+#include <string>
+
+class HttpSM;
+class HappyEyeballsSM;
+
+extern ClassAllocator<HappyEyeballsSM, true> happyEyeballsSMAllocator;
+
+/**
+   @class HappyEyeballsSM
+   @brief A state machine to race the connection to an origin over its addresses
+
+   Started by HttpSM in place of NetProcessor::connect_re when it opens a new origin connection. The address HttpSM
+   selected is connected to first, and every @c delay milliseconds without a connection the next address is connected
+   to as well. The other address family of the origin is looked up in HostDB meanwhile and its addresses are tried
+   alternating with the first family. The first connection to finish its handshake is handed to HttpSM with
+   NET_EVENT_OPEN as if it came from connect_re, the others are closed. NET_EVENT_OPEN_FAILED is signaled once all
+   addresses failed.
+
+   The connect time of each address is kept in its HostDB record, and the family that connected faster is tried first
+   the next time.
+
+   The state machine runs under the mutex of the HttpSM. HttpSM cancels the returned action like a connect action, the
+   race is then torn down on its next event without touching the HttpSM.
+ */
+class HappyEyeballsSM : public Continuation
+{
+public:
+  /// Connections in flight or tried at most, the remaining addresses of a large round robin record are not raced.
+  static constexpr int MAX_ATTEMPTS = 8;
+
+  HappyEyeballsSM(HttpSM *sm, const NetVCOptions &opt, bool tls, ink_hrtime delay);
+
+  /**
+     Start racing the addresses of the origin of @a sm
+
+     @a alternate_style is the HostDB resolution style for the other address family, HOST_RES_NONE to race the
+     addresses of the first family only.
+
+     @return the action to cancel the race, or ACTION_RESULT_DONE when HttpSM was already called back
+   */
+  static Action *start(HttpSM *sm, const NetVCOptions &opt, bool tls, HostResStyle alternate_style);
+
+  int state_race(int event, void *data);
+
+private:
+  struct Candidate {
+    IpEndpoint addr;
+    HappyEyeballs::Family family;
+    short rr_index; ///< Index in the round robin record of the family, -1 if not in it.
+  };
+
+  class Attempt : public Continuation
+  {
+  public:
+    enum State { IDLE, CONNECTING, OPEN, CLOSED };
+
+    Attempt() : Continuation(nullptr) { SET_HANDLER(&Attempt::state_connect); }
+
+    int state_connect(int event, void *data);
+
+    HappyEyeballsSM *he = nullptr;
+    Candidate candidate;
+    State state            = IDLE;
+    Action *pending_action = nullptr;
+    NetVConnection *netvc  = nullptr;
+    MIOBuffer *write_buf   = nullptr;
+    ink_hrtime start_time  = 0;
+  };
+
+  void _add_candidates(HappyEyeballs::Family family, HostDBInfo *r, const sockaddr *first);
+  void _add_candidate(HappyEyeballs::Family family, const sockaddr *addr, short rr_index, const HostDBInfo *info);
+  void _start_next();
+  void _attempt_event(Attempt *a, int event, void *data);
+  void _fail(Attempt *a, int err);
+  void _win(Attempt *a);
+  void _close(Attempt *a);
+  void _update_rtt(const Candidate &c, uint8_t sample, bool lower_bound);
+  HostDBInfo *_info(const Candidate &c) const;
+  void _teardown();
+  void _enter();
+  void _leave();
+
+  HttpSM *_sm = nullptr;
+  Action _action;
+  NetVCOptions _opt;
+  bool _tls                    = false;
+  ink_hrtime _delay            = 0;
+  ink_hrtime _connect_timeout  = 0;
+  int32_t _down_server_timeout = 0;
+  in_port_t _port              = 0;
+  std::string _host;
+  std::string _lookup_name;
+
+  Ptr<HostDBInfo> _records[2];
+  uint8_t _first_rtt[2] = {HappyEyeballs::RTT_UNKNOWN, HappyEyeballs::RTT_UNKNOWN};
+  bool _has_family[2]   = {false, false};
+  HappyEyeballs::CandidateList<Candidate> _candidates;
+
+  Attempt _attempts[MAX_ATTEMPTS];
+  int _n_attempts        = 0;
+  int _in_flight         = 0;
+  int _last_error        = EIO;
+  ink_hrtime _last_start = 0;
+  Event *_timer          = nullptr;
+  Action *_lookup_action = nullptr;
+  bool _lookup_pending   = false;
+  bool _done             = false;
+  int _depth             = 0;
+};
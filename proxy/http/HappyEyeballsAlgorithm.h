@@ -0,0 +1,177 @@
+/** @file
+
+  Happy Eyeballs (RFC 8305) ordering and connect time bookkeeping
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/ink_hrtime.h"
+
+#include <cstdint>
+#include <deque>
+#include <algorithm>
+
+namespace HappyEyeballs
+{
+/**
+   The connect time of an address is kept in a byte of its HostDB application data, in units of @c RTT_UNIT_MS
+   milliseconds. Zero means no connect was timed yet and @c RTT_FAILED is what a failed connect counts as.
+ */
+constexpr int64_t RTT_UNIT_MS = 4;
+constexpr uint8_t RTT_UNKNOWN = 0;
+constexpr uint8_t RTT_FAILED  = UINT8_MAX;
+
+/// The two address families of an origin, the one HostDB resolved first and the other one.
+enum Family { PRIMARY = 0, ALTERNATE = 1 };
+
+/**
+   Encode a connect time
+
+   @return the connect time in units of @c RTT_UNIT_MS, rounded up so that an immediate connect is not taken as unknown
+ */
+inline uint8_t
+encode_rtt(ink_hrtime t)
+{
+  const int64_t units = std::max<int64_t>(ink_hrtime_to_msec(t), 0) / RTT_UNIT_MS + 1;
+
+  return static_cast<uint8_t>(std::min<int64_t>(units, RTT_FAILED));
+}
+
+/**
+   Add a connect time sample to the smoothed value of an address
+
+   The sample weighs a quarter, enough for a family that became slow to lose its preference after a few connects.
+ */
+inline uint8_t
+smooth_rtt(uint8_t rtt, uint8_t sample)
+{
+  if (rtt == RTT_UNKNOWN) {
+    return sample;
+  }
+
+  return static_cast<uint8_t>((3 * static_cast<unsigned>(rtt) + sample) / 4);
+}
+
+/**
+   Add the time an abandoned connect was given to the smoothed value of an address
+
+   The connect would have taken at least @a sample, which only says something when it is more than known already.
+ */
+inline uint8_t
+smooth_rtt_lower_bound(uint8_t rtt, uint8_t sample)
+{
+  return sample > rtt ? smooth_rtt(rtt, sample) : rtt;
+}
+
+/**
+   Whether to start with the alternate family
+
+   The family HostDB resolved first is kept unless the other family is known to connect faster, or the first one only
+   failed lately.
+ */
+inline bool
+prefer_alternate(uint8_t primary_rtt, uint8_t alternate_rtt)
+{
+  if (alternate_rtt == RTT_UNKNOWN || alternate_rtt == RTT_FAILED) {
+    return false;
+  }
+
+  return primary_rtt == RTT_FAILED || (primary_rtt != RTT_UNKNOWN && alternate_rtt < primary_rtt);
+}
+
+/// Upper bounds of the connect time histogram, the last bucket takes the rest.
+constexpr int64_t CONNECT_TIME_BUCKETS_MS[] = {10, 50, 100, 250, 500, 1000};
+constexpr int N_CONNECT_TIME_BUCKETS        = sizeof(CONNECT_TIME_BUCKETS_MS) / sizeof(CONNECT_TIME_BUCKETS_MS[0]) + 1;
+
+inline int
+connect_time_bucket(ink_hrtime t)
+{
+  const int64_t ms = ink_hrtime_to_msec(t);
+  int i            = 0;
+
+  while (i < N_CONNECT_TIME_BUCKETS - 1 && ms > CONNECT_TIME_BUCKETS_MS[i]) {
+    ++i;
+  }
+
+  return i;
+}
+
+/**
+   Addresses left to try, per family
+
+   Addresses are taken alternating between the families, starting with the preferred one (RFC 8305 section 4). A family
+   that runs out leaves the rest to the other one, and addresses of a family may still be added while the other one is
+   being tried.
+ */
+template <typename T> class CandidateList
+{
+public:
+  void
+  push(Family f, const T &t)
+  {
+    _pending[f].push_back(t);
+  }
+
+  /// Take the next address from @a f, only meaningful before the first @c pop.
+  void
+  prefer(Family f)
+  {
+    _next = f;
+  }
+
+  bool
+  empty() const
+  {
+    return _pending[PRIMARY].empty() && _pending[ALTERNATE].empty();
+  }
+
+  size_t
+  size(Family f) const
+  {
+    return _pending[f].size();
+  }
+
+  T
+  pop()
+  {
+    if (_pending[_next].empty()) {
+      _next = other(_next);
+    }
+
+    T t = _pending[_next].front();
+    _pending[_next].pop_front();
+    _next = other(_next);
+
+    return t;
+  }
+
+private:
+  static Family
+  other(Family f)
+  {
+    return f == PRIMARY ? ALTERNATE : PRIMARY;
+  }
+
+  std::deque<T> _pending[2];
+  Family _next = PRIMARY;
+};
+
+} // namespace HappyEyeballs
@@ -166,7 +166,8 @@ http_config_enum_mask_read(const char *name, MgmtByte &value)
 static const ConfigEnumPair<TSServerSessionSharingPoolType> SessionSharingPoolStrings[] = {
   {TS_SERVER_SESSION_SHARING_POOL_GLOBAL, "global"},
   {TS_SERVER_SESSION_SHARING_POOL_THREAD, "thread"},
-  {TS_SERVER_SESSION_SHARING_POOL_HYBRID, "hybrid"}};
+  {TS_SERVER_SESSION_SHARING_POOL_HYBRID, "hybrid"},
+  {TS_SERVER_SESSION_SHARING_POOL_SHARDED, "sharded"}};
 
 int HttpConfig::m_id = 0;
 HttpConfigParams HttpConfig::m_master;
@@ -315,6 +316,8 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.tunnel.current_active_connections", RECD_INT, RECP_NON_PERSISTENT,
                      (int)tunnel_current_active_connections_stat, RecRawStatSyncSum);
   HTTP_CLEAR_DYN_STAT(tunnel_current_active_connections_stat);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.tunnel.total_spliced", RECD_INT, RECP_NON_PERSISTENT,
+                     (int)tunnel_total_spliced_stat, RecRawStatSyncCount);
 
   // Current Transaction Stats
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.current_client_transactions", RECD_INT, RECP_NON_PERSISTENT,
@@ -405,6 +408,8 @@ register_stat_callbacks()
                      (int)http_origin_not_found, RecRawStatSyncCount);
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin.reuse_fail", RECD_INT, RECP_NON_PERSISTENT,
                      (int)http_origin_reuse_fail, RecRawStatSyncCount);
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin.reuse_peer", RECD_INT, RECP_NON_PERSISTENT,
+                     (int)http_origin_reuse_peer, RecRawStatSyncCount);
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin.make_new", RECD_INT, RECP_NON_PERSISTENT,
                      (int)http_origin_make_new, RecRawStatSyncCount);
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin.no_sharing", RECD_INT, RECP_NON_PERSISTENT,
@@ -636,6 +641,54 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_server_speed_bytes_per_sec_100M", RECD_COUNTER,
                      RECP_PERSISTENT, (int)http_origin_server_speed_bytes_per_sec_100M_stat, RecRawStatSyncCount);
 
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv4_10ms", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv4_10ms_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv4_50ms", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv4_50ms_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv4_100ms", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv4_100ms_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv4_250ms", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv4_250ms_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv4_500ms", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv4_500ms_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv4_1s", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv4_1s_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv4_inf", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv4_inf_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv6_10ms", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv6_10ms_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv6_50ms", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv6_50ms_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv6_100ms", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv6_100ms_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv6_250ms", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv6_250ms_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv6_500ms", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv6_500ms_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv6_1s", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv6_1s_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.origin_connect_time_ipv6_inf", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_origin_connect_time_ipv6_inf_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.happy_eyeballs.races", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_happy_eyeballs_races_stat, RecRawStatSyncCount);
+
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.happy_eyeballs.alternate_wins", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_happy_eyeballs_alternate_wins_stat, RecRawStatSyncCount);
+
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.total_transactions_time", RECD_INT, RECP_PERSISTENT,
                      (int)http_total_transactions_time_stat, RecRawStatSyncSum);
 
@@ -798,6 +851,9 @@ register_stat_callbacks()
   RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_read_errors", RECD_COUNTER, RECP_PERSISTENT,
                      (int)http_cache_read_errors, RecRawStatSyncSum);
 
+  RecRegisterRawStat(http_rsb, RECT_PROCESS, "proxy.process.http.cache_partial_writes", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)http_cache_partial_writes_stat, RecRawStatSyncSum);
+
   ////////////////////////////////////////////////////////////////////////////////
   // status code counts
   ////////////////////////////////////////////////////////////////////////////////
@@ -1324,12 +1380,16 @@ HttpConfig::startup()
 
   HttpEstablishStaticConfigByte(c.keepalive_internal_vc, "proxy.config.http.keepalive_internal_vc");
 
+  HttpEstablishStaticConfigByte(c.tunnel_splice, "proxy.config.tunnel.splice");
+
   HttpEstablishStaticConfigByte(c.oride.cache_open_write_fail_action, "proxy.config.http.cache.open_write_fail_action");
 
   HttpEstablishStaticConfigByte(c.oride.cache_when_to_revalidate, "proxy.config.http.cache.when_to_revalidate");
   HttpEstablishStaticConfigByte(c.oride.cache_required_headers, "proxy.config.http.cache.required_headers");
   HttpEstablishStaticConfigByte(c.oride.cache_range_lookup, "proxy.config.http.cache.range.lookup");
   HttpEstablishStaticConfigByte(c.oride.cache_range_write, "proxy.config.http.cache.range.write");
+  HttpEstablishStaticConfigLongLong(c.cache_range_partial, "proxy.config.http.cache.range.partial");
+  HttpEstablishStaticConfigLongLong(c.happy_eyeballs_delay, "proxy.config.http.happy_eyeballs_delay");
 
   HttpEstablishStaticConfigStringAlloc(c.connect_ports_string, "proxy.config.http.connect_ports");
 
@@ -1444,6 +1504,8 @@ HttpConfig::reconfigure()
 
   params->server_max_connections    = m_master.server_max_connections;
   params->max_websocket_connections = m_master.max_websocket_connections;
+  params->cache_range_partial       = m_master.cache_range_partial;
+  params->happy_eyeballs_delay      = m_master.happy_eyeballs_delay;
   params->oride.outbound_conntrack  = m_master.oride.outbound_conntrack;
   params->global_outbound_conntrack = m_master.global_outbound_conntrack;
 
@@ -1620,6 +1682,8 @@ HttpConfig::reconfigure()
   params->disallow_post_100_continue = INT_TO_BOOL(m_master.disallow_post_100_continue);
   params->keepalive_internal_vc      = INT_TO_BOOL(m_master.keepalive_internal_vc);
 
+  params->tunnel_splice = INT_TO_BOOL(m_master.tunnel_splice);
+
   params->oride.cache_open_write_fail_action = m_master.oride.cache_open_write_fail_action;
   if (params->oride.cache_open_write_fail_action == CACHE_WL_FAIL_ACTION_READ_RETRY) {
     if (params->oride.max_cache_open_read_retries <= 0 || params->oride.max_cache_open_write_retries <= 0) {
@@ -63,6 +63,7 @@ enum {
   http_current_active_client_connections_stat,
   http_websocket_current_active_client_connections_stat,
   tunnel_current_active_connections_stat,
+  tunnel_total_spliced_stat,
   http_current_client_transactions_stat,
   http_total_incoming_connections_stat,
   http_current_server_transactions_stat,
@@ -175,6 +176,25 @@ enum {
   http_origin_server_speed_bytes_per_sec_10M_stat,
   http_origin_server_speed_bytes_per_sec_100M_stat,
 
+  // origin connect time stats, per address family
+  http_origin_connect_time_ipv4_10ms_stat,
+  http_origin_connect_time_ipv4_50ms_stat,
+  http_origin_connect_time_ipv4_100ms_stat,
+  http_origin_connect_time_ipv4_250ms_stat,
+  http_origin_connect_time_ipv4_500ms_stat,
+  http_origin_connect_time_ipv4_1s_stat,
+  http_origin_connect_time_ipv4_inf_stat,
+  http_origin_connect_time_ipv6_10ms_stat,
+  http_origin_connect_time_ipv6_50ms_stat,
+  http_origin_connect_time_ipv6_100ms_stat,
+  http_origin_connect_time_ipv6_250ms_stat,
+  http_origin_connect_time_ipv6_500ms_stat,
+  http_origin_connect_time_ipv6_1s_stat,
+  http_origin_connect_time_ipv6_inf_stat,
+
+  http_happy_eyeballs_races_stat,
+  http_happy_eyeballs_alternate_wins_stat,
+
   // cache result stats
   http_cache_hit_fresh_stat,
   http_cache_hit_mem_fresh_stat,
@@ -254,6 +274,7 @@ enum {
   // Http cache errors
   http_cache_write_errors,
   http_cache_read_errors,
+  http_cache_partial_writes_stat,
 
   // status code stats
   http_response_status_100_count_stat,
@@ -356,6 +377,7 @@ enum {
   http_origin_reuse,
   http_origin_not_found,
   http_origin_reuse_fail,
+  http_origin_reuse_peer,
   http_origin_make_new,
   http_origin_no_sharing,
   http_origin_body,
@@ -764,6 +786,12 @@ public:
   MgmtInt server_max_connections    = 0;
   MgmtInt max_websocket_connections = -1;
 
+  // minimum bytes of an interrupted response to keep as a partial object, 0 disables.
+  MgmtInt cache_range_partial = 0;
+
+  // milliseconds before racing the next origin address (RFC 8305), 0 disables.
+  MgmtInt happy_eyeballs_delay = 0;
+
   char *proxy_request_via_string    = nullptr;
   char *proxy_response_via_string   = nullptr;
   int proxy_request_via_string_len  = 0;
@@ -830,6 +858,8 @@ public:
   MgmtByte disallow_post_100_continue = 0;
   MgmtByte keepalive_internal_vc      = 0;
 
+  MgmtByte tunnel_splice = 0;
+
   MgmtByte server_session_sharing_pool = TS_SERVER_SESSION_SHARING_POOL_THREAD;
 
   OutboundConnTrack::GlobalConfig global_outbound_conntrack;
@@ -54,5 +54,6 @@ typedef enum {
 typedef enum {
   TS_SERVER_SESSION_SHARING_POOL_GLOBAL,
   TS_SERVER_SESSION_SHARING_POOL_THREAD,
-  TS_SERVER_SESSION_SHARING_POOL_HYBRID
+  TS_SERVER_SESSION_SHARING_POOL_HYBRID,
+  TS_SERVER_SESSION_SHARING_POOL_SHARDED
 } TSServerSessionSharingPoolType;
@@ -34,6 +34,7 @@
 #include "P_Net.h"
 #include "PreWarmConfig.h"
 #include "PreWarmManager.h"
+#include "HappyEyeballs.h"
 #include "StatPages.h"
 #include "Log.h"
 #include "LogAccess.h"
@@ -130,6 +131,30 @@ milestone_update_api_time(TransactionMilestones &milestones, ink_hrtime &api_tim
   }
 }
 
+/// Whether @a acl denies the method of @a request, fail open if there is no ACL.
+static bool
+ip_allow_denies_method(const IpAllow::ACL &acl, HTTPHdr &request)
+{
+  if (!acl.isValid()) {
+    return false;
+  }
+  if (acl.isDenyAll()) {
+    return true;
+  }
+  if (acl.isAllowAll()) {
+    return false;
+  }
+
+  int method = request.method_get_wksidx();
+  if (method != -1) {
+    return !acl.isMethodAllowed(method);
+  }
+
+  int method_str_len     = 0;
+  const char *method_str = request.method_get(&method_str_len);
+  return !acl.isNonstandardMethodAllowed(std::string_view(method_str, method_str_len));
+}
+
 // Unique state machine identifier
 std::atomic<int64_t> next_sm_id(0);
 
@@ -362,11 +387,23 @@ HttpSM::get_server_connect_timeout()
   return retval;
 }
 
+bool
+HttpSM::is_server_addr_allowed(const sockaddr *addr)
+{
+  // Same as the check in do_http_server_open, for the addresses raced with the selected one.
+  if (t_state.url_remap_success && !t_state.url_map.getMapping()->ip_allow_check_enabled_p) {
+    return true;
+  }
+  return !ip_allow_denies_method(IpAllow::match(addr, IpAllow::DST_ADDR), t_state.hdr_info.server_request);
+}
+
 HttpSM::HttpSM() : Continuation(nullptr), vc_table(this) {}
 
 void
 HttpSM::cleanup()
 {
+  // the next hop strategy is owned by the remap table, report before the lease is dropped.
+  HttpTransact::next_hop_attempt_complete(&t_state);
   t_state.destroy();
   api_hooks.clear();
   http_parser_clear(&http_parser);
@@ -1949,6 +1986,12 @@ HttpSM::state_http_server_open(int event, void *data)
     // Reset the timeout to the non-connect timeout
     server_txn->set_inactivity_timeout(get_server_inactivity_timeout());
     t_state.current.server->clear_connect_fail();
+    if (t_state.current.request_to == HttpTransact::ORIGIN_SERVER) {
+      int base = ats_is_ip6(&t_state.current.server->dst_addr) ? http_origin_connect_time_ipv6_10ms_stat :
+                                                                  http_origin_connect_time_ipv4_10ms_stat;
+      HTTP_INCREMENT_DYN_STAT(base + HappyEyeballs::connect_time_bucket(milestones[TS_MILESTONE_SERVER_CONNECT_END] -
+                                                                         milestones[TS_MILESTONE_SERVER_CONNECT]));
+    }
     handle_http_server_open();
     return 0;
   case EVENT_INTERVAL: // Delayed call from another thread
@@ -3156,6 +3199,7 @@ HttpSM::tunnel_handler_server(int event, HttpTunnelProducer *p)
 
     if (is_http_server_eos_truncation(p)) {
       SMDebug("http", "[%" PRId64 "] [HttpSM::tunnel_handler_server] aborting HTTP tunnel due to server truncation", sm_id);
+      commit_partial_cache_write(p);
       tunnel.chain_abort_all(p);
       // UA session may not be in the tunnel yet, don't NULL out the pointer in that case.
       // Note: This is a hack. The correct solution is for the UA session to signal back to the SM
@@ -3321,6 +3365,46 @@ HttpSM::tunnel_handler_100_continue_ua(int event, HttpTunnelConsumer *c)
   return 0;
 }
 
+// The response from p is about to be aborted before it is complete. If
+// proxy.config.http.cache.range.partial allows it, close its cache write
+// normally instead, so that what was written is kept as a partial object
+// that can serve Range: requests for the stored prefix.
+void
+HttpSM::commit_partial_cache_write(HttpTunnelProducer *p)
+{
+  int64_t min_bytes = t_state.http_config_param->cache_range_partial;
+
+  if (min_bytes <= 0 || p->vc_type != HT_HTTP_SERVER || t_state.hdr_info.server_response.status_get() != HTTP_STATUS_OK) {
+    return;
+  }
+
+  int64_t cl = t_state.hdr_info.server_response.get_content_length();
+  if (cl <= 0 || p->do_dechunking || p->do_chunked_passthru) {
+    return;
+  }
+
+  for (HttpTunnelConsumer *c = p->consumer_list.head; c; c = c->link.next) {
+    if (!c->alive || c->vc_type != HT_CACHE_WRITE || c->write_vio == nullptr) {
+      continue;
+    }
+
+    int64_t written = c->write_vio->ndone;
+    if (written < min_bytes || written >= cl) {
+      continue;
+    }
+
+    SMDebug("http", "[%" PRId64 "] keeping %" PRId64 " of %" PRId64 " bytes in cache as a partial object", sm_id, written, cl);
+    c->alive         = false;
+    c->write_vio     = nullptr;
+    c->write_success = true;
+    c->bytes_written = written;
+    c->vc->do_io_close();
+    t_state.cache_info.write_status = HttpTransact::CACHE_WRITE_COMPLETE;
+    HTTP_INCREMENT_DYN_STAT(http_cache_partial_writes_stat);
+    HTTP_DECREMENT_DYN_STAT(http_current_cache_connections_stat);
+  }
+}
+
 bool
 HttpSM::is_bg_fill_necessary(HttpTunnelConsumer *c)
 {
@@ -3419,6 +3503,7 @@ HttpSM::tunnel_handler_ua(int event, HttpTunnelConsumer *c)
     } else {
       // No background fill
       p = c->producer;
+      commit_partial_cache_write(p);
       tunnel.chain_abort_all(c->producer);
       selfc = p->self_consumer;
       if (selfc) {
@@ -3428,6 +3513,7 @@ HttpSM::tunnel_handler_ua(int event, HttpTunnelConsumer *c)
         // Otherwise in case of large docs, producer iobuffer gets filled up,
         // waiting for a consumer to consume data and the connection is never closed.
         if (p->alive && ((p->vc_type == HT_CACHE_READ) || (p->vc_type == HT_HTTP_SERVER))) {
+          commit_partial_cache_write(p);
           tunnel.chain_abort_all(p);
         }
       }
@@ -4626,6 +4712,12 @@ HttpSM::parse_range_and_compare(MIMEField *field, int64_t content_length)
     ranges[nr]._end   = end;
     ++nr;
 
+    // a partial object only has a prefix of content_length in cache.
+    if (end >= t_state.cache_info.object_read->object_size_get()) {
+      Debug("http_range", "request range past the partial object, end %" PRId64, end);
+      t_state.range_in_cache = false;
+    }
+
     if (!cache_sm.cache_read_vc->is_pread_capable() && cache_config_read_while_writer == 2) {
       // write in progress, check if request range not in cache yet
       HTTPInfo::FragOffset *frag_offset_tbl = t_state.cache_info.object_read->get_frag_table();
@@ -4691,7 +4783,7 @@ HttpSM::do_range_parse(MIMEField *range_field)
   int num_chars_for_ct = 0;
   t_state.cache_info.object_read->response_get()->value_get(MIME_FIELD_CONTENT_TYPE, MIME_LEN_CONTENT_TYPE, &num_chars_for_ct);
 
-  int64_t content_length   = t_state.cache_info.object_read->object_size_get();
+  int64_t content_length   = HttpTransact::cache_object_length(&t_state, t_state.cache_info.object_read);
   int64_t num_chars_for_cl = num_chars_for_int(content_length);
 
   parse_range_and_compare(range_field, content_length);
@@ -4757,7 +4849,7 @@ HttpSM::do_range_setup_if_necessary()
           // create a Range: transform processor for requests of type Range: bytes=1-2,4-5,10-100 (eg. multiple ranges)
           INKVConnInternal *range_trans = transformProcessor.range_transform(
             mutex.get(), t_state.ranges, t_state.num_range_fields, &t_state.hdr_info.transform_response, content_type,
-            field_content_type_len, t_state.cache_info.object_read->object_size_get());
+            field_content_type_len, HttpTransact::cache_object_length(&t_state, t_state.cache_info.object_read));
           api_hooks.append(TS_HTTP_RESPONSE_TRANSFORM_HOOK, range_trans);
         } else {
           // ToDo: Do we do something here? The theory is that multiple transforms do not behave well with
@@ -5060,35 +5152,14 @@ HttpSM::do_http_server_open(bool raw)
   // Otherwise, if no remap rule is defined, apply the ip_allow filter.
   if (!t_state.url_remap_success || t_state.url_map.getMapping()->ip_allow_check_enabled_p) {
     // Method allowed on dest IP address check
-    sockaddr *server_ip    = &t_state.current.server->dst_addr.sa;
-    IpAllow::ACL acl       = IpAllow::match(server_ip, IpAllow::DST_ADDR);
-    bool deny_request      = false; // default is fail open.
-    int method             = t_state.hdr_info.server_request.method_get_wksidx();
-    int method_str_len     = 0;
-    const char *method_str = nullptr;
-
-    if (acl.isValid()) {
-      if (acl.isDenyAll()) {
-        deny_request = true;
-      } else if (!acl.isAllowAll()) {
-        if (method != -1) {
-          deny_request = !acl.isMethodAllowed(method);
-        } else {
-          method_str   = t_state.hdr_info.server_request.method_get(&method_str_len);
-          deny_request = !acl.isNonstandardMethodAllowed(std::string_view(method_str, method_str_len));
-        }
-      }
-    }
+    sockaddr *server_ip = &t_state.current.server->dst_addr.sa;
+    IpAllow::ACL acl    = IpAllow::match(server_ip, IpAllow::DST_ADDR);
 
-    if (deny_request) {
+    if (ip_allow_denies_method(acl, t_state.hdr_info.server_request)) {
       if (is_debug_tag_set("ip-allow")) {
         ip_text_buffer ipb;
-        if (method != -1) {
-          method_str     = hdrtoken_index_to_wks(method);
-          method_str_len = strlen(method_str);
-        } else if (!method_str) {
-          method_str = t_state.hdr_info.client_request.method_get(&method_str_len);
-        }
+        int method_str_len     = 0;
+        const char *method_str = t_state.hdr_info.server_request.method_get(&method_str_len);
         Warning("server '%s' prohibited by ip-allow policy at line %d", ats_ip_ntop(server_ip, ipb, sizeof(ipb)),
                 acl.source_line());
         Debug("ip-allow", "Line %d denial for '%.*s' from %s", acl.source_line(), method_str_len, method_str,
@@ -5414,8 +5485,6 @@ HttpSM::do_http_server_open(bool raw)
   opt.ssl_client_ca_cert_name     = t_state.txn_conf->ssl_client_ca_cert_filename;
 
   if (tls_upstream) {
-    SMDebug("http", "calling sslNetProcessor.connect_re");
-
     std::string_view sni_name = this->get_outbound_sni();
     if (sni_name.length() > 0) {
       opt.set_sni_servername(sni_name.data(), sni_name.length());
@@ -5432,7 +5501,30 @@ HttpSM::do_http_server_open(bool raw)
     if (t_state.server_info.name) {
       opt.set_ssl_servername(t_state.server_info.name);
     }
+  }
+
+  // Race the first connect to an origin over its addresses when nothing pins the address or the source of the connection.
+  if (t_state.http_config_param->happy_eyeballs_delay > 0 && t_state.current.request_to == HttpTransact::ORIGIN_SERVER &&
+      t_state.current.attempts == 0 && t_state.hostdb_entry && !t_state.dns_info.srv_lookup_success &&
+      t_state.dns_info.os_addr_style == HttpTransact::DNSLookupInfo::OS_Addr::OS_ADDR_TRY_DEFAULT &&
+      !t_state.api_server_addr_set && opt.addr_binding == NetVCOptions::ANY_ADDR && opt.local_port == 0 &&
+      !t_state.outbound_conn_track_state.is_active()) {
+    // Race the other family as well if the resolution style allows both.
+    HostResStyle style =
+      ua_txn ? ats_host_res_from(ua_txn->get_netvc()->get_local_addr()->sa_family, t_state.txn_conf->host_res_data.order) :
+               HOST_RES_IPV4;
+    HostResStyle alternate_style = HOST_RES_NONE;
+    if (style == HOST_RES_IPV4 || style == HOST_RES_IPV6) {
+      alternate_style = AF_INET6 == ip_family ? HOST_RES_IPV4_ONLY : HOST_RES_IPV6_ONLY;
+    }
+
+    SMDebug("http", "starting happy eyeballs race");
+    pending_action = HappyEyeballsSM::start(this, opt, tls_upstream, alternate_style);
+    return;
+  }
 
+  if (tls_upstream) {
+    SMDebug("http", "calling sslNetProcessor.connect_re");
     pending_action = sslNetProcessor.connect_re(this,                                 // state machine
                                                 &t_state.current.server->dst_addr.sa, // addr + port
                                                 &opt);
@@ -7090,6 +7182,23 @@ HttpSM::setup_blind_tunnel(bool send_response_hdr, IOBufferReader *initial)
 
   tunnel.tunnel_run();
 
+  // Nothing looks at the payload of a blind tunnel, so between two plain TCP
+  // connections it can move through a kernel pipe instead of the buffers.
+  // The tunnel still sees the VIO counts and events.
+  if (t_state.http_config_param->tunnel_splice && ua_txn && server_txn) {
+    NetVConnection *ua_netvc     = ua_txn->get_netvc();
+    NetVConnection *server_netvc = server_txn->get_netvc();
+    if (ua_netvc && server_netvc) {
+      bool to_server = ua_netvc->splice_to(server_netvc);
+      bool to_client = server_netvc->splice_to(ua_netvc);
+      SMDebug("http", "[%" PRId64 "] blind tunnel splice, client to server: %s, server to client: %s", sm_id,
+              to_server ? "yes" : "no", to_client ? "yes" : "no");
+      if (to_server || to_client) {
+        HTTP_INCREMENT_DYN_STAT(tunnel_total_spliced_stat);
+      }
+    }
+  }
+
   // If we're half closed, we got a FIN from the client. Forward it on to the origin server
   // now that we have the tunnel operational.
   if (ua_txn && ua_txn->get_half_close_flag()) {
@@ -8135,6 +8244,7 @@ HttpSM::redirect_request(const char *arg_redirect_url, const int arg_redirect_le
   // we want to close the server session
   // will do that in handle_api_return under the
   // HttpTransact::SM_ACTION_REDIRECT_READ state
+  HttpTransact::next_hop_attempt_complete(&t_state);
   t_state.parent_result.reset();
   t_state.request_sent_time      = 0;
   t_state.response_received_time = 0;
@@ -565,6 +565,7 @@ protected:
 
   bool is_http_server_eos_truncation(HttpTunnelProducer *);
   bool is_bg_fill_necessary(HttpTunnelConsumer *c);
+  void commit_partial_cache_write(HttpTunnelProducer *p);
   int find_server_buffer_size();
   int find_http_resp_buffer_size(int64_t cl);
   int64_t server_transfer_init(MIOBuffer *buf, int hdr_size);
@@ -658,6 +659,8 @@ public:
   ink_hrtime get_server_inactivity_timeout();
   ink_hrtime get_server_active_timeout();
   ink_hrtime get_server_connect_timeout();
+  /// Whether ip_allow lets the server request go to @a addr.
+  bool is_server_addr_allowed(const sockaddr *addr);
   void rewind_state_machine();
 
 private:
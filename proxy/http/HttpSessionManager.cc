@@ -31,9 +31,11 @@
  ****************************************************************************/
 
 #include "HttpSessionManager.h"
+#include "OriginReuseTrack.h"
 #include "../ProxySession.h"
 #include "HttpSM.h"
 #include "HttpDebugNames.h"
+#include "Show.h"
 
 // Initialize a thread to handle HTTP session management
 void
@@ -59,6 +61,7 @@ ServerSessionPool::purge()
   m_ip_pool.apply([](PoolableSession *ssn) -> void { ssn->do_io_close(); });
   m_ip_pool.clear();
   m_fqdn_pool.clear();
+  m_count = 0;
 }
 
 bool
@@ -335,6 +338,11 @@ HttpSessionManager::acquire_session(HttpSM *sm, sockaddr const *ip, const char *
 
   CryptoContext().hash_immediate(hostname_hash, (unsigned char *)hostname, strlen(hostname));
 
+  OriginReuseTrack::Origin *origin = OriginReuseTrack::obtain(hostname, hostname_hash, ats_ip_port_host_order(ip));
+  if (origin) {
+    OriginReuseTrack::count(origin->acquires);
+  }
+
   // First check to see if there is a server session bound
   //   to the user agent session
   to_return = ua_txn->get_server_session();
@@ -355,6 +363,9 @@ HttpSessionManager::acquire_session(HttpSM *sm, sockaddr const *ip, const char *
       Debug("http_ss", "[%" PRId64 "] [acquire session] returning attached session ", to_return->connection_id());
       to_return->state = PoolableSession::SSN_IN_USE;
       sm->create_server_txn(to_return);
+      if (origin) {
+        OriginReuseTrack::count(origin->local);
+      }
       return HSM_DONE;
     }
     // Release this session back to the main session pool and
@@ -369,14 +380,32 @@ HttpSessionManager::acquire_session(HttpSM *sm, sockaddr const *ip, const char *
 
   // Otherwise, check the thread pool first
   if (this->get_pool_type() == TS_SERVER_SESSION_SHARING_POOL_THREAD ||
-      this->get_pool_type() == TS_SERVER_SESSION_SHARING_POOL_HYBRID) {
+      this->get_pool_type() == TS_SERVER_SESSION_SHARING_POOL_HYBRID ||
+      this->get_pool_type() == TS_SERVER_SESSION_SHARING_POOL_SHARDED) {
     retval = _acquire_session(ip, hostname_hash, sm, match_style, TS_SERVER_SESSION_SHARING_POOL_THREAD);
+    if (retval == HSM_DONE && origin) {
+      OriginReuseTrack::count(origin->local);
+    }
   }
 
   //  If you didn't get a match, and the global pool is an option go there.
   if (retval != HSM_DONE && (TS_SERVER_SESSION_SHARING_POOL_GLOBAL == this->get_pool_type() ||
                              TS_SERVER_SESSION_SHARING_POOL_HYBRID == this->get_pool_type())) {
     retval = _acquire_session(ip, hostname_hash, sm, match_style, TS_SERVER_SESSION_SHARING_POOL_GLOBAL);
+    if (retval == HSM_DONE && origin) {
+      OriginReuseTrack::count(origin->global);
+    }
+  }
+
+  // With sharded pools borrow from the other threads before giving up.
+  if (retval != HSM_DONE && TS_SERVER_SESSION_SHARING_POOL_SHARDED == this->get_pool_type()) {
+    retval = _acquire_peer_session(ip, hostname_hash, sm, match_style);
+    if (retval == HSM_DONE) {
+      HTTP_INCREMENT_DYN_STAT(http_origin_reuse_peer);
+      if (origin) {
+        OriginReuseTrack::count(origin->peer);
+      }
+    }
   }
   return retval;
 }
@@ -384,6 +413,43 @@ HttpSessionManager::acquire_session(HttpSM *sm, sockaddr const *ip, const char *
 HSMresult_t
 HttpSessionManager::_acquire_session(sockaddr const *ip, CryptoHash const &hostname_hash, HttpSM *sm,
                                      TSServerSessionSharingMatchMask match_style, TSServerSessionSharingPoolType pool_type)
+{
+  ServerSessionPool *pool = (TS_SERVER_SESSION_SHARING_POOL_THREAD == pool_type) ? this_ethread()->server_session_pool : m_g_pool;
+  return _acquire_pool_session(pool, ip, hostname_hash, sm, match_style);
+}
+
+// Look in the pools of the other net threads for a matching session. The pool sizes are
+// checked without locking and a busy pool is skipped rather than waited on, so neither the
+// borrowing thread nor the owning thread ever blocks on the other.
+HSMresult_t
+HttpSessionManager::_acquire_peer_session(sockaddr const *ip, CryptoHash const &hostname_hash, HttpSM *sm,
+                                          TSServerSessionSharingMatchMask match_style)
+{
+  EThread *ethread                                   = this_ethread();
+  EventProcessor::ThreadGroupDescriptor const &group = eventProcessor.thread_group[ET_NET];
+  HSMresult_t retval                                 = HSM_NOT_FOUND;
+
+  if (group._count < 2) {
+    return retval;
+  }
+
+  // Start at a random peer so that borrowing is spread over the pools.
+  int start = ethread->generator.random() % group._count;
+  for (int i = 0; i < group._count && retval != HSM_DONE; ++i) {
+    EThread *peer           = group._thread[(start + i) % group._count];
+    ServerSessionPool *pool = peer ? peer->server_session_pool : nullptr;
+    if (peer == ethread || pool == nullptr || pool->count() == 0) {
+      continue;
+    }
+    retval = _acquire_pool_session(pool, ip, hostname_hash, sm, match_style);
+  }
+  Debug("http_ss", "[acquire session] peer pool search %s", retval == HSM_DONE ? "successful" : "failed");
+  return retval == HSM_DONE ? HSM_DONE : HSM_NOT_FOUND;
+}
+
+HSMresult_t
+HttpSessionManager::_acquire_pool_session(ServerSessionPool *pool, sockaddr const *ip, CryptoHash const &hostname_hash, HttpSM *sm,
+                                          TSServerSessionSharingMatchMask match_style)
 {
   PoolableSession *to_return = nullptr;
   HSMresult_t retval         = HSM_NOT_FOUND;
@@ -394,44 +460,39 @@ HttpSessionManager::_acquire_session(sockaddr const *ip, CryptoHash const &hostn
   {
     // Now check to see if we have a connection in our shared connection pool
     EThread *ethread = this_ethread();
-    Ptr<ProxyMutex> pool_mutex =
-      (TS_SERVER_SESSION_SHARING_POOL_THREAD == pool_type) ? ethread->server_session_pool->mutex : m_g_pool->mutex;
-    MUTEX_TRY_LOCK(lock, pool_mutex, ethread);
+    MUTEX_TRY_LOCK(lock, pool->mutex, ethread);
     if (lock.is_locked()) {
-      if (TS_SERVER_SESSION_SHARING_POOL_THREAD == pool_type) {
-        retval = ethread->server_session_pool->acquireSession(ip, hostname_hash, match_style, sm, to_return);
-        Debug("http_ss", "[acquire session] thread pool search %s", to_return ? "successful" : "failed");
-      } else {
-        retval = m_g_pool->acquireSession(ip, hostname_hash, match_style, sm, to_return);
-        Debug("http_ss", "[acquire session] global pool search %s", to_return ? "successful" : "failed");
-        // At this point to_return has been removed from the pool. Do we need to move it
-        // to the same thread?
-        if (to_return) {
-          UnixNetVConnection *server_vc = dynamic_cast<UnixNetVConnection *>(to_return->get_netvc());
-          if (server_vc) {
-            // Disable i/o on this vc now, but, hold onto the g_pool cont
-            // and the mutex to stop any stray events from getting in
-            server_vc->do_io_read(m_g_pool, 0, nullptr);
-            server_vc->do_io_write(m_g_pool, 0, nullptr);
-            UnixNetVConnection *new_vc = server_vc->migrateToCurrentThread(sm, ethread);
-            // The VC moved, free up the original one
-            if (new_vc != server_vc) {
-              ink_assert(new_vc == nullptr || new_vc->nh != nullptr);
-              if (!new_vc) {
-                // Close out to_return, we were't able to get a connection
-                HTTP_INCREMENT_DYN_STAT(http_origin_shutdown_migration_failure);
-                to_return->do_io_close();
-                to_return = nullptr;
-                retval    = HSM_NOT_FOUND;
-              } else {
-                // Keep things from timing out on us
-                new_vc->set_inactivity_timeout(new_vc->get_inactivity_timeout());
-                to_return->set_netvc(new_vc);
-              }
+      retval = pool->acquireSession(ip, hostname_hash, match_style, sm, to_return);
+      Debug("http_ss", "[acquire session] %s pool search %s",
+            pool == ethread->server_session_pool ? "thread" : (pool == m_g_pool ? "global" : "peer"),
+            to_return ? "successful" : "failed");
+      // At this point to_return has been removed from the pool. Sessions from the global pool or from
+      // another thread's pool may be on a different thread and need to be moved to this one.
+      if (to_return && pool != ethread->server_session_pool) {
+        UnixNetVConnection *server_vc = dynamic_cast<UnixNetVConnection *>(to_return->get_netvc());
+        if (server_vc) {
+          // Disable i/o on this vc now, but, hold onto the pool cont
+          // and the mutex to stop any stray events from getting in
+          server_vc->do_io_read(pool, 0, nullptr);
+          server_vc->do_io_write(pool, 0, nullptr);
+          UnixNetVConnection *new_vc = server_vc->migrateToCurrentThread(sm, ethread);
+          // The VC moved, free up the original one
+          if (new_vc != server_vc) {
+            ink_assert(new_vc == nullptr || new_vc->nh != nullptr);
+            if (!new_vc) {
+              // Close out to_return, we were't able to get a connection
+              HTTP_INCREMENT_DYN_STAT(http_origin_shutdown_migration_failure);
+              to_return->do_io_close();
+              to_return = nullptr;
+              retval    = HSM_NOT_FOUND;
             } else {
               // Keep things from timing out on us
-              server_vc->set_inactivity_timeout(server_vc->get_inactivity_timeout());
+              new_vc->set_inactivity_timeout(new_vc->get_inactivity_timeout());
+              to_return->set_netvc(new_vc);
             }
+          } else {
+            // Keep things from timing out on us
+            server_vc->set_inactivity_timeout(server_vc->get_inactivity_timeout());
           }
         }
       }
@@ -458,10 +519,11 @@ HttpSessionManager::_acquire_session(sockaddr const *ip, CryptoHash const &hostn
 HSMresult_t
 HttpSessionManager::release_session(PoolableSession *to_release)
 {
-  EThread *ethread = this_ethread();
-  ServerSessionPool *pool =
-    TS_SERVER_SESSION_SHARING_POOL_THREAD == to_release->sharing_pool ? ethread->server_session_pool : m_g_pool;
-  bool released_p = true;
+  EThread *ethread        = this_ethread();
+  bool thread_pool_p      = TS_SERVER_SESSION_SHARING_POOL_THREAD == to_release->sharing_pool ||
+                       TS_SERVER_SESSION_SHARING_POOL_SHARDED == to_release->sharing_pool;
+  ServerSessionPool *pool = thread_pool_p ? ethread->server_session_pool : m_g_pool;
+  bool released_p         = true;
 
   // The per thread lock looks like it should not be needed but if it's not locked the close checking I/O op will crash.
   MUTEX_TRY_LOCK(lock, pool->mutex, ethread);
@@ -493,6 +555,7 @@ ServerSessionPool::removeSession(PoolableSession *to_remove)
   }
   m_fqdn_pool.erase(to_remove);
   if (m_ip_pool.erase(to_remove)) {
+    --m_count;
     HTTP_DECREMENT_DYN_STAT(http_pooled_server_connections_stat);
   }
   if (is_debug_tag_set("http_ss")) {
@@ -509,6 +572,7 @@ ServerSessionPool::addSession(PoolableSession *ss)
   // put it in the pools.
   m_ip_pool.insert(ss);
   m_fqdn_pool.insert(ss);
+  ++m_count;
   HTTP_INCREMENT_DYN_STAT(http_pooled_server_connections_stat);
 
   if (is_debug_tag_set("http_ss")) {
@@ -517,3 +581,21 @@ ServerSessionPool::addSession(PoolableSession *ss)
     Debug("http_ss", "[%" PRId64 "] [add session] session placed into shared pool under ip %s", ss->connection_id(), peer_ip);
   }
 }
+
+struct ShowSessionReuse : public ShowCont {
+  ShowSessionReuse(Continuation *c, HTTPHdr *h) : ShowCont(c, h) { SET_HANDLER(&ShowSessionReuse::showHandler); }
+  int
+  showHandler(int event, Event *e)
+  {
+    CHECK_SHOW(show(OriginReuseTrack::to_json_string().c_str()));
+    return completeJson(event, e);
+  }
+};
+
+Action *
+register_ShowSessionReuse(Continuation *c, HTTPHdr *h)
+{
+  ShowSessionReuse *s = new ShowSessionReuse(c, h);
+  this_ethread()->schedule_imm(s);
+  return &s->action;
+}
@@ -32,12 +32,15 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "P_EventSystem.h"
 #include "PoolableSession.h"
 #include "tscore/IntrusiveHashMap.h"
 
 class ProxyTransaction;
 class HttpSM;
+class HTTPHdr;
 
 void initialize_thread_for_http_sessions(EThread *thread, int thread_index);
 
@@ -67,10 +70,11 @@ public:
   static bool validate_host_sni(HttpSM *sm, NetVConnection *netvc);
   static bool validate_sni(HttpSM *sm, NetVConnection *netvc);
   static bool validate_cert(HttpSM *sm, NetVConnection *netvc);
+  /// Number of pooled sessions, safe to read without holding the pool lock.
   int
   count() const
   {
-    return m_ip_pool.count();
+    return m_count;
   }
 
 private:
@@ -106,6 +110,9 @@ public:
   // Note that each server session is stored in both pools.
   IPTable m_ip_pool;
   FQDNTable m_fqdn_pool;
+
+private:
+  std::atomic<int> m_count{0};
 };
 
 class HttpSessionManager
@@ -135,7 +142,13 @@ private:
   ServerSessionPool *m_g_pool = nullptr;
   HSMresult_t _acquire_session(sockaddr const *ip, CryptoHash const &hostname_hash, HttpSM *sm,
                                TSServerSessionSharingMatchMask match_style, TSServerSessionSharingPoolType pool_type);
+  HSMresult_t _acquire_pool_session(ServerSessionPool *pool, sockaddr const *ip, CryptoHash const &hostname_hash, HttpSM *sm,
+                                    TSServerSessionSharingMatchMask match_style);
+  HSMresult_t _acquire_peer_session(sockaddr const *ip, CryptoHash const &hostname_hash, HttpSM *sm,
+                                    TSServerSessionSharingMatchMask match_style);
   TSServerSessionSharingPoolType m_pool_type = TS_SERVER_SESSION_SHARING_POOL_THREAD;
 };
 
 extern HttpSessionManager httpSessionManager;
+
+Action *register_ShowSessionReuse(Continuation *, HTTPHdr *);
@@ -2520,6 +2520,14 @@ HttpTransact::issue_revalidate(State *s)
     return;
   }
 
+  // a partial object is replaced by the whole response, never revalidated.
+  if (is_cache_object_partial(s, s->cache_info.object_read)) {
+    TxnDebug("http_trans", "[issue_revalidate] cached object is partial, not conditionalizing");
+    s->hdr_info.server_request.field_delete(MIME_FIELD_IF_MODIFIED_SINCE, MIME_LEN_IF_MODIFIED_SINCE);
+    s->hdr_info.server_request.field_delete(MIME_FIELD_IF_NONE_MATCH, MIME_LEN_IF_NONE_MATCH);
+    return;
+  }
+
   // if the document is cached, just send a conditional request to the server
 
   // So the request does not have preconditions. It can, however
@@ -2894,6 +2902,16 @@ HttpTransact::HandleCacheOpenReadHit(State *s)
   // if the origin server still has to be looked up.
   bool response_returnable = is_cache_response_returnable(s);
 
+  // a partial object can only serve a Range: request for the part of it that
+  // is stored, anything else fetches the whole response again to replace it.
+  if (response_returnable && is_cache_object_partial(s, obj) &&
+      !(s->method == HTTP_WKSIDX_GET && s->hdr_info.client_request.presence(MIME_PRESENCE_RANGE))) {
+    TxnDebug("http_trans", "[HandleCacheOpenReadHit] cached object is partial, %" PRId64 " of %" PRId64 " bytes",
+             obj->object_size_get(), obj->response_get()->get_content_length());
+    SET_VIA_STRING(VIA_DETAIL_CACHE_LOOKUP, VIA_DETAIL_MISS_NOT_CACHED);
+    response_returnable = false;
+  }
+
   // do we need to revalidate. in other words if the response
   // has to be authorized, is stale or can not be returned, do
   // a revalidate.
@@ -3149,6 +3167,19 @@ HttpTransact::build_response_from_cache(State *s, HTTPWarningCode warning_code)
         }
       }
 
+      // a partial object can only serve a Range: response from its stored prefix,
+      // e.g. not if If-Range: failed or the Range: header was ignored.
+      if (s->range_setup == RANGE_NONE && is_cache_object_partial(s, s->cache_info.object_read)) {
+        TxnDebug("http_seq", "[HttpTransact::HandleCacheOpenReadHit] Partial object without a Range response - tunneling");
+        s->cache_info.action = CACHE_DO_NO_ACTION;
+        if (s->force_dns) {
+          HandleCacheOpenReadMiss(s);
+        } else {
+          CallOSDNSLookup(s);
+        }
+        return;
+      }
+
       if (s->state_machine->do_transform_open()) {
         set_header_for_transform(s, cached_response);
         to_warn = &s->hdr_info.transform_response;
@@ -3625,6 +3656,31 @@ HttpTransact::HandleStatPage(State *s)
   s->next_action       = SM_ACTION_INTERNAL_CACHE_NOOP;
 }
 
+// Report the end of the current next hop attempt to a latency tracking
+// strategy. The sample is the time to the response header, or the time
+// spent on a failed connection, no sample is taken if the attempt was
+// abandoned before either happened.
+void
+HttpTransact::next_hop_attempt_complete(State *s)
+{
+  HostRecord *host = s->parent_result.latency_host;
+  if (host == nullptr) {
+    return;
+  }
+  s->parent_result.latency_host = nullptr;
+
+  TransactionMilestones &milestones = s->state_machine->milestones;
+  ink_hrtime latency                = 0;
+  if (milestones[TS_MILESTONE_SERVER_BEGIN_WRITE] != 0 &&
+      milestones[TS_MILESTONE_SERVER_READ_HEADER_DONE] > milestones[TS_MILESTONE_SERVER_BEGIN_WRITE]) {
+    latency = milestones.elapsed(TS_MILESTONE_SERVER_BEGIN_WRITE, TS_MILESTONE_SERVER_READ_HEADER_DONE);
+  } else if (s->current.state != STATE_UNDEFINED && s->current.state != CONNECTION_ALIVE && s->current.state != PARENT_RETRY &&
+             milestones[TS_MILESTONE_SERVER_CONNECT] != 0) {
+    latency = Thread::get_hrtime() - milestones[TS_MILESTONE_SERVER_CONNECT];
+  }
+  host->attemptComplete(latency);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Name       : handle_response_from_parent
 // Description: response came from a parent proxy
@@ -3650,6 +3706,8 @@ HttpTransact::handle_response_from_parent(State *s)
   TxnDebug("http_trans", "[handle_response_from_parent] (hrfp)");
   HTTP_RELEASE_ASSERT(s->current.server == &s->parent_info);
 
+  next_hop_attempt_complete(s);
+
   // if this parent was retried from a markdown, then
   // notify that the retry has completed.
   if (s->parent_result.retry) {
@@ -6077,6 +6135,45 @@ HttpTransact::is_stale_cache_response_returnable(State *s)
   return true;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Name       : is_cache_object_partial()
+// Description: check if a cached response holds only a prefix of its body
+//
+// Input      : State, cached object
+// Output     : true or false
+//
+// Details    :
+//
+// With proxy.config.http.cache.range.partial set, a 200 response that could
+// not be read to the end is kept if enough of it was written to the cache.
+// The cached Content-Length is the length of the whole body and the object
+// size is the length of the prefix that was stored.
+///////////////////////////////////////////////////////////////////////////////
+bool
+HttpTransact::is_cache_object_partial(State *s, CacheHTTPInfo *obj)
+{
+  if (s->http_config_param->cache_range_partial <= 0 || obj == nullptr || !obj->valid()) {
+    return false;
+  }
+
+  HTTPHdr *resp  = obj->response_get();
+  int64_t size   = obj->object_size_get();
+  int64_t length = resp->get_content_length();
+
+  // INT64_MAX is a read while write in progress.
+  return resp->status_get() == HTTP_STATUS_OK && size != INT64_MAX && length > 0 && size < length;
+}
+
+// the length of the whole body of a cached object, even if only a prefix of it is stored.
+int64_t
+HttpTransact::cache_object_length(State *s, CacheHTTPInfo *obj)
+{
+  if (is_cache_object_partial(s, obj)) {
+    return obj->response_get()->get_content_length();
+  }
+  return obj->object_size_get();
+}
+
 bool
 HttpTransact::url_looks_dynamic(URL *url)
 {
@@ -9014,7 +9111,7 @@ HttpTransact::change_response_header_because_of_range_request(State *s, HTTPHdr
       header->field_delete(MIME_FIELD_CONTENT_RANGE, MIME_LEN_CONTENT_RANGE);
       field = header->field_create(MIME_FIELD_CONTENT_RANGE, MIME_LEN_CONTENT_RANGE);
       snprintf(numbers, sizeof(numbers), "bytes %" PRId64 "-%" PRId64 "/%" PRId64, s->ranges[0]._start, s->ranges[0]._end,
-               s->cache_info.object_read->object_size_get());
+               cache_object_length(s, s->cache_info.object_read));
       field->value_set(header->m_heap, header->m_mime, numbers, strlen(numbers));
       header->field_attach(field);
     }
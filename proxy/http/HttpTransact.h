@@ -972,6 +972,7 @@ public:
   static void handle_transform_cache_write(State *s);
   static void handle_response_from_parent(State *s);
   static void handle_response_from_parent_plugin(State *s);
+  static void next_hop_attempt_complete(State *s);
   static void handle_response_from_server(State *s);
   static void delete_server_rr_entry(State *s, int max_retries);
   static void retry_server_connection_not_open(State *s, ServerState_t conn_state, unsigned max_retries);
@@ -1023,6 +1024,8 @@ public:
   static bool is_server_negative_cached(State *s);
   static bool is_cache_response_returnable(State *s);
   static bool is_stale_cache_response_returnable(State *s);
+  static bool is_cache_object_partial(State *s, CacheHTTPInfo *obj);
+  static int64_t cache_object_length(State *s, CacheHTTPInfo *obj);
   static bool need_to_revalidate(State *s);
   static bool url_looks_dynamic(URL *url);
   static bool is_request_cache_lookupable(State *s);
@@ -0,0 +1,111 @@
+/** @file
+
+  Per origin counts of server session reuse
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "OriginReuseTrack.h"
+#include "tscore/BufferWriter.h"
+#include "tscore/bwf_std_format.h"
+
+std::mutex OriginReuseTrack::_tables_mutex;
+std::vector<OriginReuseTrack::Table *> OriginReuseTrack::_tables;
+
+OriginReuseTrack::Table &
+OriginReuseTrack::_thread_table()
+{
+  static thread_local Table *table = nullptr;
+
+  if (table == nullptr) {
+    table = new Table;
+    std::lock_guard<std::mutex> lock(_tables_mutex);
+    _tables.push_back(table);
+  }
+  return *table;
+}
+
+OriginReuseTrack::Origin *
+OriginReuseTrack::obtain(std::string_view fqdn, CryptoHash const &hostname_hash, in_port_t port)
+{
+  Key key{hostname_hash, port};
+  Table &table = _thread_table();
+
+  // Only this thread changes the table, so it can be searched without the lock
+  auto spot = table.origins.find(key);
+  if (spot != table.origins.end()) {
+    return spot->second.get();
+  }
+  if (table.origins.size() >= MAX_TABLE_ITEMS) {
+    return nullptr;
+  }
+  auto origin  = std::make_unique<Origin>();
+  origin->fqdn = fqdn;
+  origin->port = port;
+
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return table.origins.emplace(key, std::move(origin)).first->second.get();
+}
+
+std::string
+OriginReuseTrack::to_json_string()
+{
+  static const ts::BWFormat item_fmt{
+    R"({}  {{"fqdn": "{}", "port": {}, "acquires": {}, "local": {}, "global": {}, "peer": {}, "reuse_ratio": {:.3}}})"};
+
+  struct Sum {
+    std::string_view fqdn;
+    in_port_t port;
+    int64_t acquires = 0;
+    int64_t local    = 0;
+    int64_t global   = 0;
+    int64_t peer     = 0;
+  };
+  std::unordered_map<Key, Sum, KeyHash> sums;
+
+  // Records are never removed, so the names they hold outlive the locks
+  std::lock_guard<std::mutex> tables_lock(_tables_mutex);
+  for (Table *table : _tables) {
+    std::lock_guard<std::mutex> lock(table->mutex);
+    for (auto const &item : table->origins) {
+      Origin const *origin = item.second.get();
+      Sum &sum             = sums[item.first];
+      sum.fqdn             = origin->fqdn;
+      sum.port             = origin->port;
+      sum.acquires += origin->acquires.load(std::memory_order_relaxed);
+      sum.local += origin->local.load(std::memory_order_relaxed);
+      sum.global += origin->global.load(std::memory_order_relaxed);
+      sum.peer += origin->peer.load(std::memory_order_relaxed);
+    }
+  }
+
+  ts::LocalBufferWriter<512> w;
+  std::string text;
+  size_t count = 0;
+
+  for (auto const &item : sums) {
+    Sum const &sum = item.second;
+    int64_t reused = sum.local + sum.global + sum.peer;
+    w.reset().print(item_fmt, count ? ",\n" : "", sum.fqdn, sum.port, sum.acquires, sum.local, sum.global, sum.peer,
+                    sum.acquires ? static_cast<double>(reused) / sum.acquires : 0.0);
+    text.append(w.data(), w.size());
+    ++count;
+  }
+  return "{\"count\": " + std::to_string(count) + ", \"list\": [\n" + text + "\n]}";
+}
@@ -0,0 +1,100 @@
+/** @file
+
+  Per origin counts of server session reuse
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <netinet/in.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "tscore/CryptoHash.h"
+
+/** Per origin counts of server session acquisition and of where it was satisfied.
+
+    Each thread counts into its own table, so recording an acquisition takes no lock and touches no
+    cache line shared with other threads. The tables are summed when they are read, by the
+    {http}/session_reuse stat page.
+*/
+class OriginReuseTrack
+{
+public:
+  struct Origin {
+    std::string fqdn;
+    in_port_t port;
+    // Only the thread owning the record counts, the atomics let readers load the counts meanwhile.
+    std::atomic<int64_t> acquires{0}; ///< Attempts to acquire a pooled session.
+    std::atomic<int64_t> local{0};    ///< Satisfied by the client's attached session or the thread pool.
+    std::atomic<int64_t> global{0};   ///< Satisfied by the global pool.
+    std::atomic<int64_t> peer{0};     ///< Satisfied by migrating a session from another thread's pool.
+  };
+
+  /// Get or create the record of the calling thread for an origin, @c nullptr if its table is full.
+  static Origin *obtain(std::string_view fqdn, CryptoHash const &hostname_hash, in_port_t port);
+
+  /// Count an event in a record returned by @c obtain on the same thread.
+  static void
+  count(std::atomic<int64_t> &counter)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  /// The counts of all threads, summed by origin.
+  static std::string to_json_string();
+
+private:
+  static constexpr size_t MAX_TABLE_ITEMS = 1024;
+
+  struct Key {
+    CryptoHash hash;
+    in_port_t port;
+    bool
+    operator==(Key const &that) const
+    {
+      return port == that.port && hash == that.hash;
+    }
+  };
+  struct KeyHash {
+    size_t
+    operator()(Key const &key) const
+    {
+      return key.hash.fold() ^ key.port;
+    }
+  };
+  struct Table {
+    /// Held by the owning thread to add records, and by readers. Counting needs no lock.
+    std::mutex mutex;
+    std::unordered_map<Key, std::unique_ptr<Origin>, KeyHash> origins;
+  };
+
+  static Table &_thread_table();
+
+  // Tables of all threads that counted so far. They are never freed, records must stay valid for readers after a thread exits.
+  static std::mutex _tables_mutex;
+  static std::vector<Table *> _tables;
+};
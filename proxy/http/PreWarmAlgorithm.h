@@ -4,6 +4,7 @@
 
   v1: periodical pre-warming only
   v2: periodical pre-warming + event based pre-warming
+  v3: forecast based periodical pre-warming + event based pre-warming
 
   @section license License
 
@@ -29,6 +30,7 @@
 #include "tscore/ink_assert.h"
 #include "tscore/ink_error.h"
 
+#include <cmath>
 #include <cstdint>
 #include <algorithm>
 
@@ -37,12 +39,15 @@ namespace PreWarm
 enum class Algorithm {
   V1 = 1,
   V2,
+  V3,
 };
 
 inline PreWarm::Algorithm
 algorithm_version(int i)
 {
   switch (i) {
+  case 3:
+    return PreWarm::Algorithm::V3;
   case 2:
     return PreWarm::Algorithm::V2;
   case 1:
@@ -119,4 +124,69 @@ prewarm_size_v2_on_event_interval(uint32_t hit, uint32_t miss, uint32_t current_
   return n;
 }
 
+/**
+   Demand forecast for algorithm v3
+
+   Exponentially weighted moving average of the connections requested in a period (@hit + @miss). The weight of a new
+   period is set so that the average roughly follows the last @windows periods.
+
+   @return forecasted connections requested in the next period
+ */
+inline double
+prewarm_forecast_v3(double forecast, uint32_t hit, uint32_t miss, uint32_t windows)
+{
+  const double alpha = 2.0 / (std::max(windows, 1U) + 1);
+
+  return forecast + alpha * (static_cast<double>(hit) + miss - forecast);
+}
+
+/**
+   Pool size target for algorithm v3
+
+   The forecasted demand scaled by @rate. A demand that has decayed below a tenth of a connection per period is treated
+   as no demand, otherwise a destination that was used once would keep a connection forever.
+
+   @params min : min connections (configured)
+   @params max : max connections (configured), -1 : unlimited
+
+   @return how many connections the pool should have
+ */
+inline uint32_t
+prewarm_target_v3(double forecast, uint32_t min, int32_t max, double rate)
+{
+  const double demand = forecast * rate;
+  uint32_t n          = (demand < 0.1) ? 0 : static_cast<uint32_t>(std::ceil(demand));
+
+  n = std::max(n, min);
+
+  if (max >= 0) {
+    n = std::min(n, static_cast<uint32_t>(max));
+  }
+
+  return n;
+}
+
+/**
+   Periodical pre-warming for algorithm v3
+
+   Expand the pool size to the forecasted demand of the next period. The event based pre-warming replaces the
+   connections taken while the pool is below the target.
+
+   @params min : min connections (configured)
+   @params max : max connections (configured), -1 : unlimited
+
+   @return how many connections needs to be pre-warmed for next period
+ */
+inline uint32_t
+prewarm_size_v3_on_event_interval(double forecast, uint32_t current_size, uint32_t min, int32_t max, double rate)
+{
+  const uint32_t n = prewarm_target_v3(forecast, min, max, rate);
+
+  if (current_size >= n) {
+    return 0;
+  }
+
+  return n - current_size;
+}
+
 } // namespace PreWarm
@@ -36,6 +36,7 @@ PreWarmConfigParams::PreWarmConfigParams()
   // RECU_DYNAMIC
   REC_ReadConfigInteger(event_period, "proxy.config.tunnel.prewarm.event_period");
   REC_ReadConfigInteger(algorithm, "proxy.config.tunnel.prewarm.algorithm");
+  REC_ReadConfigInteger(forecast_windows, "proxy.config.tunnel.prewarm.forecast_windows");
 }
 
 ////
@@ -49,6 +50,7 @@ PreWarmConfig::startup()
   // dynamic configs
   _config_update_handler->attach("proxy.config.tunnel.prewarm.event_period");
   _config_update_handler->attach("proxy.config.tunnel.prewarm.algorithm");
+  _config_update_handler->attach("proxy.config.tunnel.prewarm.forecast_windows");
 
   reconfigure();
 }
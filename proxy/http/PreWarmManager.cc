@@ -825,14 +825,23 @@ PreWarmQueue::_delete_prewarm_sm(PreWarmSM *sm)
 
    V1: Expand the pool size to requested size
    V2: Expand the pool size to current size + miss * rate
+   V3: Expand the pool size to the forecasted demand * rate
  */
 void
-PreWarmQueue::_prewarm_on_event_interval(const PreWarm::SPtrConstDst &dst, const Info &info)
+PreWarmQueue::_prewarm_on_event_interval(const PreWarm::SPtrConstDst &dst, Info &info)
 {
   const uint32_t current_size = info.init_list->size() + info.open_list->size();
   uint32_t n                  = 0;
 
   switch (_algorithm) {
+  case PreWarm::Algorithm::V3: {
+    info.stat.forecast = PreWarm::prewarm_forecast_v3(info.stat.forecast, info.stat.hit, info.stat.miss, _forecast_windows);
+    Debug("v_prewarm_q", "forecast=%.3f", info.stat.forecast);
+
+    n = PreWarm::prewarm_size_v3_on_event_interval(info.stat.forecast, current_size, info.conf->min, info.conf->max,
+                                                   info.conf->rate);
+    break;
+  }
   case PreWarm::Algorithm::V2: {
     n = PreWarm::prewarm_size_v2_on_event_interval(info.stat.hit, info.stat.miss, current_size, info.conf->min, info.conf->max,
                                                    info.conf->rate);
@@ -857,6 +866,7 @@ PreWarmQueue::_prewarm_on_event_interval(const PreWarm::SPtrConstDst &dst, const
 
    V1: Do nothing
    V2: Start pre-warming a new netvc
+   V3: Start pre-warming a new netvc if the pool is below the forecasted demand
  */
 void
 PreWarmQueue::_prewarm_on_dequeue(const PreWarm::SPtrConstDst &dst, const Info &info)
@@ -869,6 +879,13 @@ PreWarmQueue::_prewarm_on_dequeue(const PreWarm::SPtrConstDst &dst, const Info &
     }
     break;
   }
+  case PreWarm::Algorithm::V3: {
+    const uint32_t current_size = info.init_list->size() + info.open_list->size();
+    if (current_size < PreWarm::prewarm_target_v3(info.stat.forecast, info.conf->min, info.conf->max, info.conf->rate)) {
+      _new_prewarm_sm(dst, info.conf, info.stats_ids);
+    }
+    break;
+  }
   case PreWarm::Algorithm::V1:
     [[fallthrough]];
   default:
@@ -886,8 +903,9 @@ PreWarmQueue::_reconfigure()
   {
     PreWarmConfig::scoped_config prewarm_conf;
 
-    _event_period = HRTIME_MSECONDS(prewarm_conf->event_period);
-    _algorithm    = PreWarm::algorithm_version(prewarm_conf->algorithm);
+    _event_period     = HRTIME_MSECONDS(prewarm_conf->event_period);
+    _algorithm        = PreWarm::algorithm_version(prewarm_conf->algorithm);
+    _forecast_windows = prewarm_conf->forecast_windows;
   }
 
   // build new map based on new SNIConfig
@@ -259,8 +259,9 @@ private:
   using Queue = std::deque<PreWarmSM *>;
 
   struct Stat {
-    uint32_t miss = 0;
-    uint32_t hit  = 0;
+    uint32_t miss   = 0;
+    uint32_t hit    = 0;
+    double forecast = 0; ///< forecasted demand per period (v3), kept across periods
   };
 
   struct Info {
@@ -283,7 +284,7 @@ private:
   void _delete_closed_sm(Queue *q);
 
   // hooks for pre-warming pool size algorithm
-  void _prewarm_on_event_interval(const PreWarm::SPtrConstDst &dst, const Info &info);
+  void _prewarm_on_event_interval(const PreWarm::SPtrConstDst &dst, Info &info);
   void _prewarm_on_dequeue(const PreWarm::SPtrConstDst &dst, const Info &info);
 
   ////
@@ -291,8 +292,9 @@ private:
   //
   PreWarm::Algorithm _algorithm = PreWarm::Algorithm::V1;
 
-  Event *_tick_event       = nullptr;
-  ink_hrtime _event_period = HRTIME_SECONDS(1);
+  Event *_tick_event         = nullptr;
+  ink_hrtime _event_period   = HRTIME_SECONDS(1);
+  uint32_t _forecast_windows = 60;
 
   // Force PreWarmSM to open new netvc to keep the connection warm periodically
   ActivityCop<PreWarmSM> _cop;
@@ -89,6 +89,14 @@ NextHopConsistentHash::Init(ts::Yaml::Map &n)
                 strategy_name.c_str(), hash_key_path.data());
       }
     }
+    if (n["hash_load_bound"]) {
+      hash_load_bound = n["hash_load_bound"].as<float>();
+      if (hash_load_bound != 0 && hash_load_bound < 1) {
+        NH_Note("Invalid 'hash_load_bound' value, '%f', for the strategy named '%s', it must be 0 or at least 1, using 1.",
+                hash_load_bound, strategy_name.c_str());
+        hash_load_bound = 1;
+      }
+    }
   } catch (std::exception &ex) {
     NH_Note("Error parsing the strategy named '%s' due to '%s', this strategy will be ignored.", strategy_name.c_str(), ex.what());
     return false;
@@ -118,6 +126,7 @@ NextHopConsistentHash::Init(ts::Yaml::Map &n)
                p->hostname.c_str(), strategy_name.c_str());
     }
     hash.clear();
+    hash_ring->set_load_bound(hash_load_bound);
     rings.push_back(std::move(hash_ring));
   }
   return true;
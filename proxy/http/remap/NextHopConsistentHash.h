@@ -44,6 +44,7 @@ class NextHopConsistentHash : public NextHopSelectionStrategy
 
 public:
   NHHashKeyType hash_key = NH_PATH_HASH_KEY;
+  float hash_load_bound  = 0; // bounded loads factor, 0 if the load is not bounded
 
   NextHopConsistentHash() = delete;
   NextHopConsistentHash(const std::string_view name, const NHPolicyType &policy) : NextHopSelectionStrategy(name, policy) {}
@@ -0,0 +1,265 @@
+/** @file
+
+  Implementation of the latency aware nexthop selection strategy.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <mutex>
+#include <unordered_map>
+#include <yaml-cpp/yaml.h>
+
+#include "tscore/Random.h"
+#include "HttpSM.h"
+#include "NextHopLeastLatency.h"
+
+namespace
+{
+// weight of a new sample in the latency EWMA, 1/2^NH_EWMA_SHIFT.
+constexpr int NH_EWMA_SHIFT = 3;
+// the EWMA of a host that has not been sampled for this long is halved for
+// every period, so that a host that was once slow is eventually tried again.
+constexpr ink_hrtime NH_LATENCY_DECAY = HRTIME_SECONDS(10);
+
+// per host stats, the stats are registered by name so that they outlive
+// strategy reloads.
+enum { nh_ewma_latency_stat = 0, nh_in_flight_stat, nh_score_stat, nh_stats_per_host };
+constexpr int NH_LATENCY_MAX_STATS = 1024 * nh_stats_per_host;
+
+std::mutex stats_mutex;
+RecRawStatBlock *nh_latency_rsb = nullptr;
+std::unordered_map<std::string, int> nh_stat_ids;
+int nh_stat_next = 0;
+
+int
+register_host_stats(const std::string &strategy, const std::string &hostname)
+{
+#ifndef _NH_UNIT_TESTS_
+  std::string prefix = "proxy.process.http.next_hop." + strategy + "." + hostname;
+  std::lock_guard<std::mutex> lock(stats_mutex);
+
+  auto iter = nh_stat_ids.find(prefix);
+  if (iter != nh_stat_ids.end()) {
+    return iter->second;
+  }
+  if (nh_latency_rsb == nullptr) {
+    nh_latency_rsb = RecAllocateRawStatBlock(NH_LATENCY_MAX_STATS);
+  }
+  if (nh_latency_rsb == nullptr || nh_stat_next + nh_stats_per_host > NH_LATENCY_MAX_STATS) {
+    NH_Warn("next hop latency stats are exhausted, no stats for %s in the strategy named '%s'", hostname.c_str(),
+            strategy.c_str());
+    return -1;
+  }
+
+  int id = nh_stat_next;
+  RecRegisterRawStat(nh_latency_rsb, RECT_PROCESS, (prefix + ".ewma_latency").c_str(), RECD_INT, RECP_NON_PERSISTENT,
+                     id + nh_ewma_latency_stat, RecRawStatSyncSum);
+  RecRegisterRawStat(nh_latency_rsb, RECT_PROCESS, (prefix + ".in_flight").c_str(), RECD_INT, RECP_NON_PERSISTENT,
+                     id + nh_in_flight_stat, RecRawStatSyncSum);
+  RecRegisterRawStat(nh_latency_rsb, RECT_PROCESS, (prefix + ".score").c_str(), RECD_INT, RECP_NON_PERSISTENT, id + nh_score_stat,
+                     RecRawStatSyncSum);
+  nh_stat_next += nh_stats_per_host;
+  nh_stat_ids.emplace(prefix, id);
+  return id;
+#else
+  return -1;
+#endif
+}
+
+void
+publish_host_stats(const HostRecord *host)
+{
+#ifndef _NH_UNIT_TESTS_
+  if (host->stat_id >= 0) {
+    RecSetGlobalRawStatSum(nh_latency_rsb, host->stat_id + nh_ewma_latency_stat, host->ewma_latency.load());
+    RecSetGlobalRawStatSum(nh_latency_rsb, host->stat_id + nh_in_flight_stat, host->in_flight.load());
+    RecSetGlobalRawStatSum(nh_latency_rsb, host->stat_id + nh_score_stat, host->latencyScore(ink_get_hrtime_internal()));
+  }
+#endif
+}
+} // namespace
+
+void
+HostRecord::attemptStarted()
+{
+  in_flight++;
+  publish_host_stats(this);
+}
+
+// latency is 0 if the attempt ended without a sample.
+void
+HostRecord::attemptComplete(ink_hrtime latency)
+{
+  in_flight--;
+  if (latency > 0) {
+    int64_t sample = ink_hrtime_to_usec(latency);
+    int64_t old    = ewma_latency.load();
+    int64_t ewma;
+    do {
+      ewma = (old == 0) ? sample : old + ((sample - old) >> NH_EWMA_SHIFT);
+    } while (!ewma_latency.compare_exchange_weak(old, ewma));
+    latency_updated = ink_get_hrtime_internal();
+  }
+  publish_host_stats(this);
+}
+
+// lower is better, an unsampled host scores lowest so that it gets sampled.
+int64_t
+HostRecord::latencyScore(ink_hrtime now) const
+{
+  int64_t ewma    = ewma_latency.load();
+  ink_hrtime idle = now - latency_updated.load();
+  if (idle > NH_LATENCY_DECAY) {
+    ewma >>= std::min<ink_hrtime>(idle / NH_LATENCY_DECAY, 63);
+  }
+  return (ewma + 1) * (std::max(in_flight.load(), 0) + 1);
+}
+
+NextHopLeastLatency::~NextHopLeastLatency()
+{
+  NH_Debug(NH_DEBUG_TAG, "destructor called for strategy named: %s", strategy_name.c_str());
+}
+
+bool
+NextHopLeastLatency::Init(ts::Yaml::Map &n)
+{
+  if (!NextHopSelectionStrategy::Init(n)) {
+    return false;
+  }
+  for (auto &hosts : host_groups) {
+    for (auto &host : hosts) {
+      host->stat_id = register_host_stats(strategy_name, host->hostname);
+    }
+  }
+  return true;
+}
+
+bool
+NextHopLeastLatency::isAvailable(HostRecord *host, int64_t fail_threshold) const
+{
+  HostStatRec *hst       = HostStatus::instance().getHostStatus(host->hostname.c_str());
+  TSHostStatus host_stat = (hst) ? hst->status : TSHostStatus::TS_HOST_STATUS_UP;
+  if (ignore_self_detect && hst && hst->status == TS_HOST_STATUS_DOWN && hst->reasons == Reason::SELF_DETECT) {
+    host_stat = TS_HOST_STATUS_UP;
+  }
+  return host_stat == TS_HOST_STATUS_UP && host->available.load() &&
+         (host->failedAt == 0 || host->failCount.load() < fail_threshold);
+}
+
+bool
+NextHopLeastLatency::isRetryable(HostRecord *host, time_t now, int64_t retry_time)
+{
+  HostStatRec *hst       = HostStatus::instance().getHostStatus(host->hostname.c_str());
+  TSHostStatus host_stat = (hst) ? hst->status : TSHostStatus::TS_HOST_STATUS_UP;
+  return host_stat == TS_HOST_STATUS_UP && (host->failedAt + retry_time) < static_cast<unsigned>(now) &&
+         host->retriers.inc(max_retriers);
+}
+
+void
+NextHopLeastLatency::findNextHop(TSHttpTxn txnp, void *ih, time_t now)
+{
+  HttpSM *sm             = reinterpret_cast<HttpSM *>(txnp);
+  ParentResult *result   = &sm->t_state.parent_result;
+  int64_t sm_id          = sm->sm_id;
+  int64_t fail_threshold = sm->t_state.txn_conf->parent_fail_threshold;
+  int64_t retry_time     = sm->t_state.txn_conf->parent_retry_time;
+  time_t _now            = (now == 0) ? time(nullptr) : now;
+  ink_hrtime hrnow       = ink_get_hrtime_internal();
+  HostRecord *exclude    = nullptr;
+  uint32_t start_group   = 0;
+  std::vector<HostRecord *> candidates;
+
+  // HttpTransact normally reports the previous attempt before asking for another next hop.
+  if (result->latency_host != nullptr) {
+    result->latency_host->attemptComplete(0);
+    result->latency_host = nullptr;
+  }
+
+  if (result->line_number != -1 && result->result != PARENT_UNDEFINED) {
+    // stay away from the next hop that was just tried.
+    start_group = result->last_group;
+    exclude     = host_groups[result->last_group][result->last_parent].get();
+    NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] next call, excluding %s, start_group: %d", sm_id, exclude->hostname.c_str(),
+             start_group);
+  } else {
+    // distance is the index into the strategies map, this is the equivalent to the old line_number in parent.config.
+    result->line_number = distance;
+  }
+
+  for (uint32_t grp = start_group; grp < groups; grp++) {
+    HostRecord *chosen = nullptr;
+    bool retry         = false;
+
+    candidates.clear();
+    for (auto &host : host_groups[grp]) {
+      if (host.get() != exclude && isAvailable(host.get(), fail_threshold)) {
+        candidates.push_back(host.get());
+      }
+    }
+
+    if (candidates.size() == 1) {
+      chosen = candidates[0];
+    } else if (candidates.size() > 1) {
+      // power of two choices, two distinct random hosts.
+      uint64_t r      = ts::Random::random();
+      size_t n        = candidates.size();
+      size_t a        = (r & 0xffffffff) % n;
+      size_t b        = (a + 1 + (r >> 32) % (n - 1)) % n;
+      int64_t a_score = candidates[a]->latencyScore(hrnow);
+      int64_t b_score = candidates[b]->latencyScore(hrnow);
+      chosen          = (a_score <= b_score) ? candidates[a] : candidates[b];
+      NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] %s scores %" PRId64 ", %s scores %" PRId64, sm_id, candidates[a]->hostname.c_str(),
+               a_score, candidates[b]->hostname.c_str(), b_score);
+    } else {
+      // nothing is up in this group, retry a host that was marked down if its retry time has passed.
+      for (auto &host : host_groups[grp]) {
+        if (host.get() != exclude && isRetryable(host.get(), _now, retry_time)) {
+          chosen = host.get();
+          retry  = true;
+          NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] NextHop marked for retry %s:%d, max_retriers: %d, retriers: %d", sm_id,
+                   chosen->hostname.c_str(), chosen->getPort(scheme), max_retriers, chosen->retriers());
+          break;
+        }
+      }
+    }
+
+    if (chosen != nullptr) {
+      result->result      = PARENT_SPECIFIED;
+      result->hostname    = chosen->hostname.c_str();
+      result->port        = chosen->getPort(scheme);
+      result->last_parent = chosen->host_index;
+      result->last_group  = grp;
+      result->retry       = retry;
+      ink_assert(result->hostname != nullptr);
+      ink_assert(result->port != 0);
+      chosen->attemptStarted();
+      result->latency_host = chosen;
+      NH_Debug(NH_DEBUG_TAG, "[%" PRIu64 "] Chosen parent = %s.%d", sm_id, result->hostname, result->port);
+      return;
+    }
+  }
+
+  if (go_direct == true) {
+    result->result = PARENT_DIRECT;
+  } else {
+    result->result = PARENT_FAIL;
+  }
+  result->hostname = nullptr;
+  result->port     = 0;
+}
@@ -0,0 +1,43 @@
+/** @file
+
+  Implementation of the latency aware nexthop selection strategy.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+#include "NextHopSelectionStrategy.h"
+
+// Picks two random available hosts from the first host group that has any and
+// uses the one with the lower score, the EWMA of its response latency
+// multiplied by its in flight requests. Groups are used in order for failover.
+class NextHopLeastLatency : public NextHopSelectionStrategy
+{
+  bool isAvailable(HostRecord *host, int64_t fail_threshold) const;
+  bool isRetryable(HostRecord *host, time_t now, int64_t retry_time);
+
+public:
+  NextHopLeastLatency() = delete;
+  NextHopLeastLatency(const std::string_view &name, const NHPolicyType &policy) : NextHopSelectionStrategy(name, policy) {}
+  ~NextHopLeastLatency();
+  bool Init(ts::Yaml::Map &n);
+  void findNextHop(TSHttpTxn txnp, void *ih = nullptr, time_t now = 0) override;
+};
@@ -38,8 +38,8 @@ constexpr std::string_view peering_rings   = "peering_ring";
 constexpr std::string_view active_health_check  = "active";
 constexpr std::string_view passive_health_check = "passive";
 
-constexpr const char *policy_strings[] = {"NH_UNDEFINED", "NH_FIRST_LIVE", "NH_RR_STRICT",
-                                          "NH_RR_IP",     "NH_RR_LATCHED", "NH_CONSISTENT_HASH"};
+constexpr const char *policy_strings[] = {"NH_UNDEFINED",  "NH_FIRST_LIVE",      "NH_RR_STRICT",    "NH_RR_IP",
+                                          "NH_RR_LATCHED", "NH_CONSISTENT_HASH", "NH_LEAST_LATENCY"};
 
 NextHopSelectionStrategy::NextHopSelectionStrategy(const std::string_view &name, const NHPolicyType &policy)
 {
@@ -62,8 +62,9 @@ enum NHPolicyType {
   NH_FIRST_LIVE,     // first available nexthop
   NH_RR_STRICT,      // strict round robin
   NH_RR_IP,          // round robin by client ip.
-  NH_RR_LATCHED,     // latched to available next hop.
-  NH_CONSISTENT_HASH // consistent hashing strategy.
+  NH_RR_LATCHED,      // latched to available next hop.
+  NH_CONSISTENT_HASH, // consistent hashing strategy.
+  NH_LEAST_LATENCY    // power of two choices by ewma latency and in flight requests.
 };
 
 enum NHSchemeType { NH_SCHEME_NONE = 0, NH_SCHEME_HTTP, NH_SCHEME_HTTPS };
@@ -118,6 +119,12 @@ struct HostRecord : ATSConsistentHashNode {
   std::vector<std::shared_ptr<NHProtocol>> protocols;
   pRetriers retriers;
 
+  // latency tracking, only maintained for hosts of the least_latency policy.
+  std::atomic<int64_t> ewma_latency{0}; // microseconds, 0 until the first sample.
+  std::atomic<ink_hrtime> latency_updated{0};
+  std::atomic<int32_t> in_flight{0};
+  int stat_id = -1; // first of the per host latency stats, -1 if not published.
+
   // construct without locking the _mutex.
   HostRecord()
   {
@@ -216,6 +223,11 @@ struct HostRecord : ATSConsistentHashNode {
   {
     return makeHostPort(this->hostname, port);
   }
+
+  // latency tracking, see NextHopLeastLatency.cc
+  void attemptStarted();
+  void attemptComplete(ink_hrtime latency);
+  int64_t latencyScore(ink_hrtime now) const;
 };
 
 class NextHopHealthStatus : public NHHealthStatus
@@ -29,6 +29,7 @@
 #include "NextHopStrategyFactory.h"
 #include "NextHopConsistentHash.h"
 #include "NextHopRoundRobin.h"
+#include "NextHopLeastLatency.h"
 #include <YamlCfg.h>
 
 NextHopStrategyFactory::NextHopStrategyFactory(const char *file) : fn(file)
@@ -44,6 +45,7 @@ NextHopStrategyFactory::NextHopStrategyFactory(const char *file) : fn(file)
   constexpr std::string_view rr_strict       = "rr_strict";
   constexpr std::string_view rr_ip           = "rr_ip";
   constexpr std::string_view latched         = "latched";
+  constexpr std::string_view least_latency   = "least_latency";
 
   bool error_loading   = false;
   strategies_loaded    = true;
@@ -97,6 +99,8 @@ NextHopStrategyFactory::NextHopStrategyFactory(const char *file) : fn(file)
         policy_type = NH_RR_IP;
       } else if (policy_value == latched) {
         policy_type = NH_RR_LATCHED;
+      } else if (policy_value == least_latency) {
+        policy_type = NH_LEAST_LATENCY;
       }
       if (policy_type == NH_UNDEFINED) {
         NH_Error("Invalid policy '%s' for the strategy named '%s', this strategy will be ignored.", policy_value.c_str(),
@@ -131,6 +135,7 @@ NextHopStrategyFactory::createStrategy(const std::string &name, const NHPolicyTy
   std::shared_ptr<NextHopSelectionStrategy> strat;
   std::shared_ptr<NextHopRoundRobin> strat_rr;
   std::shared_ptr<NextHopConsistentHash> strat_chash;
+  std::shared_ptr<NextHopLeastLatency> strat_latency;
 
   strat = strategyInstance(name.c_str());
   if (strat != nullptr) {
@@ -159,6 +164,14 @@ NextHopStrategyFactory::createStrategy(const std::string &name, const NHPolicyTy
       strat_chash.reset();
     }
     break;
+  case NH_LEAST_LATENCY:
+    strat_latency = std::make_shared<NextHopLeastLatency>(name, policy_type);
+    if (strat_latency->Init(node)) {
+      _strategies.emplace(std::make_pair(std::string(name), strat_latency));
+    } else {
+      strat_latency.reset();
+    }
+    break;
   default: // handles P_UNDEFINED, no strategy is added
     break;
   };
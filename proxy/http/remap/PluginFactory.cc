@@ -35,7 +35,7 @@
 #endif
 #include "P_EventSystem.h"
 
-#include <algorithm> /* std::swap */
+#include <algorithm> /* std::swap, std::find_if, std::remove_if */
 
 RemapPluginInst::RemapPluginInst(RemapPluginInfo &plugin) : _plugin(plugin)
 {
@@ -53,6 +53,7 @@ RemapPluginInst::init(RemapPluginInfo *plugin, int argc, char **argv, std::strin
   RemapPluginInst *inst = new RemapPluginInst(*plugin);
   if (plugin->initInstance(argc, argv, &(inst->_instance), error)) {
     plugin->incInstanceCount();
+    inst->_args = argsKey(argc, argv);
     return inst;
   }
   delete inst;
@@ -70,6 +71,16 @@ RemapPluginInst::done()
   }
 }
 
+std::string
+RemapPluginInst::argsKey(int argc, char **argv)
+{
+  std::string key;
+  for (int i = 0; i < argc; ++i) {
+    key.append(argv[i]).push_back('\0');
+  }
+  return key;
+}
+
 TSRemapStatus
 RemapPluginInst::doRemap(TSHttpTxn rh, TSRemapRequestInfo *rri)
 {
@@ -99,7 +110,12 @@ PluginFactory::PluginFactory()
 
 PluginFactory::~PluginFactory()
 {
-  _instList.apply([](RemapPluginInst *pluginInst) -> void { delete pluginInst; });
+  for (auto inst : _instList) {
+    /* After deactivate() only the instances no other factory uses are left */
+    if (_deactivated || 1 == inst->_factoryCount.fetch_sub(1)) {
+      delete inst;
+    }
+  }
   _instList.clear();
 
   fs::remove(_runtimeDir, _ec);
@@ -124,6 +140,35 @@ PluginFactory::setRuntimeDir(const fs::path &runtimeDir)
   return *this;
 }
 
+/**
+ * @brief Allow instances created by @a previous to be reused by this factory.
+ *
+ * An instance is reused instead of initializing a new one if it was created from the same plugin DSO with the same parameters,
+ * i.e. for an unchanged remap rule, so a config reload does not call the plugin new / delete instance callbacks for it. Passing
+ * @c nullptr ends the reuse, @a previous must stay alive until then.
+ *
+ * @param previous factory of the configuration being replaced
+ */
+PluginFactory &
+PluginFactory::reuseInstancesFrom(PluginFactory *previous)
+{
+  _reusable.clear();
+  if (nullptr != previous) {
+    _reusable.reserve(previous->_instList.size());
+    for (auto inst : previous->_instList) {
+      _reusable.emplace(inst->_args, inst);
+    }
+    PluginDebug(_tag, "factory %s can reuse %zu instances of factory %s", getUuid(), _reusable.size(), previous->getUuid());
+  }
+  return *this;
+}
+
+int
+PluginFactory::reusedInstanceCount() const
+{
+  return _reusedCount;
+}
+
 const char *
 PluginFactory::getUuid()
 {
@@ -195,7 +240,7 @@ PluginFactory::getRemapPlugin(const fs::path &configPath, int argc, char **argv,
           inst = RemapPluginInst::init(plugin, argc, argv, error);
           if (nullptr != inst) {
             /* Plugin loading and instance init went fine. */
-            _instList.append(inst);
+            _instList.push_back(inst);
           }
         } else {
           /* Plugin DSO load succeeded but instance init failed. */
@@ -215,9 +260,21 @@ PluginFactory::getRemapPlugin(const fs::path &configPath, int argc, char **argv,
     }
   } else {
     PluginDebug(_tag, "plugin '%s' has already been loaded", configPath.c_str());
-    inst = RemapPluginInst::init(plugin, argc, argv, error);
+
+    /* The DSO did not change, an instance of the previous factory with the same parameters can be used as is */
+    auto range = _reusable.equal_range(RemapPluginInst::argsKey(argc, argv));
+    auto spot  = std::find_if(range.first, range.second, [plugin](auto const &item) { return &item.second->_plugin == plugin; });
+    if (spot != range.second) {
+      inst = spot->second;
+      _reusable.erase(spot);
+      inst->_factoryCount++;
+      _reusedCount++;
+      PluginDebug(_tag, "reusing instance of plugin '%s'", configPath.c_str());
+    } else {
+      inst = RemapPluginInst::init(plugin, argc, argv, error);
+    }
     if (nullptr != inst) {
-      _instList.append(inst);
+      _instList.push_back(inst);
     }
   }
 
@@ -278,7 +335,15 @@ PluginFactory::deactivate()
 {
   PluginDebug(_tag, "deactivate configuration used by factory '%s'", getUuid());
 
-  _instList.apply([](RemapPluginInst &pluginInst) -> void { pluginInst.done(); });
+  /* Instances still used by another factory are left to it */
+  auto last = std::remove_if(_instList.begin(), _instList.end(),
+                             [](RemapPluginInst *inst) -> bool { return 1 != inst->_factoryCount.fetch_sub(1); });
+  _instList.erase(last, _instList.end());
+  _deactivated = true;
+
+  for (auto inst : _instList) {
+    inst->done();
+  }
 }
 
 /**
@@ -298,8 +363,8 @@ PluginFactory::indicatePostReload(bool reloadSuccessful)
 {
   /* Find out which plugins (DSO) are actually instantiated by this factory */
   std::unordered_map<PluginDso *, int> pluginUsed;
-  for (auto &inst : _instList) {
-    pluginUsed[&(inst._plugin)]++;
+  for (auto inst : _instList) {
+    pluginUsed[&(inst->_plugin)]++;
   }
 
   PluginDso::loadedPlugins()->indicatePostReload(reloadSuccessful, pluginUsed, getUuid());
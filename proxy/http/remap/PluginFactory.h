@@ -23,15 +23,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "tscore/Ptr.h"
 #include "PluginDso.h"
 #include "RemapPluginInfo.h"
 
-#include "tscore/Ptr.h"
-#include "tscpp/util/IntrusiveDList.h"
-
 #include "tscore/ink_uuid.h"
 #include "ts/apidefs.h"
 
@@ -54,15 +54,18 @@ public:
   TSRemapStatus doRemap(TSHttpTxn rh, TSRemapRequestInfo *rri);
   void osResponse(TSHttpTxn rh, int os_response_type);
 
-  /* List used by the plugin factory */
-  using self_type  = RemapPluginInst; ///< Self reference type.
-  self_type *_next = nullptr;
-  self_type *_prev = nullptr;
-  using Linkage    = ts::IntrusiveLinkage<self_type>;
+  /* Key identifying the parameters the instance was initialized with */
+  static std::string argsKey(int argc, char **argv);
 
   /* Plugin instance = the plugin info + the data returned by the init callback */
   RemapPluginInfo &_plugin;
   void *_instance = nullptr;
+
+  /* Parameters the instance was initialized with, see argsKey() */
+  std::string _args;
+
+  /* Number of factories using this instance, more than 1 only if it was reused by a later factory */
+  std::atomic<int> _factoryCount{1};
 };
 
 /**
@@ -87,7 +90,7 @@ public:
  */
 class PluginFactory
 {
-  using PluginInstList = ts::IntrusiveDList<RemapPluginInst::Linkage>;
+  using PluginInstList = std::vector<RemapPluginInst *>;
 
 public:
   PluginFactory();
@@ -101,6 +104,9 @@ public:
   virtual const char *getUuid();
   void clean(std::string &error);
 
+  PluginFactory &reuseInstancesFrom(PluginFactory *previous);
+  int reusedInstanceCount() const;
+
   void deactivate();
   void indicatePreReload();
   void indicatePostReload(bool reloadSuccessful);
@@ -114,6 +120,11 @@ protected:
 
   PluginInstList _instList;
 
+  /* Instances of the previous factory which can still be reused by this one, keyed by their parameters */
+  std::unordered_multimap<std::string, RemapPluginInst *> _reusable;
+  int _reusedCount = 0;
+  bool _deactivated = false;
+
   ATSUuid *_uuid = nullptr;
   std::error_code _ec;
   bool _preventiveCleaning = true;
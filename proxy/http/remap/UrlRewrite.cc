@@ -52,7 +52,7 @@ SetHomePageRedirectFlag(url_mapping *new_mapping, URL &new_to_url)
 }
 
 bool
-UrlRewrite::load()
+UrlRewrite::load(UrlRewrite *previous)
 {
   ats_scoped_str config_file_path;
 
@@ -83,13 +83,19 @@ UrlRewrite::load()
 
   /* Initialize the plugin factory */
   pluginFactory.setRuntimeDir(RecConfigReadRuntimeDir()).addSearchDir(RecConfigReadPluginDir());
+  if (previous != nullptr) {
+    pluginFactory.reuseInstancesFrom(&previous->pluginFactory);
+  }
 
   /* Initialize the next hop strategy factory */
   std::string sf = RecConfigReadConfigPath("proxy.config.url_remap.strategies.filename", "strategies.yaml");
   Debug("url_rewrite_regex", "strategyFactory file: %s", sf.c_str());
   strategyFactory = new NextHopStrategyFactory(sf.c_str());
 
-  if (0 == this->BuildTable(config_file_path)) {
+  int build_result = this->BuildTable(config_file_path);
+  pluginFactory.reuseInstancesFrom(nullptr);
+
+  if (0 == build_result) {
     _valid = true;
     if (is_debug_tag_set("url_rewrite")) {
       Print();
@@ -730,9 +736,36 @@ UrlRewrite::BuildTable(const char *path)
     forward_mappings_with_recv_port.hash_lookup.reset(nullptr);
   }
 
+  _buildRegexSet(forward_mappings);
+  _buildRegexSet(reverse_mappings);
+  _buildRegexSet(permanent_redirects);
+  _buildRegexSet(temporary_redirects);
+  _buildRegexSet(forward_mappings_with_recv_port);
+
   return zret;
 }
 
+void
+UrlRewrite::_buildRegexSet(MappingsStore &store)
+{
+  std::vector<std::string_view> patterns;
+
+  forl_LL(RegexMapping, list_iter, store.regex_list)
+  {
+    int host_len;
+    const char *host = list_iter->url_map->fromURL.host_get(&host_len);
+
+    store.regex_mappings.push_back(list_iter);
+    patterns.emplace_back(host, host_len);
+  }
+
+  if (!patterns.empty()) {
+    // Same patterns and flags as RegexMapping::regular_expression, which all compiled already
+    int count = store.regex_set.compile(patterns.data(), patterns.size(), RE_UNANCHORED);
+    ink_release_assert(count == static_cast<int>(patterns.size()));
+  }
+}
+
 /**
   Inserts arg mapping in h_table with key src_host chaining the mapping
   of existing entries bound to src_host if necessary.
@@ -803,7 +836,7 @@ UrlRewrite::_mappingLookup(MappingsStore &mappings, URL *request_url, int reques
     mapping_container.set(mapping);
     retval = true;
   }
-  if (_regexMappingLookup(mappings.regex_list, request_url, request_port, request_host_lower, request_host_len, rank_ceiling,
+  if (_regexMappingLookup(mappings, request_url, request_port, request_host_lower, request_host_len, rank_ceiling,
                           mapping_container)) {
     Debug("url_rewrite", "Using regex mapping with rank %d", (mapping_container.getMapping())->getRank());
     retval = true;
@@ -863,7 +896,7 @@ lOverFlow:
 }
 
 bool
-UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_url, int request_port, const char *request_host,
+UrlRewrite::_regexMappingLookup(MappingsStore &mappings, URL *request_url, int request_port, const char *request_host,
                                 int request_host_len, int rank_ceiling, UrlMappingContainer &mapping_container)
 {
   bool retval = false;
@@ -888,39 +921,41 @@ UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_u
     request_scheme_len = hdrtoken_wks_to_length(request_scheme);
   }
 
-  // Loop over the entire linked list, or until we're satisfied
-  forl_LL(RegexMapping, list_iter, regex_mappings)
-  {
-    int reg_map_rank = list_iter->url_map->getRank();
+  std::string_view host(request_host, request_host_len);
+
+  // Loop over the mappings whose host regex matches, in rank order, until we're satisfied
+  for (int i = mappings.regex_set.match(host, 0); i >= 0; i = mappings.regex_set.match(host, i + 1)) {
+    RegexMapping *reg_map = mappings.regex_mappings[i];
+    int reg_map_rank      = reg_map->url_map->getRank();
 
     if (reg_map_rank > rank_ceiling) {
       break;
     }
 
-    reg_map_scheme = list_iter->url_map->fromURL.scheme_get(&reg_map_scheme_len);
+    reg_map_scheme = reg_map->url_map->fromURL.scheme_get(&reg_map_scheme_len);
     if ((request_scheme_len != reg_map_scheme_len) || strncmp(request_scheme, reg_map_scheme, request_scheme_len)) {
       Debug("url_rewrite_regex", "Skipping regex with rank %d as scheme does not match request scheme", reg_map_rank);
       continue;
     }
 
-    if (list_iter->url_map->fromURL.port_get() != request_port) {
+    if (reg_map->url_map->fromURL.port_get() != request_port) {
       Debug("url_rewrite_regex",
             "Skipping regex with rank %d as regex map port does not match request port. "
             "regex map port: %d, request port %d",
-            reg_map_rank, list_iter->url_map->fromURL.port_get(), request_port);
+            reg_map_rank, reg_map->url_map->fromURL.port_get(), request_port);
       continue;
     }
 
-    reg_map_path = list_iter->url_map->fromURL.path_get(&reg_map_path_len);
+    reg_map_path = reg_map->url_map->fromURL.path_get(&reg_map_path_len);
     if ((request_path_len < reg_map_path_len) ||
         strncmp(reg_map_path, request_path, reg_map_path_len)) { // use the shorter path length here
       Debug("url_rewrite_regex", "Skipping regex with rank %d as path does not cover request path", reg_map_rank);
       continue;
     }
 
+    // Evaluate the mapping's own regex again for its capture groups
     int matches_info[MAX_REGEX_SUBS * 3];
-    bool match_result =
-      list_iter->regular_expression.exec(std::string_view(request_host, request_host_len), matches_info, countof(matches_info));
+    bool match_result = reg_map->regular_expression.exec(host, matches_info, countof(matches_info));
 
     if (match_result == true) {
       Debug("url_rewrite_regex",
@@ -928,23 +963,20 @@ UrlRewrite::_regexMappingLookup(RegexMappingList &regex_mappings, URL *request_u
             "with %d possible substitutions",
             request_host_len, request_host, reg_map_rank, match_result);
 
-      mapping_container.set(list_iter->url_map);
+      mapping_container.set(reg_map->url_map);
 
       char buf[4096];
       int buf_len;
 
       // Expand substitutions in the host field from the stored template
-      buf_len           = _expandSubstitutions(matches_info, list_iter, request_host, buf, sizeof(buf));
+      buf_len           = _expandSubstitutions(matches_info, reg_map, request_host, buf, sizeof(buf));
       URL *expanded_url = mapping_container.createNewToURL();
-      expanded_url->copy(&((list_iter->url_map)->toURL));
+      expanded_url->copy(&((reg_map->url_map)->toURL));
       expanded_url->host_set(buf, buf_len);
 
       Debug("url_rewrite_regex", "Expanded toURL to [%.*s]", expanded_url->length_get(), expanded_url->string_get_ref());
       retval = true;
       break;
-    } else {
-      Debug("url_rewrite_regex", "Request URL host [%.*s] did NOT match regex in mapping of rank %d", request_host_len,
-            request_host, reg_map_rank);
     }
   }
 
@@ -67,9 +67,11 @@ public:
    *
    * This access data in librecords to obtain the information needed for loading the configuration.
    *
+   * @param previous If not @c nullptr, the configuration being replaced, whose remap plugin instances are reused for the rules
+   * which did not change. It must stay alive until this returns.
    * @return @c true if the instance state is valid, @c false if not.
    */
-  bool load();
+  bool load(UrlRewrite *previous = nullptr);
 
   /** Build the internal url write tables.
    *
@@ -137,6 +139,12 @@ public:
   struct MappingsStore {
     std::unique_ptr<URLTable> hash_lookup;
     RegexMappingList regex_list;
+
+    // The mappings of regex_list in rank order, and their host regexes compiled as one set so that hosts matching none of
+    // them are rejected without evaluating each one. Built by BuildTable() once all the rules are loaded.
+    std::vector<RegexMapping *> regex_mappings;
+    DFA regex_set;
+
     bool
     empty()
     {
@@ -153,6 +161,7 @@ public:
   DestroyStore(MappingsStore &store)
   {
     _destroyTable(store.hash_lookup);
+    store.regex_mappings.clear();
     _destroyList(store.regex_list);
   }
 
@@ -222,8 +231,9 @@ private:
                       UrlMappingContainer &mapping_container);
   url_mapping *_tableLookup(std::unique_ptr<URLTable> &h_table, URL *request_url, int request_port, char *request_host,
                             int request_host_len);
-  bool _regexMappingLookup(RegexMappingList &regex_mappings, URL *request_url, int request_port, const char *request_host,
+  bool _regexMappingLookup(MappingsStore &mappings, URL *request_url, int request_port, const char *request_host,
                            int request_host_len, int rank_ceiling, UrlMappingContainer &mapping_container);
+  void _buildRegexSet(MappingsStore &store);
   int _expandSubstitutions(int *matches_info, const RegexMapping *reg_map, const char *matched_string, char *dest_buf,
                            int dest_buf_size);
   void _destroyTable(std::unique_ptr<URLTable> &h_table);
@@ -0,0 +1,164 @@
+/** @file
+
+  Unit tests for the NextHopLeastLatency.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+  @section details Details
+
+  Unit testing the NextHopLeastLatency class.
+
+ */
+
+#define CATCH_CONFIG_MAIN /* include main function */
+
+#include <catch.hpp> /* catch unit-test framework */
+#include <yaml-cpp/yaml.h>
+
+#include "HttpSM.h"
+#include "nexthop_test_stubs.h"
+#include "NextHopSelectionStrategy.h"
+#include "NextHopStrategyFactory.h"
+#include "NextHopLeastLatency.h"
+
+SCENARIO("Testing NextHopLeastLatency class, using policy 'least_latency'", "[NextHopLeastLatency]")
+{
+  // We need this to build a HdrHeap object in build_request();
+  // No thread setup, forbid use of thread local allocators.
+  cmd_disable_pfreelist = true;
+  // Get all of the HTTP WKS items populated.
+  http_init();
+
+  GIVEN("Loading the least-latency-tests.yaml config for 'least_latency' tests.")
+  {
+    std::shared_ptr<NextHopSelectionStrategy> strategy;
+    NextHopStrategyFactory nhf(TS_SRC_DIR "unit-tests/least-latency-tests.yaml");
+    strategy = nhf.strategyInstance("least-latency");
+
+    WHEN("the config is loaded.")
+    {
+      THEN("the least_latency strategy is ready for use.")
+      {
+        REQUIRE(nhf.strategies_loaded == true);
+        REQUIRE(strategy != nullptr);
+        REQUIRE(strategy->policy_type == NH_LEAST_LATENCY);
+        REQUIRE(strategy->groups == 2);
+      }
+    }
+
+    WHEN("making requests using a 'least_latency' policy.")
+    {
+      HttpSM sm;
+      ParentResult *result = &sm.t_state.parent_result;
+      TSHttpTxn txnp       = reinterpret_cast<TSHttpTxn>(&sm);
+      time_t now           = time(nullptr);
+
+      THEN("then testing least_latency.")
+      {
+        REQUIRE(nhf.strategies_loaded == true);
+        REQUIRE(strategy != nullptr);
+
+        // first request, neither host has been sampled.
+        build_request(20001, &sm, nullptr, "rabbit.net", nullptr);
+        strategy->findNextHop(txnp, nullptr, now);
+        REQUIRE(result->result == ParentResultType::PARENT_SPECIFIED);
+        REQUIRE(result->latency_host != nullptr);
+        HostRecord *first = result->latency_host;
+        CHECK(first->in_flight == 1);
+
+        // second request while the first is in flight goes to the idle host.
+        build_request(20002, &sm, nullptr, "rabbit.net", nullptr);
+        result->reset();
+        strategy->findNextHop(txnp, nullptr, now);
+        REQUIRE(result->latency_host != nullptr);
+        HostRecord *second = result->latency_host;
+        CHECK(second != first);
+        CHECK(strcmp(second->hostname.c_str(), "s1.bar.com") != 0);
+
+        // p1 answers in 10ms, p2 in 100ms.
+        HostRecord *p1 = (strcmp(first->hostname.c_str(), "p1.foo.com") == 0) ? first : second;
+        HostRecord *p2 = (p1 == first) ? second : first;
+        p1->attemptComplete(HRTIME_MSECONDS(10));
+        p2->attemptComplete(HRTIME_MSECONDS(100));
+        CHECK(p1->in_flight == 0);
+        CHECK(p2->in_flight == 0);
+        CHECK(p1->ewma_latency == 10000);
+        CHECK(p2->ewma_latency == 100000);
+        CHECK(p1->latencyScore(ink_get_hrtime_internal()) < p2->latencyScore(ink_get_hrtime_internal()));
+
+        // the faster host gets the requests.
+        for (int i = 0; i < 10; i++) {
+          build_request(20003 + i, &sm, nullptr, "rabbit.net", nullptr);
+          result->reset();
+          strategy->findNextHop(txnp, nullptr, now);
+          CHECK(strcmp(result->hostname, "p1.foo.com") == 0);
+          REQUIRE(result->latency_host == p1);
+          result->latency_host->attemptComplete(HRTIME_MSECONDS(10));
+          result->latency_host = nullptr;
+        }
+        CHECK(p1->in_flight == 0);
+        CHECK(p1->ewma_latency == 10000);
+
+        // a slower sample moves the EWMA by an eighth of the difference.
+        p1->attemptStarted();
+        p1->attemptComplete(HRTIME_MSECONDS(90));
+        CHECK(p1->ewma_latency == 20000);
+
+        // retrying the request avoids the next hop that was just tried.
+        build_request(20020, &sm, nullptr, "rabbit.net", nullptr);
+        result->reset();
+        strategy->findNextHop(txnp, nullptr, now);
+        CHECK(strcmp(result->hostname, "p1.foo.com") == 0);
+        strategy->findNextHop(txnp, nullptr, now);
+        CHECK(strcmp(result->hostname, "p2.foo.com") == 0);
+        CHECK(p1->in_flight == 0);
+        CHECK(p2->in_flight == 1);
+
+        // mark down p2, then p1, the secondary group is used.
+        strategy->markNextHop(txnp, result->hostname, result->port, NH_MARK_DOWN, nullptr, now);
+        build_request(20021, &sm, nullptr, "rabbit.net", nullptr);
+        result->reset();
+        strategy->findNextHop(txnp, nullptr, now);
+        CHECK(strcmp(result->hostname, "p1.foo.com") == 0);
+        strategy->markNextHop(txnp, result->hostname, result->port, NH_MARK_DOWN, nullptr, now);
+
+        build_request(20022, &sm, nullptr, "rabbit.net", nullptr);
+        result->reset();
+        strategy->findNextHop(txnp, nullptr, now);
+        CHECK(strcmp(result->hostname, "s1.bar.com") == 0);
+
+        // mark down s1, nothing is left and go_direct is false.
+        strategy->markNextHop(txnp, result->hostname, result->port, NH_MARK_DOWN, nullptr, now);
+        build_request(20023, &sm, nullptr, "rabbit.net", nullptr);
+        result->reset();
+        strategy->findNextHop(txnp, nullptr, now);
+        CHECK(result->result == ParentResultType::PARENT_FAIL);
+        CHECK(result->latency_host == nullptr);
+
+        // once the retry time has passed, a host that was marked down is retried.
+        build_request(20024, &sm, nullptr, "rabbit.net", nullptr);
+        result->reset();
+        strategy->findNextHop(txnp, nullptr, now + 10);
+        CHECK(result->result == ParentResultType::PARENT_SPECIFIED);
+        CHECK(result->retry == true);
+      }
+      br_destroy(sm);
+    }
+  }
+}
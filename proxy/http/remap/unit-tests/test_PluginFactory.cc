@@ -1427,3 +1427,81 @@ SCENARIO("notifying plugins of config reload", "[plugin][core]")
     }
   }
 }
+
+SCENARIO("reusing plugin instances on config reload", "[plugin][core]")
+{
+  REQUIRE_FALSE(sandboxDir.empty());
+  enablePluginDynamicReload();
+
+  fs::path configName = fs::path("plugin_testing_calls.so");
+  fs::path buildPath  = pluginBuildDir / fs::path("plugin_testing_calls.so");
+
+  static fs::path uuid_t1 = fs::path("c71e2bab-90dc-4770-9535-c9304c3de381"); /* UUID at moment t1 */
+  static fs::path uuid_t2 = fs::path("c71e2bab-90dc-4770-9535-e7304c3ee732"); /* UUID at moment t2 */
+
+  fs::path effectivePath;
+  fs::path runtimePath;
+
+  std::string error;
+
+  char from[]   = "http://from.example.com/";
+  char to1[]    = "http://to1.example.com/";
+  char to2[]    = "http://to2.example.com/";
+  char *argv1[] = {from, to1};
+  char *argv2[] = {from, to2};
+
+  GIVEN("a plugin instantiated twice by the 1st factory and the 2nd factory reusing its instances")
+  {
+    setupConfigPathTest(configName, buildPath, uuid_t1, effectivePath, runtimePath, 1556825556);
+    PluginFactoryUnitTest *factory1 = getFactory(uuid_t1);
+    RemapPluginInst *inst1          = factory1->getRemapPlugin(configName, 2, argv1, error, isPluginDynamicReloadEnabled());
+    RemapPluginInst *inst2          = factory1->getRemapPlugin(configName, 2, argv2, error, isPluginDynamicReloadEnabled());
+    validateSuccessfulConfigPathTest(inst1, error, effectivePath, runtimePath);
+    validateSuccessfulConfigPathTest(inst2, error, effectivePath, runtimePath);
+
+    PluginDebugObject *debugObject = getDebugObject(inst1->_plugin);
+
+    PluginFactoryUnitTest *factory2 = getFactory(uuid_t2);
+    factory2->reuseInstancesFrom(factory1);
+
+    WHEN("the 2nd factory asks for the same plugin with the same and with different parameters")
+    {
+      debugObject->clear();
+      RemapPluginInst *inst3 = factory2->getRemapPlugin(configName, 2, argv1, error, isPluginDynamicReloadEnabled());
+      RemapPluginInst *inst4 = factory2->getRemapPlugin(configName, 2, argv2, error, isPluginDynamicReloadEnabled());
+      RemapPluginInst *inst5 = factory2->getRemapPlugin(configName, 2, argv1, error, isPluginDynamicReloadEnabled());
+      factory2->reuseInstancesFrom(nullptr);
+
+      THEN("expect each instance to be reused by the rule with the same parameters and only once")
+      {
+        CHECK(inst1 == inst3);
+        CHECK(inst2 == inst4);
+        CHECK(inst3 != inst4);
+        CHECK(inst1 != inst5);
+        CHECK(inst2 != inst5);
+        CHECK(1 == debugObject->initInstanceCalled);
+        CHECK(2 == factory2->reusedInstanceCount());
+
+        delete factory2;
+        delete factory1;
+      }
+
+      THEN("expect the reused instances to be deleted only when the last factory using them is deactivated")
+      {
+        debugObject->clear();
+        factory1->deactivate();
+        CHECK(0 == debugObject->deleteInstanceCalled);
+        CHECK(0 == debugObject->doneCalled);
+        delete factory1;
+
+        debugObject->clear();
+        factory2->deactivate();
+        CHECK(3 == debugObject->deleteInstanceCalled);
+        CHECK(1 == debugObject->doneCalled);
+        delete factory2;
+      }
+    }
+
+    clean();
+  }
+}
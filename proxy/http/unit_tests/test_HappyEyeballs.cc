@@ -0,0 +1,139 @@
+/** @file
+
+  Unit Tests for Happy Eyeballs ordering and connect time bookkeeping
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "HappyEyeballsAlgorithm.h"
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+using namespace HappyEyeballs;
+
+TEST_CASE("Happy Eyeballs Algorithm", "[happy_eyeballs]")
+{
+  SECTION("encode_rtt")
+  {
+    CHECK(encode_rtt(0) == 1);
+    CHECK(encode_rtt(HRTIME_MSECONDS(3)) == 1);
+    CHECK(encode_rtt(HRTIME_MSECONDS(4)) == 2);
+    CHECK(encode_rtt(HRTIME_MSECONDS(100)) == 26);
+    CHECK(encode_rtt(HRTIME_SECONDS(10)) == RTT_FAILED);
+  }
+
+  SECTION("smooth_rtt")
+  {
+    CHECK(smooth_rtt(RTT_UNKNOWN, 20) == 20);
+    CHECK(smooth_rtt(20, 20) == 20);
+    CHECK(smooth_rtt(20, 40) == 25);
+    CHECK(smooth_rtt(1, 1) == 1);
+
+    // a failing address converges to failed, and recovers.
+    uint8_t rtt = 10;
+    for (int i = 0; i < 32; ++i) {
+      rtt = smooth_rtt(rtt, RTT_FAILED);
+    }
+    CHECK(rtt > 240);
+    for (int i = 0; i < 32; ++i) {
+      rtt = smooth_rtt(rtt, 10);
+    }
+    CHECK(rtt < 20);
+  }
+
+  SECTION("smooth_rtt_lower_bound")
+  {
+    CHECK(smooth_rtt_lower_bound(RTT_UNKNOWN, 70) == 70);
+    CHECK(smooth_rtt_lower_bound(20, 10) == 20);
+    CHECK(smooth_rtt_lower_bound(20, 60) == 30);
+    // an address that keeps losing ends up behind the one that wins.
+    CHECK(prefer_alternate(smooth_rtt_lower_bound(RTT_UNKNOWN, encode_rtt(HRTIME_MSECONDS(260))), 3));
+  }
+
+  SECTION("prefer_alternate")
+  {
+    CHECK(!prefer_alternate(RTT_UNKNOWN, RTT_UNKNOWN));
+    CHECK(!prefer_alternate(RTT_UNKNOWN, 10));
+    CHECK(!prefer_alternate(10, RTT_UNKNOWN));
+    CHECK(!prefer_alternate(10, 10));
+    CHECK(!prefer_alternate(10, 20));
+    CHECK(prefer_alternate(20, 10));
+    CHECK(prefer_alternate(RTT_FAILED, 200));
+    CHECK(!prefer_alternate(RTT_FAILED, RTT_FAILED));
+    CHECK(!prefer_alternate(RTT_FAILED, RTT_UNKNOWN));
+  }
+
+  SECTION("connect_time_bucket")
+  {
+    CHECK(connect_time_bucket(0) == 0);
+    CHECK(connect_time_bucket(HRTIME_MSECONDS(10)) == 0);
+    CHECK(connect_time_bucket(HRTIME_MSECONDS(11)) == 1);
+    CHECK(connect_time_bucket(HRTIME_MSECONDS(250)) == 3);
+    CHECK(connect_time_bucket(HRTIME_MSECONDS(1000)) == 5);
+    CHECK(connect_time_bucket(HRTIME_SECONDS(30)) == N_CONNECT_TIME_BUCKETS - 1);
+  }
+}
+
+TEST_CASE("Happy Eyeballs Candidate List", "[happy_eyeballs]")
+{
+  SECTION("interleave")
+  {
+    CandidateList<int> list;
+    list.push(PRIMARY, 1);
+    list.push(PRIMARY, 2);
+    list.push(PRIMARY, 3);
+    list.push(ALTERNATE, 11);
+
+    CHECK(list.pop() == 1);
+    CHECK(list.pop() == 11);
+    CHECK(list.pop() == 2);
+    CHECK(list.pop() == 3);
+    CHECK(list.empty());
+  }
+
+  SECTION("prefer alternate")
+  {
+    CandidateList<int> list;
+    list.push(PRIMARY, 1);
+    list.push(ALTERNATE, 11);
+    list.push(ALTERNATE, 12);
+    list.prefer(ALTERNATE);
+
+    CHECK(list.pop() == 11);
+    CHECK(list.pop() == 1);
+    CHECK(list.pop() == 12);
+    CHECK(list.empty());
+  }
+
+  SECTION("late alternate")
+  {
+    CandidateList<int> list;
+    list.push(PRIMARY, 1);
+    list.push(PRIMARY, 2);
+
+    CHECK(list.pop() == 1);
+    CHECK(list.size(PRIMARY) == 1);
+    // the alternate family resolved while the first address was tried.
+    list.push(ALTERNATE, 11);
+    CHECK(list.pop() == 11);
+    CHECK(list.pop() == 2);
+    CHECK(list.empty());
+  }
+}
@@ -0,0 +1,89 @@
+/** @file
+
+  Unit Tests for the per origin counts of server session reuse
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <cstring>
+#include <thread>
+
+#include "OriginReuseTrack.h"
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+namespace
+{
+CryptoHash
+hash_of(const char *fqdn)
+{
+  CryptoHash hash;
+  hash.u64[0] = std::hash<std::string_view>{}(fqdn);
+  hash.u64[1] = 0;
+  return hash;
+}
+} // namespace
+
+TEST_CASE("OriginReuseTrack", "[http][session_reuse]")
+{
+  CryptoHash a = hash_of("a.example.com");
+  CryptoHash b = hash_of("b.example.com");
+
+  SECTION("records are per origin and port")
+  {
+    OriginReuseTrack::Origin *a80  = OriginReuseTrack::obtain("a.example.com", a, 80);
+    OriginReuseTrack::Origin *a443 = OriginReuseTrack::obtain("a.example.com", a, 443);
+    OriginReuseTrack::Origin *b80  = OriginReuseTrack::obtain("b.example.com", b, 80);
+
+    REQUIRE(a80 != nullptr);
+    CHECK(a80 != a443);
+    CHECK(a80 != b80);
+    CHECK(OriginReuseTrack::obtain("a.example.com", a, 80) == a80);
+    CHECK(a80->fqdn == "a.example.com");
+    CHECK(a443->port == 443);
+  }
+
+  SECTION("counts of all threads are summed by origin")
+  {
+    CryptoHash c = hash_of("c.example.com");
+
+    auto acquire = [&c](int n, bool reused) {
+      OriginReuseTrack::Origin *origin = OriginReuseTrack::obtain("c.example.com", c, 8080);
+      for (int i = 0; i < n; ++i) {
+        OriginReuseTrack::count(origin->acquires);
+        if (reused) {
+          OriginReuseTrack::count(origin->peer);
+        }
+      }
+    };
+
+    acquire(10, false);
+    std::thread t1(acquire, 20, true);
+    std::thread t2(acquire, 30, true);
+    t1.join();
+    t2.join();
+
+    std::string json = OriginReuseTrack::to_json_string();
+    CHECK(json.find(R"("fqdn": "c.example.com", "port": 8080, "acquires": 60, "local": 0, "global": 0, "peer": 50)") !=
+          std::string::npos);
+    // The records of the threads that exited are still counted, once per origin
+    CHECK(json.find("c.example.com") == json.rfind("c.example.com"));
+  }
+}
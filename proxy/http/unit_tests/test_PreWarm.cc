@@ -220,4 +220,73 @@ TEST_CASE("PreWarm Algorithm", "[prewarm]")
       }
     }
   }
+
+  SECTION("prewarm_forecast_v3")
+  {
+    // a steady demand converges to the demand
+    double forecast = 0;
+    for (int i = 0; i < 100; ++i) {
+      forecast = PreWarm::prewarm_forecast_v3(forecast, 3, 2, 9);
+    }
+    CHECK(forecast == Approx(5.0));
+
+    // one period weighs 2 / (windows + 1)
+    CHECK(PreWarm::prewarm_forecast_v3(0, 10, 0, 9) == Approx(2.0));
+    CHECK(PreWarm::prewarm_forecast_v3(10, 0, 0, 9) == Approx(8.0));
+    CHECK(PreWarm::prewarm_forecast_v3(0, 10, 0, 1) == Approx(10.0));
+    CHECK(PreWarm::prewarm_forecast_v3(0, 10, 0, 0) == Approx(10.0));
+
+    // a lull decays the forecast gradually
+    forecast = 5.0;
+    for (int i = 0; i < 10; ++i) {
+      forecast = PreWarm::prewarm_forecast_v3(forecast, 0, 0, 59);
+    }
+    CHECK(forecast > 3.0);
+    CHECK(forecast < 5.0);
+  }
+
+  SECTION("prewarm_size_v3_on_event_interval")
+  {
+    SECTION("{min, max} = {0, 100}")
+    {
+      const uint32_t min = 0;
+      const uint32_t max = 100;
+
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(0.0, 0, min, max, 1.0) == 0);
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(0.05, 0, min, max, 1.0) == 0);
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(0.2, 0, min, max, 1.0) == 1);
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(4.2, 0, min, max, 1.0) == 5);
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(4.2, 3, min, max, 1.0) == 2);
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(4.2, 5, min, max, 1.0) == 0);
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(4.2, 10, min, max, 1.0) == 0);
+
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(4.0, 0, min, max, 1.5) == 6);
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(4.0, 0, min, max, 0.5) == 2);
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(4.0, 0, min, max, 0.0) == 0);
+
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(500.0, 0, min, max, 1.0) == max);
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(500.0, 90, min, max, 1.0) == 10);
+    }
+
+    SECTION("{min, max} = {10, -1}")
+    {
+      const uint32_t min = 10;
+      const int32_t max  = -1;
+
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(0.0, 0, min, max, 1.0) == min);
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(0.0, 4, min, max, 1.0) == 6);
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(4.2, 0, min, max, 1.0) == min);
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(500.0, 0, min, max, 1.0) == 500);
+      CHECK(PreWarm::prewarm_size_v3_on_event_interval(500.0, 600, min, max, 1.0) == 0);
+    }
+  }
+
+  SECTION("prewarm_target_v3")
+  {
+    CHECK(PreWarm::prewarm_target_v3(0.0, 0, 100, 1.0) == 0);
+    CHECK(PreWarm::prewarm_target_v3(2.5, 0, 100, 1.0) == 3);
+    CHECK(PreWarm::prewarm_target_v3(2.5, 5, 100, 1.0) == 5);
+    CHECK(PreWarm::prewarm_target_v3(2.5, 0, 2, 1.0) == 2);
+    CHECK(PreWarm::prewarm_target_v3(2.5, 0, 0, 1.0) == 0);
+  }
 }
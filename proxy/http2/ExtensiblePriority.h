@@ -0,0 +1,356 @@
+/** @file
+
+  Extensible Prioritization Scheme for HTTP (RFC 9218)
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "tscore/List.h"
+#include "tscore/ink_assert.h"
+
+namespace ExtensiblePriority
+{
+// [RFC 9218] 4.1. Urgency
+const static uint8_t URGENCY_LEVELS  = 8;
+const static uint8_t DEFAULT_URGENCY = 3;
+
+// [RFC 9218] 5. The Priority HTTP Header Field
+const static std::string_view FIELD_NAME{"priority"};
+// Field values longer than this are not parsed. The defined parameters fit in a handful of bytes.
+const static size_t MAX_FIELD_VALUE_LEN = 128;
+
+struct Priority {
+  uint8_t urgency  = DEFAULT_URGENCY;
+  bool incremental = false;
+
+  bool
+  operator==(const Priority &p) const
+  {
+    return urgency == p.urgency && incremental == p.incremental;
+  }
+
+  bool
+  operator!=(const Priority &p) const
+  {
+    return !(*this == p);
+  }
+};
+
+/**
+  Parse a Priority Field Value, the Structured Fields Dictionary carried by the Priority header field and by PRIORITY_UPDATE
+  frames.
+
+  [RFC 9218] 4. Parameters that are absent, out of range or of an unexpected type are ignored and keep their default value, as are
+  unknown parameters.
+ */
+inline Priority
+parse_priority_field_value(std::string_view value)
+{
+  Priority priority;
+
+  auto is_ows = [](char c) { return c == ' ' || c == '\t'; };
+
+  while (!value.empty()) {
+    size_t end             = value.find(',');
+    std::string_view entry = value.substr(0, end);
+    value.remove_prefix(end == std::string_view::npos ? value.size() : end + 1);
+
+    // Member parameters are not used by any of the defined keys
+    entry = entry.substr(0, entry.find(';'));
+    while (!entry.empty() && is_ows(entry.front())) {
+      entry.remove_prefix(1);
+    }
+    while (!entry.empty() && is_ows(entry.back())) {
+      entry.remove_suffix(1);
+    }
+
+    size_t eq             = entry.find('=');
+    std::string_view key  = entry.substr(0, eq);
+    std::string_view item = eq == std::string_view::npos ? std::string_view("?1") : entry.substr(eq + 1);
+
+    if (key == "u") {
+      if (item.size() == 1 && item[0] >= '0' && item[0] < '0' + URGENCY_LEVELS) {
+        priority.urgency = item[0] - '0';
+      }
+    } else if (key == "i") {
+      if (item == "?1") {
+        priority.incremental = true;
+      } else if (item == "?0") {
+        priority.incremental = false;
+      }
+    }
+  }
+
+  return priority;
+}
+
+class Node
+{
+public:
+  explicit Node(uint32_t i = 0, Priority p = Priority(), void *t = nullptr) : id(i), priority(p), t(t) {}
+
+  LINK(Node, link);
+  LINK(Node, node_link);
+
+  bool active       = false;
+  uint32_t id       = 0;
+  Priority priority = {};
+  void *t           = nullptr;
+};
+
+/**
+  Urgency/incremental scheduler
+
+  Active nodes are kept in one queue per urgency level, split into non-incremental nodes which are served one at a time in
+  ascending id order and incremental nodes which are served round-robin ([RFC 9218] 10. Server Scheduling). A bitmap of non-empty
+  urgency levels makes selecting the next node O(1), and (re)activating a node is O(1) for the common case of ids arriving in
+  ascending order.
+ */
+class Scheduler
+{
+public:
+  explicit Scheduler(uint32_t max_pending) : _max_pending(max_pending) {}
+  ~Scheduler();
+
+  Scheduler(const Scheduler &) = delete;
+  Scheduler &operator=(const Scheduler &) = delete;
+
+  Node *add(uint32_t id, Priority priority, void *t);
+  void reprioritize(Node *node, Priority priority);
+  bool reprioritize(uint32_t id, Priority priority);
+  Node *top() const;
+  Node *next(const Node *node) const;
+  void remove(Node *node);
+  void activate(Node *node);
+  void deactivate(Node *node);
+  void update(Node *node, uint32_t sent);
+  uint32_t size() const;
+
+private:
+  Queue<Node> &_queue_of(const Node *node);
+  void _enqueue(Node *node);
+  void _dequeue(Node *node);
+
+  Queue<Node> _non_incremental[URGENCY_LEVELS];
+  Queue<Node> _incremental[URGENCY_LEVELS];
+  DLL<Node, Node::Link_node_link> _nodes;
+  uint32_t _active_levels = 0;
+  uint32_t _node_count    = 0;
+
+  /*
+   * Priority signals which arrived before the stream they refer to was opened. [RFC 9218] 7.1 & 7.2 allow PRIORITY_UPDATE to be
+   * sent before the request, in which case it takes precedence over the Priority header field.
+   */
+  uint32_t _max_pending;
+  std::unordered_map<uint32_t, Priority> _pending;
+};
+
+inline Scheduler::~Scheduler()
+{
+  while (Node *node = _nodes.pop()) {
+    delete node;
+  }
+}
+
+inline Queue<Node> &
+Scheduler::_queue_of(const Node *node)
+{
+  return node->priority.incremental ? _incremental[node->priority.urgency] : _non_incremental[node->priority.urgency];
+}
+
+inline void
+Scheduler::_enqueue(Node *node)
+{
+  Queue<Node> &queue = _queue_of(node);
+
+  if (node->priority.incremental) {
+    queue.enqueue(node);
+  } else {
+    Node *after = queue.tail;
+    while (after != nullptr && after->id > node->id) {
+      after = after->link.prev;
+    }
+    queue.insert(node, after);
+  }
+  _active_levels |= 1u << node->priority.urgency;
+}
+
+inline void
+Scheduler::_dequeue(Node *node)
+{
+  const uint8_t u = node->priority.urgency;
+
+  _queue_of(node).remove(node);
+  if (_non_incremental[u].empty() && _incremental[u].empty()) {
+    _active_levels &= ~(1u << u);
+  }
+}
+
+inline Node *
+Scheduler::add(uint32_t id, Priority priority, void *t)
+{
+  auto pending = _pending.find(id);
+  if (pending != _pending.end()) {
+    priority = pending->second;
+    _pending.erase(pending);
+  }
+
+  Node *node = new Node(id, priority, t);
+  _nodes.push(node);
+  ++_node_count;
+  return node;
+}
+
+inline void
+Scheduler::reprioritize(Node *node, Priority priority)
+{
+  if (node->priority == priority) {
+    return;
+  }
+
+  if (node->active) {
+    _dequeue(node);
+    node->priority = priority;
+    _enqueue(node);
+  } else {
+    node->priority = priority;
+  }
+}
+
+/**
+  Remember the priority of a stream that has not been opened yet. Returns false if too many such signals are already held.
+ */
+inline bool
+Scheduler::reprioritize(uint32_t id, Priority priority)
+{
+  auto pending = _pending.find(id);
+  if (pending != _pending.end()) {
+    pending->second = priority;
+  } else if (_pending.size() < _max_pending) {
+    _pending.emplace(id, priority);
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+inline Node *
+Scheduler::top() const
+{
+  if (_active_levels == 0) {
+    return nullptr;
+  }
+
+  const uint8_t u = __builtin_ctz(_active_levels);
+  return _non_incremental[u].head ? _non_incremental[u].head : _incremental[u].head;
+}
+
+/**
+  The active node served after @a node, in the order top() serves them, so that the caller can skip nodes which have nothing to
+  send right now. Returns nullptr after the last one.
+ */
+inline Node *
+Scheduler::next(const Node *node) const
+{
+  ink_assert(node->active);
+
+  const uint8_t u = node->priority.urgency;
+  if (node->link.next) {
+    return node->link.next;
+  }
+  if (!node->priority.incremental && _incremental[u].head) {
+    return _incremental[u].head;
+  }
+
+  // Levels above u
+  uint32_t levels = _active_levels & ~((2u << u) - 1);
+  if (levels == 0) {
+    return nullptr;
+  }
+
+  const uint8_t next_u = __builtin_ctz(levels);
+  return _non_incremental[next_u].head ? _non_incremental[next_u].head : _incremental[next_u].head;
+}
+
+inline void
+Scheduler::remove(Node *node)
+{
+  if (node->active) {
+    deactivate(node);
+  }
+
+  _nodes.remove(node);
+  --_node_count;
+  delete node;
+}
+
+inline void
+Scheduler::activate(Node *node)
+{
+  if (node->active) {
+    return;
+  }
+
+  node->active = true;
+  _enqueue(node);
+}
+
+inline void
+Scheduler::deactivate(Node *node)
+{
+  if (!node->active) {
+    return;
+  }
+
+  node->active = false;
+  _dequeue(node);
+}
+
+/**
+  Account for @a sent bytes of @a node. Incremental nodes yield to the next node of the same urgency, non-incremental nodes keep
+  their place until they are deactivated.
+ */
+inline void
+Scheduler::update(Node *node, uint32_t sent)
+{
+  ink_assert(node->active);
+
+  if (node->priority.incremental && sent > 0) {
+    Queue<Node> &queue = _incremental[node->priority.urgency];
+    if (queue.tail != node) {
+      queue.remove(node);
+      queue.enqueue(node);
+    }
+  }
+}
+
+inline uint32_t
+Scheduler::size() const
+{
+  return _node_count;
+}
+
+} // namespace ExtensiblePriority
@@ -84,6 +84,10 @@ static const char *const HTTP2_STAT_MAX_PING_FRAMES_PER_MINUTE_EXCEEDED_NAME =
 static const char *const HTTP2_STAT_MAX_PRIORITY_FRAMES_PER_MINUTE_EXCEEDED_NAME =
   "proxy.process.http2.max_priority_frames_per_minute_exceeded";
 static const char *const HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE_NAME = "proxy.process.http2.insufficient_avg_window_update";
+static const char *const HTTP2_STAT_WRITE_FLUSHES_NAME                  = "proxy.process.http2.write_flushes";
+static const char *const HTTP2_STAT_WRITE_FLUSHED_FRAMES_NAME           = "proxy.process.http2.write_flushed_frames";
+static const char *const HTTP2_STAT_BDP_PINGS_NAME                      = "proxy.process.http2.bdp_pings";
+static const char *const HTTP2_STAT_WINDOW_SIZE_INCREASES_NAME          = "proxy.process.http2.window_size_increases";
 
 union byte_pointer {
   byte_pointer(void *p) : ptr(p) {}
@@ -173,6 +177,9 @@ http2_settings_parameter_is_valid(const Http2SettingsParameter &param)
     HTTP2_MAX_WINDOW_SIZE, // HTTP2_SETTINGS_INITIAL_WINDOW_SIZE
     16777215,              // HTTP2_SETTINGS_MAX_FRAME_SIZE
     UINT_MAX,              // HTTP2_SETTINGS_MAX_HEADER_LIST_SIZE
+    UINT_MAX,              // Unsupported
+    UINT_MAX,              // Unsupported
+    1,                     // HTTP2_SETTINGS_NO_RFC7540_PRIORITIES
   };
 
   if (param.id == 0 || param.id >= HTTP2_SETTINGS_MAX) {
@@ -416,6 +423,24 @@ http2_parse_window_update(IOVec iov, uint32_t &size)
   return true;
 }
 
+bool
+http2_parse_priority_update(IOVec iov, Http2StreamId &prioritized_stream_id)
+{
+  byte_pointer ptr(iov.iov_base);
+  byte_addressable_value<uint32_t> sid;
+
+  if (unlikely(iov.iov_len < HTTP2_PRIORITY_UPDATE_LEN)) {
+    return false;
+  }
+
+  memcpy_and_advance(sid.bytes, ptr);
+
+  sid.bytes[0] &= 0x7f; // Clear the reserved bit
+  prioritized_stream_id = ntohl(sid.value);
+
+  return true;
+}
+
 ParseResult
 http2_convert_header_from_2_to_1_1(HTTPHdr *headers)
 {
@@ -786,6 +811,7 @@ uint32_t Http2::max_active_streams_in          = 0;
 bool Http2::throttling                         = false;
 uint32_t Http2::stream_priority_enabled        = 0;
 uint32_t Http2::initial_window_size            = 65535;
+uint32_t Http2::max_window_size_in             = 0;
 uint32_t Http2::max_frame_size                 = 16384;
 uint32_t Http2::header_table_size              = 4096;
 uint32_t Http2::max_header_list_size           = 4294967295;
@@ -816,6 +842,7 @@ Http2::init()
   REC_EstablishStaticConfigInt32U(max_active_streams_in, "proxy.config.http2.max_active_streams_in");
   REC_EstablishStaticConfigInt32U(stream_priority_enabled, "proxy.config.http2.stream_priority_enabled");
   REC_EstablishStaticConfigInt32U(initial_window_size, "proxy.config.http2.initial_window_size_in");
+  REC_EstablishStaticConfigInt32U(max_window_size_in, "proxy.config.http2.max_window_size_in");
   REC_EstablishStaticConfigInt32U(max_frame_size, "proxy.config.http2.max_frame_size");
   REC_EstablishStaticConfigInt32U(header_table_size, "proxy.config.http2.header_table_size");
   REC_EstablishStaticConfigInt32U(max_header_list_size, "proxy.config.http2.max_header_list_size");
@@ -842,6 +869,7 @@ Http2::init()
   ink_release_assert(http2_settings_parameter_is_valid({HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, max_concurrent_streams_in}));
   ink_release_assert(http2_settings_parameter_is_valid({HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, min_concurrent_streams_in}));
   ink_release_assert(http2_settings_parameter_is_valid({HTTP2_SETTINGS_INITIAL_WINDOW_SIZE, initial_window_size}));
+  ink_release_assert(http2_settings_parameter_is_valid({HTTP2_SETTINGS_INITIAL_WINDOW_SIZE, max_window_size_in}));
   ink_release_assert(http2_settings_parameter_is_valid({HTTP2_SETTINGS_MAX_FRAME_SIZE, max_frame_size}));
   ink_release_assert(http2_settings_parameter_is_valid({HTTP2_SETTINGS_HEADER_TABLE_SIZE, header_table_size}));
   ink_release_assert(http2_settings_parameter_is_valid({HTTP2_SETTINGS_MAX_HEADER_LIST_SIZE, max_header_list_size}));
@@ -899,6 +927,14 @@ Http2::init()
                      static_cast<int>(HTTP2_STAT_MAX_PRIORITY_FRAMES_PER_MINUTE_EXCEEDED), RecRawStatSyncSum);
   RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE_NAME, RECD_INT, RECP_PERSISTENT,
                      static_cast<int>(HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WRITE_FLUSHES_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WRITE_FLUSHES), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WRITE_FLUSHED_FRAMES_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WRITE_FLUSHED_FRAMES), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_BDP_PINGS_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_BDP_PINGS), RecRawStatSyncSum);
+  RecRegisterRawStat(http2_rsb, RECT_PROCESS, HTTP2_STAT_WINDOW_SIZE_INCREASES_NAME, RECD_INT, RECP_PERSISTENT,
+                     static_cast<int>(HTTP2_STAT_WINDOW_SIZE_INCREASES), RecRawStatSyncSum);
 
   http2_init();
 }
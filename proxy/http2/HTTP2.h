@@ -64,6 +64,7 @@ const size_t HTTP2_PING_LEN               = 8;
 const size_t HTTP2_GOAWAY_LEN             = 8;
 const size_t HTTP2_WINDOW_UPDATE_LEN      = 4;
 const size_t HTTP2_SETTINGS_PARAMETER_LEN = 6;
+const size_t HTTP2_PRIORITY_UPDATE_LEN    = 4;
 
 // SETTINGS initial values. NOTE: These should not be modified
 // unless the protocol changes! Do not change this thinking you
@@ -105,6 +106,10 @@ enum {
   HTTP2_STAT_MAX_PING_FRAMES_PER_MINUTE_EXCEEDED,
   HTTP2_STAT_MAX_PRIORITY_FRAMES_PER_MINUTE_EXCEEDED,
   HTTP2_STAT_INSUFFICIENT_AVG_WINDOW_UPDATE,
+  HTTP2_STAT_WRITE_FLUSHES,         // # of times buffered frames were handed to the network
+  HTTP2_STAT_WRITE_FLUSHED_FRAMES,  // # of frames handed to the network, divide by the above for frames per write
+  HTTP2_STAT_BDP_PINGS,             // # of PING frames sent to sample the bandwidth-delay product
+  HTTP2_STAT_WINDOW_SIZE_INCREASES, // # of times a receive window was grown by auto-tuning
 
   HTTP2_N_STATS // Terminal counter, NOT A STAT INDEX.
 };
@@ -168,6 +173,9 @@ enum Http2FrameType {
   HTTP2_FRAME_TYPE_CONTINUATION  = 9,
 
   HTTP2_FRAME_TYPE_MAX,
+
+  // [RFC 9218] 7.1. Extension frame, not part of the frame type tables
+  HTTP2_FRAME_TYPE_PRIORITY_UPDATE = 0x10,
 };
 
 // [RFC 7540] 6.1. Data
@@ -246,9 +254,19 @@ enum Http2SettingsIdentifier {
   HTTP2_SETTINGS_MAX_FRAME_SIZE         = 5,
   HTTP2_SETTINGS_MAX_HEADER_LIST_SIZE   = 6,
 
+  // [RFC 9218] 2.1. Disabling RFC 7540 Priorities
+  HTTP2_SETTINGS_NO_RFC7540_PRIORITIES = 9,
+
   HTTP2_SETTINGS_MAX
 };
 
+// Values of proxy.config.http2.stream_priority_enabled
+enum Http2StreamPriorityScheme {
+  HTTP2_STREAM_PRIORITY_DISABLED   = 0,
+  HTTP2_STREAM_PRIORITY_RFC7540    = 1, // Dependency tree driven by PRIORITY frames
+  HTTP2_STREAM_PRIORITY_EXTENSIBLE = 2, // [RFC 9218] Priority header field and PRIORITY_UPDATE frames
+};
+
 // [RFC 7540] 4.1. Frame Format
 struct Http2FrameHeader {
   uint32_t length;
@@ -362,6 +380,8 @@ bool http2_parse_goaway(IOVec, Http2Goaway &);
 
 bool http2_parse_window_update(IOVec, uint32_t &);
 
+bool http2_parse_priority_update(IOVec, Http2StreamId &);
+
 Http2ErrorCode http2_decode_header_blocks(HTTPHdr *, const uint8_t *, const uint32_t, uint32_t *, HpackHandle &, bool &, uint32_t);
 
 Http2ErrorCode http2_encode_header_blocks(HTTPHdr *, uint8_t *, uint32_t, uint32_t *, HpackHandle &, int32_t);
@@ -385,6 +405,7 @@ public:
   static bool throttling;
   static uint32_t stream_priority_enabled;
   static uint32_t initial_window_size;
+  static uint32_t max_window_size_in;
   static uint32_t max_frame_size;
   static uint32_t header_table_size;
   static uint32_t max_header_list_size;
@@ -0,0 +1,96 @@
+/** @file
+
+  Http2BdpEstimator
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "Http2BdpEstimator.h"
+
+#include <algorithm>
+
+namespace
+{
+// Weight of the latest RTT sample
+constexpr double RTT_ALPHA = 0.1;
+// Grow the window once a sample reaches this fraction of it
+constexpr double GROW_THRESHOLD = 0.66;
+} // namespace
+
+bool
+Http2BdpEstimator::add_received(uint32_t length)
+{
+  if (this->_sampling) {
+    this->_sample += length;
+    return false;
+  }
+
+  this->_sampling  = true;
+  this->_ping_sent = false;
+  this->_sample    = length;
+  return true;
+}
+
+void
+Http2BdpEstimator::ping_sent(ink_hrtime now)
+{
+  this->_ping_sent = true;
+  this->_sent_at   = now;
+}
+
+uint32_t
+Http2BdpEstimator::ping_acked(ink_hrtime now, uint32_t window, uint32_t max_window)
+{
+  if (!this->_sampling || !this->_ping_sent) {
+    return window;
+  }
+  this->_sampling = false;
+
+  ink_hrtime rtt = std::max<ink_hrtime>(now - this->_sent_at, 1);
+  if (++this->_sample_count == 1) {
+    this->_rtt = rtt;
+  } else {
+    this->_rtt += (rtt - this->_rtt) * RTT_ALPHA;
+  }
+
+  // The sample is taken over a bit more than one round trip: the PING goes out after the first DATA frame of the sample
+  double bandwidth = static_cast<double>(this->_sample) * HRTIME_SECOND / (this->_rtt * 1.5);
+  if (bandwidth < this->_max_bandwidth) {
+    return window;
+  }
+  this->_max_bandwidth = bandwidth;
+
+  if (this->_sample >= window * GROW_THRESHOLD && window < max_window) {
+    return std::min<uint64_t>(this->_sample * 2, max_window);
+  }
+
+  return window;
+}
+
+bool
+Http2BdpEstimator::is_sampling() const
+{
+  return this->_sampling;
+}
+
+ink_hrtime
+Http2BdpEstimator::rtt() const
+{
+  return this->_rtt;
+}
@@ -0,0 +1,69 @@
+/** @file
+
+  Http2BdpEstimator
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "tscore/ink_hrtime.h"
+
+/**
+  Bandwidth-delay product estimator for receive window auto-tuning
+
+  A sample starts with the first DATA frame received while no sample is in progress, at which point a PING is sent. The DATA
+  payload received until the PING is acknowledged approximates the amount of data the peer can have in flight within one round
+  trip. Whenever a sample fills most of the current window while the measured bandwidth is still growing, the window is doubled,
+  up to the configured maximum.
+ */
+class Http2BdpEstimator
+{
+public:
+  /**
+    Account for @a length bytes of DATA payload.
+
+    @return true if a PING should be sent now to start a new sample.
+   */
+  bool add_received(uint32_t length);
+
+  void ping_sent(ink_hrtime now);
+
+  /**
+    Finish the current sample.
+
+    @return the new receive window size, which is @a window if it does not need to grow.
+   */
+  uint32_t ping_acked(ink_hrtime now, uint32_t window, uint32_t max_window);
+
+  bool is_sampling() const;
+  ink_hrtime rtt() const;
+
+private:
+  bool _sampling      = false;
+  bool _ping_sent     = false;
+  uint64_t _sample    = 0;
+  ink_hrtime _sent_at = 0;
+
+  // Smoothed round trip time and the highest bandwidth seen so far, in bytes per second
+  ink_hrtime _rtt        = 0;
+  double _max_bandwidth  = 0;
+  uint32_t _sample_count = 0;
+};
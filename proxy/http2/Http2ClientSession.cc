@@ -143,6 +143,11 @@ Http2ClientSession::do_io_close(int alerrno)
 
   this->clear_session_active();
 
+  if (this->_flush_event) {
+    this->_flush_event->cancel();
+    this->_flush_event = nullptr;
+  }
+
   // Clean up the write VIO in case of inactivity timeout
   this->do_io_write(this, 0, nullptr);
 }
@@ -178,6 +183,12 @@ Http2ClientSession::main_event_handler(int event, void *edata)
     this->_reenable_event = nullptr;
     break;
 
+  case HTTP2_SESSION_EVENT_FLUSH:
+    this->_flush_event = nullptr;
+    this->flush();
+    retval = 0;
+    break;
+
   case VC_EVENT_ACTIVE_TIMEOUT:
   case VC_EVENT_INACTIVITY_TIMEOUT:
   case VC_EVENT_ERROR:
@@ -67,6 +67,10 @@ Http2CommonSession::common_free(ProxySession *ssn)
     this->_reenable_event->cancel();
     this->_reenable_event = nullptr;
   }
+  if (this->_flush_event) {
+    this->_flush_event->cancel();
+    this->_flush_event = nullptr;
+  }
 
   // Make sure the we are at the bottom of the stack
   if (this->connection_state.is_recursing() || this->recursion != 0) {
@@ -147,33 +151,58 @@ Http2CommonSession::set_half_close_local_flag(bool flag)
   half_close_local = flag;
 }
 
+/**
+  Serialize @a frame into the write buffer.
+
+  Frames are not handed to the network one by one. If @a flush is set, a flush is scheduled for the end of the current event loop
+  iteration so that frames of all the streams which get ready in the meantime go out in the same write, and are packed into as
+  few TLS records as possible. Otherwise the frame waits for the write size or time threshold.
+ */
 int64_t
 Http2CommonSession::xmit(const Http2TxFrame &frame, bool flush)
 {
   int64_t len = frame.write_to(this->write_buffer);
   this->_pending_sending_data_size += len;
-  // Force flush for some cases
-  if (!flush) {
-    // Flush if we already use half of the buffer to avoid adding a new block to the chain.
-    // A frame size can be 16MB at maximum so blocks can be added, but that's fine.
-    if (this->_pending_sending_data_size >= this->_write_size_threshold) {
-      flush = true;
-    }
-  }
+  ++this->_pending_sending_frame_count;
 
-  if (flush) {
+  // Flush if we already use half of the buffer to avoid adding a new block to the chain.
+  // A frame size can be 16MB at maximum so blocks can be added, but that's fine.
+  if (this->_pending_sending_data_size >= this->_write_size_threshold) {
     this->flush();
+  } else if (flush) {
+    this->schedule_flush();
   }
 
   return len;
 }
 
+/**
+  Flush at the end of the current event loop iteration, unless something else flushes first.
+ */
+void
+Http2CommonSession::schedule_flush()
+{
+  if (this->_pending_sending_data_size > 0 && this->_flush_event == nullptr) {
+    this->_flush_event = this_ethread()->schedule_imm_local(this->get_proxy_session(), HTTP2_SESSION_EVENT_FLUSH);
+  }
+}
+
 void
 Http2CommonSession::flush()
 {
+  if (this->_flush_event) {
+    this->_flush_event->cancel();
+    this->_flush_event = nullptr;
+  }
+
   if (this->_pending_sending_data_size > 0) {
-    this->_pending_sending_data_size = 0;
-    this->_write_buffer_last_flush   = Thread::get_hrtime();
+    EThread *ethread = this_ethread();
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_WRITE_FLUSHES, ethread);
+    HTTP2_SUM_THREAD_DYN_STAT(HTTP2_STAT_WRITE_FLUSHED_FRAMES, ethread, this->_pending_sending_frame_count);
+
+    this->_pending_sending_data_size   = 0;
+    this->_pending_sending_frame_count = 0;
+    this->_write_buffer_last_flush     = Thread::get_hrtime();
     write_reenable();
   }
 }
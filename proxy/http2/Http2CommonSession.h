@@ -33,6 +33,7 @@
 // HTTP2_SESSION_EVENT_FINI   Http2CommonSession *  HTTP/2 session is ended
 // HTTP2_SESSION_EVENT_RECV   Http2Frame *          Received a frame
 // HTTP2_SESSION_EVENT_XMIT   Http2Frame *          Send this frame
+// HTTP2_SESSION_EVENT_FLUSH  Event *               Hand frames queued during the last event loop iteration to the network
 
 #define HTTP2_SESSION_EVENT_INIT (HTTP2_SESSION_EVENTS_START + 1)
 #define HTTP2_SESSION_EVENT_FINI (HTTP2_SESSION_EVENTS_START + 2)
@@ -41,6 +42,7 @@
 #define HTTP2_SESSION_EVENT_SHUTDOWN_INIT (HTTP2_SESSION_EVENTS_START + 5)
 #define HTTP2_SESSION_EVENT_SHUTDOWN_CONT (HTTP2_SESSION_EVENTS_START + 6)
 #define HTTP2_SESSION_EVENT_REENABLE (HTTP2_SESSION_EVENTS_START + 7)
+#define HTTP2_SESSION_EVENT_FLUSH (HTTP2_SESSION_EVENTS_START + 8)
 
 enum class Http2SessionCod : int {
   NOT_PROVIDED,
@@ -82,6 +84,7 @@ public:
   void write_reenable();
   int64_t xmit(const Http2TxFrame &frame, bool flush = true);
   void flush();
+  void schedule_flush();
 
   int64_t get_connection_id();
   Ptr<ProxyMutex> &get_mutex();
@@ -152,9 +155,11 @@ protected:
   std::unordered_set<std::string> *_h2_pushed_urls = nullptr;
 
   Event *_reenable_event = nullptr;
+  Event *_flush_event    = nullptr;
   int _n_frame_read      = 0;
 
-  uint32_t _pending_sending_data_size = 0;
+  uint32_t _pending_sending_data_size   = 0;
+  uint32_t _pending_sending_frame_count = 0;
 
   int64_t read_from_early_data   = 0;
   bool cur_frame_from_early_data = false;
@@ -51,6 +51,9 @@
 
 using http2_frame_dispatch = Http2Error (*)(Http2ConnectionState &, const Http2Frame &);
 
+// Opaque data of the PING frames sent to sample the bandwidth-delay product
+static const uint8_t HTTP2_BDP_PING_OPAQUE_DATA[HTTP2_PING_LEN] = {'A', 'T', 'S', '-', 'B', 'D', 'P', 0};
+
 static const int buffer_size_index[HTTP2_FRAME_TYPE_MAX] = {
   BUFFER_SIZE_INDEX_16K, // HTTP2_FRAME_TYPE_DATA
   BUFFER_SIZE_INDEX_16K, // HTTP2_FRAME_TYPE_HEADERS
@@ -170,6 +173,7 @@ rcv_data_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
   // Update Window size
   cstate.decrement_server_rwnd(payload_length);
   stream->decrement_server_rwnd(payload_length);
+  cstate.sample_received_data(payload_length);
 
   if (is_debug_tag_set("http2_con")) {
     uint32_t rwnd = cstate.server_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE);
@@ -216,6 +220,31 @@ rcv_data_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
   return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
 }
 
+/*
+ * [RFC 9218] 5. The Priority HTTP Header Field
+ *
+ * Called once the request header block is decoded. A PRIORITY_UPDATE frame received before this point takes precedence over the
+ * header field.
+ */
+static void
+set_extensible_priority(Http2ConnectionState &cstate, Http2Stream *stream)
+{
+  if (cstate.priority_scheduler == nullptr || stream->extensible_priority_node != nullptr) {
+    return;
+  }
+
+  ExtensiblePriority::Priority priority;
+  std::string_view value = stream->get_request_header().value_get(ExtensiblePriority::FIELD_NAME);
+  if (!value.empty()) {
+    priority = ExtensiblePriority::parse_priority_field_value(value);
+  }
+
+  stream->extensible_priority_node = cstate.priority_scheduler->add(stream->get_id(), priority, stream);
+  Http2StreamDebug(cstate.session, stream->get_id(), "PRIORITY - urgency: %u, incremental: %d, scheduler size: %u",
+                   stream->extensible_priority_node->priority.urgency, stream->extensible_priority_node->priority.incremental,
+                   cstate.priority_scheduler->size());
+}
+
 /*
  * [RFC 7540] 6.2 HEADERS Frame
  *
@@ -321,7 +350,7 @@ rcv_headers_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
     header_block_fragment_length -= HTTP2_PRIORITY_LEN;
   }
 
-  if (new_stream && Http2::stream_priority_enabled) {
+  if (new_stream && cstate.dependency_tree != nullptr) {
     Http2DependencyTree::Node *node = cstate.dependency_tree->find(stream_id);
     if (node != nullptr) {
       stream->priority_node = node;
@@ -388,6 +417,8 @@ rcv_headers_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
 
     // Set up the State Machine
     if (!empty_request) {
+      set_extensible_priority(cstate, stream);
+
       SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
       stream->mark_milestone(Http2StreamMilestone::START_TXN);
       stream->new_transaction(frame.is_from_early_data());
@@ -452,7 +483,8 @@ rcv_priority_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
                       "PRIORITY frame depends on itself");
   }
 
-  if (!Http2::stream_priority_enabled) {
+  // PRIORITY frames are ignored unless the RFC 7540 dependency tree is in use ([RFC 9218] 2.1.)
+  if (cstate.dependency_tree == nullptr) {
     return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
   }
 
@@ -495,6 +527,83 @@ rcv_priority_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
   return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
 }
 
+/*
+ * [RFC 9218] 7.1. HTTP/2 PRIORITY_UPDATE Frame
+ *
+ */
+static Http2Error
+rcv_priority_update_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
+{
+  const Http2StreamId stream_id = frame.header().streamid;
+  const uint32_t payload_length = frame.header().length;
+
+  Http2StreamDebug(cstate.session, stream_id, "Received PRIORITY_UPDATE frame");
+
+  // PRIORITY_UPDATE frames are sent on the control stream; any other stream identifier is a connection error of type
+  // PROTOCOL_ERROR.
+  if (stream_id != 0) {
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_CONNECTION, Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR,
+                      "priority update non 0 stream_id");
+  }
+
+  if (payload_length < HTTP2_PRIORITY_UPDATE_LEN) {
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_CONNECTION, Http2ErrorCode::HTTP2_ERROR_FRAME_SIZE_ERROR,
+                      "priority update bad length");
+  }
+
+  if (cstate.priority_scheduler == nullptr) {
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
+  }
+
+  uint8_t buf[HTTP2_PRIORITY_UPDATE_LEN] = {0};
+  frame.reader()->memcpy(buf, HTTP2_PRIORITY_UPDATE_LEN, 0);
+
+  Http2StreamId prioritized_stream_id = 0;
+  if (!http2_parse_priority_update(make_iovec(buf, HTTP2_PRIORITY_UPDATE_LEN), prioritized_stream_id)) {
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_CONNECTION, Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR,
+                      "priority update parse error");
+  }
+
+  // Only requests can be reprioritized by a client
+  if (!http2_is_client_streamid(prioritized_stream_id)) {
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_CONNECTION, Http2ErrorCode::HTTP2_ERROR_PROTOCOL_ERROR,
+                      "priority update bad prioritized stream id");
+  }
+
+  // Share the PRIORITY frame rate limit
+  cstate.increment_received_priority_frame_count();
+  if (Http2::max_priority_frames_per_minute != 0 &&
+      cstate.get_received_priority_frame_count() > Http2::max_priority_frames_per_minute) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_MAX_PRIORITY_FRAMES_PER_MINUTE_EXCEEDED, this_ethread());
+    Http2StreamDebug(cstate.session, stream_id, "Observed too frequent priority changes: %u priority changes within a last minute",
+                     cstate.get_received_priority_frame_count());
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_CONNECTION, Http2ErrorCode::HTTP2_ERROR_ENHANCE_YOUR_CALM,
+                      "recv priority update too frequent priority changes");
+  }
+
+  const uint32_t value_length = payload_length - HTTP2_PRIORITY_UPDATE_LEN;
+  char value[ExtensiblePriority::MAX_FIELD_VALUE_LEN];
+  if (value_length > sizeof(value)) {
+    // Far larger than any meaningful set of parameters, leave the priority as it is
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
+  }
+  frame.reader()->memcpy(value, value_length, HTTP2_PRIORITY_UPDATE_LEN);
+
+  ExtensiblePriority::Priority priority = ExtensiblePriority::parse_priority_field_value(std::string_view(value, value_length));
+  Http2StreamDebug(cstate.session, prioritized_stream_id, "PRIORITY_UPDATE - urgency: %u, incremental: %d", priority.urgency,
+                   priority.incremental);
+
+  Http2Stream *stream = cstate.find_stream(prioritized_stream_id);
+  if (stream != nullptr && stream->extensible_priority_node != nullptr) {
+    cstate.priority_scheduler->reprioritize(stream->extensible_priority_node, priority);
+  } else if (stream != nullptr || !cstate.is_valid_streamid(prioritized_stream_id)) {
+    // The request is not open yet, or its header block is still being received
+    cstate.priority_scheduler->reprioritize(prioritized_stream_id, priority);
+  }
+
+  return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
+}
+
 static Http2Error
 rcv_rst_stream_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
 {
@@ -703,6 +812,14 @@ rcv_ping_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
                       "ping bad length");
   }
 
+  frame.reader()->memcpy(opaque_data, HTTP2_PING_LEN, 0);
+
+  // ACKs of the PINGs we sent are not counted as PINGs from the client, unsolicited ones are
+  const bool ack = frame.header().flags & HTTP2_FLAGS_PING_ACK;
+  if (ack && cstate.rcv_ping_ack(opaque_data)) {
+    return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
+  }
+
   // Update PING frame count per minute
   cstate.increment_received_ping_frame_count();
   // Close this connection if its ping count received exceeds a limit
@@ -715,12 +832,10 @@ rcv_ping_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
   }
 
   // An endpoint MUST NOT respond to PING frames containing this flag.
-  if (frame.header().flags & HTTP2_FLAGS_PING_ACK) {
+  if (ack) {
     return Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_NONE);
   }
 
-  frame.reader()->memcpy(opaque_data, HTTP2_PING_LEN, 0);
-
   // ACK (0x1): An endpoint MUST set this flag in PING responses.
   cstate.send_ping_frame(stream_id, HTTP2_FLAGS_PING_ACK, opaque_data);
 
@@ -944,6 +1059,8 @@ rcv_continuation_frame(Http2ConnectionState &cstate, const Http2Frame &frame)
       }
     }
 
+    set_extensible_priority(cstate, stream);
+
     // Set up the State Machine
     SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
     stream->mark_milestone(Http2StreamMilestone::START_TXN);
@@ -1047,8 +1164,10 @@ Http2ConnectionState::init(Http2CommonSession *ssn)
 
   local_hpack_handle  = new HpackHandle(HTTP2_HEADER_TABLE_SIZE);
   remote_hpack_handle = new HpackHandle(HTTP2_HEADER_TABLE_SIZE);
-  if (Http2::stream_priority_enabled) {
+  if (Http2::stream_priority_enabled == HTTP2_STREAM_PRIORITY_RFC7540) {
     dependency_tree = new DependencyTree(Http2::max_concurrent_streams_in);
+  } else if (Http2::stream_priority_enabled == HTTP2_STREAM_PRIORITY_EXTENSIBLE) {
+    priority_scheduler = new ExtensiblePriorityScheduler(Http2::max_concurrent_streams_in);
   }
 
   _cop = ActivityCop<Http2Stream>(this->mutex, &stream_list, 1);
@@ -1073,6 +1192,7 @@ Http2ConnectionState::send_connection_preface()
   Http2ConnectionSettings configured_settings;
   configured_settings.settings_from_configs();
   configured_settings.set(HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, _adjust_concurrent_stream());
+  configured_settings.set(HTTP2_SETTINGS_NO_RFC7540_PRIORITIES, priority_scheduler != nullptr);
 
   send_settings_frame(configured_settings);
 
@@ -1104,7 +1224,9 @@ Http2ConnectionState::destroy()
   remote_hpack_handle = nullptr;
   delete dependency_tree;
   dependency_tree = nullptr;
-  this->session   = nullptr;
+  delete priority_scheduler;
+  priority_scheduler = nullptr;
+  this->session      = nullptr;
 
   if (fini_event) {
     fini_event->cancel();
@@ -1125,7 +1247,7 @@ Http2ConnectionState::rcv_frame(const Http2Frame *frame)
 
   // [RFC 7540] 5.5. Extending HTTP/2
   //   Implementations MUST discard frames that have unknown or unsupported types.
-  if (frame->header().type >= HTTP2_FRAME_TYPE_MAX) {
+  if (frame->header().type >= HTTP2_FRAME_TYPE_MAX && frame->header().type != HTTP2_FRAME_TYPE_PRIORITY_UPDATE) {
     Http2StreamDebug(session, stream_id, "Discard a frame which has unknown type, type=%x", frame->header().type);
     return;
   }
@@ -1141,6 +1263,7 @@ Http2ConnectionState::rcv_frame(const Http2Frame *frame)
   // GOAWAY:        NO
   // WINDOW_UPDATE: YES
   // CONTINUATION:  YES (safe http methods only, same as HEADERS frame).
+  // PRIORITY_UPDATE: YES
   if (frame->is_from_early_data() &&
       (frame->header().type == HTTP2_FRAME_TYPE_DATA || frame->header().type == HTTP2_FRAME_TYPE_RST_STREAM ||
        frame->header().type == HTTP2_FRAME_TYPE_PUSH_PROMISE || frame->header().type == HTTP2_FRAME_TYPE_GOAWAY)) {
@@ -1148,7 +1271,9 @@ Http2ConnectionState::rcv_frame(const Http2Frame *frame)
     return;
   }
 
-  if (frame_handlers[frame->header().type]) {
+  if (frame->header().type == HTTP2_FRAME_TYPE_PRIORITY_UPDATE) {
+    error = rcv_priority_update_frame(*this, *frame);
+  } else if (frame_handlers[frame->header().type]) {
     error = frame_handlers[frame->header().type](*this, *frame);
   } else {
     error = Http2Error(Http2ErrorClass::HTTP2_ERROR_CLASS_CONNECTION, Http2ErrorCode::HTTP2_ERROR_INTERNAL_ERROR, "no handler");
@@ -1421,6 +1546,12 @@ Http2ConnectionState::restart_receiving(Http2Stream *stream)
   uint32_t initial_rwnd = this->server_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE);
   uint32_t min_rwnd     = std::min(initial_rwnd, this->server_settings.get(HTTP2_SETTINGS_MAX_FRAME_SIZE));
 
+  // An auto-tuned window is topped up once half of it is consumed, so that the peer never runs dry within a round trip
+  if (this->_tuned_rwnd > initial_rwnd) {
+    initial_rwnd = this->_tuned_rwnd;
+    min_rwnd     = this->_tuned_rwnd / 2;
+  }
+
   // Connection level WINDOW UPDATE
   if (this->server_rwnd() < min_rwnd) {
     Http2WindowSize diff_size = initial_rwnd - this->server_rwnd();
@@ -1444,6 +1575,53 @@ Http2ConnectionState::restart_receiving(Http2Stream *stream)
   this->send_window_update_frame(stream->get_id(), diff_size);
 }
 
+/**
+  Feed the BDP estimator with received DATA payload, and start a new sample with a PING if none is in progress.
+ */
+void
+Http2ConnectionState::sample_received_data(uint32_t length)
+{
+  if (Http2::max_window_size_in == 0 || this->_tuned_rwnd >= Http2::max_window_size_in) {
+    return;
+  }
+
+  if (this->_bdp_estimator.add_received(length)) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_BDP_PINGS, this_ethread());
+    this->send_ping_frame(0, 0, HTTP2_BDP_PING_OPAQUE_DATA);
+    this->_bdp_estimator.ping_sent(Thread::get_hrtime());
+  }
+}
+
+/**
+  Handle the ACK of a PING. Returns false if it doesn't acknowledge a PING we sent.
+ */
+bool
+Http2ConnectionState::rcv_ping_ack(const uint8_t *opaque_data)
+{
+  if (!this->_bdp_estimator.is_sampling() || memcmp(opaque_data, HTTP2_BDP_PING_OPAQUE_DATA, HTTP2_PING_LEN) != 0) {
+    return false;
+  }
+
+  uint32_t initial_rwnd = this->server_settings.get(HTTP2_SETTINGS_INITIAL_WINDOW_SIZE);
+  uint32_t rwnd         = std::max(initial_rwnd, this->_tuned_rwnd);
+  uint32_t new_rwnd     = this->_bdp_estimator.ping_acked(Thread::get_hrtime(), rwnd, Http2::max_window_size_in);
+
+  Http2ConDebug(session, "BDP sample - rtt: %" PRId64 "us, rwnd: %u, new rwnd: %u", ink_hrtime_to_usec(this->_bdp_estimator.rtt()),
+                rwnd, new_rwnd);
+
+  if (new_rwnd > rwnd) {
+    HTTP2_INCREMENT_THREAD_DYN_STAT(HTTP2_STAT_WINDOW_SIZE_INCREASES, this_ethread());
+    this->_tuned_rwnd = new_rwnd;
+
+    // Open up the connection window right away. Stream windows follow as their data is consumed.
+    Http2WindowSize diff_size = new_rwnd - rwnd;
+    this->increment_server_rwnd(diff_size);
+    this->send_window_update_frame(0, diff_size);
+  }
+
+  return true;
+}
+
 void
 Http2ConnectionState::cleanup_streams()
 {
@@ -1485,7 +1663,7 @@ Http2ConnectionState::delete_stream(Http2Stream *stream)
   Http2StreamDebug(session, stream->get_id(), "Delete stream");
   REMEMBER(NO_EVENT, this->recursion);
 
-  if (Http2::stream_priority_enabled) {
+  if (dependency_tree != nullptr) {
     Http2DependencyTree::Node *node = stream->priority_node;
     if (node != nullptr) {
       if (node->active) {
@@ -1501,6 +1679,10 @@ Http2ConnectionState::delete_stream(Http2Stream *stream)
     }
     stream->priority_node = nullptr;
   }
+  if (priority_scheduler != nullptr && stream->extensible_priority_node != nullptr) {
+    priority_scheduler->remove(stream->extensible_priority_node);
+    stream->extensible_priority_node = nullptr;
+  }
 
   if (stream->get_state() != Http2StreamState::HTTP2_STREAM_STATE_CLOSED) {
     send_rst_stream_frame(stream->get_id(), Http2ErrorCode::HTTP2_ERROR_NO_ERROR);
@@ -1576,11 +1758,18 @@ Http2ConnectionState::schedule_stream(Http2Stream *stream)
 {
   Http2StreamDebug(session, stream->get_id(), "Scheduled");
 
-  Http2DependencyTree::Node *node = stream->priority_node;
-  ink_release_assert(node != nullptr);
-
   SCOPED_MUTEX_LOCK(lock, this->mutex, this_ethread());
-  dependency_tree->activate(node);
+  if (priority_scheduler != nullptr) {
+    // Pushed streams have no request header to take a priority from
+    if (stream->extensible_priority_node == nullptr) {
+      stream->extensible_priority_node = priority_scheduler->add(stream->get_id(), ExtensiblePriority::Priority(), stream);
+    }
+    priority_scheduler->activate(stream->extensible_priority_node);
+  } else {
+    Http2DependencyTree::Node *node = stream->priority_node;
+    ink_release_assert(node != nullptr);
+    dependency_tree->activate(node);
+  }
 
   if (!_scheduled) {
     _scheduled = true;
@@ -1593,6 +1782,11 @@ Http2ConnectionState::schedule_stream(Http2Stream *stream)
 void
 Http2ConnectionState::send_data_frames_depends_on_priority()
 {
+  if (priority_scheduler != nullptr) {
+    send_data_frames_depends_on_extensible_priority();
+    return;
+  }
+
   Http2DependencyTree::Node *node = dependency_tree->top();
 
   // No node to send or no connection level window left
@@ -1635,6 +1829,57 @@ Http2ConnectionState::send_data_frames_depends_on_priority()
   return;
 }
 
+/**
+   [RFC 9218] 10. Server Scheduling
+
+   Send one DATA frame of the most urgent active stream and reschedule. Streams of equal urgency are served in stream id order,
+   or round-robin when they are incremental.
+ */
+void
+Http2ConnectionState::send_data_frames_depends_on_extensible_priority()
+{
+  ExtensiblePriority::Node *node = priority_scheduler->top();
+
+  // No node to send or no connection level window left
+  if (node == nullptr || _client_rwnd <= 0) {
+    return;
+  }
+
+  Http2Stream *stream = static_cast<Http2Stream *>(node->t);
+  ink_release_assert(stream != nullptr);
+  Http2StreamDebug(session, stream->get_id(), "top node, urgency=%u incremental=%d", node->priority.urgency,
+                   node->priority.incremental);
+
+  size_t len                      = 0;
+  Http2SendDataFrameResult result = send_a_data_frame(stream, len);
+
+  switch (result) {
+  case Http2SendDataFrameResult::NO_ERROR: {
+    // No response body to send
+    if (len == 0 && !stream->is_write_vio_done()) {
+      priority_scheduler->deactivate(node);
+    } else {
+      priority_scheduler->update(node, len);
+
+      SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
+      stream->signal_write_event(true);
+    }
+    break;
+  }
+  case Http2SendDataFrameResult::DONE: {
+    priority_scheduler->deactivate(node);
+    stream->initiating_close();
+    break;
+  }
+  default:
+    // When no stream level window left, deactivate node once and wait window_update frame
+    priority_scheduler->deactivate(node);
+    break;
+  }
+
+  this_ethread()->schedule_imm_local((Continuation *)this, HTTP2_SESSION_EVENT_XMIT);
+}
+
 Http2SendDataFrameResult
 Http2ConnectionState::send_a_data_frame(Http2Stream *stream, size_t &payload_length)
 {
@@ -1663,7 +1908,7 @@ Http2ConnectionState::send_a_data_frame(Http2Stream *stream, size_t &payload_len
     // We only need to check for window size when there is a payload
     if (window_size <= 0) {
       Http2StreamDebug(this->session, stream->get_id(), "No window");
-      this->session->flush();
+      this->session->schedule_flush();
       return Http2SendDataFrameResult::NO_WINDOW;
     }
 
@@ -1683,7 +1928,7 @@ Http2ConnectionState::send_a_data_frame(Http2Stream *stream, size_t &payload_len
   // OK if there is no body yet. Otherwise continue on to send a DATA frame and delete the stream
   if (!stream->is_write_vio_done() && payload_length == 0) {
     Http2StreamDebug(this->session, stream->get_id(), "No payload");
-    this->session->flush();
+    this->session->schedule_flush();
     return Http2SendDataFrameResult::NO_PAYLOAD;
   }
 
@@ -1898,7 +2143,7 @@ Http2ConnectionState::send_push_promise_frame(Http2Stream *stream, URL &url, con
   }
 
   SCOPED_MUTEX_LOCK(stream_lock, stream->mutex, this_ethread());
-  if (Http2::stream_priority_enabled) {
+  if (this->dependency_tree != nullptr) {
     Http2DependencyTree::Node *node = this->dependency_tree->find(id);
     if (node != nullptr) {
       stream->priority_node = node;
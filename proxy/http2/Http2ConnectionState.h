@@ -31,7 +31,9 @@
 #include "HPACK.h"
 #include "Http2Stream.h"
 #include "Http2DependencyTree.h"
+#include "ExtensiblePriority.h"
 #include "Http2FrequencyCounter.h"
+#include "Http2BdpEstimator.h"
 
 class Http2CommonSession;
 class Http2Frame;
@@ -80,10 +82,11 @@ public:
 
   ProxyError rx_error_code;
   ProxyError tx_error_code;
-  Http2CommonSession *session      = nullptr;
-  HpackHandle *local_hpack_handle  = nullptr;
-  HpackHandle *remote_hpack_handle = nullptr;
-  DependencyTree *dependency_tree  = nullptr;
+  Http2CommonSession *session                     = nullptr;
+  HpackHandle *local_hpack_handle                 = nullptr;
+  HpackHandle *remote_hpack_handle                = nullptr;
+  DependencyTree *dependency_tree                 = nullptr;
+  ExtensiblePriorityScheduler *priority_scheduler = nullptr;
   ActivityCop<Http2Stream> _cop;
 
   // Settings.
@@ -108,6 +111,8 @@ public:
   void cleanup_streams();
   void restart_receiving(Http2Stream *stream);
   void update_initial_rwnd(Http2WindowSize new_size);
+  void sample_received_data(uint32_t length);
+  bool rcv_ping_ack(const uint8_t *opaque_data);
 
   Http2StreamId get_latest_stream_id_in() const;
   Http2StreamId get_latest_stream_id_out() const;
@@ -125,8 +130,10 @@ public:
   Http2ErrorCode get_shutdown_reason() const;
 
   // HTTP/2 frame sender
+  bool is_stream_priority_enabled() const;
   void schedule_stream(Http2Stream *stream);
   void send_data_frames_depends_on_priority();
+  void send_data_frames_depends_on_extensible_priority();
   void send_data_frames(Http2Stream *stream);
   Http2SendDataFrameResult send_a_data_frame(Http2Stream *stream, size_t &payload_length);
   void send_headers_frame(Http2Stream *stream);
@@ -196,6 +203,10 @@ private:
   std::vector<size_t> _recent_rwnd_increment = {SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX};
   int _recent_rwnd_increment_index           = 0;
 
+  // Receive window auto-tuning, see proxy.config.http2.max_window_size_in. 0 means the advertised initial window size is used.
+  Http2BdpEstimator _bdp_estimator;
+  uint32_t _tuned_rwnd = 0;
+
   Http2FrequencyCounter _received_settings_counter;
   Http2FrequencyCounter _received_settings_frame_counter;
   Http2FrequencyCounter _received_ping_frame_counter;
@@ -308,6 +319,13 @@ Http2ConnectionState::is_recursing() const
   return recursion > 0;
 }
 
+// Whether DATA frames are sent through the dependency tree or the RFC 9218 scheduler, decided when the connection starts.
+inline bool
+Http2ConnectionState::is_stream_priority_enabled() const
+{
+  return dependency_tree != nullptr || priority_scheduler != nullptr;
+}
+
 inline bool
 Http2ConnectionState::is_valid_streamid(Http2StreamId id) const
 {
@@ -41,6 +41,8 @@ Http2DebugNames::get_settings_param_name(uint16_t id)
     return "MAX_FRAME_SIZE";
   case HTTP2_SETTINGS_MAX_HEADER_LIST_SIZE:
     return "MAX_HEADER_LIST_SIZE";
+  case HTTP2_SETTINGS_NO_RFC7540_PRIORITIES:
+    return "NO_RFC7540_PRIORITIES";
   }
 
   return "UNKNOWN";
@@ -788,7 +788,7 @@ Http2Stream::send_response_body(bool call_update)
   Http2ClientSession *h2_proxy_ssn = static_cast<Http2ClientSession *>(this->_proxy_ssn);
   _timeout.update_inactivity();
 
-  if (Http2::stream_priority_enabled) {
+  if (h2_proxy_ssn->connection_state.is_stream_priority_enabled()) {
     SCOPED_MUTEX_LOCK(lock, h2_proxy_ssn->mutex, this_ethread());
     h2_proxy_ssn->connection_state.schedule_stream(this);
     // signal_write_event() will be called from `Http2ConnectionState::send_data_frames_depends_on_priority()`
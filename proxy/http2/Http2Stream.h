@@ -29,6 +29,7 @@
 #include "ProxyTransaction.h"
 #include "Http2DebugNames.h"
 #include "Http2DependencyTree.h"
+#include "ExtensiblePriority.h"
 #include "tscore/History.h"
 #include "Milestones.h"
 
@@ -36,6 +37,7 @@ class Http2Stream;
 class Http2ConnectionState;
 
 typedef Http2DependencyTree::Tree<Http2Stream *> DependencyTree;
+typedef ExtensiblePriority::Scheduler ExtensiblePriorityScheduler;
 
 enum class Http2StreamMilestone {
   OPEN = 0,
@@ -127,6 +129,7 @@ public:
   void update_initial_rwnd(Http2WindowSize new_size);
   bool has_trailing_header() const;
   void set_request_headers(HTTPHdr &h2_headers);
+  const HTTPHdr &get_request_header() const;
   MIOBuffer *read_vio_writer() const;
   int64_t read_vio_read_avail();
 
@@ -142,7 +145,8 @@ public:
   bool is_first_transaction_flag = false;
 
   HTTPHdr response_header;
-  Http2DependencyTree::Node *priority_node = nullptr;
+  Http2DependencyTree::Node *priority_node           = nullptr;
+  ExtensiblePriority::Node *extensible_priority_node = nullptr;
 
 private:
   bool response_is_data_available() const;
@@ -269,6 +273,12 @@ Http2Stream::has_trailing_header() const
   return trailing_header;
 }
 
+inline const HTTPHdr &
+Http2Stream::get_request_header() const
+{
+  return _req_header;
+}
+
 inline void
 Http2Stream::set_request_headers(HTTPHdr &h2_headers)
 {
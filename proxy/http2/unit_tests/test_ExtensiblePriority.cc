@@ -0,0 +1,184 @@
+/** @file
+
+    Unit tests for ExtensiblePriority
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <string>
+
+#include "ExtensiblePriority.h"
+
+using namespace std;
+
+using Scheduler = ExtensiblePriority::Scheduler;
+using Node      = ExtensiblePriority::Node;
+using Priority  = ExtensiblePriority::Priority;
+using ExtensiblePriority::parse_priority_field_value;
+
+TEST_CASE("ExtensiblePriority_parse", "[http2][ExtensiblePriority]")
+{
+  SECTION("defaults")
+  {
+    Priority p = parse_priority_field_value("");
+    REQUIRE(p.urgency == 3);
+    REQUIRE(p.incremental == false);
+  }
+
+  SECTION("urgency and incremental")
+  {
+    Priority p = parse_priority_field_value("u=0, i");
+    REQUIRE(p.urgency == 0);
+    REQUIRE(p.incremental == true);
+
+    p = parse_priority_field_value("i=?1,u=7");
+    REQUIRE(p.urgency == 7);
+    REQUIRE(p.incremental == true);
+
+    p = parse_priority_field_value("u=5, i=?0");
+    REQUIRE(p.urgency == 5);
+    REQUIRE(p.incremental == false);
+  }
+
+  SECTION("invalid and unknown members are ignored")
+  {
+    Priority p = parse_priority_field_value("u=8, i=1, foo=bar");
+    REQUIRE(p.urgency == 3);
+    REQUIRE(p.incremental == false);
+
+    p = parse_priority_field_value("u=-1, u=2;x=y, U=0");
+    REQUIRE(p.urgency == 2);
+  }
+}
+
+/**
+ * Lower urgency value wins, non-incremental streams are served in id order
+ */
+TEST_CASE("ExtensiblePriority_urgency", "[http2][ExtensiblePriority]")
+{
+  Scheduler scheduler(16);
+  string a("A"), b("B"), c("C");
+
+  Node *node_a = scheduler.add(1, parse_priority_field_value("u=3"), &a);
+  Node *node_b = scheduler.add(3, parse_priority_field_value("u=1"), &b);
+  Node *node_c = scheduler.add(5, parse_priority_field_value("u=3"), &c);
+  REQUIRE(scheduler.size() == 3);
+  REQUIRE(scheduler.top() == nullptr);
+
+  scheduler.activate(node_c);
+  scheduler.activate(node_a);
+  REQUIRE(scheduler.top() == node_a);
+
+  scheduler.activate(node_b);
+  REQUIRE(scheduler.top() == node_b);
+
+  // Non-incremental streams keep their turn until deactivated
+  scheduler.update(node_b, 100);
+  REQUIRE(scheduler.top() == node_b);
+  scheduler.deactivate(node_b);
+  REQUIRE(scheduler.top() == node_a);
+  scheduler.deactivate(node_a);
+  REQUIRE(scheduler.top() == node_c);
+
+  scheduler.remove(node_c);
+  REQUIRE(scheduler.top() == nullptr);
+  REQUIRE(scheduler.size() == 2);
+}
+
+/**
+ * Incremental streams of the same urgency are served round-robin, after non-incremental ones
+ */
+TEST_CASE("ExtensiblePriority_incremental", "[http2][ExtensiblePriority]")
+{
+  Scheduler scheduler(16);
+  string a("A"), b("B"), c("C");
+
+  Node *node_a = scheduler.add(1, parse_priority_field_value("i"), &a);
+  Node *node_b = scheduler.add(3, parse_priority_field_value("i"), &b);
+  Node *node_c = scheduler.add(5, Priority(), &c);
+
+  scheduler.activate(node_a);
+  scheduler.activate(node_b);
+  REQUIRE(scheduler.top() == node_a);
+  scheduler.update(node_a, 100);
+  REQUIRE(scheduler.top() == node_b);
+  scheduler.update(node_b, 100);
+  REQUIRE(scheduler.top() == node_a);
+
+  scheduler.activate(node_c);
+  REQUIRE(scheduler.top() == node_c);
+}
+
+/**
+ * Reprioritization of open streams and of streams which are not opened yet
+ */
+TEST_CASE("ExtensiblePriority_reprioritize", "[http2][ExtensiblePriority]")
+{
+  Scheduler scheduler(1);
+  string a("A"), b("B"), c("C");
+
+  Node *node_a = scheduler.add(1, Priority(), &a);
+  Node *node_b = scheduler.add(3, Priority(), &b);
+  scheduler.activate(node_a);
+  scheduler.activate(node_b);
+  REQUIRE(scheduler.top() == node_a);
+
+  scheduler.reprioritize(node_b, parse_priority_field_value("u=2"));
+  REQUIRE(scheduler.top() == node_b);
+  scheduler.reprioritize(node_b, parse_priority_field_value("u=4"));
+  REQUIRE(scheduler.top() == node_a);
+
+  // PRIORITY_UPDATE before HEADERS takes precedence
+  REQUIRE(scheduler.reprioritize(5, parse_priority_field_value("u=0")) == true);
+  REQUIRE(scheduler.reprioritize(7, parse_priority_field_value("u=0")) == false);
+  Node *node_c = scheduler.add(5, parse_priority_field_value("u=6"), &c);
+  REQUIRE(node_c->priority.urgency == 0);
+  scheduler.activate(node_c);
+  REQUIRE(scheduler.top() == node_c);
+}
+
+/**
+ * Walking the active nodes in the order they are served
+ */
+TEST_CASE("ExtensiblePriority_next", "[http2][ExtensiblePriority]")
+{
+  Scheduler scheduler(16);
+  string a("A"), b("B"), c("C"), d("D");
+
+  Node *node_a = scheduler.add(1, parse_priority_field_value("u=1, i"), &a);
+  Node *node_b = scheduler.add(3, parse_priority_field_value("u=1"), &b);
+  Node *node_c = scheduler.add(5, parse_priority_field_value("u=5"), &c);
+  Node *node_d = scheduler.add(7, parse_priority_field_value("u=1"), &d);
+
+  scheduler.activate(node_a);
+  scheduler.activate(node_b);
+  scheduler.activate(node_c);
+  scheduler.activate(node_d);
+
+  REQUIRE(scheduler.top() == node_b);
+  REQUIRE(scheduler.next(node_b) == node_d);
+  REQUIRE(scheduler.next(node_d) == node_a);
+  REQUIRE(scheduler.next(node_a) == node_c);
+  REQUIRE(scheduler.next(node_c) == nullptr);
+
+  scheduler.deactivate(node_a);
+  REQUIRE(scheduler.next(node_d) == node_c);
+}
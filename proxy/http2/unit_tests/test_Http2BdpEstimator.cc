@@ -0,0 +1,79 @@
+/** @file
+
+    Unit tests for Http2BdpEstimator
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "Http2BdpEstimator.h"
+
+TEST_CASE("Http2BdpEstimator_sample", "[http2][Http2BdpEstimator]")
+{
+  Http2BdpEstimator estimator;
+  ink_hrtime now = HRTIME_SECONDS(1);
+
+  // The first DATA frame starts a sample, following ones are accounted to it
+  REQUIRE(estimator.add_received(16384) == true);
+  estimator.ping_sent(now);
+  REQUIRE(estimator.is_sampling());
+  REQUIRE(estimator.add_received(16384) == false);
+  REQUIRE(estimator.add_received(16384) == false);
+
+  SECTION("window is not filled")
+  {
+    REQUIRE(estimator.ping_acked(now + HRTIME_MSECONDS(100), 1048576, 16777216) == 1048576);
+    REQUIRE(estimator.rtt() == HRTIME_MSECONDS(100));
+    REQUIRE(estimator.is_sampling() == false);
+  }
+
+  SECTION("window is filled")
+  {
+    REQUIRE(estimator.ping_acked(now + HRTIME_MSECONDS(100), 65535, 16777216) == 16384 * 3 * 2);
+  }
+
+  SECTION("growth is capped")
+  {
+    REQUIRE(estimator.ping_acked(now + HRTIME_MSECONDS(100), 65535, 70000) == 70000);
+  }
+}
+
+TEST_CASE("Http2BdpEstimator_bandwidth", "[http2][Http2BdpEstimator]")
+{
+  Http2BdpEstimator estimator;
+  ink_hrtime now  = HRTIME_SECONDS(1);
+  uint32_t window = 65535;
+
+  // Bandwidth grows, so does the window
+  REQUIRE(estimator.add_received(65535));
+  estimator.ping_sent(now);
+  window = estimator.ping_acked(now + HRTIME_MSECONDS(100), window, 16777216);
+  REQUIRE(window == 65535 * 2);
+
+  // The window is filled again but over a much longer round trip, which is less bandwidth. The window stays.
+  now += HRTIME_SECONDS(1);
+  REQUIRE(estimator.add_received(100000));
+  estimator.ping_sent(now);
+  REQUIRE(estimator.ping_acked(now + HRTIME_SECONDS(2), window, 16777216) == window);
+  REQUIRE(estimator.rtt() == HRTIME_MSECONDS(290));
+
+  // An acknowledgement without a sample in progress is ignored
+  REQUIRE(estimator.ping_acked(now + HRTIME_SECONDS(1), window, 16777216) == window);
+}
@@ -50,10 +50,14 @@ Http3App::Http3App(QUICNetVConnection *client_vc, IpAllow::ACL &&session_acl, co
   this->_ssn->new_connection(client_vc, nullptr, nullptr);
 
   this->_qc->stream_manager()->set_default_application(this);
+  this->_qc->stream_manager()->set_stream_scheduler(this->_ssn);
 
   this->_settings_handler = new Http3SettingsHandler(this->_ssn);
   this->_control_stream_dispatcher.add_handler(this->_settings_handler);
 
+  this->_priority_update_handler = new Http3PriorityUpdateHandler(this->_ssn);
+  this->_control_stream_dispatcher.add_handler(this->_priority_update_handler);
+
   this->_settings_framer = new Http3SettingsFramer(client_vc->get_context());
   this->_control_stream_collector.add_generator(this->_settings_framer);
 
@@ -62,8 +66,10 @@ Http3App::Http3App(QUICNetVConnection *client_vc, IpAllow::ACL &&session_acl, co
 
 Http3App::~Http3App()
 {
+  this->_qc->stream_manager()->set_stream_scheduler(nullptr);
   delete this->_ssn;
   delete this->_settings_handler;
+  delete this->_priority_update_handler;
   delete this->_settings_framer;
 }
 
@@ -73,18 +79,15 @@ Http3App::start()
   QUICStreamId stream_id;
   QUICConnectionErrorUPtr error;
 
-  error = this->create_uni_stream(stream_id, Http3StreamType::CONTROL);
-
-  // TODO: Open uni streams for QPACK when dynamic table is used
-  // error = this->create_uni_stream(stream_id, Http3StreamType::QPACK_ENCODER);
-  // if (error == nullptr) {
-  //   this->_handle_uni_stream_on_write_ready(VC_EVENT_WRITE_READY, this->_find_stream_io(stream_id));
-  // }
-
-  // error = this->create_uni_stream(stream_id, Http3StreamType::QPACK_DECODER);
-  // if (error == nullptr) {
-  //   this->_handle_uni_stream_on_write_ready(VC_EVENT_WRITE_READY, this->_find_stream_io(stream_id));
-  // }
+  // QPACK doesn't use the dynamic table for encoding until the encoder stream gets ready
+  for (auto type : {Http3StreamType::CONTROL, Http3StreamType::QPACK_ENCODER, Http3StreamType::QPACK_DECODER}) {
+    error = this->create_uni_stream(stream_id, type);
+    if (error != nullptr) {
+      // HTTP/3 can't work without its critical streams
+      this->_qc->close_quic_connection(std::move(error));
+      return;
+    }
+  }
 }
 
 void
@@ -212,7 +215,9 @@ Http3App::_handle_uni_stream_on_read_ready(int /* event */, VIO *vio)
   }
   case Http3StreamType::QPACK_ENCODER:
   case Http3StreamType::QPACK_DECODER: {
-    this->_set_qpack_stream(type, adapter);
+    QPACK *qpack = this->_set_qpack_stream(type, adapter, false);
+    qpack->handleEvent(VC_EVENT_READ_READY, vio);
+    break;
   }
   case Http3StreamType::UNKNOWN:
   default:
@@ -272,7 +277,16 @@ Http3App::_handle_uni_stream_on_write_ready(int /* event */, VIO *vio)
     break;
   case Http3StreamType::QPACK_ENCODER:
   case Http3StreamType::QPACK_DECODER: {
-    this->_set_qpack_stream(it->second, adapter);
+    bool &initialized = it->second == Http3StreamType::QPACK_ENCODER ? this->_is_qpack_encoder_stream_initialized :
+                                                                        this->_is_qpack_decoder_stream_initialized;
+    if (!initialized) {
+      uint8_t buf[] = {static_cast<uint8_t>(it->second)};
+      vio->get_writer()->write(buf, sizeof(uint8_t));
+      initialized = true;
+    }
+    QPACK *qpack = this->_set_qpack_stream(it->second, adapter, true);
+    qpack->handleEvent(VC_EVENT_WRITE_READY, vio);
+    break;
   }
   case Http3StreamType::UNKNOWN:
   case Http3StreamType::PUSH:
@@ -293,24 +307,22 @@ Http3App::_handle_uni_stream_on_eos(int /* event */, VIO *v)
   // TODO: handle eos
 }
 
-void
-Http3App::_set_qpack_stream(Http3StreamType type, QUICStreamVCAdapter *adapter)
+QPACK *
+Http3App::_set_qpack_stream(Http3StreamType type, QUICStreamVCAdapter *adapter, bool is_local)
 {
-  // Change app to QPACK from Http3
+  // Our encoder stream and the peer's decoder stream serve the QPACK encoding our headers (local QPACK), and the others serve the
+  // QPACK decoding the peer's headers (remote QPACK).
   if (type == Http3StreamType::QPACK_ENCODER) {
-    if (this->_qc->direction() == NET_VCONNECTION_IN) {
-      this->_ssn->remote_qpack()->set_encoder_stream(adapter->stream().id());
-    } else {
-      this->_ssn->local_qpack()->set_encoder_stream(adapter->stream().id());
-    }
+    QPACK *qpack = is_local ? this->_ssn->local_qpack() : this->_ssn->remote_qpack();
+    qpack->set_encoder_stream(adapter->stream().id());
+    return qpack;
   } else if (type == Http3StreamType::QPACK_DECODER) {
-    if (this->_qc->direction() == NET_VCONNECTION_IN) {
-      this->_ssn->local_qpack()->set_decoder_stream(adapter->stream().id());
-    } else {
-      this->_ssn->remote_qpack()->set_decoder_stream(adapter->stream().id());
-    }
+    QPACK *qpack = is_local ? this->_ssn->remote_qpack() : this->_ssn->local_qpack();
+    qpack->set_decoder_stream(adapter->stream().id());
+    return qpack;
   } else {
     ink_abort("unknown stream type");
+    return nullptr;
   }
 }
 
@@ -355,21 +367,21 @@ Http3SettingsHandler::handle_frame(std::shared_ptr<const Http3Frame> frame)
   // TODO: Add length check: the maximum number of values are 2^62 - 1, but some fields have shorter maximum than it.
   if (settings_frame->contains(Http3SettingsId::HEADER_TABLE_SIZE)) {
     uint64_t header_table_size = settings_frame->get(Http3SettingsId::HEADER_TABLE_SIZE);
-    this->_session->remote_qpack()->update_max_table_size(header_table_size);
+    this->_session->local_qpack()->update_max_table_size(std::min<uint64_t>(header_table_size, UINT16_MAX));
 
     Debug("http3", "SETTINGS_HEADER_TABLE_SIZE: %" PRId64, header_table_size);
   }
 
   if (settings_frame->contains(Http3SettingsId::MAX_HEADER_LIST_SIZE)) {
     uint64_t max_header_list_size = settings_frame->get(Http3SettingsId::MAX_HEADER_LIST_SIZE);
-    this->_session->remote_qpack()->update_max_header_list_size(max_header_list_size);
+    this->_session->local_qpack()->update_max_header_list_size(std::min<uint64_t>(max_header_list_size, UINT32_MAX));
 
     Debug("http3", "SETTINGS_MAX_HEADER_LIST_SIZE: %" PRId64, max_header_list_size);
   }
 
   if (settings_frame->contains(Http3SettingsId::QPACK_BLOCKED_STREAMS)) {
     uint64_t qpack_blocked_streams = settings_frame->get(Http3SettingsId::QPACK_BLOCKED_STREAMS);
-    this->_session->remote_qpack()->update_max_blocking_streams(qpack_blocked_streams);
+    this->_session->local_qpack()->update_max_blocking_streams(std::min<uint64_t>(qpack_blocked_streams, UINT16_MAX));
 
     Debug("http3", "SETTINGS_QPACK_BLOCKED_STREAMS: %" PRId64, qpack_blocked_streams);
   }
@@ -384,6 +396,47 @@ Http3SettingsHandler::handle_frame(std::shared_ptr<const Http3Frame> frame)
   return Http3ErrorUPtr(new Http3NoError());
 }
 
+//
+// PRIORITY_UPDATE frame handler
+//
+std::vector<Http3FrameType>
+Http3PriorityUpdateHandler::interests()
+{
+  return {Http3FrameType::PRIORITY_UPDATE_REQUEST, Http3FrameType::PRIORITY_UPDATE_PUSH};
+}
+
+Http3ErrorUPtr
+Http3PriorityUpdateHandler::handle_frame(std::shared_ptr<const Http3Frame> frame)
+{
+  const Http3PriorityUpdateFrame *priority_update_frame = dynamic_cast<const Http3PriorityUpdateFrame *>(frame.get());
+
+  if (!priority_update_frame || !priority_update_frame->is_valid()) {
+    return std::make_unique<Http3ConnectionError>(Http3ErrorCode::MALFORMED_FRAME, "malformed PRIORITY_UPDATE frame");
+  }
+
+  // Server push is not supported, so there are no push streams to reprioritize
+  if (frame->type() == Http3FrameType::PRIORITY_UPDATE_PUSH) {
+    return Http3ErrorUPtr(new Http3NoError());
+  }
+
+  // [RFC 9218] 7.2. The Prioritized Element ID of a request must be a client-initiated bidirectional stream
+  QUICStreamId stream_id = priority_update_frame->prioritized_element_id();
+  if (stream_id % 4 != 0) {
+    return std::make_unique<Http3ConnectionError>(Http3ErrorCode::ID_ERROR, "PRIORITY_UPDATE for a non-request stream");
+  }
+
+  ExtensiblePriority::Priority priority =
+    ExtensiblePriority::parse_priority_field_value(priority_update_frame->priority_field_value());
+  Debug("http3", "PRIORITY_UPDATE: stream=%" PRIu64 " urgency=%u incremental=%d", stream_id, priority.urgency, priority.incremental);
+
+  Http3Transaction *txn = static_cast<Http3Transaction *>(this->_session->get_transaction(stream_id));
+  if (txn == nullptr || !txn->reprioritize(priority)) {
+    this->_session->priority_scheduler().reprioritize(stream_id, priority);
+  }
+
+  return Http3ErrorUPtr(new Http3NoError());
+}
+
 //
 // SETTINGS frame framer
 //
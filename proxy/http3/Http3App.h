@@ -40,6 +40,7 @@
 
 class QUICNetVConnection;
 class Http3Session;
+class QPACK;
 
 /**
  * @brief A HTTP/3 application
@@ -73,10 +74,11 @@ private:
   void _handle_bidi_stream_on_write_ready(int event, VIO *vio);
   void _handle_bidi_stream_on_eos(int event, VIO *vio);
 
-  void _set_qpack_stream(Http3StreamType type, QUICStreamVCAdapter *adapter);
+  QPACK *_set_qpack_stream(Http3StreamType type, QUICStreamVCAdapter *adapter, bool is_local);
 
-  Http3FrameHandler *_settings_handler  = nullptr;
-  Http3FrameGenerator *_settings_framer = nullptr;
+  Http3FrameHandler *_settings_handler        = nullptr;
+  Http3FrameHandler *_priority_update_handler = nullptr;
+  Http3FrameGenerator *_settings_framer       = nullptr;
 
   Http3FrameDispatcher _control_stream_dispatcher;
   Http3FrameCollector _control_stream_collector;
@@ -84,7 +86,9 @@ private:
   std::map<QUICStreamId, Http3StreamType> _remote_uni_stream_map;
   std::map<QUICStreamId, Http3StreamType> _local_uni_stream_map;
 
-  bool _is_control_stream_initialized = false;
+  bool _is_control_stream_initialized       = false;
+  bool _is_qpack_encoder_stream_initialized = false;
+  bool _is_qpack_decoder_stream_initialized = false;
 };
 
 class Http3SettingsHandler : public Http3FrameHandler
@@ -101,6 +105,19 @@ private:
   Http3Session *_session = nullptr;
 };
 
+class Http3PriorityUpdateHandler : public Http3FrameHandler
+{
+public:
+  Http3PriorityUpdateHandler(Http3Session *session) : _session(session){};
+
+  // Http3FrameHandler
+  std::vector<Http3FrameType> interests() override;
+  Http3ErrorUPtr handle_frame(std::shared_ptr<const Http3Frame> frame) override;
+
+private:
+  Http3Session *_session = nullptr;
+};
+
 class Http3SettingsFramer : public Http3FrameGenerator
 {
 public:
@@ -44,6 +44,9 @@ Http3DebugNames::frame_type(Http3FrameType type)
     return "GOAWAY";
   case Http3FrameType::DUPLICATE_PUSH_ID:
     return "DUPLICATE_PUSH_ID";
+  case Http3FrameType::PRIORITY_UPDATE_REQUEST:
+  case Http3FrameType::PRIORITY_UPDATE_PUSH:
+    return "PRIORITY_UPDATE";
   case Http3FrameType::UNKNOWN:
   default:
     return "UNKNOWN";
@@ -136,6 +139,8 @@ Http3DebugNames::error_code(uint16_t code)
     return "UNEXPECTED_FRAME";
   case static_cast<uint16_t>(Http3ErrorCode::REQUEST_REJECTED):
     return "REQUEST_REJECTED";
+  case static_cast<uint16_t>(Http3ErrorCode::ID_ERROR):
+    return "ID_ERROR";
   case static_cast<uint16_t>(Http3ErrorCode::QPACK_DECOMPRESSION_FAILED):
     return "QPACK_DECOMPRESSION_FAILED";
   case static_cast<uint16_t>(Http3ErrorCode::QPACK_ENCODER_STREAM_ERROR):
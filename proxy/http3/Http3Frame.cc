@@ -30,6 +30,15 @@ ClassAllocator<Http3Frame> http3FrameAllocator("http3FrameAllocator");
 ClassAllocator<Http3DataFrame> http3DataFrameAllocator("http3DataFrameAllocator");
 ClassAllocator<Http3HeadersFrame> http3HeadersFrameAllocator("http3HeadersFrameAllocator");
 ClassAllocator<Http3SettingsFrame> http3SettingsFrameAllocator("http3SettingsFrameAllocator");
+ClassAllocator<Http3PriorityUpdateFrame> http3PriorityUpdateFrameAllocator("http3PriorityUpdateFrameAllocator");
+
+static bool
+is_known_frame_type(uint64_t type)
+{
+  return type <= static_cast<uint64_t>(Http3FrameType::X_MAX_DEFINED) ||
+         type == static_cast<uint64_t>(Http3FrameType::PRIORITY_UPDATE_REQUEST) ||
+         type == static_cast<uint64_t>(Http3FrameType::PRIORITY_UPDATE_PUSH);
+}
 
 constexpr int HEADER_OVERHEAD = 10; // This should work as long as a payload length is less than 64 bits
 
@@ -51,13 +60,26 @@ Http3Frame::type(const uint8_t *buf, size_t buf_len)
   size_t type_field_length = 0;
   int ret                  = QUICVariableInt::decode(type, type_field_length, buf, buf_len);
   ink_assert(ret != 1);
-  if (type <= static_cast<uint64_t>(Http3FrameType::X_MAX_DEFINED)) {
+  if (is_known_frame_type(type)) {
     return static_cast<Http3FrameType>(type);
   } else {
     return Http3FrameType::UNKNOWN;
   }
 }
 
+uint8_t
+Http3Frame::type_index(Http3FrameType type)
+{
+  switch (type) {
+  case Http3FrameType::PRIORITY_UPDATE_REQUEST:
+    return static_cast<uint8_t>(Http3FrameType::X_MAX_DEFINED) + 1;
+  case Http3FrameType::PRIORITY_UPDATE_PUSH:
+    return static_cast<uint8_t>(Http3FrameType::X_MAX_DEFINED) + 2;
+  default:
+    return static_cast<uint8_t>(type);
+  }
+}
+
 //
 // Generic Frame
 //
@@ -95,7 +117,7 @@ Http3Frame::length() const
 Http3FrameType
 Http3Frame::type() const
 {
-  if (static_cast<uint64_t>(this->_type) <= static_cast<uint64_t>(Http3FrameType::X_MAX_DEFINED)) {
+  if (is_known_frame_type(static_cast<uint64_t>(this->_type))) {
     return this->_type;
   } else {
     return Http3FrameType::UNKNOWN;
@@ -384,6 +406,81 @@ Http3SettingsFrame::set(Http3SettingsId id, uint64_t value)
   this->_settings[id] = value;
 }
 
+//
+// PRIORITY_UPDATE Frame
+//
+
+Http3PriorityUpdateFrame::Http3PriorityUpdateFrame(const uint8_t *buf, size_t buf_len) : Http3Frame(buf, buf_len)
+{
+  size_t len = this->_payload_offset;
+  size_t end = std::min(buf_len, this->total_length());
+  size_t n   = 0;
+
+  if (len >= end || QUICVariableInt::decode(this->_prioritized_element_id, n, buf + len, end - len) != 0) {
+    return;
+  }
+  len += n;
+
+  this->_priority_field_value.assign(reinterpret_cast<const char *>(buf + len), end - len);
+  this->_valid = true;
+}
+
+Http3PriorityUpdateFrame::Http3PriorityUpdateFrame(Http3FrameType type, uint64_t prioritized_element_id,
+                                                   std::string_view priority_field_value)
+  : Http3Frame(type), _valid(true), _prioritized_element_id(prioritized_element_id), _priority_field_value(priority_field_value)
+{
+  this->_length = QUICVariableInt::size(prioritized_element_id) + priority_field_value.size();
+}
+
+Ptr<IOBufferBlock>
+Http3PriorityUpdateFrame::to_io_buffer_block() const
+{
+  Ptr<IOBufferBlock> block;
+  size_t n       = 0;
+  size_t written = 0;
+
+  block = make_ptr<IOBufferBlock>(new_IOBufferBlock());
+  block->alloc(iobuffer_size_to_index(HEADER_OVERHEAD + this->length(), BUFFER_SIZE_INDEX_32K));
+  uint8_t *block_start = reinterpret_cast<uint8_t *>(block->start());
+
+  QUICVariableInt::encode(block_start, UINT64_MAX, n, static_cast<uint64_t>(this->_type));
+  written += n;
+  QUICVariableInt::encode(block_start + written, UINT64_MAX, n, this->_length);
+  written += n;
+  QUICVariableInt::encode(block_start + written, UINT64_MAX, n, this->_prioritized_element_id);
+  written += n;
+  memcpy(block_start + written, this->_priority_field_value.data(), this->_priority_field_value.size());
+  written += this->_priority_field_value.size();
+
+  block->fill(written);
+  return block;
+}
+
+void
+Http3PriorityUpdateFrame::reset(const uint8_t *buf, size_t len)
+{
+  this->~Http3PriorityUpdateFrame();
+  new (this) Http3PriorityUpdateFrame(buf, len);
+}
+
+bool
+Http3PriorityUpdateFrame::is_valid() const
+{
+  return this->_valid;
+}
+
+uint64_t
+Http3PriorityUpdateFrame::prioritized_element_id() const
+{
+  return this->_prioritized_element_id;
+}
+
+std::string_view
+Http3PriorityUpdateFrame::priority_field_value() const
+{
+  return this->_priority_field_value;
+}
+
 //
 // Http3FrameFactory
 //
@@ -413,6 +510,11 @@ Http3FrameFactory::create(const uint8_t *buf, size_t len)
     frame = http3SettingsFrameAllocator.alloc();
     new (frame) Http3SettingsFrame(buf, len, params->max_settings());
     return Http3FrameUPtr(frame, &Http3FrameDeleter::delete_settings_frame);
+  case Http3FrameType::PRIORITY_UPDATE_REQUEST:
+  case Http3FrameType::PRIORITY_UPDATE_PUSH:
+    frame = http3PriorityUpdateFrameAllocator.alloc();
+    new (frame) Http3PriorityUpdateFrame(buf, len);
+    return Http3FrameUPtr(frame, &Http3FrameDeleter::delete_priority_update_frame);
   default:
     // Unknown frame
     Debug("http3_frame_factory", "Unknown frame type %hhx", static_cast<uint8_t>(type));
@@ -435,12 +537,12 @@ Http3FrameFactory::fast_create(const uint8_t *buf, size_t len)
     return this->_unknown_frame;
   }
 
-  std::shared_ptr<Http3Frame> frame = this->_reusable_frames[static_cast<uint8_t>(type)];
+  std::shared_ptr<Http3Frame> frame = this->_reusable_frames[Http3Frame::type_index(type)];
 
   if (frame == nullptr) {
     frame = Http3FrameFactory::create(buf, len);
     if (frame != nullptr) {
-      this->_reusable_frames[static_cast<uint8_t>(type)] = frame;
+      this->_reusable_frames[Http3Frame::type_index(type)] = frame;
     }
   } else {
     frame->reset(buf, len);
@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <string>
+#include <string_view>
+
 #include "tscore/Allocator.h"
 #include "tscore/ink_memory.h"
 #include "tscore/ink_assert.h"
@@ -46,6 +49,11 @@ public:
   virtual void reset(const uint8_t *buf, size_t len);
   static int length(const uint8_t *buf, size_t buf_len, uint64_t &length);
   static Http3FrameType type(const uint8_t *buf, size_t buf_len);
+  /*
+   * Maps a frame type to a slot of the 256 entry per-type tables. Extension frame types do not fit in a byte and take the slots
+   * following X_MAX_DEFINED.
+   */
+  static uint8_t type_index(Http3FrameType type);
 
 protected:
   uint64_t _length       = 0;
@@ -148,11 +156,36 @@ private:
   const char *_error_reason = nullptr;
 };
 
+//
+// PRIORITY_UPDATE Frame
+//
+
+class Http3PriorityUpdateFrame : public Http3Frame
+{
+public:
+  Http3PriorityUpdateFrame() : Http3Frame(Http3FrameType::PRIORITY_UPDATE_REQUEST) {}
+  Http3PriorityUpdateFrame(const uint8_t *buf, size_t len);
+  Http3PriorityUpdateFrame(Http3FrameType type, uint64_t prioritized_element_id, std::string_view priority_field_value);
+
+  Ptr<IOBufferBlock> to_io_buffer_block() const override;
+  void reset(const uint8_t *buf, size_t len) override;
+
+  bool is_valid() const;
+  uint64_t prioritized_element_id() const;
+  std::string_view priority_field_value() const;
+
+private:
+  bool _valid                      = false;
+  uint64_t _prioritized_element_id = 0;
+  std::string _priority_field_value;
+};
+
 using Http3FrameDeleterFunc  = void (*)(Http3Frame *p);
 using Http3FrameUPtr         = std::unique_ptr<Http3Frame, Http3FrameDeleterFunc>;
 using Http3DataFrameUPtr     = std::unique_ptr<Http3DataFrame, Http3FrameDeleterFunc>;
 using Http3HeadersFrameUPtr  = std::unique_ptr<Http3HeadersFrame, Http3FrameDeleterFunc>;
 using Http3SettingsFrameUPtr = std::unique_ptr<Http3SettingsFrame, Http3FrameDeleterFunc>;
+using Http3PriorityUpdateFrameUPtr = std::unique_ptr<Http3PriorityUpdateFrame, Http3FrameDeleterFunc>;
 
 using Http3FrameDeleterFunc = void (*)(Http3Frame *p);
 using Http3FrameUPtr        = std::unique_ptr<Http3Frame, Http3FrameDeleterFunc>;
@@ -163,6 +196,7 @@ extern ClassAllocator<Http3Frame> http3FrameAllocator;
 extern ClassAllocator<Http3DataFrame> http3DataFrameAllocator;
 extern ClassAllocator<Http3HeadersFrame> http3HeadersFrameAllocator;
 extern ClassAllocator<Http3SettingsFrame> http3SettingsFrameAllocator;
+extern ClassAllocator<Http3PriorityUpdateFrame> http3PriorityUpdateFrameAllocator;
 
 class Http3FrameDeleter
 {
@@ -200,6 +234,13 @@ public:
     frame->~Http3Frame();
     http3SettingsFrameAllocator.free(static_cast<Http3SettingsFrame *>(frame));
   }
+
+  static void
+  delete_priority_update_frame(Http3Frame *frame)
+  {
+    frame->~Http3Frame();
+    http3PriorityUpdateFrameAllocator.free(static_cast<Http3PriorityUpdateFrame *>(frame));
+  }
 };
 
 //
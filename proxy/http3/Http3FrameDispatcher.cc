@@ -36,7 +36,7 @@ void
 Http3FrameDispatcher::add_handler(Http3FrameHandler *handler)
 {
   for (Http3FrameType t : handler->interests()) {
-    this->_handlers[static_cast<uint8_t>(t)].push_back(handler);
+    this->_handlers[Http3Frame::type_index(t)].push_back(handler);
   }
 }
 
@@ -103,7 +103,7 @@ Http3FrameDispatcher::on_read_ready(QUICStreamId stream_id, IOBufferReader &read
       // Dispatch
       Http3FrameType type = frame->type();
       Debug("http3", "[RX] [%" PRIu64 "] | %s size=%zu", stream_id, Http3DebugNames::frame_type(type), frame_len);
-      std::vector<Http3FrameHandler *> handlers = this->_handlers[static_cast<uint8_t>(type)];
+      std::vector<Http3FrameHandler *> handlers = this->_handlers[Http3Frame::type_index(type)];
       for (auto h : handlers) {
         error = h->handle_frame(frame);
         if (error->cls != Http3ErrorClass::NONE) {
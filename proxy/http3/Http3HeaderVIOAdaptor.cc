@@ -81,6 +81,12 @@ Http3HeaderVIOAdaptor::is_complete()
   return this->_is_complete;
 }
 
+const HTTPHdr &
+Http3HeaderVIOAdaptor::get_header() const
+{
+  return this->_header;
+}
+
 int
 Http3HeaderVIOAdaptor::event_handler(int event, Event *data)
 {
@@ -38,6 +38,7 @@ public:
   Http3ErrorUPtr handle_frame(std::shared_ptr<const Http3Frame> frame) override;
 
   bool is_complete();
+  const HTTPHdr &get_header() const;
   int event_handler(int event, Event *data);
 
 private:
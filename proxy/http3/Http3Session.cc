@@ -25,6 +25,7 @@
 #include "P_QUICNetVConnection.h"
 
 #include "Http3.h"
+#include "Http3Config.h"
 
 //
 // HQSession
@@ -162,10 +163,15 @@ HQSession::get_transact_count() const
 //
 Http3Session::Http3Session(NetVConnection *vc) : HQSession(vc)
 {
+  Http3Config::scoped_config params;
+
+  // The encoder starts with the default settings and follows the SETTINGS frame from the peer, while the decoder accepts what we
+  // advertise on our SETTINGS frame.
   this->_local_qpack  = new QPACK(static_cast<QUICNetVConnection *>(vc), HTTP3_DEFAULT_MAX_HEADER_LIST_SIZE,
                                  HTTP3_DEFAULT_HEADER_TABLE_SIZE, HTTP3_DEFAULT_QPACK_BLOCKED_STREAMS);
-  this->_remote_qpack = new QPACK(static_cast<QUICNetVConnection *>(vc), HTTP3_DEFAULT_MAX_HEADER_LIST_SIZE,
-                                  HTTP3_DEFAULT_HEADER_TABLE_SIZE, HTTP3_DEFAULT_QPACK_BLOCKED_STREAMS);
+  this->_remote_qpack = new QPACK(static_cast<QUICNetVConnection *>(vc), params->max_header_list_size(),
+                                  std::min<uint32_t>(params->header_table_size(), UINT16_MAX),
+                                  std::min<uint32_t>(params->qpack_blocked_streams(), UINT16_MAX));
 }
 
 Http3Session::~Http3Session()
@@ -205,6 +211,30 @@ Http3Session::remote_qpack()
   return this->_remote_qpack;
 }
 
+Http3Session::PriorityScheduler &
+Http3Session::priority_scheduler()
+{
+  return this->_priority_scheduler;
+}
+
+/**
+   [RFC 9218] 10. Send the data of the most urgent request that has any. Requests stay active until they are closed, the ones with
+   nothing to send, or no flow control credit, are skipped.
+ */
+QUICFrame *
+Http3Session::generate_frame(const std::function<QUICFrame *(QUICStream &)> &generate)
+{
+  for (ExtensiblePriority::Node *node = this->_priority_scheduler.top(); node; node = this->_priority_scheduler.next(node)) {
+    QUICFrame *frame = generate(static_cast<Http3Transaction *>(node->t)->quic_stream());
+    if (frame) {
+      this->_priority_scheduler.update(node, frame->size());
+      return frame;
+    }
+  }
+
+  return nullptr;
+}
+
 //
 // Http09Session
 //
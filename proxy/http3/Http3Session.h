@@ -26,6 +26,8 @@
 #include "ProxySession.h"
 #include "Http3Transaction.h"
 #include "QPACK.h"
+#include "ExtensiblePriority.h"
+#include "QUICStreamManager.h"
 
 class HQSession : public ProxySession
 {
@@ -63,7 +65,7 @@ private:
   char _protocol_string[16];
 };
 
-class Http3Session : public HQSession
+class Http3Session : public HQSession, public QUICStreamScheduler
 {
 public:
   using super = HQSession; ///< Parent type
@@ -79,9 +81,20 @@ public:
   QPACK *local_qpack();
   QPACK *remote_qpack();
 
+  using PriorityScheduler = ExtensiblePriority::Scheduler;
+  PriorityScheduler &priority_scheduler();
+
+  // QUICStreamScheduler
+  QUICFrame *generate_frame(const std::function<QUICFrame *(QUICStream &)> &generate) override;
+
 private:
+  // Upper bound of PRIORITY_UPDATE frames held for requests which are not opened yet
+  static constexpr uint32_t MAX_PENDING_PRIORITY_UPDATES = 100;
+
   QPACK *_remote_qpack = nullptr; // QPACK for decoding
   QPACK *_local_qpack  = nullptr; // QPACK for encoding
+
+  PriorityScheduler _priority_scheduler{MAX_PENDING_PRIORITY_UPDATES};
 };
 
 /**
@@ -228,6 +228,12 @@ HQTransaction::direction() const
   return this->_proxy_ssn->get_netvc()->get_context();
 }
 
+QUICStream &
+HQTransaction::quic_stream()
+{
+  return this->_info.adapter.stream();
+}
+
 /**
  * @brief Replace existing event only if the new event is different than the inprogress event
  */
@@ -394,6 +400,8 @@ Http3Transaction::state_stream_open(int event, void *edata)
     Http3TransDebug("Unknown event %d", event);
   }
 
+  this->_set_priority();
+
   return EVENT_DONE;
 }
 
@@ -432,6 +440,12 @@ void
 Http3Transaction::do_io_close(int lerrno)
 {
   SET_HANDLER(&Http3Transaction::state_stream_closed);
+
+  if (this->_priority_node) {
+    static_cast<Http3Session *>(this->_proxy_ssn)->priority_scheduler().remove(this->_priority_node);
+    this->_priority_node = nullptr;
+  }
+
   super::do_io_close(lerrno);
 }
 
@@ -507,6 +521,45 @@ Http3Transaction::has_request_body(int64_t content_length, bool is_chunked_set)
   return false;
 }
 
+/**
+   Apply a PRIORITY_UPDATE frame. Returns false if the request header is not decoded yet, in which case the priority has to be kept
+   by the session until it is.
+ */
+bool
+Http3Transaction::reprioritize(const ExtensiblePriority::Priority &priority)
+{
+  if (this->_priority_node == nullptr) {
+    return false;
+  }
+
+  static_cast<Http3Session *>(this->_proxy_ssn)->priority_scheduler().reprioritize(this->_priority_node, priority);
+  return true;
+}
+
+/**
+   [RFC 9218] 5. Register the request with the session scheduler once its header is decoded. A PRIORITY_UPDATE frame received
+   before that takes precedence over the Priority header field.
+ */
+void
+Http3Transaction::_set_priority()
+{
+  if (this->_priority_node != nullptr || this->direction() == NET_VCONNECTION_OUT || !this->_header_handler->is_complete()) {
+    return;
+  }
+
+  ExtensiblePriority::Priority priority;
+  std::string_view value = this->_header_handler->get_header().value_get(ExtensiblePriority::FIELD_NAME);
+  if (!value.empty()) {
+    priority = ExtensiblePriority::parse_priority_field_value(value);
+  }
+
+  QUICStreamId stream_id = this->_info.adapter.stream().id();
+  auto &scheduler        = static_cast<Http3Session *>(this->_proxy_ssn)->priority_scheduler();
+  this->_priority_node   = scheduler.add(stream_id, priority, this);
+  scheduler.activate(this->_priority_node);
+  Http3TransDebug("urgency=%u incremental=%d", this->_priority_node->priority.urgency, this->_priority_node->priority.incremental);
+}
+
 //
 // Http09Transaction
 //
@@ -28,6 +28,7 @@
 #include "quic/QUICStreamVCAdapter.h"
 #include "Http3FrameDispatcher.h"
 #include "Http3FrameCollector.h"
+#include "ExtensiblePriority.h"
 
 class QUICStreamIO;
 class HQSession;
@@ -68,6 +69,7 @@ public:
   virtual int state_stream_open(int, void *)             = 0;
   virtual int state_stream_closed(int event, void *data) = 0;
   NetVConnectionContext_t direction() const;
+  QUICStream &quic_stream();
 
 protected:
   virtual int64_t _process_read_vio()  = 0;
@@ -107,9 +109,14 @@ public:
   // TODO:  Just a place holder for now
   bool has_request_body(int64_t content_length, bool is_chunked_set) const override;
 
+  bool reprioritize(const ExtensiblePriority::Priority &priority);
+
 private:
   int64_t _process_read_vio() override;
   int64_t _process_write_vio() override;
+  void _set_priority();
+
+  ExtensiblePriority::Node *_priority_node = nullptr;
 
   // These are for HTTP/3
   Http3FrameDispatcher _frame_dispatcher;
@@ -64,6 +64,10 @@ enum class Http3FrameType : uint64_t {
   DUPLICATE_PUSH_ID = 0x0E,
   X_MAX_DEFINED     = 0x0E,
   UNKNOWN           = 0xFF,
+
+  // [RFC 9218] 7.2. HTTP/3 PRIORITY_UPDATE Frame
+  PRIORITY_UPDATE_REQUEST = 0xF0700,
+  PRIORITY_UPDATE_PUSH    = 0xF0701,
 };
 
 enum class Http3ErrorClass {
@@ -95,6 +99,7 @@ enum class Http3ErrorCode : uint16_t {
   UNEXPECTED_FRAME           = 0x0013,
   REQUEST_REJECTED           = 0x0014,
   MALFORMED_FRAME            = 0x0100,
+  ID_ERROR                   = 0x0108,
   QPACK_DECOMPRESSION_FAILED = 0x200,
   QPACK_ENCODER_STREAM_ERROR = 0x201,
   QPACK_DECODER_STREAM_ERROR = 0x202,
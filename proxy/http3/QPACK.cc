@@ -209,24 +209,36 @@ QPACK::encode(uint64_t stream_id, HTTPHdr &header_set, MIOBuffer *header_block,
 
   uint16_t base_index = this->_largest_known_received_index;
 
+  // Referring entries that have not been acknowledged may block the stream on the decoder side. Only allow it while the number of
+  // blocked streams is below the limit the decoder told us.
+  bool may_block = this->_is_blocking_stream(stream_id) || this->_count_blocking_streams() < this->_max_blocking_streams;
+
   // Compress headers and record the largest reference
   uint16_t referred_index           = 0;
-  uint16_t largest_reference        = 0;
-  uint16_t smallest_reference       = 0;
+  struct EntryReference eref        = {};
   IOBufferBlock *compressed_headers = new_IOBufferBlock();
   compressed_headers->alloc(BUFFER_SIZE_INDEX_2K);
 
   for (auto &field : header_set) {
-    int ret            = this->_encode_header(field, base_index, compressed_headers, referred_index);
-    largest_reference  = std::max(largest_reference, referred_index);
-    smallest_reference = std::min(smallest_reference, referred_index);
+    referred_index = 0;
+    int ret        = this->_encode_header(field, base_index, may_block, compressed_headers, referred_index);
     if (ret < 0) {
+      for (auto index : eref.indices) {
+        this->_dynamic_table.unref_entry(index);
+      }
       compressed_headers->free();
       return ret;
     }
+    if (referred_index) {
+      eref.largest = std::max(eref.largest, referred_index);
+      eref.indices.push_back(referred_index);
+    }
+  }
+  uint16_t largest_reference = eref.largest;
+  if (largest_reference) {
+    // Header blocks that don't refer the dynamic table are never acknowledged
+    this->_references[stream_id].push_back(std::move(eref));
   }
-  struct EntryReference eref = {smallest_reference, largest_reference};
-  this->_references.emplace(stream_id, eref);
 
   // Make an IOBufferBlock for Header Data Prefix
   IOBufferBlock *header_data_prefix = new_IOBufferBlock();
@@ -239,6 +251,10 @@ QPACK::encode(uint64_t stream_id, HTTPHdr &header_set, MIOBuffer *header_block,
   header_block->append_block(compressed_headers);
   header_block_len += compressed_headers->size();
 
+  if (this->_encoder_stream_write_vio && this->_encoder_stream_sending_instructions_reader->is_read_avail_more_than(0)) {
+    this->_encoder_stream_write_vio->reenable();
+  }
+
   return 0;
 }
 
@@ -273,7 +289,28 @@ QPACK::decode(uint64_t stream_id, const uint8_t *header_block, size_t header_blo
     }
   }
 
-  this->_decode(thread, cont, stream_id, header_block, header_block_len, hdr);
+  this->_decode(thread, cont, stream_id, largest_reference, header_block, header_block_len, hdr);
+
+  return 0;
+}
+
+int
+QPACK::cancel(uint64_t stream_id)
+{
+  DecodeRequest *r = this->_blocked_list.head();
+  while (r) {
+    DecodeRequest *next = DecodeRequest::Linkage::next_ptr(r);
+    if (r->stream_id() == stream_id) {
+      this->_blocked_list.erase(r);
+      delete r;
+    }
+    r = next;
+  }
+
+  this->_write_stream_cancellation(stream_id);
+  if (this->_decoder_stream_write_vio) {
+    this->_decoder_stream_write_vio->reenable();
+  }
 
   return 0;
 }
@@ -281,7 +318,8 @@ QPACK::decode(uint64_t stream_id, const uint8_t *header_block, size_t header_blo
 void
 QPACK::set_encoder_stream(QUICStreamId id)
 {
-  this->_encoder_stream_id = id;
+  this->_encoder_stream_id  = id;
+  this->_has_encoder_stream = true;
 }
 
 void
@@ -300,6 +338,12 @@ void
 QPACK::update_max_table_size(uint16_t max_table_size)
 {
   this->_max_table_size = max_table_size;
+
+  // This is called with the capacity the decoder allows; let the decoder know the capacity we actually use
+  if (this->_dynamic_table.update_size(max_table_size)) {
+    this->_write_dynamic_table_size_update(this->_dynamic_table.max_size());
+    QPACKDebug("Wrote Dynamic Table Size Update: max_size=%u", this->_dynamic_table.max_size());
+  }
 }
 
 void
@@ -339,7 +383,8 @@ QPACK::_encode_prefix(uint16_t largest_reference, uint16_t base_index, IOBufferB
 }
 
 int
-QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock *compressed_header, uint16_t &referred_index)
+QPACK::_encode_header(const MIMEField &field, uint16_t base_index, bool may_block, IOBufferBlock *compressed_header,
+                      uint16_t &referred_index)
 {
   Arena arena;
   int name_len;
@@ -354,86 +399,68 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
   // TODO Set never_index flag on/off according to encoding headers
   bool never_index = false;
 
+  // Instructions for the dynamic table can't be sent until we have the encoder stream
+  bool use_dynamic_table = this->_has_encoder_stream && this->_dynamic_table.max_size() > 0;
+
   // Find from tables, and insert / duplicate a entry prior to encode it
   LookupResult lookup_result_static;
   LookupResult lookup_result_dynamic;
   lookup_result_static = StaticTable::lookup(lowered_name, name_len, value, value_len);
-  if (lookup_result_static.match_type != LookupResult::MatchType::EXACT) {
+  if (lookup_result_static.match_type != LookupResult::MatchType::EXACT && use_dynamic_table) {
     lookup_result_dynamic = this->_dynamic_table.lookup(lowered_name, name_len, value, value_len);
     if (lookup_result_dynamic.match_type == LookupResult::MatchType::EXACT) {
       if (this->_dynamic_table.should_duplicate(lookup_result_dynamic.index)) {
-        // Duplicate an entry and use the new entry
+        // Duplicate an entry and use the new entry. Hold the current entry so that the insertion doesn't evict it.
         uint16_t current_index = lookup_result_dynamic.index;
-        lookup_result_dynamic  = this->_dynamic_table.duplicate_entry(current_index);
-        if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE) {
+        this->_dynamic_table.ref_entry(current_index);
+        LookupResult result = this->_dynamic_table.duplicate_entry(current_index);
+        this->_dynamic_table.unref_entry(current_index);
+        if (result.match_type != LookupResult::MatchType::NONE) {
           this->_write_duplicate(current_index);
           QPACKDebug("Wrote Duplicate: current_index=%d", current_index);
-          this->_dynamic_table.ref_entry(current_index);
+          if (may_block || result.index <= base_index) {
+            lookup_result_dynamic = result;
+          }
         }
       }
+    } else if (never_index) {
+      // Sensitive values must not be added to the dynamic table
     } else if (lookup_result_static.match_type == LookupResult::MatchType::NAME) {
-      if (never_index) {
-        // Name in static table is always available. Do nothing.
-      } else {
-        // Insert both the name and the value
-        lookup_result_dynamic = this->_dynamic_table.insert_entry(lowered_name, name_len, value, value_len);
-        if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE) {
-          this->_write_insert_with_name_ref(lookup_result_static.index, false, value, value_len);
-          QPACKDebug("Wrote Insert With Name Ref: index=%u, dynamic_table=%d value=%.*s", lookup_result_static.index, false,
-                     value_len, value);
-        }
+      // Insert both the name and the value
+      LookupResult result = this->_dynamic_table.insert_entry(lowered_name, name_len, value, value_len);
+      if (result.match_type != LookupResult::MatchType::NONE) {
+        lookup_result_dynamic = result;
+        this->_write_insert_with_name_ref(lookup_result_static.index, false, value, value_len);
+        QPACKDebug("Wrote Insert With Name Ref: index=%u, dynamic_table=%d value=%.*s", lookup_result_static.index, false,
+                   value_len, value);
       }
     } else if (lookup_result_dynamic.match_type == LookupResult::MatchType::NAME) {
-      if (never_index) {
-        if (this->_dynamic_table.should_duplicate(lookup_result_dynamic.index)) {
-          // Duplicate an entry and use the new entry
-          uint16_t current_index = lookup_result_dynamic.index;
-          lookup_result_dynamic  = this->_dynamic_table.duplicate_entry(current_index);
-          if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE) {
-            this->_write_duplicate(current_index);
-            QPACKDebug("Wrote Duplicate: current_index=%d", current_index);
-            this->_dynamic_table.ref_entry(current_index);
-          }
-        }
-      } else {
-        if (this->_dynamic_table.should_duplicate(lookup_result_dynamic.index)) {
-          // Duplicate an entry and use the new entry
-          uint16_t current_index = lookup_result_dynamic.index;
-          lookup_result_dynamic  = this->_dynamic_table.duplicate_entry(current_index);
-          if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE) {
-            this->_write_duplicate(current_index);
-            QPACKDebug("Wrote Duplicate: current_index=%d", current_index);
-            this->_dynamic_table.ref_entry(current_index);
-          }
-        } else {
-          // Insert both the name and the value
-          uint16_t current_index = lookup_result_dynamic.index;
-          lookup_result_dynamic  = this->_dynamic_table.insert_entry(lowered_name, name_len, value, value_len);
-          if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE) {
-            this->_write_insert_with_name_ref(current_index, true, value, value_len);
-            QPACKDebug("Wrote Insert With Name Ref: index=%u, dynamic_table=%d, value=%.*s", current_index, true, value_len, value);
-          }
-        }
+      // Insert both the name and the value, referring the name of the current entry
+      uint16_t current_index = lookup_result_dynamic.index;
+      this->_dynamic_table.ref_entry(current_index);
+      LookupResult result = this->_dynamic_table.insert_entry(lowered_name, name_len, value, value_len);
+      this->_dynamic_table.unref_entry(current_index);
+      if (result.match_type != LookupResult::MatchType::NONE) {
+        lookup_result_dynamic = result;
+        this->_write_insert_with_name_ref(current_index, true, value, value_len);
+        QPACKDebug("Wrote Insert With Name Ref: index=%u, dynamic_table=%d, value=%.*s", current_index, true, value_len, value);
       }
     } else {
-      if (never_index) {
-        // Insert only the name
-        lookup_result_dynamic = this->_dynamic_table.insert_entry(lowered_name, name_len, "", 0);
-        if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE) {
-          this->_write_insert_without_name_ref(lowered_name, name_len, "", 0);
-          QPACKDebug("Wrote Insert Without Name Ref: name=%.*s value=%.*s", name_len, lowered_name, 0, "");
-        }
-      } else {
-        // Insert both the name and the value
-        lookup_result_dynamic = this->_dynamic_table.insert_entry(lowered_name, name_len, value, value_len);
-        if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE) {
-          this->_write_insert_without_name_ref(lowered_name, name_len, value, value_len);
-          QPACKDebug("Wrote Insert Without Name Ref: name=%.*s value=%.*s", name_len, lowered_name, value_len, value);
-        }
+      // Insert both the name and the value
+      LookupResult result = this->_dynamic_table.insert_entry(lowered_name, name_len, value, value_len);
+      if (result.match_type != LookupResult::MatchType::NONE) {
+        lookup_result_dynamic = result;
+        this->_write_insert_without_name_ref(lowered_name, name_len, value, value_len);
+        QPACKDebug("Wrote Insert Without Name Ref: name=%.*s value=%.*s", name_len, lowered_name, value_len, value);
       }
     }
   }
 
+  // Entries that the decoder may not have received yet can only be referred if the stream is allowed to block
+  if (lookup_result_dynamic.match_type != LookupResult::MatchType::NONE && lookup_result_dynamic.index > base_index && !may_block) {
+    lookup_result_dynamic = {};
+  }
+
   // Encode
   if (lookup_result_static.match_type == LookupResult::MatchType::EXACT) {
     this->_encode_indexed_header_field(lookup_result_static.index, base_index, false, compressed_header);
@@ -441,7 +468,7 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
                base_index, false);
     referred_index = 0;
   } else if (lookup_result_dynamic.match_type == LookupResult::MatchType::EXACT) {
-    if (lookup_result_dynamic.index < this->_largest_known_received_index) {
+    if (lookup_result_dynamic.index <= base_index) {
       this->_encode_indexed_header_field(lookup_result_dynamic.index, base_index, true, compressed_header);
       QPACKDebug("Encoded Indexed Header Field: abs_index=%d, base_index=%d, dynamic_table=%d", lookup_result_dynamic.index,
                  base_index, true);
@@ -461,7 +488,7 @@ QPACK::_encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock
       lookup_result_static.index, base_index, false, value_len, value, never_index);
     referred_index = 0;
   } else if (lookup_result_dynamic.match_type == LookupResult::MatchType::NAME) {
-    if (lookup_result_dynamic.index <= this->_largest_known_received_index) {
+    if (lookup_result_dynamic.index <= base_index) {
       this->_encode_literal_header_field_with_name_ref(lookup_result_dynamic.index, true, base_index, value, value_len, never_index,
                                                        compressed_header);
       QPACKDebug(
@@ -944,8 +971,8 @@ QPACK::_decode_header(const uint8_t *header_block, size_t header_block_len, HTTP
 }
 
 void
-QPACK::_decode(EThread *ethread, Continuation *cont, uint64_t stream_id, const uint8_t *header_block, size_t header_block_len,
-               HTTPHdr &hdr)
+QPACK::_decode(EThread *ethread, Continuation *cont, uint64_t stream_id, uint16_t largest_reference, const uint8_t *header_block,
+               size_t header_block_len, HTTPHdr &hdr)
 {
   int event;
   int res = this->_decode_header(header_block, header_block_len, hdr);
@@ -954,11 +981,35 @@ QPACK::_decode(EThread *ethread, Continuation *cont, uint64_t stream_id, const u
     QPACKDebug("decoding header failed (%d)", res);
   } else {
     event = QPACK_EVENT_DECODE_COMPLETE;
-    this->_write_header_acknowledgement(stream_id);
+    // Header blocks that don't refer the dynamic table are not acknowledged
+    if (largest_reference) {
+      this->_write_header_acknowledgement(stream_id);
+      this->_acknowledged_insert_count = std::max(this->_acknowledged_insert_count, largest_reference);
+      if (this->_decoder_stream_write_vio) {
+        this->_decoder_stream_write_vio->reenable();
+      }
+    }
   }
   ethread->schedule_imm(cont, event, &hdr);
 }
 
+void
+QPACK::_acknowledge_inserts()
+{
+  uint16_t insert_count = this->_dynamic_table.largest_index();
+  if (insert_count <= this->_acknowledged_insert_count) {
+    return;
+  }
+
+  // Let the encoder know the entries it can refer without blocking streams
+  this->_write_table_state_synchronize(insert_count - this->_acknowledged_insert_count);
+  QPACKDebug("Wrote Table State Synchronize: inserted_count=%d", insert_count - this->_acknowledged_insert_count);
+  this->_acknowledged_insert_count = insert_count;
+  if (this->_decoder_stream_write_vio) {
+    this->_decoder_stream_write_vio->reenable();
+  }
+}
+
 bool
 QPACK::_add_to_blocked_list(DecodeRequest *decode_request)
 {
@@ -973,13 +1024,20 @@ QPACK::_add_to_blocked_list(DecodeRequest *decode_request)
 void
 QPACK::_update_largest_known_received_index_by_insert_count(uint16_t insert_count)
 {
-  this->_largest_known_received_index += insert_count;
+  this->_largest_known_received_index =
+    std::min<uint16_t>(this->_largest_known_received_index + insert_count, this->_dynamic_table.largest_index());
 }
 
 void
 QPACK::_update_largest_known_received_index_by_stream_id(uint64_t stream_id)
 {
-  uint16_t largest_ref_index = this->_references[stream_id].largest;
+  auto it = this->_references.find(stream_id);
+  if (it == this->_references.end()) {
+    return;
+  }
+
+  // Header blocks on a stream are acknowledged in order
+  uint16_t largest_ref_index = it->second.front().largest;
   if (largest_ref_index > this->_largest_known_received_index) {
     this->_largest_known_received_index = largest_ref_index;
   }
@@ -988,19 +1046,72 @@ QPACK::_update_largest_known_received_index_by_stream_id(uint64_t stream_id)
 void
 QPACK::_update_reference_counts(uint64_t stream_id)
 {
-  uint16_t smallest_ref_index = this->_references[stream_id].smallest;
-  if (smallest_ref_index) {
-    this->_dynamic_table.unref_entry(smallest_ref_index);
+  auto it = this->_references.find(stream_id);
+  if (it == this->_references.end()) {
+    return;
+  }
+
+  for (auto index : it->second.front().indices) {
+    this->_dynamic_table.unref_entry(index);
+  }
+  it->second.pop_front();
+  if (it->second.empty()) {
+    this->_references.erase(it);
   }
 }
 
+void
+QPACK::_release_references(uint64_t stream_id)
+{
+  auto it = this->_references.find(stream_id);
+  if (it == this->_references.end()) {
+    return;
+  }
+
+  for (auto &eref : it->second) {
+    for (auto index : eref.indices) {
+      this->_dynamic_table.unref_entry(index);
+    }
+  }
+  this->_references.erase(it);
+}
+
+bool
+QPACK::_is_blocking_stream(uint64_t stream_id) const
+{
+  auto it = this->_references.find(stream_id);
+  if (it == this->_references.end()) {
+    return false;
+  }
+
+  for (auto &eref : it->second) {
+    if (eref.largest > this->_largest_known_received_index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint16_t
+QPACK::_count_blocking_streams() const
+{
+  uint16_t n = 0;
+  for (auto &it : this->_references) {
+    if (this->_is_blocking_stream(it.first)) {
+      ++n;
+    }
+  }
+  return n;
+}
+
 void
 QPACK::_resume_decode()
 {
   DecodeRequest *r = this->_blocked_list.head();
   while (r) {
     if (this->_largest_known_received_index >= r->largest_reference()) {
-      this->_decode(r->thread(), r->continuation(), r->stream_id(), r->header_block(), r->header_block_len(), r->hdr());
+      this->_decode(r->thread(), r->continuation(), r->stream_id(), r->largest_reference(), r->header_block(), r->header_block_len(),
+                    r->hdr());
       DecodeRequest *tmp = r;
       r                  = DecodeRequest::Linkage::next_ptr(r);
       this->_blocked_list.erase(tmp);
@@ -1054,8 +1165,10 @@ QPACK::_on_write_ready(VIO *vio)
   QUICStreamId stream_id = static_cast<QUICStreamVCAdapter *>(vio->vc_server)->stream().id();
 
   if (stream_id == this->_decoder_stream_id) {
+    this->_decoder_stream_write_vio = vio;
     return this->_on_decoder_write_ready(*vio->get_writer());
   } else if (stream_id == this->_encoder_stream_id) {
+    this->_encoder_stream_write_vio = vio;
     return this->_on_encoder_write_ready(*vio->get_writer());
   } else {
     ink_assert(!"The stream ID must match either decoder stream id or decoder stream id");
@@ -1066,30 +1179,31 @@ QPACK::_on_write_ready(VIO *vio)
 int
 QPACK::_on_decoder_stream_read_ready(IOBufferReader &reader)
 {
-  if (reader.is_read_avail_more_than(0)) {
+  while (reader.is_read_avail_more_than(0)) {
     uint8_t buf;
     reader.memcpy(&buf, 1);
     if (buf & 0x80) { // Header Acknowledgement
       uint64_t stream_id;
-      if (this->_read_header_acknowledgement(reader, stream_id) >= 0) {
-        QPACKDebug("Received Header Acknowledgement: stream_id=%" PRIu64, stream_id);
-        this->_update_largest_known_received_index_by_stream_id(stream_id);
-        this->_update_reference_counts(stream_id);
-        this->_references.erase(stream_id);
+      if (this->_read_header_acknowledgement(reader, stream_id) < 0) {
+        break;
       }
+      QPACKDebug("Received Header Acknowledgement: stream_id=%" PRIu64, stream_id);
+      this->_update_largest_known_received_index_by_stream_id(stream_id);
+      this->_update_reference_counts(stream_id);
     } else if (buf & 0x40) { // Stream Cancellation
       uint64_t stream_id;
-      if (this->_read_stream_cancellation(reader, stream_id) >= 0) {
-        QPACKDebug("Received Stream Cancellation: stream_id=%" PRIu64, stream_id);
-        this->_update_reference_counts(stream_id);
-        this->_references.erase(stream_id);
+      if (this->_read_stream_cancellation(reader, stream_id) < 0) {
+        break;
       }
+      QPACKDebug("Received Stream Cancellation: stream_id=%" PRIu64, stream_id);
+      this->_release_references(stream_id);
     } else { // Table State Synchronize
       uint16_t insert_count;
-      if (this->_read_table_state_synchronize(reader, insert_count) >= 0) {
-        QPACKDebug("Received Table State Synchronize: inserted_count=%d", insert_count);
-        this->_update_largest_known_received_index_by_insert_count(insert_count);
+      if (this->_read_table_state_synchronize(reader, insert_count) < 0) {
+        break;
       }
+      QPACKDebug("Received Table State Synchronize: inserted_count=%d", insert_count);
+      this->_update_largest_known_received_index_by_insert_count(insert_count);
     }
   }
 
@@ -1133,7 +1247,10 @@ QPACK::_on_encoder_stream_read_ready(IOBufferReader &reader)
         return EVENT_DONE;
       }
       QPACKDebug("Received Dynamic Table Size Update: max_size=%d", max_size);
-      this->_dynamic_table.update_size(max_size);
+      if (max_size > this->_max_table_size || !this->_dynamic_table.update_size(max_size)) {
+        this->_abort_decode();
+        return EVENT_DONE;
+      }
     } else { // Duplicates
       uint16_t index;
       if (this->_read_duplicate(reader, index) < 0) {
@@ -1147,6 +1264,8 @@ QPACK::_on_encoder_stream_read_ready(IOBufferReader &reader)
     this->_resume_decode();
   }
 
+  this->_acknowledge_inserts();
+
   return EVENT_DONE;
 }
 
@@ -1173,9 +1292,19 @@ QPACK::estimate_header_block_size(const HTTPHdr &hdr)
   return 128 * 1024 * 1024;
 }
 
+uint16_t
+QPACK::StaticTable::size()
+{
+  return countof(STATIC_HEADER_FIELDS);
+}
+
 const QPACK::LookupResult
 QPACK::StaticTable::lookup(uint16_t index, const char **name, int *name_len, const char **value, int *value_len)
 {
+  if (index >= countof(STATIC_HEADER_FIELDS)) {
+    return {index, QPACK::LookupResult::MatchType::NONE};
+  }
+
   const Header &header = STATIC_HEADER_FIELDS[index];
   *name                = header.name;
   *name_len            = header.name_len;
@@ -1247,32 +1376,100 @@ QPACK::_attach_header(HTTPHdr &hdr, const char *name, int name_len, const char *
 //
 // DynamicTable
 //
-QPACK::DynamicTable::DynamicTable(uint16_t size) : _available(size), _max_entries(size), _storage(new DynamicTableStorage(size))
+QPACK::DynamicTable::DynamicTable(uint16_t size) : _max_size(size)
 {
   QPACKDTDebug("Dynamic table size: %u", size);
-  this->_entries      = static_cast<struct DynamicTableEntry *>(ats_malloc(sizeof(struct DynamicTableEntry) * size));
+  this->_allocate(size);
+}
+
+QPACK::DynamicTable::~DynamicTable()
+{
+  this->_release();
+}
+
+void
+QPACK::DynamicTable::_allocate(uint16_t size)
+{
+  this->_max_entries = size;
+  this->_storage     = new DynamicTableStorage(size);
+  if (size) {
+    this->_entries = static_cast<struct DynamicTableEntry *>(ats_malloc(sizeof(struct DynamicTableEntry) * size));
+  }
   this->_entries_head = size - 1;
   this->_entries_tail = size - 1;
 }
 
-QPACK::DynamicTable::~DynamicTable()
+void
+QPACK::DynamicTable::_release()
 {
   if (this->_storage) {
     delete this->_storage;
     this->_storage = nullptr;
   }
   if (this->_entries) {
-    delete this->_entries;
+    ats_free(this->_entries);
     this->_entries = nullptr;
   }
+  this->_max_entries = 0;
+  this->_name_lookup_table.clear();
+  this->_field_lookup_table.clear();
+}
+
+bool
+QPACK::DynamicTable::_is_valid_index(uint16_t index) const
+{
+  uint16_t n_entries = this->_entries_inserted - this->_entries_evicted;
+  return index != 0 && static_cast<uint16_t>(this->_entries_inserted - index) < n_entries;
+}
+
+uint16_t
+QPACK::DynamicTable::_index_to_pos(uint16_t index) const
+{
+  uint16_t distance = this->_entries_inserted - index;
+  return (this->_entries_head + this->_max_entries - distance) % this->_max_entries;
+}
+
+size_t
+QPACK::DynamicTable::_hash(std::string_view name) const
+{
+  return std::hash<std::string_view>{}(name);
+}
+
+size_t
+QPACK::DynamicTable::_hash(std::string_view name, std::string_view value) const
+{
+  size_t h = this->_hash(name);
+  return h ^ (std::hash<std::string_view>{}(value) + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2));
+}
+
+void
+QPACK::DynamicTable::_remove_from_lookup_tables(const DynamicTableEntry &entry)
+{
+  const char *name;
+  const char *value;
+  this->_storage->read(entry.offset, &name, entry.name_len, &value, entry.value_len);
+
+  auto remove = [&entry](std::unordered_multimap<size_t, uint16_t> &table, size_t hash) {
+    auto range = table.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == entry.index) {
+        table.erase(it);
+        break;
+      }
+    }
+  };
+  remove(this->_name_lookup_table, this->_hash({name, entry.name_len}));
+  remove(this->_field_lookup_table, this->_hash({name, entry.name_len}, {value, entry.value_len}));
 }
 
 const QPACK::LookupResult
 QPACK::DynamicTable::lookup(uint16_t index, const char **name, int *name_len, const char **value, int *value_len)
 {
-  // ink_assert(index >= this->_entries[(this->_entries_tail + 1) % this->_max_entries].index);
-  // ink_assert(index <= this->_entries[this->_entries_head].index);
-  uint16_t pos = (this->_entries_head + (index - this->_entries[this->_entries_head].index)) % this->_max_entries;
+  if (!this->_is_valid_index(index)) {
+    return {index, QPACK::LookupResult::MatchType::NONE};
+  }
+
+  uint16_t pos = this->_index_to_pos(index);
   *name_len    = this->_entries[pos].name_len;
   *value_len   = this->_entries[pos].value_len;
   this->_storage->read(this->_entries[pos].offset, name, *name_len, value, *value_len);
@@ -1283,33 +1480,49 @@ const QPACK::LookupResult
 QPACK::DynamicTable::lookup(const char *name, int name_len, const char *value, int value_len)
 {
   QPACK::LookupResult::MatchType match_type = QPACK::LookupResult::MatchType::NONE;
-  uint16_t i                                = this->_entries_tail + 1;
-  int end                                   = this->_entries_head;
   uint16_t candidate_index                  = 0;
   const char *tmp_name                      = nullptr;
   const char *tmp_value                     = nullptr;
 
   // DynamicTable is empty
-  if (this->_entries_inserted == 0) {
+  if (this->_entries_inserted == this->_entries_evicted) {
     return {candidate_index, match_type};
   }
 
-  // TODO Use a tree for better performance
-  for (; i <= end; i = (i + 1) % this->_max_entries) {
-    if (name_len != 0 && this->_entries[i].name_len == name_len) {
-      this->_storage->read(this->_entries[i].offset, &tmp_name, this->_entries[i].name_len, &tmp_value,
-                           this->_entries[i].value_len);
-      if (memcmp(name, tmp_name, name_len) == 0) {
-        candidate_index = this->_entries[i].index;
-        if (value_len == this->_entries[i].value_len && memcmp(value, tmp_value, value_len) == 0) {
-          // Exact match
-          match_type = QPACK::LookupResult::MatchType::EXACT;
-          break;
-        } else {
-          // Name match -- Keep it for no exact matches
-          match_type = QPACK::LookupResult::MatchType::NAME;
-        }
-      }
+  // Prefer the newest entry because it is the farthest from eviction
+  auto newer = [this](uint16_t a, uint16_t b) {
+    return static_cast<uint16_t>(this->_entries_inserted - a) < static_cast<uint16_t>(this->_entries_inserted - b);
+  };
+
+  auto range = this->_field_lookup_table.equal_range(this->_hash({name, static_cast<size_t>(name_len)},
+                                                                 {value, static_cast<size_t>(value_len)}));
+  for (auto it = range.first; it != range.second; ++it) {
+    const DynamicTableEntry &entry = this->_entries[this->_index_to_pos(it->second)];
+    if (entry.name_len != name_len || entry.value_len != value_len) {
+      continue;
+    }
+    this->_storage->read(entry.offset, &tmp_name, entry.name_len, &tmp_value, entry.value_len);
+    if (memcmp(name, tmp_name, name_len) == 0 && memcmp(value, tmp_value, value_len) == 0 &&
+        (match_type == QPACK::LookupResult::MatchType::NONE || newer(entry.index, candidate_index))) {
+      candidate_index = entry.index;
+      match_type      = QPACK::LookupResult::MatchType::EXACT;
+    }
+  }
+  if (match_type == QPACK::LookupResult::MatchType::EXACT) {
+    return {candidate_index, match_type};
+  }
+
+  range = this->_name_lookup_table.equal_range(this->_hash({name, static_cast<size_t>(name_len)}));
+  for (auto it = range.first; it != range.second; ++it) {
+    const DynamicTableEntry &entry = this->_entries[this->_index_to_pos(it->second)];
+    if (entry.name_len != name_len) {
+      continue;
+    }
+    this->_storage->read(entry.offset, &tmp_name, entry.name_len, &tmp_value, entry.value_len);
+    if (memcmp(name, tmp_name, name_len) == 0 &&
+        (match_type == QPACK::LookupResult::MatchType::NONE || newer(entry.index, candidate_index))) {
+      candidate_index = entry.index;
+      match_type      = QPACK::LookupResult::MatchType::NAME;
     }
   }
 
@@ -1325,53 +1538,96 @@ QPACK::DynamicTable::insert_entry(bool is_static, uint16_t index, const char *va
   int dummy_len;
 
   if (is_static) {
+    if (index >= StaticTable::size()) {
+      return {UINT16_C(0), QPACK::LookupResult::MatchType::NONE};
+    }
     StaticTable::lookup(index, &name, &name_len, &dummy, &dummy_len);
-  } else {
-    this->lookup(index, &name, &name_len, &dummy, &dummy_len);
+    return this->insert_entry(name, name_len, value, value_len);
   }
-  return this->insert_entry(name, name_len, value, value_len);
-}
 
-const QPACK::LookupResult
-QPACK::DynamicTable::insert_entry(const char *name, uint16_t name_len, const char *value, uint16_t value_len)
-{
-  if (this->_max_entries == 0) {
+  if (this->lookup(index, &name, &name_len, &dummy, &dummy_len).match_type == QPACK::LookupResult::MatchType::NONE) {
     return {UINT16_C(0), QPACK::LookupResult::MatchType::NONE};
   }
+  // The referred entry may be evicted by the insertion
+  char *duped_name          = ats_strndup(name, name_len);
+  const LookupResult result = this->insert_entry(duped_name, name_len, value, value_len);
+  ats_free(duped_name);
+
+  return result;
+}
+
+uint32_t
+QPACK::DynamicTable::_entry_size(uint16_t name_len, uint16_t value_len)
+{
+  return name_len + value_len + ENTRY_OVERHEAD;
+}
 
-  // Check if we can make enough space to insert a new entry
-  uint16_t required_len = name_len + value_len;
-  uint16_t available    = this->_available;
-  uint16_t tail         = (this->_entries_tail + 1) % this->_max_entries;
-  while (available < required_len) {
-    if (this->_entries[tail].ref_count) {
+bool
+QPACK::DynamicTable::_evict(uint32_t required_len)
+{
+  uint16_t n_entries = this->_entries_inserted - this->_entries_evicted;
+
+  // Check if we can make enough space without evicting entries that are still referred
+  int32_t required  = static_cast<int32_t>(required_len);
+  int32_t available = static_cast<int32_t>(this->_max_size) - this->_used;
+  uint16_t n_evict  = 0;
+  uint16_t pos      = (this->_entries_tail + 1) % this->_max_entries;
+  while ((available < required || n_entries - n_evict >= this->_max_entries) && n_evict < n_entries) {
+    if (this->_entries[pos].ref_count) {
       break;
     }
-    available += this->_entries[tail].name_len + this->_entries[tail].value_len;
-    tail = (tail + 1) % this->_max_entries;
+    available += _entry_size(this->_entries[pos].name_len, this->_entries[pos].value_len);
+    pos = (pos + 1) % this->_max_entries;
+    ++n_evict;
+  }
+  if (available < required || n_entries - n_evict >= this->_max_entries) {
+    // We can't make the space because some stream(s) refer an entry that need to be evicted
+    return false;
   }
-  if (available < required_len) {
-    // We can't insert a new entry because some stream(s) refer an entry that need to be evicted
+
+  for (uint16_t i = 0; i < n_evict; ++i) {
+    this->_entries_tail            = (this->_entries_tail + 1) % this->_max_entries;
+    const DynamicTableEntry &entry = this->_entries[this->_entries_tail];
+    uint32_t size                  = _entry_size(entry.name_len, entry.value_len);
+    QPACKDTDebug("Evict entry: index=%u, size=%u", entry.index, size);
+    this->_remove_from_lookup_tables(entry);
+    this->_storage->erase(entry.name_len, entry.value_len);
+    this->_used -= size;
+    this->_bytes_evicted += size;
+    ++this->_entries_evicted;
+  }
+
+  return true;
+}
+
+const QPACK::LookupResult
+QPACK::DynamicTable::insert_entry(const char *name, uint16_t name_len, const char *value, uint16_t value_len)
+{
+  if (this->_max_entries == 0) {
     return {UINT16_C(0), QPACK::LookupResult::MatchType::NONE};
   }
 
-  // Evict
-  if (this->_available != available) {
-    QPACKDTDebug("Evict entries: from %u to %u", this->_entries[(this->_entries_tail + 1) % this->_max_entries].index,
-                 this->_entries[tail - 1].index);
-    this->_available    = available;
-    this->_entries_tail = tail - 1;
-    QPACKDTDebug("Available size: %u", this->_available);
+  uint32_t required_len = _entry_size(name_len, value_len);
+  if (required_len > this->_max_size || !this->_evict(required_len)) {
+    return {UINT16_C(0), QPACK::LookupResult::MatchType::NONE};
   }
 
   // Insert
   this->_entries_head                 = (this->_entries_head + 1) % this->_max_entries;
-  this->_entries[this->_entries_head] = {++this->_entries_inserted, this->_storage->write(name, name_len, value, value_len),
-                                         name_len, value_len, 0};
-  this->_available -= required_len;
-
-  QPACKDTDebug("Insert Entry: entry=%u, index=%u, size=%u", this->_entries_head, this->_entries_inserted, name_len + value_len);
-  QPACKDTDebug("Available size: %u", this->_available);
+  this->_entries[this->_entries_head] = {++this->_entries_inserted,
+                                         this->_storage->write(name, name_len, value, value_len),
+                                         name_len,
+                                         value_len,
+                                         0,
+                                         this->_bytes_inserted};
+  this->_used += required_len;
+  this->_bytes_inserted += required_len;
+
+  this->_name_lookup_table.emplace(this->_hash({name, name_len}), this->_entries_inserted);
+  this->_field_lookup_table.emplace(this->_hash({name, name_len}, {value, value_len}), this->_entries_inserted);
+
+  QPACKDTDebug("Insert Entry: entry=%u, index=%u, size=%u", this->_entries_head, this->_entries_inserted, required_len);
+  QPACKDTDebug("Available size: %u", this->_max_size - this->_used);
   return {this->_entries_inserted, value_len ? LookupResult::MatchType::EXACT : LookupResult::MatchType::NAME};
 }
 
@@ -1385,7 +1641,9 @@ QPACK::DynamicTable::duplicate_entry(uint16_t current_index)
   char *duped_name;
   char *duped_value;
 
-  this->lookup(current_index, &name, &name_len, &value, &value_len);
+  if (this->lookup(current_index, &name, &name_len, &value, &value_len).match_type == QPACK::LookupResult::MatchType::NONE) {
+    return {UINT16_C(0), QPACK::LookupResult::MatchType::NONE};
+  }
   // We need to dup name and value to avoid memcpy-param-overlap
   duped_name                = ats_strndup(name, name_len);
   duped_value               = ats_strndup(value, value_len);
@@ -1399,29 +1657,56 @@ QPACK::DynamicTable::duplicate_entry(uint16_t current_index)
 bool
 QPACK::DynamicTable::should_duplicate(uint16_t index)
 {
-  // TODO: Check whether a specified entry should be duplicated
-  // Just return false for now
-  return false;
+  if (!this->_is_valid_index(index)) {
+    return false;
+  }
+
+  // An entry in the oldest quarter of a table that is mostly used is going to be evicted soon. Refer a fresh copy instead so that
+  // the old one can be evicted.
+  const DynamicTableEntry &entry = this->_entries[this->_index_to_pos(index)];
+  uint64_t distance_from_tail    = entry.position + _entry_size(entry.name_len, entry.value_len) - this->_bytes_evicted;
+  return this->_used > this->_max_size / 4 * 3 && distance_from_tail <= this->_max_size / 4;
 }
 
-void
+bool
 QPACK::DynamicTable::update_size(uint16_t max_size)
 {
-  // TODO Implement it
+  if (max_size > this->_max_entries) {
+    // Storage can be reallocated only while there are no entries
+    if (this->_entries_inserted != this->_entries_evicted) {
+      return false;
+    }
+    this->_release();
+    this->_allocate(max_size);
+  }
+
+  uint16_t current_max_size = this->_max_size;
+  this->_max_size           = max_size;
+  if (this->_max_entries && !this->_evict(0)) {
+    this->_max_size = current_max_size;
+    return false;
+  }
+
+  QPACKDTDebug("Dynamic table size: %u", max_size);
+  return true;
 }
 
 void
 QPACK::DynamicTable::ref_entry(uint16_t index)
 {
-  uint16_t pos = (this->_entries_head + (index - this->_entries[this->_entries_head].index)) % this->_max_entries;
-  ++this->_entries[pos].ref_count;
+  if (this->_is_valid_index(index)) {
+    ++this->_entries[this->_index_to_pos(index)].ref_count;
+  }
 }
 
 void
 QPACK::DynamicTable::unref_entry(uint16_t index)
 {
-  uint16_t pos = (this->_entries_head + (index - this->_entries[this->_entries_head].index)) % this->_max_entries;
-  --this->_entries[pos].ref_count;
+  if (this->_is_valid_index(index)) {
+    uint16_t pos = this->_index_to_pos(index);
+    ink_assert(this->_entries[pos].ref_count > 0);
+    --this->_entries[pos].ref_count;
+  }
 }
 
 uint16_t
@@ -1430,6 +1715,12 @@ QPACK::DynamicTable::largest_index() const
   return this->_entries_inserted;
 }
 
+uint16_t
+QPACK::DynamicTable::max_size() const
+{
+  return this->_max_size;
+}
+
 int
 QPACK::_write_insert_with_name_ref(uint16_t index, bool dynamic, const char *value, uint16_t value_len)
 {
@@ -1515,6 +1806,9 @@ QPACK::_write_duplicate(uint16_t index)
   char *buf_end = buf + instruction->write_avail();
   int written   = 0;
 
+  // Duplicate
+  buf[0] = 0x00;
+
   // Index
   int ret;
   if ((ret = xpack_encode_integer(reinterpret_cast<uint8_t *>(buf + written), reinterpret_cast<uint8_t *>(buf_end), index, 5)) <
@@ -1568,6 +1862,9 @@ QPACK::_write_table_state_synchronize(uint16_t insert_count)
   char *buf_end = buf + instruction->write_avail();
   int written   = 0;
 
+  // Table State Synchronize
+  buf[0] = 0x00;
+
   // Insert Count
   int ret;
   if ((ret = xpack_encode_integer(reinterpret_cast<uint8_t *>(buf + written), reinterpret_cast<uint8_t *>(buf_end), insert_count,
@@ -1578,7 +1875,7 @@ QPACK::_write_table_state_synchronize(uint16_t insert_count)
 
   // Finalize and Schedule to send
   instruction->fill(written);
-  this->_encoder_stream_sending_instructions->append_block(instruction);
+  this->_decoder_stream_sending_instructions->append_block(instruction);
 
   return 0;
 }
@@ -1606,7 +1903,7 @@ QPACK::_write_header_acknowledgement(uint64_t stream_id)
 
   // Finalize and Schedule to send
   instruction->fill(written);
-  this->_encoder_stream_sending_instructions->append_block(instruction);
+  this->_decoder_stream_sending_instructions->append_block(instruction);
 
   return 0;
 }
@@ -1626,7 +1923,7 @@ QPACK::_write_stream_cancellation(uint64_t stream_id)
 
   // Stream ID
   int ret;
-  if ((ret = xpack_encode_integer(reinterpret_cast<uint8_t *>(buf + written), reinterpret_cast<uint8_t *>(buf_end), stream_id, 7)) <
+  if ((ret = xpack_encode_integer(reinterpret_cast<uint8_t *>(buf + written), reinterpret_cast<uint8_t *>(buf_end), stream_id, 6)) <
       0) {
     return ret;
   }
@@ -1634,7 +1931,7 @@ QPACK::_write_stream_cancellation(uint64_t stream_id)
 
   // Finalize and Schedule to send
   instruction->fill(written);
-  this->_encoder_stream_sending_instructions->append_block(instruction);
+  this->_decoder_stream_sending_instructions->append_block(instruction);
 
   return 0;
 }
@@ -1816,7 +2113,7 @@ QPACK::_read_stream_cancellation(IOBufferReader &reader, uint64_t &stream_id)
 
 QPACK::DynamicTableStorage::DynamicTableStorage(uint16_t size) : _head(size * 2 - 1), _tail(size * 2 - 1)
 {
-  this->_data_size           = size * 2;
+  this->_data_size           = static_cast<uint32_t>(size) * 2;
   this->_data                = reinterpret_cast<uint8_t *>(ats_malloc(this->_data_size));
   this->_overwrite_threshold = size;
 }
@@ -1830,17 +2127,17 @@ QPACK::DynamicTableStorage::~DynamicTableStorage()
 }
 
 void
-QPACK::DynamicTableStorage::read(uint16_t offset, const char **name, uint16_t name_len, const char **value,
+QPACK::DynamicTableStorage::read(uint32_t offset, const char **name, uint16_t name_len, const char **value,
                                  uint16_t value_len) const
 {
   *name  = reinterpret_cast<const char *>(this->_data + offset);
   *value = reinterpret_cast<const char *>(this->_data + offset + name_len);
 }
 
-uint16_t
+uint32_t
 QPACK::DynamicTableStorage::write(const char *name, uint16_t name_len, const char *value, uint16_t value_len)
 {
-  uint16_t offset = (this->_head + 1) % this->_data_size;
+  uint32_t offset = (this->_head + 1) % this->_data_size;
   memcpy(this->_data + offset, name, name_len);
   memcpy(this->_data + offset + name_len, value, value_len);
 
@@ -23,7 +23,11 @@
 
 #pragma once
 
+#include <deque>
 #include <map>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include "I_EventSystem.h"
 #include "I_Event.h"
@@ -97,6 +101,7 @@ private:
   public:
     static const LookupResult lookup(uint16_t index, const char **name, int *name_len, const char **value, int *value_len);
     static const LookupResult lookup(const char *name, int name_len, const char *value, int value_len);
+    static uint16_t size();
 
   private:
     static const Header STATIC_HEADER_FIELDS[];
@@ -104,10 +109,12 @@ private:
 
   struct DynamicTableEntry {
     uint16_t index     = 0;
-    uint16_t offset    = 0;
+    uint32_t offset    = 0;
     uint16_t name_len  = 0;
     uint16_t value_len = 0;
     uint16_t ref_count = 0;
+    // Total bytes inserted before this entry; used to find out how close to eviction the entry is
+    uint64_t position = 0;
   };
 
   class DynamicTableStorage
@@ -115,16 +122,16 @@ private:
   public:
     DynamicTableStorage(uint16_t size);
     ~DynamicTableStorage();
-    void read(uint16_t offset, const char **name, uint16_t name_len, const char **value, uint16_t value_len) const;
-    uint16_t write(const char *name, uint16_t name_len, const char *value, uint16_t value_len);
+    void read(uint32_t offset, const char **name, uint16_t name_len, const char **value, uint16_t value_len) const;
+    uint32_t write(const char *name, uint16_t name_len, const char *value, uint16_t value_len);
     void erase(uint16_t name_len, uint16_t value_len);
 
   private:
-    uint16_t _overwrite_threshold = 0;
+    uint32_t _overwrite_threshold = 0;
     uint8_t *_data                = nullptr;
-    uint16_t _data_size           = 0;
-    uint16_t _head                = 0;
-    uint16_t _tail                = 0;
+    uint32_t _data_size           = 0;
+    uint32_t _head                = 0;
+    uint32_t _tail                = 0;
   };
 
   class DynamicTable
@@ -139,14 +146,32 @@ private:
     const LookupResult insert_entry(const char *name, uint16_t name_len, const char *value, uint16_t value_len);
     const LookupResult duplicate_entry(uint16_t current_index);
     bool should_duplicate(uint16_t index);
-    void update_size(uint16_t max_size);
+    bool update_size(uint16_t max_size);
     void ref_entry(uint16_t index);
     void unref_entry(uint16_t index);
     uint16_t largest_index() const;
+    uint16_t max_size() const;
 
   private:
-    uint16_t _available        = 0;
+    bool _is_valid_index(uint16_t index) const;
+    uint16_t _index_to_pos(uint16_t index) const;
+    // RFC 9204 3.2.1: the size of an entry is the length of its name and value plus 32 bytes
+    static constexpr uint32_t ENTRY_OVERHEAD = 32;
+    static uint32_t _entry_size(uint16_t name_len, uint16_t value_len);
+
+    bool _evict(uint32_t required_len);
+    void _allocate(uint16_t size);
+    void _release();
+    size_t _hash(std::string_view name) const;
+    size_t _hash(std::string_view name, std::string_view value) const;
+    void _remove_from_lookup_tables(const DynamicTableEntry &entry);
+
+    uint16_t _max_size         = 0;
+    uint16_t _used             = 0;
     uint16_t _entries_inserted = 0;
+    uint16_t _entries_evicted  = 0;
+    uint64_t _bytes_inserted   = 0;
+    uint64_t _bytes_evicted    = 0;
 
     // FIXME It may be better to split this array into small arrays to reduce memory footprint
     struct DynamicTableEntry *_entries = nullptr;
@@ -154,6 +179,10 @@ private:
     uint16_t _entries_head             = 0;
     uint16_t _entries_tail             = 0;
     DynamicTableStorage *_storage      = nullptr;
+
+    // Hashes of names and of name-value pairs to absolute indexes. Collisions are resolved by comparing the stored entry.
+    std::unordered_multimap<size_t, uint16_t> _name_lookup_table;
+    std::unordered_multimap<size_t, uint16_t> _field_lookup_table;
   };
 
   class DecodeRequest
@@ -242,13 +271,14 @@ private:
     DecodeRequest *_prev = nullptr;
   };
 
+  // Dynamic table entries referred by a header block that has not been acknowledged yet
   struct EntryReference {
-    uint16_t smallest;
-    uint16_t largest;
+    uint16_t largest = 0;
+    std::vector<uint16_t> indices;
   };
 
   DynamicTable _dynamic_table;
-  std::map<uint64_t, struct EntryReference> _references;
+  std::map<uint64_t, std::deque<struct EntryReference>> _references;
   uint32_t _max_header_list_size = 0;
   uint16_t _max_table_size       = 0;
   uint16_t _max_blocking_streams = 0;
@@ -267,6 +297,13 @@ private:
   void _update_largest_known_received_index_by_stream_id(uint64_t stream_id);
 
   void _update_reference_counts(uint64_t stream_id);
+  void _release_references(uint64_t stream_id);
+  bool _is_blocking_stream(uint64_t stream_id) const;
+  uint16_t _count_blocking_streams() const;
+
+  // Insert count the decoder has already told the encoder about
+  uint16_t _acknowledged_insert_count = 0;
+  void _acknowledge_inserts();
 
   // Encoder Stream
   int _read_insert_with_name_ref(IOBufferReader &reader, bool &is_static, uint16_t &index, Arena &arena, char **value,
@@ -290,7 +327,8 @@ private:
 
   // Request and Push Streams
   int _encode_prefix(uint16_t largest_reference, uint16_t base_index, IOBufferBlock *prefix);
-  int _encode_header(const MIMEField &field, uint16_t base_index, IOBufferBlock *compressed_header, uint16_t &referred_index);
+  int _encode_header(const MIMEField &field, uint16_t base_index, bool may_block, IOBufferBlock *compressed_header,
+                     uint16_t &referred_index);
   int _encode_indexed_header_field(uint16_t index, uint16_t base_index, bool dynamic_table, IOBufferBlock *compressed_header);
   int _encode_indexed_header_field_with_postbase_index(uint16_t index, uint16_t base_index, bool never_index,
                                                        IOBufferBlock *compressed_header);
@@ -301,8 +339,8 @@ private:
   int _encode_literal_header_field_with_postbase_name_ref(uint16_t index, uint16_t base_index, const char *value, int value_len,
                                                           bool never_index, IOBufferBlock *compressed_header);
 
-  void _decode(EThread *ethread, Continuation *cont, uint64_t stream_id, const uint8_t *header_block, size_t header_block_len,
-               HTTPHdr &hdr);
+  void _decode(EThread *ethread, Continuation *cont, uint64_t stream_id, uint16_t largest_reference, const uint8_t *header_block,
+               size_t header_block_len, HTTPHdr &hdr);
   int _decode_header(const uint8_t *header_block, size_t header_block_len, HTTPHdr &hdr);
   int _decode_indexed_header_field(int16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr, uint32_t &header_len);
   int _decode_indexed_header_field_with_postbase_index(int16_t base_index, const uint8_t *buf, size_t buf_len, HTTPHdr &hdr,
@@ -333,6 +371,13 @@ private:
   uint64_t _encoder_stream_id = 0;
   uint64_t _decoder_stream_id = 9999;
 
+  // The dynamic table is not used for encoding until the encoder stream is available
+  bool _has_encoder_stream = false;
+
+  // Write VIOs of the streams, to be reenabled when new instructions are queued
+  VIO *_encoder_stream_write_vio = nullptr;
+  VIO *_decoder_stream_write_vio = nullptr;
+
   // Chain of sending instructions
   MIOBuffer *_encoder_stream_sending_instructions;
   MIOBuffer *_decoder_stream_sending_instructions;
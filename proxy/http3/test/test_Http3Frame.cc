@@ -156,6 +156,27 @@ TEST_CASE("Load SETTINGS Frame", "[http3]")
   }
 }
 
+TEST_CASE("Load PRIORITY_UPDATE Frame", "[http3]")
+{
+  uint8_t buf[] = {
+    0x80, 0x0f, 0x07, 0x00, // Type
+    0x05,                   // Length
+    0x04,                   // Prioritized Element ID
+    'u',  '=',  '1',  ',',  // Priority Field Value
+  };
+
+  std::shared_ptr<const Http3Frame> frame = Http3FrameFactory::create(buf, sizeof(buf));
+  CHECK(frame->type() == Http3FrameType::PRIORITY_UPDATE_REQUEST);
+  CHECK(frame->length() == 5);
+
+  std::shared_ptr<const Http3PriorityUpdateFrame> priority_update_frame =
+    std::dynamic_pointer_cast<const Http3PriorityUpdateFrame>(frame);
+  CHECK(priority_update_frame);
+  CHECK(priority_update_frame->is_valid());
+  CHECK(priority_update_frame->prioritized_element_id() == 4);
+  CHECK(priority_update_frame->priority_field_value() == "u=1,");
+}
+
 TEST_CASE("Store SETTINGS Frame", "[http3]")
 {
   SECTION("Normal")
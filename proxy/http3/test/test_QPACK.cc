@@ -472,3 +472,145 @@ TEST_CASE("Decoding", "[qpack-decode]")
     }
   }
 }
+
+static HTTPHdr *
+make_request(const char *name, const char *value)
+{
+  HTTPHdr *hdr = new HTTPHdr();
+  hdr->create(HTTP_TYPE_REQUEST);
+  MIMEField *field = hdr->field_create(name, strlen(name));
+  hdr->field_attach(field);
+  hdr->field_value_set(field, value, strlen(value));
+  return hdr;
+}
+
+// Encodes a request made of one field, and returns the Required Insert Count in the prefix of the header block; 0 if the block
+// doesn't refer the dynamic table.
+static uint8_t
+encode_field(QPACK *qpack, uint64_t stream_id, const char *name, const char *value, IOBufferReader **header_block = nullptr)
+{
+  HTTPHdr *hdr                 = make_request(name, value);
+  MIOBuffer *block             = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  IOBufferReader *block_reader = block->alloc_reader();
+  uint64_t block_len           = 0;
+
+  REQUIRE(qpack->encode(stream_id, *hdr, block, block_len) == 0);
+  uint8_t required_insert_count = 0;
+  block_reader->memcpy(&required_insert_count, 1);
+
+  if (header_block) {
+    *header_block = block_reader;
+  } else {
+    free_MIOBuffer(block);
+  }
+  hdr->destroy();
+  delete hdr;
+
+  return required_insert_count;
+}
+
+TEST_CASE("Dynamic table", "[qpack-dynamic-table]")
+{
+  // "x-test" and a value of 20 bytes take 58 bytes of the table with the overhead of 32 bytes per entry
+  const char *value_a = "aaaaaaaaaaaaaaaaaaaa";
+  const char *value_b = "bbbbbbbbbbbbbbbbbbbb";
+  const char *value_c = "cccccccccccccccccccc";
+
+  QUICApplicationDriver driver;
+
+  SECTION("Entries take 32 bytes more than their name and value")
+  {
+    QPACK *qpack                   = new QPACK(driver.get_connection(), UINT32_MAX, 64, 100);
+    TestQUICStream *encoder_stream = new TestQUICStream(0);
+    qpack->on_new_stream(*encoder_stream);
+    qpack->set_encoder_stream(encoder_stream->id());
+
+    // 6 + 20 + 32 fits, 6 + 30 + 32 doesn't
+    CHECK(encode_field(qpack, 1, "x-test", value_a) != 0);
+    CHECK(encode_field(qpack, 2, "x-long", "dddddddddddddddddddddddddddddd") == 0);
+  }
+
+  SECTION("Entries referred by unacknowledged header blocks are not evicted")
+  {
+    QPACK *qpack                   = new QPACK(driver.get_connection(), UINT32_MAX, 128, 100);
+    TestQUICStream *encoder_stream = new TestQUICStream(0);
+    TestQUICStream *decoder_stream = new TestQUICStream(10);
+    qpack->on_new_stream(*encoder_stream);
+    qpack->on_new_stream(*decoder_stream);
+    qpack->set_encoder_stream(encoder_stream->id());
+    qpack->set_decoder_stream(decoder_stream->id());
+
+    // Distinct names so that no field refers the name of another entry
+    CHECK(encode_field(qpack, 1, "x-test", value_a) != 0);
+    CHECK(encode_field(qpack, 2, "x-tesu", value_b) != 0);
+
+    // Inserting a third entry needs to evict the first one, which stream 1 still refers
+    CHECK(encode_field(qpack, 3, "x-tesv", value_c) == 0);
+
+    // Once the header block of stream 1 is acknowledged, the first entry can be evicted
+    acknowledge_header_block(decoder_stream, 1);
+    CHECK(encode_field(qpack, 4, "x-tesv", value_c) != 0);
+
+    // The second entry is still there, the first one is gone
+    CHECK(encode_field(qpack, 5, "x-tesu", value_b) != 0);
+    CHECK(encode_field(qpack, 6, "x-test", value_a) == 0);
+  }
+
+  SECTION("The encoder doesn't refer unacknowledged entries beyond the blocked stream limit")
+  {
+    QPACK *qpack                   = new QPACK(driver.get_connection(), UINT32_MAX, 128, 0);
+    TestQUICStream *encoder_stream = new TestQUICStream(0);
+    qpack->on_new_stream(*encoder_stream);
+    qpack->set_encoder_stream(encoder_stream->id());
+
+    // The entry is inserted, but the decoder may not have it yet when it gets the header block
+    CHECK(encode_field(qpack, 1, "x-test", value_a) == 0);
+  }
+
+  SECTION("Header blocks wait for the entries they refer")
+  {
+    QPACK *encoder                 = new QPACK(driver.get_connection(), UINT32_MAX, 128, 100);
+    TestQUICStream *encoder_stream = new TestQUICStream(0);
+    encoder->on_new_stream(*encoder_stream);
+    encoder->set_encoder_stream(encoder_stream->id());
+
+    IOBufferReader *block_1 = nullptr;
+    IOBufferReader *block_2 = nullptr;
+    CHECK(encode_field(encoder, 1, "x-test", value_a, &block_1) != 0);
+    CHECK(encode_field(encoder, 2, "x-test", value_b, &block_2) != 0);
+
+    uint8_t instructions[1024];
+    uint8_t header_block_1[128];
+    uint8_t header_block_2[128];
+    size_t instructions_len   = encoder_stream->read(instructions, sizeof(instructions));
+    size_t header_block_1_len = block_1->read(header_block_1, sizeof(header_block_1));
+    size_t header_block_2_len = block_2->read(header_block_2, sizeof(header_block_2));
+    REQUIRE(instructions_len > 0);
+
+    TestQPACKEventHandler *event_handler = new TestQPACKEventHandler();
+    QPACK *decoder                       = new QPACK(driver.get_connection(), UINT32_MAX, 128, 1);
+    TestQUICStream *peer_encoder_stream  = new TestQUICStream(0);
+    decoder->on_new_stream(*peer_encoder_stream);
+
+    HTTPHdr hdr_1;
+    HTTPHdr hdr_2;
+    hdr_1.create(HTTP_TYPE_REQUEST);
+    hdr_2.create(HTTP_TYPE_REQUEST);
+
+    // The first stream blocks, the second one exceeds the limit of blocked streams
+    CHECK(decoder->decode(1, header_block_1, header_block_1_len, hdr_1, event_handler, eventProcessor.all_ethreads[0]) == 1);
+    CHECK(decoder->decode(2, header_block_2, header_block_2_len, hdr_2, event_handler, eventProcessor.all_ethreads[0]) == -2);
+
+    // Receiving the insertions resumes the first stream
+    peer_encoder_stream->write(instructions, instructions_len, 0, false);
+    sleep(1);
+    CHECK(event_handler->last_event() == QPACK_EVENT_DECODE_COMPLETE);
+
+    int value_len     = 0;
+    const char *value = hdr_1.value_get("x-test", 6, &value_len);
+    CHECK(std::string_view(value, value_len) == value_a);
+
+    hdr_1.destroy();
+    hdr_2.destroy();
+  }
+}
@@ -32,6 +32,9 @@
  class.
 
  ***************************************************************************/
+#include <algorithm>
+#include <vector>
+
 #include "tscore/ink_platform.h"
 #include "tscore/TSSystemState.h"
 #include "P_EventSystem.h"
@@ -55,6 +58,9 @@
 
 #define PERIODIC_TASKS_INTERVAL_FALLBACK 5
 
+// buffers written to a file by a single writev()
+#define FLUSH_MAX_IOV 64
+
 // Log global objects
 LogObject *Log::error_log = nullptr;
 LogFieldList Log::global_field_list;
@@ -64,9 +70,11 @@ Log::LoggingMode Log::logging_mode = LOG_MODE_NONE;
 EventNotify *Log::preproc_notify;
 EventNotify *Log::flush_notify;
 InkAtomicList *Log::flush_data_list;
+std::atomic<int64_t> *Log::flush_queue_bytes;
 
 // Log private objects
 int Log::preproc_threads;
+int Log::flush_threads;
 int Log::init_status                  = 0;
 int Log::config_flags                 = 0;
 bool Log::logging_mode_changed        = false;
@@ -146,12 +154,15 @@ Log::change_configuration()
   such as checking the amount of space used, seeing if it's time to roll
   files, and flushing idle log buffers.  Most of these tasks require having
   exclusive access to the back-end structures, which is controlled by the
-  flush_thread.  Therefore, we will simply instruct the flush thread to
-  execute a periodic_tasks() function once per period.  To ensure that the
-  tasks are executed AT LEAST once each period, we'll register a call-back
-  with the system and trigger the flush thread's condition variable.  To
-  ensure that the tasks are executed AT MOST once per period, the flush
-  thread will keep track of executions per period.
+  flush threads.  Therefore, we will simply instruct the first flush thread
+  to execute a periodic_tasks() function once per period.  The other flush
+  threads keep writing their files meanwhile, a file that is rolled or
+  reopened is locked with its m_flush_mutex, so that its own flush thread
+  waits for the roll to complete.  To ensure that the tasks are executed
+  AT LEAST once each period, we'll register a call-back with the system and
+  trigger the flush thread's condition variable.  To ensure that the tasks
+  are executed AT MOST once per period, the flush thread will keep track of
+  executions per period.
   -------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------
@@ -1004,6 +1015,7 @@ void
 Log::init(int flags)
 {
   preproc_threads = 1;
+  flush_threads   = 1;
 
   // store the configuration flags
   //
@@ -1025,6 +1037,7 @@ Log::init(int flags)
 
     config->read_configuration_variables();
     preproc_threads = config->preproc_threads;
+    flush_threads   = config->flush_threads;
 
     int val = static_cast<int>(REC_ConfigReadInteger("proxy.config.log.logging_enabled"));
     if (val < LOG_MODE_NONE || val > LOG_MODE_FULL) {
@@ -1083,9 +1096,9 @@ Log::init_when_enabled()
 
     LogConfig::register_mgmt_callbacks();
 
-    // create the flush thread
+    // create the flush threads
     create_threads();
-    eventProcessor.schedule_every(new PeriodicWakeup(preproc_threads, 1), HRTIME_SECOND, ET_CALL);
+    eventProcessor.schedule_every(new PeriodicWakeup(preproc_threads, flush_threads), HRTIME_SECOND, ET_CALL);
 
     init_status |= FULLY_INITIALIZED;
   }
@@ -1115,16 +1128,54 @@ Log::create_threads()
     eventProcessor.spawn_thread(preproc_cont, desc, stacksize);
   }
 
-  // Now, only one flush thread is supported.
-  // TODO: Enable multiple flush threads, such as
-  //       one flush thread per file.
+  // start the flush threads, each log file is written by one of them so
+  // that the buffers of a file are written in the order they were queued.
   //
-  flush_notify    = new EventNotify;
-  flush_data_list = new InkAtomicList;
+  flush_notify      = new EventNotify[flush_threads];
+  flush_data_list   = new InkAtomicList[flush_threads];
+  flush_queue_bytes = new std::atomic<int64_t>[flush_threads];
+
+  for (int i = 0; i < flush_threads; i++) {
+    flush_queue_bytes[i] = 0;
+    ink_atomiclist_init(&flush_data_list[i], "Logging flush buffer list", 0);
+    Continuation *flush_cont = new LoggingFlushContinuation(i);
+    sprintf(desc, "[LOG_FLUSH %d]", i);
+    eventProcessor.spawn_thread(flush_cont, desc, stacksize);
+  }
+}
+
+/*-------------------------------------------------------------------------
+  Log::push_flush_data
+
+  Queue data for the flush thread of its log file. If the flush queue of
+  that thread already holds proxy.config.log.max_flush_queue_mb, the data
+  is dropped so that the queue can not grow without bound while the disk
+  does not keep up. Returns false if the data was dropped.
+  -------------------------------------------------------------------------*/
+
+bool
+Log::push_flush_data(LogFlushData *fdata)
+{
+  int idx           = fdata->m_logfile->m_flush_idx % flush_threads;
+  int64_t limit     = config->max_flush_queue_mb * LOG_MEGABYTE;
+  ProxyMutex *mutex = this_thread()->mutex.get();
+
+  if (limit > 0 && flush_queue_bytes[idx] + fdata->m_len > limit) {
+    SiteThrottledWarning("log flush queue is full, have dropped (%d) bytes for %s.", fdata->m_len, fdata->m_logfile->get_name());
+
+    RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat, fdata->m_len);
+    RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_flush_buffers_dropped_stat, 1);
+    delete fdata;
+    return false;
+  }
 
-  ink_atomiclist_init(flush_data_list, "Logging flush buffer list", 0);
-  Continuation *flush_cont = new LoggingFlushContinuation(0);
-  eventProcessor.spawn_thread(flush_cont, "[LOG_FLUSH]", stacksize);
+  flush_queue_bytes[idx] += fdata->m_len;
+  RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_flush_queue_depth_stat, 1);
+
+  fdata->m_queued = Thread::get_hrtime();
+  ink_atomiclist_push(&flush_data_list[idx], fdata);
+  flush_notify[idx].signal();
+  return true;
 }
 
 /*-------------------------------------------------------------------------
@@ -1330,106 +1381,173 @@ Log::preproc_thread_main(void *args)
   return nullptr;
 }
 
-void *
-Log::flush_thread_main(void * /* args ATS_UNUSED */)
-{
-  LogBuffer *logbuffer;
-  LogFlushData *fdata;
-  ink_hrtime now, last_time = 0;
-  int len, total_bytes;
-  SLL<LogFlushData, LogFlushData::Link_link> link, invert_link;
-  ProxyMutex *mutex = this_thread()->mutex.get();
+/*-------------------------------------------------------------------------
+  flush_logfile
 
-  Log::flush_notify->lock();
+  Write the data queued for a log file, FLUSH_MAX_IOV buffers at a time.
+  The file is locked while it is written so that it is not rolled or
+  reopened in the middle of a write.
+  -------------------------------------------------------------------------*/
 
-  while (true) {
-    if (TSSystemState::is_event_system_shut_down()) {
-      return nullptr;
-    }
-    fdata = static_cast<LogFlushData *>(ink_atomiclist_popall(flush_data_list));
+static void
+flush_logfile(LogFile *logfile, LogFlushData **fdata, int count, ProxyMutex *mutex)
+{
+  struct iovec iov[FLUSH_MAX_IOV];
+  int64_t total_bytes   = 0;
+  int64_t bytes_written = 0;
+  int done              = 0;
 
-    // invert the list
-    //
-    link.head = fdata;
-    while ((fdata = link.pop())) {
-      invert_link.push(fdata);
-    }
+  for (int i = 0; i < count; i++) {
+    total_bytes += fdata[i]->m_len;
+  }
 
-    // process each flush data
-    //
-    while ((fdata = invert_link.pop())) {
-      char *buf         = nullptr;
-      int bytes_written = 0;
-      LogFile *logfile  = fdata->m_logfile.get();
+  ink_scoped_mutex_lock lock(logfile->m_flush_mutex);
 
-      if (logfile->m_file_format == LOG_FILE_BINARY) {
-        logbuffer                      = static_cast<LogBuffer *>(fdata->m_data);
-        LogBufferHeader *buffer_header = logbuffer->header();
+  // make sure we're open & ready to write
+  logfile->check_fd();
+  if (!logfile->is_open()) {
+    SiteThrottledWarning("File:%s was closed, have dropped (%" PRId64 ") bytes.", logfile->get_name(), total_bytes);
 
-        buf         = reinterpret_cast<char *>(buffer_header);
-        total_bytes = buffer_header->byte_count;
+    RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat, total_bytes);
+    RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_flush_buffers_dropped_stat, count);
+    return;
+  }
 
-      } else if (logfile->m_file_format == LOG_FILE_ASCII || logfile->m_file_format == LOG_FILE_PIPE) {
-        buf         = static_cast<char *>(fdata->m_data);
-        total_bytes = fdata->m_len;
+  int logfilefd = logfile->get_fd();
+  // This should always be true because we just checked it.
+  ink_assert(logfilefd >= 0);
 
+  // write *all* data to target file as much as possible
+  //
+  while (done < count) {
+    if (Log::config->logging_space_exhausted) {
+      Debug("log", "logging space exhausted, failed to write file:%s, have dropped (%" PRId64 ") bytes.", logfile->get_name(),
+            total_bytes - bytes_written);
+      break;
+    }
+
+    int n = 0;
+    for (; n < FLUSH_MAX_IOV && done + n < count; n++) {
+      LogFlushData *fd = fdata[done + n];
+      if (logfile->m_file_format == LOG_FILE_BINARY) {
+        iov[n].iov_base = static_cast<LogBuffer *>(fd->m_data)->header();
       } else {
-        ink_release_assert(!"Unknown file format type!");
+        iov[n].iov_base = fd->m_data;
       }
+      iov[n].iov_len = fd->m_len;
+    }
 
-      // make sure we're open & ready to write
-      logfile->check_fd();
-      if (!logfile->is_open()) {
-        SiteThrottledWarning("File:%s was closed, have dropped (%d) bytes.", logfile->get_name(), total_bytes);
+    struct iovec *vec = iov;
+    int vec_count     = n;
+    while (vec_count > 0) {
+      ssize_t len = ::writev(logfilefd, vec, vec_count);
 
-        RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat, total_bytes);
-        delete fdata;
-        continue;
+      if (len < 0) {
+        SiteThrottledError("Failed to write log to %s: [tried %" PRId64 ", wrote %" PRId64 ", %s]", logfile->get_name(),
+                           total_bytes - bytes_written, bytes_written, strerror(errno));
+        break;
+      }
+      Debug("log", "Successfully wrote some stuff to %s", logfile->get_name());
+      bytes_written += len;
+
+      // skip what was written, a partial write leaves the rest of a buffer
+      while (vec_count > 0 && static_cast<size_t>(len) >= vec->iov_len) {
+        len -= vec->iov_len;
+        ++vec;
+        --vec_count;
       }
+      if (vec_count > 0) {
+        vec->iov_base = static_cast<char *>(vec->iov_base) + len;
+        vec->iov_len -= len;
+      }
+    }
+    if (vec_count > 0) {
+      break;
+    }
+    done += n;
+  }
 
-      int logfilefd = logfile->get_fd();
-      // This should always be true because we just checked it.
-      ink_assert(logfilefd >= 0);
+  if (done < count) {
+    RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat, total_bytes - bytes_written);
+    RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_flush_buffers_dropped_stat, count - done);
+  }
+  RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_written_to_disk_stat, bytes_written);
 
-      // write *all* data to target file as much as possible
-      //
-      while (total_bytes - bytes_written) {
-        if (Log::config->logging_space_exhausted) {
-          Debug("log", "logging space exhausted, failed to write file:%s, have dropped (%d) bytes.", logfile->get_name(),
-                (total_bytes - bytes_written));
+  if (logfile->m_log) {
+    ink_atomic_increment(&logfile->m_log->m_bytes_written, bytes_written);
+  }
+}
 
-          RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat,
-                         total_bytes - bytes_written);
-          break;
-        }
+void *
+Log::flush_thread_main(void *args)
+{
+  int idx = *static_cast<int *>(args);
+  LogFlushData *fdata;
+  ink_hrtime now, last_time = 0;
+  SLL<LogFlushData, LogFlushData::Link_link> link;
+  std::vector<LogFlushData *> batch;
+  ProxyMutex *mutex = this_thread()->mutex.get();
 
-        len = ::write(logfilefd, &buf[bytes_written], total_bytes - bytes_written);
+  Log::flush_notify[idx].lock();
 
-        if (len < 0) {
-          SiteThrottledError("Failed to write log to %s: [tried %d, wrote %d, %s]", logfile->get_name(),
-                             total_bytes - bytes_written, bytes_written, strerror(errno));
+  while (true) {
+    if (TSSystemState::is_event_system_shut_down()) {
+      return nullptr;
+    }
+    fdata = static_cast<LogFlushData *>(ink_atomiclist_popall(&flush_data_list[idx]));
 
-          RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_lost_before_written_to_disk_stat,
-                         total_bytes - bytes_written);
-          break;
-        }
-        Debug("log", "Successfully wrote some stuff to %s", logfile->get_name());
-        bytes_written += len;
-      }
+    // the list is in reverse order, put it back in the order the data was
+    // queued and group the data of each file, keeping that order.
+    //
+    batch.clear();
+    link.head = fdata;
+    while ((fdata = link.pop())) {
+      batch.push_back(fdata);
+    }
+    std::reverse(batch.begin(), batch.end());
+    std::stable_sort(batch.begin(), batch.end(),
+                     [](LogFlushData *a, LogFlushData *b) { return a->m_logfile.get() < b->m_logfile.get(); });
 
-      RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_written_to_disk_stat, bytes_written);
+    // process the flush data of each file
+    //
+    for (size_t start = 0, end = 0; start < batch.size(); start = end) {
+      int64_t queued_bytes = 0;
 
-      if (logfile->m_log) {
-        ink_atomic_increment(&logfile->m_log->m_bytes_written, bytes_written);
+      for (end = start + 1; end < batch.size() && batch[end]->m_logfile == batch[start]->m_logfile; end++) {
       }
+      flush_logfile(batch[start]->m_logfile.get(), &batch[start], end - start, mutex);
+
+      now = Thread::get_hrtime();
+      for (size_t i = start; i < end; i++) {
+        ink_hrtime latency = now - batch[i]->m_queued;
+        int stat;
+
+        if (latency <= HRTIME_MSECOND) {
+          stat = log_stat_flush_latency_1ms_stat;
+        } else if (latency <= HRTIME_MSECONDS(10)) {
+          stat = log_stat_flush_latency_10ms_stat;
+        } else if (latency <= HRTIME_MSECONDS(100)) {
+          stat = log_stat_flush_latency_100ms_stat;
+        } else if (latency <= HRTIME_SECOND) {
+          stat = log_stat_flush_latency_1s_stat;
+        } else {
+          stat = log_stat_flush_latency_inf_stat;
+        }
+        RecIncrRawStat(log_rsb, mutex->thread_holding, stat, 1);
 
-      delete fdata;
+        queued_bytes += batch[i]->m_len;
+        // this may drop the last reference to the log file
+        delete batch[i];
+      }
+      flush_queue_bytes[idx] -= queued_bytes;
+      RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_flush_queue_depth_stat, -static_cast<int64_t>(end - start));
     }
 
-    // Time to work on periodic events??
+    // Time to work on periodic events?? They run on the first flush
+    // thread only, see PERIODIC EVENTS above.
     //
     now = Thread::get_hrtime() / HRTIME_SECOND;
-    if (now >= last_time + periodic_tasks_interval) {
+    if (idx == 0 && now >= last_time + periodic_tasks_interval) {
       Debug("log-preproc", "periodic tasks for %" PRId64, (int64_t)now);
       periodic_tasks(now);
       last_time = Thread::get_hrtime() / HRTIME_SECOND;
@@ -1439,10 +1557,10 @@ Log::flush_thread_main(void * /* args ATS_UNUSED */)
     // check the queue and find there is nothing to do, then wait
     // again.
     //
-    Log::flush_notify->wait();
+    Log::flush_notify[idx].wait();
   }
 
   /* NOTREACHED */
-  Log::flush_notify->unlock();
+  Log::flush_notify[idx].unlock();
   return nullptr;
 }
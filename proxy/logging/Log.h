@@ -51,6 +51,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdarg>
 #include "tscore/ink_platform.h"
 #include "tscore/EventNotify.h"
@@ -81,6 +82,7 @@ public:
   LogBuffer *logbuffer = nullptr;
   void *m_data;
   int m_len;
+  ink_hrtime m_queued = 0; // when the data was queued for the flush thread
 
   LogFlushData(LogFile *logfile, void *data, int len = -1) : m_logfile(logfile), m_data(data), m_len(len) {}
   ~LogFlushData()
@@ -92,6 +94,7 @@ public:
       break;
     case LOG_FILE_ASCII:
     case LOG_FILE_PIPE:
+    case LOG_FILE_COLUMNAR:
       free(m_data);
       break;
     case N_LOGFILE_TYPES:
@@ -197,9 +200,12 @@ public:
   static void *preproc_thread_main(void *args);
   static EventNotify *flush_notify;
   static InkAtomicList *flush_data_list;
+  static std::atomic<int64_t> *flush_queue_bytes;
   static void *flush_thread_main(void *args);
+  static bool push_flush_data(LogFlushData *fdata);
 
   static int preproc_threads;
+  static int flush_threads;
 
   // reconfiguration stuff
   static void change_configuration();
@@ -24,6 +24,8 @@
 
 #include "LogAccess.h"
 
+#include <charconv>
+
 #include "http/HttpSM.h"
 #include "MIME.h"
 #include "I_Machine.h"
@@ -542,7 +544,8 @@ LogAccess::unmarshal_itox(int64_t val, char *dest, int field_width, char leading
 /*-------------------------------------------------------------------------
   LogAccess::unmarshal_int_to_str
 
-  Return the string representation of the integer pointed at by buf.
+  Return the string representation of the integer pointed at by buf. The
+  digits are written straight into dest, which must keep room for a nul.
   -------------------------------------------------------------------------*/
 
 int
@@ -552,13 +555,13 @@ LogAccess::unmarshal_int_to_str(char **buf, char *dest, int len)
   ink_assert(*buf != nullptr);
   ink_assert(dest != nullptr);
 
-  char val_buf[128];
   int64_t val = unmarshal_int(buf);
-  int val_len = unmarshal_itoa(val, val_buf + 127);
 
-  if (val_len < len) {
-    memcpy(dest, val_buf + 128 - val_len, val_len);
-    return val_len;
+  if (len > 1) {
+    auto [end, ec] = std::to_chars(dest, dest + len - 1, val);
+    if (ec == std::errc()) {
+      return static_cast<int>(end - dest);
+    }
   }
   return -1;
 }
@@ -883,6 +886,23 @@ LogAccess::unmarshal_ip_to_str(char **buf, char *dest, int len)
   IpEndpoint ip;
   int zret = -1;
 
+  // IPv4 is formatted here rather than by inet_ntop(), it is the common case.
+  if (len >= INET_ADDRSTRLEN && AF_INET == reinterpret_cast<LogFieldIp *>(*buf)->_family) {
+    LogFieldIp4 *ip4     = reinterpret_cast<LogFieldIp4 *>(*buf);
+    const uint8_t *octet = reinterpret_cast<const uint8_t *>(&ip4->_addr);
+    char *p              = dest;
+
+    for (int i = 0; i < 4; i++) {
+      if (i) {
+        *p++ = '.';
+      }
+      p = std::to_chars(p, p + 3, static_cast<unsigned>(octet[i])).ptr;
+    }
+    *p = '\0';
+    *buf += INK_ALIGN_DEFAULT(sizeof(*ip4));
+    return static_cast<int>(p - dest);
+  }
+
   if (len > 0) {
     unmarshal_ip(buf, &ip);
     if (!ats_is_ip(&ip)) {
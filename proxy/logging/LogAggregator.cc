@@ -0,0 +1,252 @@
+/** @file
+
+  Group by aggregation of log entries.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/ink_platform.h"
+#include "tscore/Diags.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "LogField.h"
+#include "LogObject.h"
+#include "Log.h"
+#include "LogAggregator.h"
+
+LogAggregator::LogAggregator(int interval_sec, int max_groups)
+  : m_interval_sec(std::max(interval_sec, 1)), m_max_groups(std::max(max_groups, 1))
+{
+}
+
+LogAggregator::~LogAggregator()
+{
+  for (LogField *f : m_group_by) {
+    delete f;
+  }
+  for (LogField *f : m_values) {
+    delete f;
+  }
+}
+
+bool
+LogAggregator::add_group_by(const char *symbol)
+{
+  LogField *f = Log::global_field_list.find_by_symbol(symbol);
+  if (f == nullptr) {
+    return false;
+  }
+  m_group_by.push_back(new LogField(*f));
+  return true;
+}
+
+bool
+LogAggregator::add_value(const char *symbol)
+{
+  LogField *f = Log::global_field_list.find_by_symbol(symbol);
+  if (f == nullptr || f->type() != LogField::sINT) {
+    return false;
+  }
+  m_values.push_back(new LogField(*f));
+  return true;
+}
+
+void
+LogAggregator::set_histogram(const std::vector<int64_t> &bounds)
+{
+  m_bounds = bounds;
+}
+
+void
+LogAggregator::init_group(Group &group) const
+{
+  group.values.assign(m_values.size() * stride(), 0);
+  for (size_t i = 0; i < m_values.size(); i++) {
+    group.values[i * stride() + 1] = INT64_MAX;
+    group.values[i * stride() + 2] = INT64_MIN;
+  }
+}
+
+void
+LogAggregator::update_group(Group &group, const int64_t *values) const
+{
+  int64_t *v = group.values.data();
+
+  group.count++;
+  for (size_t i = 0; i < m_values.size(); i++) {
+    int64_t value = values[i];
+    v[0] += value;
+    v[1] = std::min(v[1], value);
+    v[2] = std::max(v[2], value);
+    v[3 + (std::lower_bound(m_bounds.begin(), m_bounds.end(), value) - m_bounds.begin())]++;
+    v += stride();
+  }
+}
+
+void
+LogAggregator::add(LogAccess *lad)
+{
+  std::string key;
+  char text[1024];
+
+  for (LogField *f : m_group_by) {
+    int len = f->to_text(lad, text, sizeof(text));
+    if (len > 0) {
+      key.append(text, len);
+    }
+    key.push_back('\0');
+  }
+
+  // the values are marshalled before the group is locked
+  std::vector<int64_t> values(m_values.size());
+  for (size_t i = 0; i < m_values.size(); i++) {
+    m_values[i]->marshal(lad, reinterpret_cast<char *>(&values[i]));
+  }
+
+  add_entry(key, values.data());
+}
+
+void
+LogAggregator::add(const std::vector<std::string_view> &texts, const std::vector<int64_t> &values)
+{
+  ink_assert(texts.size() == m_group_by.size() && values.size() == m_values.size());
+
+  std::string key;
+  for (std::string_view text : texts) {
+    key.append(text);
+    key.push_back('\0');
+  }
+  add_entry(key, values.data());
+}
+
+void
+LogAggregator::add_entry(std::string &key, const int64_t *values)
+{
+  Shard &shard = m_shards[std::hash<std::string>{}(key) % N_SHARDS];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  auto spot = shard.groups.find(key);
+  if (spot == shard.groups.end()) {
+    if (m_num_groups.load(std::memory_order_relaxed) >= m_max_groups) {
+      std::lock_guard<std::mutex> overflow_lock(m_overflow.mutex);
+      Group &group = m_overflow.groups[std::string()];
+      if (group.count == 0) {
+        init_group(group);
+      }
+      update_group(group, values);
+      return;
+    }
+    spot = shard.groups.emplace(std::move(key), Group()).first;
+    init_group(spot->second);
+    m_num_groups++;
+  }
+  update_group(spot->second, values);
+}
+
+void
+LogAggregator::print_group(std::string &line, std::string_view key, const Group &group) const
+{
+  for (LogField *f : m_group_by) {
+    size_t end = key.find('\0');
+    line += ' ';
+    line += f->symbol();
+    line += '=';
+    if (end == std::string_view::npos) {
+      // the overflow group
+      line += '-';
+    } else {
+      line.append(key.data(), end);
+      key.remove_prefix(end + 1);
+    }
+  }
+
+  line += " count=";
+  line += std::to_string(group.count);
+
+  const int64_t *v = group.values.data();
+  for (LogField *f : m_values) {
+    std::string prefix = std::string(" ") + f->symbol() + '.';
+    line += prefix + "sum=" + std::to_string(v[0]);
+    line += prefix + "min=" + std::to_string(v[1]);
+    line += prefix + "max=" + std::to_string(v[2]);
+    for (size_t i = 0; i < m_bounds.size(); i++) {
+      line += prefix + "le" + std::to_string(m_bounds[i]) + '=' + std::to_string(v[3 + i]);
+    }
+    line += prefix + "inf=" + std::to_string(v[3 + m_bounds.size()]);
+    v += stride();
+  }
+}
+
+void
+LogAggregator::emit(LogObject *obj, long time_now)
+{
+  emit(time_now, [obj](const std::string &line) { obj->log(nullptr, line); });
+}
+
+void
+LogAggregator::emit(long time_now, const std::function<void(const std::string &)> &out)
+{
+  if (m_interval_start == 0) {
+    m_interval_start = time_now - time_now % m_interval_sec;
+    return;
+  }
+  if (time_now < m_interval_start + m_interval_sec) {
+    return;
+  }
+
+  long start       = m_interval_start;
+  m_interval_start = time_now - time_now % m_interval_sec;
+
+  // Take the groups out of the shards so that the entries of the next
+  // interval are not blocked while the lines are logged.
+  std::string prefix = std::to_string(start) + ' ' + std::to_string(m_interval_sec);
+  std::string line;
+  auto log_groups = [&](Shard &shard) {
+    GroupMap groups;
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      groups.swap(shard.groups);
+    }
+    for (auto &[key, group] : groups) {
+      line = prefix;
+      print_group(line, key, group);
+      out(line);
+    }
+    return groups.size();
+  };
+
+  for (Shard &shard : m_shards) {
+    m_num_groups -= log_groups(shard);
+  }
+  log_groups(m_overflow);
+}
+
+bool
+LogAggregator::operator==(const LogAggregator &rhs) const
+{
+  auto same_fields = [](const std::vector<LogField *> &a, const std::vector<LogField *> &b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const LogField *x, const LogField *y) { return strcmp(x->symbol(), y->symbol()) == 0; });
+  };
+
+  return m_interval_sec == rhs.m_interval_sec && m_max_groups == rhs.m_max_groups && m_bounds == rhs.m_bounds &&
+         same_fields(m_group_by, rhs.m_group_by) && same_fields(m_values, rhs.m_values);
+}
@@ -0,0 +1,138 @@
+/** @file
+
+  Group by aggregation of log entries.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "tscore/ink_platform.h"
+
+class LogAccess;
+class LogField;
+class LogObject;
+
+/*-------------------------------------------------------------------------
+  LogAggregator
+
+  The aggregation stage of a LogObject. The entries that pass the filters
+  of the object are not logged, they are grouped by the text of the group
+  by fields instead. For each group, the aggregator counts the entries and
+  keeps the sum, minimum, maximum and a histogram of each value field. At
+  the end of every interval, one line per group is logged to the object:
+
+    <start> <interval> <field>=<text> ... count=<n> <value>.sum=<n>
+      <value>.min=<n> <value>.max=<n> <value>.le<bound>=<n> ... <value>.inf=<n>
+
+  Once max_groups groups exist in an interval, the entries of new groups are
+  counted in a group whose fields are all "-".
+  -------------------------------------------------------------------------*/
+
+class LogAggregator
+{
+public:
+  LogAggregator(int interval_sec, int max_groups);
+  ~LogAggregator();
+
+  /** Adds a field to group the entries by. Returns false if there is no
+      field with the symbol @a symbol.
+   */
+  bool add_group_by(const char *symbol);
+
+  /** Adds a field to aggregate. Returns false if there is no integer field
+      with the symbol @a symbol.
+   */
+  bool add_value(const char *symbol);
+
+  /** Sets the upper bounds of the histogram buckets of the value fields,
+      they must be in increasing order. Must be called before any entry is
+      added.
+   */
+  void set_histogram(const std::vector<int64_t> &bounds);
+
+  void add(LogAccess *lad);
+
+  /** Adds an entry whose group by fields have the text @a texts and whose
+      value fields have the values @a values, both in the order the fields
+      were added.
+   */
+  void add(const std::vector<std::string_view> &texts, const std::vector<int64_t> &values);
+
+  /** Logs the groups to @a obj if the interval ended by @a time_now. This is
+      only called from the periodic tasks of the flush thread.
+   */
+  void emit(LogObject *obj, long time_now);
+
+  /** Passes the line of each group to @a out if the interval ended by
+      @a time_now, and starts the next interval.
+   */
+  void emit(long time_now, const std::function<void(const std::string &)> &out);
+
+  bool operator==(const LogAggregator &rhs) const;
+
+  // noncopyable
+  LogAggregator(const LogAggregator &) = delete;
+  LogAggregator &operator=(const LogAggregator &) = delete;
+
+private:
+  struct Group {
+    int64_t count = 0;
+    std::vector<int64_t> values; // sum, min, max and the buckets of each value field
+  };
+  using GroupMap = std::unordered_map<std::string, Group>;
+
+  static constexpr int N_SHARDS = 16;
+
+  struct Shard {
+    std::mutex mutex;
+    GroupMap groups;
+  };
+
+  size_t
+  stride() const
+  {
+    return 3 + m_bounds.size() + 1;
+  }
+
+  void add_entry(std::string &key, const int64_t *values);
+  void init_group(Group &group) const;
+  void update_group(Group &group, const int64_t *values) const;
+  void print_group(std::string &line, std::string_view key, const Group &group) const;
+
+  std::vector<LogField *> m_group_by;
+  std::vector<LogField *> m_values;
+  std::vector<int64_t> m_bounds;
+
+  int m_interval_sec;
+  size_t m_max_groups;
+  long m_interval_start = 0;
+
+  std::atomic<size_t> m_num_groups{0};
+  Shard m_shards[N_SHARDS];
+  Shard m_overflow; // only uses its mutex and the empty key
+};
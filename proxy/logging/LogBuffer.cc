@@ -28,9 +28,11 @@
 #include "tscore/ink_platform.h"
 #include "tscore/BufferWriter.h"
 
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
 
 #include "P_EventSystem.h"
 #include "LogField.h"
@@ -55,6 +57,18 @@ enum {
 
 FieldListCacheElement fieldlist_cache[FIELDLIST_CACHE_SIZE];
 int fieldlist_cache_entries = 0;
+
+// The ascii programs are only added to, an entry is complete before the
+// count that makes it visible is incremented.
+struct AsciiProgramCacheElement {
+  char *symbol_str;
+  char *printf_str;
+  LogAsciiProgram *program;
+};
+
+AsciiProgramCacheElement ascii_program_cache[FIELDLIST_CACHE_SIZE];
+std::atomic<int> ascii_program_cache_entries{0};
+std::mutex ascii_program_cache_mutex;
 int32_t LogBuffer::M_ID;
 
 /*-------------------------------------------------------------------------
@@ -540,6 +554,53 @@ LogBuffer::resolve_custom_entry(LogFieldList *fieldlist, char *printf_str, char
   return bytes_written;
 }
 
+/*-------------------------------------------------------------------------
+  LogBuffer::ascii_program
+
+  Return the compiled ascii program of a format, compiling it the first
+  time the format is seen. Returns nullptr if the format can not be
+  compiled, or if too many formats were seen already.
+  -------------------------------------------------------------------------*/
+LogAsciiProgram *
+LogBuffer::ascii_program(const char *symbol_str, const char *printf_str)
+{
+  if (symbol_str == nullptr || printf_str == nullptr) {
+    return nullptr;
+  }
+
+  auto find = [symbol_str, printf_str](int from, int to) -> AsciiProgramCacheElement * {
+    for (int i = from; i < to; i++) {
+      if (strcmp(symbol_str, ascii_program_cache[i].symbol_str) == 0 && strcmp(printf_str, ascii_program_cache[i].printf_str) == 0) {
+        return &ascii_program_cache[i];
+      }
+    }
+    return nullptr;
+  };
+
+  int entries                     = ascii_program_cache_entries.load(std::memory_order_acquire);
+  AsciiProgramCacheElement *found = find(0, entries);
+
+  if (!found) {
+    std::lock_guard<std::mutex> lock(ascii_program_cache_mutex);
+    int now = ascii_program_cache_entries.load(std::memory_order_relaxed);
+
+    found = find(entries, now);
+    if (!found) {
+      if (now == FIELDLIST_CACHE_SIZE) {
+        return nullptr;
+      }
+      Debug("log-fieldlist", "Compiling ascii program for %s as entry %d", symbol_str, now);
+      found             = &ascii_program_cache[now];
+      found->symbol_str = ats_strdup(symbol_str);
+      found->printf_str = ats_strdup(printf_str);
+      found->program    = new LogAsciiProgram(symbol_str, printf_str);
+      ascii_program_cache_entries.store(now + 1, std::memory_order_release);
+    }
+  }
+
+  return found->program->valid() ? found->program : nullptr;
+}
+
 /*-------------------------------------------------------------------------
   LogBuffer::to_ascii
 
@@ -568,6 +629,12 @@ LogBuffer::to_ascii(LogEntryHeader *entry, LogFormatType type, char *buf, int bu
     //
     return ink_strlcpy(write_to, read_from, buf_len);
   }
+
+  if (!alt_format) {
+    if (LogAsciiProgram *program = ascii_program(symbol_str, printf_str)) {
+      return program->run(read_from, write_to, buf_len);
+    }
+  }
   //
   // We no longer make the distinction between custom vs pre-defined
   // logging formats in converting to ASCII.  This way we're sure to
@@ -654,6 +721,93 @@ LogBuffer::to_ascii(LogEntryHeader *entry, LogFormatType type, char *buf, int bu
   return ret;
 }
 
+/*-------------------------------------------------------------------------
+  LogAsciiProgram::LogAsciiProgram
+  -------------------------------------------------------------------------*/
+LogAsciiProgram::LogAsciiProgram(const char *symbol_str, const char *printf_str)
+{
+  bool contains_aggregates = false;
+  LogFormat::parse_symbol_string(symbol_str, &m_fieldlist, &contains_aggregates);
+
+  LogField *field = m_fieldlist.first();
+  Step text       = {STEP_TEXT, 0, 0, nullptr};
+
+  for (const char *c = printf_str; *c; c++) {
+    if (*c != LOG_FIELD_MARKER) {
+      m_text.push_back(*c);
+      text.len++;
+      continue;
+    }
+    if (field == nullptr) {
+      // resolve_custom_entry() reports the entries of this format.
+      m_valid = false;
+      break;
+    }
+    if (text.len) {
+      m_steps.push_back(text);
+    }
+
+    LogField::UnmarshalFunc func = field->unmarshal_func();
+    if (func == &LogAccess::unmarshal_int_to_str) {
+      m_steps.push_back({STEP_INT, 0, 0, field});
+    } else if (func == &LogAccess::unmarshal_ip_to_str) {
+      m_steps.push_back({STEP_IP, 0, 0, field});
+    } else {
+      m_steps.push_back({STEP_FIELD, 0, 0, field});
+    }
+
+    field = m_fieldlist.next(field);
+    text  = {STEP_TEXT, static_cast<uint32_t>(m_text.size()), 0, nullptr};
+  }
+  if (text.len) {
+    m_steps.push_back(text);
+  }
+}
+
+/*-------------------------------------------------------------------------
+  LogAsciiProgram::run
+
+  This is resolve_custom_entry() for a compiled format, it gives the same
+  output for the same entry.
+  -------------------------------------------------------------------------*/
+int
+LogAsciiProgram::run(char *read_from, char *write_to, int write_to_len) const
+{
+  int bytes_written = 0;
+  int res           = 0;
+
+  for (const Step &step : m_steps) {
+    switch (step.type) {
+    case STEP_TEXT:
+      if (bytes_written + static_cast<int>(step.len) >= write_to_len) {
+        res = -1;
+        break;
+      }
+      memcpy(&write_to[bytes_written], m_text.data() + step.offset, step.len);
+      res = step.len;
+      break;
+    case STEP_INT:
+      res = LogAccess::unmarshal_int_to_str(&read_from, &write_to[bytes_written], write_to_len - bytes_written);
+      break;
+    case STEP_IP:
+      res = LogAccess::unmarshal_ip_to_str(&read_from, &write_to[bytes_written], write_to_len - bytes_written);
+      break;
+    case STEP_FIELD:
+      res = step.field->unmarshal(&read_from, &write_to[bytes_written], write_to_len - bytes_written);
+      break;
+    }
+
+    if (res < 0) {
+      SiteThrottledNote("Traffic Server is skipping the current log entry because its size "
+                        "exceeds the maximum line (entry) size for an ascii log buffer");
+      return 0;
+    }
+    bytes_written += res;
+  }
+
+  return bytes_written;
+}
+
 /*-------------------------------------------------------------------------
   LogBufferList
 
@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "tscore/ink_platform.h"
 #include "tscore/Diags.h"
 #include "LogFormat.h"
@@ -32,6 +35,7 @@
 class LogObject;
 class LogConfig;
 class LogBufferIterator;
+class LogAsciiProgram;
 
 #define LOG_SEGMENT_COOKIE 0xaceface
 #define LOG_SEGMENT_VERSION 2
@@ -193,6 +197,7 @@ public:
   static int resolve_custom_entry(LogFieldList *fieldlist, char *printf_str, char *read_from, char *write_to, int write_to_len,
                                   long timestamp, long timestamp_us, unsigned buffer_version, LogFieldList *alt_fieldlist = nullptr,
                                   char *alt_printf_str = nullptr);
+  static LogAsciiProgram *ascii_program(const char *symbol_str, const char *printf_str);
 
   static void
   destroy(LogBuffer *&lb)
@@ -244,6 +249,55 @@ private:
   friend class LogBufferIterator;
 };
 
+/*-------------------------------------------------------------------------
+  LogAsciiProgram
+
+  A log format compiled for the conversion of its entries to ascii. The
+  printf string is split once into the text between the fields and the
+  fields, and the unmarshalling routine of each field is resolved, so that
+  converting an entry is a walk over a flat array of steps. Integer and IP
+  fields are converted without going through a function pointer.
+  -------------------------------------------------------------------------*/
+
+class LogAsciiProgram
+{
+public:
+  LogAsciiProgram(const char *symbol_str, const char *printf_str);
+
+  /** False if the printf string has more field markers than there are
+      fields, the entries then have to go through resolve_custom_entry().
+   */
+  bool
+  valid() const
+  {
+    return m_valid;
+  }
+
+  /** Converts the entry at @a read_from into @a write_to, returns the
+      number of characters written or 0 if the entry does not fit.
+   */
+  int run(char *read_from, char *write_to, int write_to_len) const;
+
+  // noncopyable
+  LogAsciiProgram(const LogAsciiProgram &) = delete;
+  LogAsciiProgram &operator=(const LogAsciiProgram &) = delete;
+
+private:
+  enum StepType { STEP_TEXT, STEP_INT, STEP_IP, STEP_FIELD };
+
+  struct Step {
+    StepType type;
+    uint32_t offset; // STEP_TEXT, into m_text
+    uint32_t len;    // STEP_TEXT
+    LogField *field; // STEP_FIELD
+  };
+
+  LogFieldList m_fieldlist;
+  std::vector<Step> m_steps;
+  std::string m_text;
+  bool m_valid = true;
+};
+
 class LogFile;
 
 /*-------------------------------------------------------------------------
@@ -0,0 +1,642 @@
+/** @file
+
+  Columnar binary log blocks.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "tscore/ink_platform.h"
+#include "tscore/ink_align.h"
+#include "tscore/ink_memory.h"
+#include "tscore/Diags.h"
+#include "tscpp/util/TextView.h"
+
+#if HAVE_ZSTD_H
+#include <zstd.h>
+#endif
+
+#include "LogField.h"
+#include "LogFormat.h"
+#include "LogBuffer.h"
+#include "LogLimits.h"
+#include "LogColumnar.h"
+
+// zstd level of the column data, the blocks are small so a higher level
+// buys little.
+#define LOG_COLUMNAR_ZSTD_LEVEL 3
+
+// bytes of an entry in the timestamp column, timestamp and timestamp_usec
+#define LOG_COLUMNAR_TIMESTAMP_WIDTH (sizeof(int64_t) + sizeof(int32_t))
+
+// largest block a reader accepts
+#define LOG_COLUMNAR_MAX_BLOCK (64 * LOG_MEGABYTE)
+
+namespace
+{
+bool
+read_fully(int fd, char *buf, int len)
+{
+  while (len > 0) {
+    int rc = ::read(fd, buf, len);
+    if (rc <= 0) {
+      return false;
+    }
+    buf += rc;
+    len -= rc;
+  }
+  return true;
+}
+
+int64_t
+load_int64(const char *p)
+{
+  int64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint32_t
+load_uint32(const char *p)
+{
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// grows an ats_malloc()'d buffer to at least size bytes
+void
+reserve(char **buf, uint32_t *buf_size, uint32_t size)
+{
+  if (*buf_size < size) {
+    *buf      = static_cast<char *>(ats_realloc(*buf, size));
+    *buf_size = size;
+  }
+}
+} // namespace
+
+/*-------------------------------------------------------------------------
+  LogColumnar::encode
+
+  Splits each entry in the fields of the format, the marshalled length of
+  a field is how far its unmarshal routine moves the read pointer. The
+  bytes of the fields are copied as they are, so that decoding a block
+  gives back the entries of the LogBuffer unchanged.
+  -------------------------------------------------------------------------*/
+
+char *
+LogColumnar::encode(LogBufferHeader *header, LogFieldList *fieldlist, int *block_len)
+{
+  if (header == nullptr || header->entry_count == 0 || header->data_offset < sizeof(LogBufferHeader) ||
+      header->data_offset > header->byte_count) {
+    return nullptr;
+  }
+
+  unsigned n_entries = header->entry_count;
+  std::vector<LogField *> fields;
+  if (fieldlist) {
+    for (LogField *field = fieldlist->first(); field; field = fieldlist->next(field)) {
+      fields.push_back(field);
+    }
+  }
+
+  std::vector<LogEntryHeader *> entries;
+  entries.reserve(n_entries);
+  LogBufferIterator iter(header);
+  LogEntryHeader *entry;
+  while (entries.size() < n_entries && (entry = iter.next())) {
+    if (entry->entry_len < sizeof(LogEntryHeader)) {
+      return nullptr;
+    }
+    entries.push_back(entry);
+  }
+  if (entries.size() != n_entries) {
+    return nullptr;
+  }
+
+  // lens[e * n_columns + c] is the length of column c in entry e, column 0
+  // is the timestamp and always has the same width.
+  //
+  unsigned n_columns = fields.size() + 2;
+  bool split         = !fields.empty();
+  std::vector<uint32_t> lens(n_entries * n_columns);
+  std::vector<char> scratch(LOG_MAX_FORMATTED_LINE);
+
+  for (unsigned e = 0; e < n_entries && split; ++e) {
+    char *read_from = reinterpret_cast<char *>(entries[e]) + sizeof(LogEntryHeader);
+    char *end       = reinterpret_cast<char *>(entries[e]) + entries[e]->entry_len;
+    uint32_t *row   = &lens[e * n_columns];
+    unsigned c      = 1;
+
+    for (LogField *field : fields) {
+      char *start = read_from;
+      int res     = field->unmarshal(&read_from, scratch.data(), scratch.size());
+      if (res < 0 || read_from < start || read_from > end) {
+        split = false;
+        break;
+      }
+      row[c++] = read_from - start;
+    }
+    row[c] = end - read_from;
+  }
+
+  if (!split) {
+    Debug("log-columnar", "entries are not split in fields, format has %zu fields", fields.size());
+    n_columns = 2;
+    lens.assign(n_entries * n_columns, 0);
+    for (unsigned e = 0; e < n_entries; ++e) {
+      lens[e * n_columns + 1] = entries[e]->entry_len - sizeof(LogEntryHeader);
+    }
+  }
+
+  std::vector<LogColumnIndex> index(n_columns);
+  uint32_t raw_bytes = 0;
+
+  for (unsigned c = 0; c < n_columns; ++c) {
+    LogColumnIndex &col = index[c];
+    memset(&col, 0, sizeof(col));
+    if (c == 0) {
+      col.width = LOG_COLUMNAR_TIMESTAMP_WIDTH;
+      col.bytes = col.width * n_entries;
+    } else {
+      uint64_t data = 0;
+      col.width     = lens[c];
+      for (unsigned e = 0; e < n_entries; ++e) {
+        data += lens[e * n_columns + c];
+        if (lens[e * n_columns + c] != col.width) {
+          col.width = 0;
+        }
+      }
+      col.bytes = col.width ? data : data + sizeof(uint32_t) * n_entries;
+    }
+    raw_bytes += col.bytes;
+  }
+
+  // the block is allocated large enough to compress the column data into
+  // it, or to copy it when compression does not pay off.
+  //
+  uint32_t prefix_bytes  = INK_ALIGN(header->data_offset, 8);
+  uint32_t payload_start = sizeof(LogColumnarBlockHeader) + prefix_bytes + n_columns * sizeof(LogColumnIndex);
+  size_t payload_room    = raw_bytes;
+#if HAVE_ZSTD_H
+  payload_room = std::max(payload_room, ZSTD_compressBound(raw_bytes));
+#endif
+  char *block = static_cast<char *>(ats_malloc(payload_start + payload_room));
+  char *raw   = static_cast<char *>(ats_malloc(std::max(raw_bytes, 1U)));
+  char *w     = raw;
+
+  // the column data, with the range of the timestamps and integer fields
+  //
+  std::vector<uint32_t> cursor(n_entries, sizeof(LogEntryHeader));
+  for (unsigned c = 0; c < n_columns; ++c) {
+    LogColumnIndex &col = index[c];
+    bool ranged         = (c == 0) || (split && c <= fields.size() && fields[c - 1]->type() == LogField::sINT && col.width == 8);
+
+    if (col.width == 0) {
+      for (unsigned e = 0; e < n_entries; ++e) {
+        memcpy(w, &lens[e * n_columns + c], sizeof(uint32_t));
+        w += sizeof(uint32_t);
+      }
+    }
+    for (unsigned e = 0; e < n_entries; ++e) {
+      char *from = reinterpret_cast<char *>(entries[e]);
+      int64_t value;
+
+      if (c == 0) {
+        memcpy(w, &entries[e]->timestamp, sizeof(int64_t));
+        memcpy(w + sizeof(int64_t), &entries[e]->timestamp_usec, sizeof(int32_t));
+        value = entries[e]->timestamp;
+        w += LOG_COLUMNAR_TIMESTAMP_WIDTH;
+      } else {
+        uint32_t len = lens[e * n_columns + c];
+        memcpy(w, from + cursor[e], len);
+        value = ranged ? load_int64(w) : 0;
+        cursor[e] += len;
+        w += len;
+      }
+      if (ranged) {
+        if (e == 0 || value < col.min) {
+          col.min = value;
+        }
+        if (e == 0 || value > col.max) {
+          col.max = value;
+        }
+      }
+    }
+    if (ranged) {
+      col.flags |= LOG_COLUMN_HAS_RANGE;
+    }
+  }
+  ink_assert(static_cast<uint32_t>(w - raw) == raw_bytes);
+
+  LogColumnarBlockHeader *bh = reinterpret_cast<LogColumnarBlockHeader *>(block);
+  memset(bh, 0, sizeof(*bh));
+  bh->cookie         = LOG_COLUMNAR_COOKIE;
+  bh->version        = LOG_COLUMNAR_VERSION;
+  bh->entry_count    = n_entries;
+  bh->low_timestamp  = header->low_timestamp;
+  bh->high_timestamp = header->high_timestamp;
+  bh->column_count   = n_columns;
+  bh->compression    = LOG_COLUMNAR_UNCOMPRESSED;
+  bh->prefix_bytes   = prefix_bytes;
+  bh->raw_bytes      = raw_bytes;
+  bh->payload_bytes  = raw_bytes;
+
+  char *prefix = block + sizeof(LogColumnarBlockHeader);
+  memcpy(prefix, header, header->data_offset);
+  memset(prefix + header->data_offset, 0, prefix_bytes - header->data_offset);
+  memcpy(prefix + prefix_bytes, index.data(), n_columns * sizeof(LogColumnIndex));
+
+#if HAVE_ZSTD_H
+  size_t res = ZSTD_compress(block + payload_start, payload_room, raw, raw_bytes, LOG_COLUMNAR_ZSTD_LEVEL);
+  if (!ZSTD_isError(res) && res < raw_bytes) {
+    bh->compression   = LOG_COLUMNAR_ZSTD;
+    bh->payload_bytes = res;
+  } else
+#endif
+  {
+    memcpy(block + payload_start, raw, raw_bytes);
+  }
+  ats_free(raw);
+
+  bh->block_bytes = payload_start + bh->payload_bytes;
+  *block_len      = bh->block_bytes;
+
+  Debug("log-columnar", "encoded %u entries in %u columns, %u bytes of entries, %u bytes of column data, block of %u bytes",
+        n_entries, n_columns, header->byte_count - header->data_offset, raw_bytes, bh->block_bytes);
+  return block;
+}
+
+/*-------------------------------------------------------------------------
+  LogColumnarReader
+  -------------------------------------------------------------------------*/
+
+LogColumnarReader::~LogColumnarReader()
+{
+  for (auto &p : m_predicates) {
+    ats_free(p.symbol);
+  }
+  ats_free(m_block);
+  ats_free(m_raw);
+  ats_free(m_out);
+  ats_free(m_fieldlist_str);
+  delete m_fieldlist;
+}
+
+bool
+LogColumnarReader::add_predicates(const char *spec)
+{
+  ts::TextView text(spec, strlen(spec));
+
+  while (!text.ltrim_if(&isspace).empty()) {
+    ts::TextView term = text.take_prefix_at(',').trim_if(&isspace);
+    size_t op_pos     = term.find_first_of("=!<>");
+
+    if (op_pos == ts::TextView::npos || op_pos == 0) {
+      return false;
+    }
+
+    ts::TextView symbol = term.prefix(op_pos).rtrim_if(&isspace);
+    term.remove_prefix(op_pos);
+
+    Predicate p;
+    char op = term[0];
+    if (term.size() > 1 && term[1] == '=' && op != '=') {
+      p.op = (op == '!') ? OP_NE : (op == '<') ? OP_LE : OP_GE;
+      term.remove_prefix(2);
+    } else if (op == '<' || op == '>' || op == '=') {
+      p.op = (op == '<') ? OP_LT : (op == '>') ? OP_GT : OP_EQ;
+      term.remove_prefix(1);
+    } else {
+      return false;
+    }
+    term.ltrim_if(&isspace);
+
+    ts::TextView parsed;
+    p.value = ts::svtoi(term, &parsed);
+    if (parsed.size() != term.size() || term.empty()) {
+      return false;
+    }
+    p.symbol = ats_strndup(symbol.data(), symbol.size());
+    p.column = -1;
+    m_predicates.push_back(p);
+  }
+  return true;
+}
+
+int
+LogColumnarReader::read(int fd, const char *start, int have)
+{
+  reserve(&m_block, &m_block_sz, sizeof(LogColumnarBlockHeader));
+  if (have > 0) {
+    memcpy(m_block, start, have);
+  }
+  if (have < static_cast<int>(sizeof(LogColumnarBlockHeader))) {
+    int need = sizeof(LogColumnarBlockHeader) - have;
+    if (have == 0) {
+      int rc = ::read(fd, m_block, need);
+      if (rc <= 0) {
+        return 0;
+      }
+      have = rc;
+      need -= rc;
+    }
+    if (!read_fully(fd, m_block + have, need)) {
+      Note("truncated columnar log block header");
+      return -1;
+    }
+  }
+
+  const LogColumnarBlockHeader *bh = block();
+  if (bh->cookie != LOG_COLUMNAR_COOKIE || bh->version != LOG_COLUMNAR_VERSION) {
+    Note("bad columnar log block, cookie %x, version %u", bh->cookie, bh->version);
+    return -1;
+  }
+
+  uint64_t expected = static_cast<uint64_t>(sizeof(LogColumnarBlockHeader)) + bh->prefix_bytes +
+                      static_cast<uint64_t>(bh->column_count) * sizeof(LogColumnIndex) + bh->payload_bytes;
+  if (bh->block_bytes != expected || bh->block_bytes > LOG_COLUMNAR_MAX_BLOCK || bh->raw_bytes > LOG_COLUMNAR_MAX_BLOCK ||
+      bh->column_count < 2 || bh->prefix_bytes < sizeof(LogBufferHeader)) {
+    Note("bad columnar log block, %u bytes in the header, %" PRIu64 " bytes expected", bh->block_bytes, expected);
+    return -1;
+  }
+
+  uint32_t block_bytes = bh->block_bytes;
+  reserve(&m_block, &m_block_sz, block_bytes);
+  if (!read_fully(fd, m_block + sizeof(LogColumnarBlockHeader), block_bytes - sizeof(LogColumnarBlockHeader))) {
+    Note("truncated columnar log block");
+    return -1;
+  }
+  return 1;
+}
+
+bool
+LogColumnarReader::match(const Predicate &p, int64_t value)
+{
+  switch (p.op) {
+  case OP_EQ:
+    return value == p.value;
+  case OP_NE:
+    return value != p.value;
+  case OP_LT:
+    return value < p.value;
+  case OP_LE:
+    return value <= p.value;
+  case OP_GT:
+    return value > p.value;
+  case OP_GE:
+    return value >= p.value;
+  }
+  return false;
+}
+
+/*-------------------------------------------------------------------------
+  LogColumnarReader::resolve_predicates
+
+  Finds the column of each predicate in the block being decoded. Returns
+  false if a predicate can not be evaluated on the block, in which case no
+  entry of the block matches.
+  -------------------------------------------------------------------------*/
+
+bool
+LogColumnarReader::resolve_predicates(LogBufferHeader *prefix)
+{
+  const LogColumnarBlockHeader *bh = block();
+  const LogColumnIndex *index =
+    reinterpret_cast<const LogColumnIndex *>(m_block + sizeof(LogColumnarBlockHeader) + bh->prefix_bytes);
+  const char *fieldlist_str = nullptr;
+
+  if (prefix->fmt_fieldlist_offset >= sizeof(LogBufferHeader) && prefix->fmt_fieldlist_offset < prefix->data_offset &&
+      memchr(prefix->fmt_fieldlist(), 0, prefix->data_offset - prefix->fmt_fieldlist_offset)) {
+    fieldlist_str = prefix->fmt_fieldlist();
+  }
+
+  for (auto &p : m_predicates) {
+    p.column = -1;
+    if (strcmp(p.symbol, "timestamp") == 0) {
+      p.column = 0;
+      continue;
+    }
+    if (fieldlist_str == nullptr) {
+      return false;
+    }
+
+    // the field list is parsed again only when the format changes
+    if (m_fieldlist == nullptr || strcmp(m_fieldlist_str, fieldlist_str) != 0) {
+      bool contains_aggregates = false;
+      delete m_fieldlist;
+      ats_free(m_fieldlist_str);
+      m_fieldlist     = new LogFieldList;
+      m_fieldlist_str = ats_strdup(fieldlist_str);
+      LogFormat::parse_symbol_string(m_fieldlist_str, m_fieldlist, &contains_aggregates);
+    }
+    if (bh->column_count != m_fieldlist->count() + 2) {
+      return false;
+    }
+
+    int column = 1;
+    for (LogField *field = m_fieldlist->first(); field; field = m_fieldlist->next(field), ++column) {
+      if (strcmp(field->symbol(), p.symbol) == 0) {
+        if (field->type() == LogField::sINT && index[column].width == sizeof(int64_t)) {
+          p.column = column;
+        }
+        break;
+      }
+    }
+    if (p.column < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool
+LogColumnarReader::block_may_match(const LogColumnIndex *index) const
+{
+  for (auto &p : m_predicates) {
+    const LogColumnIndex &col = index[p.column];
+    if (!(col.flags & LOG_COLUMN_HAS_RANGE)) {
+      continue;
+    }
+    switch (p.op) {
+    case OP_EQ:
+      if (p.value < col.min || p.value > col.max) {
+        return false;
+      }
+      break;
+    case OP_NE:
+      if (col.min == p.value && col.max == p.value) {
+        return false;
+      }
+      break;
+    case OP_LT:
+      if (col.min >= p.value) {
+        return false;
+      }
+      break;
+    case OP_LE:
+      if (col.min > p.value) {
+        return false;
+      }
+      break;
+    case OP_GT:
+      if (col.max <= p.value) {
+        return false;
+      }
+      break;
+    case OP_GE:
+      if (col.max < p.value) {
+        return false;
+      }
+      break;
+    }
+  }
+  return true;
+}
+
+/*-------------------------------------------------------------------------
+  LogColumnarReader::decode
+  -------------------------------------------------------------------------*/
+
+LogBufferHeader *
+LogColumnarReader::decode()
+{
+  const LogColumnarBlockHeader *bh = block();
+  char *prefix_start               = m_block + sizeof(LogColumnarBlockHeader);
+  LogBufferHeader *prefix          = reinterpret_cast<LogBufferHeader *>(prefix_start);
+  const LogColumnIndex *index      = reinterpret_cast<const LogColumnIndex *>(prefix_start + bh->prefix_bytes);
+  const char *payload              = reinterpret_cast<const char *>(index + bh->column_count);
+  unsigned n_entries               = bh->entry_count;
+  unsigned n_columns               = bh->column_count;
+
+  ++blocks_read;
+
+  if (prefix->cookie != LOG_SEGMENT_COOKIE || prefix->data_offset < sizeof(LogBufferHeader) ||
+      prefix->data_offset > bh->prefix_bytes) {
+    Note("bad LogBufferHeader in columnar log block");
+    return nullptr;
+  }
+
+  if (!resolve_predicates(prefix) || !block_may_match(index)) {
+    Debug("log-columnar", "skipping block of %u entries, %u - %u", n_entries, bh->low_timestamp, bh->high_timestamp);
+    ++blocks_skipped;
+    return nullptr;
+  }
+
+  const char *raw = payload;
+  if (bh->compression == LOG_COLUMNAR_ZSTD) {
+#if HAVE_ZSTD_H
+    reserve(&m_raw, &m_raw_sz, std::max(bh->raw_bytes, 1U));
+    size_t res = ZSTD_decompress(m_raw, bh->raw_bytes, payload, bh->payload_bytes);
+    if (ZSTD_isError(res) || res != bh->raw_bytes) {
+      Note("failed to decompress columnar log block: %s", ZSTD_isError(res) ? ZSTD_getErrorName(res) : "short block");
+      return nullptr;
+    }
+    raw = m_raw;
+#else
+    Note("columnar log block is zstd compressed, and zstd support is not built in");
+    return nullptr;
+#endif
+  } else if (bh->compression != LOG_COLUMNAR_UNCOMPRESSED || bh->payload_bytes != bh->raw_bytes) {
+    Note("bad columnar log block compression %u", bh->compression);
+    return nullptr;
+  }
+
+  // locate the columns, the lengths of a column of variable width lead
+  // its data.
+  //
+  std::vector<const char *> lengths(n_columns), cursor(n_columns), end(n_columns);
+  std::vector<uint32_t> len(n_columns);
+  uint64_t offset = 0;
+
+  for (unsigned c = 0; c < n_columns; ++c) {
+    const char *start = raw + offset;
+    offset += index[c].bytes;
+    if (offset > bh->raw_bytes || (index[c].width == 0 && index[c].bytes < sizeof(uint32_t) * n_entries) ||
+        (c == 0 && index[c].width != LOG_COLUMNAR_TIMESTAMP_WIDTH)) {
+      Note("bad columnar log block index");
+      return nullptr;
+    }
+    lengths[c] = index[c].width ? nullptr : start;
+    cursor[c]  = index[c].width ? start : start + sizeof(uint32_t) * n_entries;
+    end[c]     = raw + offset;
+  }
+
+  uint64_t out_bytes = prefix->data_offset + static_cast<uint64_t>(n_entries) * sizeof(LogEntryHeader) + bh->raw_bytes;
+  reserve(&m_out, &m_out_sz, out_bytes);
+  memcpy(m_out, prefix, prefix->data_offset);
+
+  char *w         = m_out + prefix->data_offset;
+  unsigned matched = 0;
+  uint32_t low_ts  = UINT32_MAX;
+  uint32_t high_ts = 0;
+
+  for (unsigned e = 0; e < n_entries; ++e) {
+    uint32_t entry_len = sizeof(LogEntryHeader);
+    for (unsigned c = 0; c < n_columns; ++c) {
+      len[c] = index[c].width ? index[c].width : load_uint32(lengths[c] + e * sizeof(uint32_t));
+      if (len[c] > static_cast<uint64_t>(end[c] - cursor[c])) {
+        Note("bad columnar log block, column %u overflows", c);
+        return nullptr;
+      }
+      if (c > 0) {
+        entry_len += len[c];
+      }
+    }
+
+    bool keep = true;
+    for (auto &p : m_predicates) {
+      if (!match(p, load_int64(cursor[p.column]))) {
+        keep = false;
+        break;
+      }
+    }
+
+    if (keep) {
+      LogEntryHeader entry;
+      entry.timestamp = load_int64(cursor[0]);
+      memcpy(&entry.timestamp_usec, cursor[0] + sizeof(int64_t), sizeof(int32_t));
+      entry.entry_len = entry_len;
+      memcpy(w, &entry, sizeof(entry));
+      w += sizeof(entry);
+      for (unsigned c = 1; c < n_columns; ++c) {
+        memcpy(w, cursor[c], len[c]);
+        w += len[c];
+      }
+      low_ts  = std::min(low_ts, static_cast<uint32_t>(entry.timestamp));
+      high_ts = std::max(high_ts, static_cast<uint32_t>(entry.timestamp));
+      ++matched;
+    }
+
+    for (unsigned c = 0; c < n_columns; ++c) {
+      cursor[c] += len[c];
+    }
+  }
+
+  entries_matched += matched;
+  if (matched == 0) {
+    return nullptr;
+  }
+
+  LogBufferHeader *header = reinterpret_cast<LogBufferHeader *>(m_out);
+  header->byte_count      = w - m_out;
+  header->entry_count     = matched;
+  header->low_timestamp   = low_ts;
+  header->high_timestamp  = high_ts;
+  return header;
+}
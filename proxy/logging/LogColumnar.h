@@ -0,0 +1,179 @@
+/** @file
+
+  Columnar binary log blocks.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "tscore/ink_platform.h"
+
+struct LogBufferHeader;
+class LogFieldList;
+
+#define LOG_COLUMNAR_COOKIE 0xc01face
+#define LOG_COLUMNAR_VERSION 1
+
+/*-------------------------------------------------------------------------
+  LogColumnarBlockHeader
+
+  A columnar log file is a sequence of blocks, one per LogBuffer. A block
+  is laid out as
+
+    LogColumnarBlockHeader
+    the LogBufferHeader of the buffer and its strings, up to data_offset
+    LogColumnIndex[column_count]
+    the column data, compressed as a whole
+
+  Column 0 holds the timestamp (int64_t) and timestamp_usec (int32_t) of
+  each entry, followed by one column per field of the format, and a last
+  column with whatever follows the fields in an entry. A column with a
+  width of 0 starts with a uint32_t length per entry. If the fields of an
+  entry can not be told apart, the block only has the timestamp column and
+  the last column, which then holds the whole entry.
+  -------------------------------------------------------------------------*/
+
+enum LogColumnarCompression {
+  LOG_COLUMNAR_UNCOMPRESSED = 0,
+  LOG_COLUMNAR_ZSTD,
+};
+
+struct LogColumnarBlockHeader {
+  uint32_t cookie;         // LOG_COLUMNAR_COOKIE
+  uint32_t version;        // LOG_COLUMNAR_VERSION
+  uint32_t block_bytes;    // the whole block, this header included
+  uint32_t entry_count;    // number of entries in the block
+  uint32_t low_timestamp;  // lowest timestamp value of entries
+  uint32_t high_timestamp; // highest timestamp value of entries
+  uint32_t column_count;   // number of LogColumnIndex following the prefix
+  uint32_t compression;    // LogColumnarCompression of the column data
+  uint32_t prefix_bytes;   // the LogBufferHeader and its strings, padded
+  uint32_t raw_bytes;      // the column data before compression
+  uint32_t payload_bytes;  // the column data as stored
+  uint32_t reserved;
+};
+
+#define LOG_COLUMN_HAS_RANGE 1
+
+struct LogColumnIndex {
+  uint32_t width; // bytes per entry, 0 if the entries vary in size
+  uint32_t flags; // LOG_COLUMN_HAS_RANGE if min and max are set
+  uint32_t bytes; // bytes of the column in the raw column data
+  uint32_t reserved;
+  int64_t min; // smallest integer value of the column
+  int64_t max; // largest integer value of the column
+};
+
+namespace LogColumnar
+{
+/** Encodes the entries of a LogBuffer as a columnar block.
+
+    @a fieldlist is the field list of the format of the buffer, it is used
+    to split the entries in columns. Returns an ats_malloc()'d block and
+    its length in @a block_len, or nullptr if the buffer is invalid.
+ */
+char *encode(LogBufferHeader *header, LogFieldList *fieldlist, int *block_len);
+} // namespace LogColumnar
+
+/*-------------------------------------------------------------------------
+  LogColumnarReader
+
+  Reads the blocks of a columnar log file and rebuilds a LogBufferHeader
+  from each, so that the tools that read binary logs can process them. A
+  reader can have predicates on the entry timestamp and the integer fields,
+  blocks whose column index shows that no entry can match are skipped
+  without being decompressed, and only the matching entries are rebuilt.
+  -------------------------------------------------------------------------*/
+
+class LogColumnarReader
+{
+public:
+  LogColumnarReader() = default;
+  ~LogColumnarReader();
+
+  /** Adds the predicates of @a spec, a comma separated list of
+      "<field><op><integer>" where field is "timestamp" or the symbol of an
+      integer field and op is one of = != < <= > >=. Entries must match all
+      the predicates. Returns false if @a spec is not valid.
+   */
+  bool add_predicates(const char *spec);
+
+  bool
+  has_predicates() const
+  {
+    return !m_predicates.empty();
+  }
+
+  /** Reads the rest of a block from @a fd, the first @a have bytes of the
+      block were already read into @a start. Returns 1 if a block was read,
+      0 at the end of the file and -1 on error.
+   */
+  int read(int fd, const char *start, int have);
+
+  /** The header of the block last read.
+   */
+  const LogColumnarBlockHeader *
+  block() const
+  {
+    return reinterpret_cast<const LogColumnarBlockHeader *>(m_block);
+  }
+
+  /** Decodes the block last read. Returns the LogBufferHeader holding the
+      entries that match the predicates, owned by the reader and valid
+      until the next call, or nullptr if there are none or on error.
+   */
+  LogBufferHeader *decode();
+
+  uint64_t blocks_read     = 0;
+  uint64_t blocks_skipped  = 0;
+  uint64_t entries_matched = 0;
+
+  // noncopyable
+  LogColumnarReader(const LogColumnarReader &) = delete;
+  LogColumnarReader &operator=(const LogColumnarReader &) = delete;
+
+private:
+  enum PredicateOp { OP_EQ, OP_NE, OP_LT, OP_LE, OP_GT, OP_GE };
+
+  struct Predicate {
+    char *symbol;
+    PredicateOp op;
+    int64_t value;
+    int column; // resolved for the block being decoded, -1 if absent
+  };
+
+  bool resolve_predicates(LogBufferHeader *prefix);
+  bool block_may_match(const LogColumnIndex *index) const;
+  static bool match(const Predicate &p, int64_t value);
+
+  std::vector<Predicate> m_predicates;
+
+  char *m_block       = nullptr;
+  uint32_t m_block_sz = 0;
+  char *m_raw         = nullptr;
+  uint32_t m_raw_sz   = 0;
+  char *m_out         = nullptr;
+  uint32_t m_out_sz   = 0;
+
+  char *m_fieldlist_str     = nullptr;
+  LogFieldList *m_fieldlist = nullptr;
+};
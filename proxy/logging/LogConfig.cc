@@ -78,7 +78,9 @@ LogConfig::setup_default_values()
   logfile_perm          = 0644;
   logfile_dir           = ats_strdup(".");
 
-  preproc_threads = 1;
+  preproc_threads    = 1;
+  flush_threads      = 1;
+  max_flush_queue_mb = 0;
 
   rolling_enabled          = Log::NO_ROLLING;
   rolling_interval_sec     = 86400; // 24 hours
@@ -182,6 +184,16 @@ LogConfig::read_configuration_variables()
     preproc_threads = val;
   }
 
+  val = static_cast<int>(REC_ConfigReadInteger("proxy.config.log.flush_threads"));
+  if (val > 0 && val <= 128) {
+    flush_threads = val;
+  }
+
+  val = static_cast<int>(REC_ConfigReadInteger("proxy.config.log.max_flush_queue_mb"));
+  if (val >= 0) {
+    max_flush_queue_mb = val;
+  }
+
   // ROLLING
 
   // we don't check for valid values of rolling_enabled, rolling_interval_sec,
@@ -373,6 +385,8 @@ LogConfig::display(FILE *fd)
   fprintf(fd, "   error_log_filename = %s\n", error_log_filename);
 
   fprintf(fd, "   preproc_threads = %d\n", preproc_threads);
+  fprintf(fd, "   flush_threads = %d\n", flush_threads);
+  fprintf(fd, "   max_flush_queue_mb = %d\n", max_flush_queue_mb);
   fprintf(fd, "   rolling_enabled = %d\n", rolling_enabled);
   fprintf(fd, "   rolling_interval_sec = %d\n", rolling_interval_sec);
   fprintf(fd, "   rolling_offset_hr = %d\n", rolling_offset_hr);
@@ -546,6 +560,23 @@ LogConfig::register_stat_callbacks()
   RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.bytes_lost_before_written_to_disk", RECD_INT, RECP_PERSISTENT,
                      (int)log_stat_bytes_lost_before_written_to_disk_stat, RecRawStatSyncSum);
   //
+  // Flush queue
+  //
+  RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.flush_queue_depth", RECD_INT, RECP_NON_PERSISTENT,
+                     (int)log_stat_flush_queue_depth_stat, RecRawStatSyncSum);
+  RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.flush_buffers_dropped", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)log_stat_flush_buffers_dropped_stat, RecRawStatSyncSum);
+  RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.flush_latency_1ms", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)log_stat_flush_latency_1ms_stat, RecRawStatSyncSum);
+  RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.flush_latency_10ms", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)log_stat_flush_latency_10ms_stat, RecRawStatSyncSum);
+  RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.flush_latency_100ms", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)log_stat_flush_latency_100ms_stat, RecRawStatSyncSum);
+  RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.flush_latency_1s", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)log_stat_flush_latency_1s_stat, RecRawStatSyncSum);
+  RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.flush_latency_inf", RECD_COUNTER, RECP_PERSISTENT,
+                     (int)log_stat_flush_latency_inf_stat, RecRawStatSyncSum);
+  //
   // I/O
   //
   RecRegisterRawStat(log_rsb, RECT_PROCESS, "proxy.process.log.log_files_open", RECD_COUNTER, RECP_NON_PERSISTENT,
@@ -67,6 +67,15 @@ enum {
   log_stat_bytes_written_to_disk_stat,
   log_stat_bytes_lost_before_written_to_disk_stat,
 
+  // Flush queue
+  log_stat_flush_queue_depth_stat,
+  log_stat_flush_buffers_dropped_stat,
+  log_stat_flush_latency_1ms_stat,
+  log_stat_flush_latency_10ms_stat,
+  log_stat_flush_latency_100ms_stat,
+  log_stat_flush_latency_1s_stat,
+  log_stat_flush_latency_inf_stat,
+
   // Logging I/O
   log_stat_log_files_open_stat,
   log_stat_log_files_space_used_stat,
@@ -189,6 +198,8 @@ public:
   int logfile_perm;
 
   int preproc_threads;
+  int flush_threads;
+  int max_flush_queue_mb;
 
   Log::RollingEnabledValues rolling_enabled;
   int rolling_interval_sec;
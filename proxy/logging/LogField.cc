@@ -606,6 +606,35 @@ LogField::unmarshal(char **buf, char *dest, int len)
   }
 }
 
+/*-------------------------------------------------------------------------
+  LogField::to_text
+
+  Marshal the field for the given LogAccess object and convert it to the
+  text it would have in an ascii log. Returns the length of the text
+  written to dest, or -1 if it does not fit.
+  -------------------------------------------------------------------------*/
+int
+LogField::to_text(LogAccess *lad, char *dest, int len)
+{
+  static const unsigned BUFSIZE = 1024;
+  char small_buf[BUFSIZE];
+  char *big_buf = nullptr;
+  char *buf     = small_buf;
+  unsigned mlen = marshal_len(lad);
+
+  if (mlen > BUFSIZE) {
+    big_buf = static_cast<char *>(ats_malloc(mlen));
+    buf     = big_buf;
+  }
+  marshal(lad, buf);
+
+  char *read_from = buf;
+  int res         = unmarshal(&read_from, dest, len);
+
+  ats_free(big_buf);
+  return res;
+}
+
 /*-------------------------------------------------------------------------
   LogField::display
   -------------------------------------------------------------------------*/
@@ -749,6 +778,8 @@ LogFieldList::clear()
     delete f; // safe given the semantics stated above
   }
   m_marshal_len = 0;
+  m_marshal_steps.clear();
+  m_variable_steps.clear();
   _badSymbols.clear();
 }
 
@@ -758,13 +789,16 @@ LogFieldList::add(LogField *field, bool copy)
   ink_assert(field != nullptr);
 
   if (copy) {
-    m_field_list.enqueue(new LogField(*field));
-  } else {
-    m_field_list.enqueue(field);
+    field = new LogField(*field);
   }
+  m_field_list.enqueue(field);
 
+  MarshalStep step = {field, field->marshal_func()};
+  m_marshal_steps.push_back(step);
   if (field->type() == LogField::sINT) {
     m_marshal_len += INK_MIN_ALIGN;
+  } else {
+    m_variable_steps.push_back(step);
   }
 }
 
@@ -800,16 +834,20 @@ LogFieldList::find_by_symbol(const char *symbol) const
   return nullptr;
 }
 
+/*-------------------------------------------------------------------------
+  LogFieldList::marshal_len
+
+  The sINT fields always take INK_MIN_ALIGN bytes and are accounted for
+  in m_marshal_len, only the other fields are asked for their length.
+  -------------------------------------------------------------------------*/
 unsigned
 LogFieldList::marshal_len(LogAccess *lad)
 {
   int bytes = 0;
-  for (LogField *f = first(); f; f = next(f)) {
-    if (f->type() != LogField::sINT) {
-      const int len = f->marshal_len(lad);
-      ink_release_assert(len >= INK_MIN_ALIGN);
-      bytes += len;
-    }
+  for (const MarshalStep &step : m_variable_steps) {
+    const int len = step.func ? (lad->*step.func)(nullptr) : step.field->marshal_len(lad);
+    ink_release_assert(len >= INK_MIN_ALIGN);
+    bytes += len;
   }
   return m_marshal_len + bytes;
 }
@@ -817,11 +855,10 @@ LogFieldList::marshal_len(LogAccess *lad)
 unsigned
 LogFieldList::marshal(LogAccess *lad, char *buf)
 {
-  char *ptr;
   int bytes = 0;
-  for (LogField *f = first(); f; f = next(f)) {
-    ptr = &buf[bytes];
-    bytes += f->marshal(lad, ptr);
+  for (const MarshalStep &step : m_marshal_steps) {
+    char *ptr = &buf[bytes];
+    bytes += step.func ? (lad->*step.func)(ptr) : step.field->marshal(lad, ptr);
     ink_assert(bytes % INK_MIN_ALIGN == 0);
   }
   return bytes;
@@ -25,6 +25,7 @@
 
 #include <string_view>
 #include <string>
+#include <vector>
 
 #include "tscore/ink_platform.h"
 #include "tscore/List.h"
@@ -134,6 +135,7 @@ public:
   unsigned marshal(LogAccess *lad, char *buf);
   unsigned marshal_agg(char *buf);
   unsigned unmarshal(char **buf, char *dest, int len);
+  int to_text(LogAccess *lad, char *dest, int len);
   void display(FILE *fd = stdout);
   bool operator==(LogField &rhs);
   void updateField(LogAccess *lad, char *val, int len);
@@ -162,6 +164,20 @@ public:
     return m_alias_map;
   }
 
+  // The unmarshalling routine, or nullptr if the field has an alias map.
+  UnmarshalFunc
+  unmarshal_func() const
+  {
+    return m_alias_map ? nullptr : m_unmarshal_func;
+  }
+
+  // The marshalling routine, or nullptr if the field is in a container.
+  MarshalFunc
+  marshal_func() const
+  {
+    return m_container == NO_CONTAINER ? m_marshal_func : nullptr;
+  }
+
   Aggregate
   aggregate() const
   {
@@ -266,8 +282,17 @@ public:
   LogFieldList &operator=(const LogFieldList &rhs) = delete;
 
 private:
+  // The fields compiled for marshalling, in the order of the list. func is
+  // the marshalling routine of the field if it can be called directly.
+  struct MarshalStep {
+    LogField *field;
+    LogField::MarshalFunc func;
+  };
+
   unsigned m_marshal_len = 0;
   Queue<LogField> m_field_list;
+  std::vector<MarshalStep> m_marshal_steps;
+  std::vector<MarshalStep> m_variable_steps; // the fields that are not a fixed size
   std::string _badSymbols;
 };
 
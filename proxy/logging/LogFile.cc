@@ -34,6 +34,7 @@
 #include "tscore/ink_platform.h"
 #include "tscore/SimpleTokenizer.h"
 #include "tscore/ink_file.h"
+#include "tscore/HashFNV.h"
 
 #include <cerrno>
 #include <sys/types.h>
@@ -49,6 +50,7 @@
 #include "LogFilter.h"
 #include "LogFormat.h"
 #include "LogBuffer.h"
+#include "LogColumnar.h"
 #include "LogFile.h"
 #include "LogObject.h"
 #include "LogUtils.h"
@@ -82,6 +84,8 @@ LogFile::LogFile(const char *name, const char *header, LogFileFormat format, uin
 
   m_fd                = -1;
   m_ascii_buffer_size = (ascii_buffer_size < max_line_size ? max_line_size : ascii_buffer_size);
+  m_flush_idx         = flush_index(name);
+  ink_mutex_init(&m_flush_mutex);
 
   Debug("log-file", "exiting LogFile constructor, m_name=%s, this=%p", m_name, this);
 }
@@ -101,10 +105,13 @@ LogFile::LogFile(const LogFile &copy)
     m_ascii_buffer_size(copy.m_ascii_buffer_size),
     m_max_line_size(copy.m_max_line_size),
     m_pipe_buffer_size(copy.m_pipe_buffer_size),
-    m_fd(copy.m_fd)
+    m_fd(copy.m_fd),
+    m_flush_idx(copy.m_flush_idx)
 {
   ink_release_assert(m_ascii_buffer_size >= m_max_line_size);
 
+  ink_mutex_init(&m_flush_mutex);
+
   if (copy.m_log) {
     m_log = new BaseLogFile(*(copy.m_log));
   } else {
@@ -129,6 +136,7 @@ LogFile::~LogFile()
   delete m_log;
   ats_free(m_header);
   ats_free(m_name);
+  ink_mutex_destroy(&m_flush_mutex);
   Debug("log-file", "exiting LogFile destructor, this=%p", this);
 }
 
@@ -143,7 +151,26 @@ LogFile::change_name(const char *new_name)
   if (m_log) {
     m_log->change_name(new_name);
   }
-  m_name = ats_strdup(new_name);
+  m_name      = ats_strdup(new_name);
+  m_flush_idx = flush_index(new_name);
+}
+
+/*-------------------------------------------------------------------------
+  LogFile::flush_index
+
+  The flush thread of a log file is picked from a hash of its path, so
+  that the copies a reconfiguration makes of a LogFile, and a LogFile that
+  is created again for the same path, are written by the same thread as
+  the buffers still queued for the previous one.
+  -------------------------------------------------------------------------*/
+
+unsigned
+LogFile::flush_index(const char *path)
+{
+  ATSHash32FNV1a fnv;
+  fnv.update(path, strlen(path));
+  fnv.final();
+  return fnv.get();
 }
 
 /*-------------------------------------------------------------------------
@@ -237,7 +264,7 @@ LogFile::open_file()
   // file.
   //
   if (!file_exists) {
-    if (m_file_format != LOG_FILE_BINARY && m_header && m_log) {
+    if (m_file_format != LOG_FILE_BINARY && m_file_format != LOG_FILE_COLUMNAR && m_header && m_log) {
       Debug("log-file", "writing header to LogFile %s", m_name);
       writeln(m_header, strlen(m_header), fileno(m_log->m_fp), m_name);
     }
@@ -372,10 +399,12 @@ LogFile::roll(long interval_start, long interval_end, bool reopen_after_rolling)
     // the old/new object swap happens within lock/unlock calls within Diags.cc.
     // For logging log files, the rolling is implemented by renaming the original file and closing it.
     // Afterwards, the LogFile object will re-open a new file with the original file name using the original object.
-    // There is no need to protect against contention since the open/close/writes are all executed under a
-    // single log flush thread.
+    // The flush threads write to the file under m_flush_mutex, which is held here so that no buffer is
+    // written while the file is being renamed and closed.
     // Since these two methods of using BaseLogFile are not compatible, we perform the logging log file specific
     // close file operation here within the containing LogFile object.
+    ink_scoped_mutex_lock lock(m_flush_mutex);
+
     if (m_log->roll(interval_start, interval_end)) {
       if (m_log->close_file()) {
         Error("Error closing LogFile %s: %s.", m_log->get_name(), strerror(errno));
@@ -416,6 +445,8 @@ LogFile::reopen_if_moved()
     return false;
   }
 
+  ink_scoped_mutex_lock lock(m_flush_mutex);
+
   // Both of the following log if there are problems.
   close_file();
   open_file();
@@ -472,7 +503,7 @@ LogFile::preproc_and_try_delete(LogBuffer *lb)
     // don't change between buffers), it's not worth trying to separate
     // out the buffer-dependent data from the buffer-independent data.
     //
-    LogFlushData *flush_data = new LogFlushData(this, lb);
+    LogFlushData *flush_data = new LogFlushData(this, lb, lb->header()->byte_count);
 
     ProxyMutex *mutex = this_thread()->mutex.get();
 
@@ -480,9 +511,7 @@ LogFile::preproc_and_try_delete(LogBuffer *lb)
 
     RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_flush_to_disk_stat, lb->header()->byte_count);
 
-    ink_atomiclist_push(Log::flush_data_list, flush_data);
-
-    Log::flush_notify->signal();
+    Log::push_flush_data(flush_data);
 
     //
     // LogBuffer will be deleted in flush thread
@@ -491,6 +520,27 @@ LogFile::preproc_and_try_delete(LogBuffer *lb)
   } else if (m_file_format == LOG_FILE_ASCII || m_file_format == LOG_FILE_PIPE) {
     write_ascii_logbuffer3(buffer_header);
     ret = 0;
+  } else if (m_file_format == LOG_FILE_COLUMNAR) {
+    //
+    // The columnar block is built here, in the preproc thread, so that the
+    // flush thread only has to write it out.
+    //
+    LogObject *owner = lb->get_owner();
+    int block_len    = 0;
+    char *block = LogColumnar::encode(buffer_header, owner ? &owner->m_format->m_field_list : nullptr, &block_len);
+
+    if (block) {
+      LogFlushData *flush_data = new LogFlushData(this, block, block_len);
+      ProxyMutex *mutex        = this_thread()->mutex.get();
+
+      RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_num_flush_to_disk_stat, buffer_header->entry_count);
+      RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_flush_to_disk_stat, block_len);
+
+      Log::push_flush_data(flush_data);
+      ret = 0;
+    } else {
+      Note("Cannot write LogBuffer to LogFile %s; failed to build a columnar block", m_name);
+    }
   } else {
     Note("Cannot write LogBuffer to LogFile %s; invalid file format: %d", m_name, m_file_format);
   }
@@ -609,6 +659,12 @@ LogFile::write_ascii_logbuffer3(LogBufferHeader *buffer_header, const char *alt_
     return 0;
   }
 
+  // compile the format once for the whole buffer
+  LogAsciiProgram *program = nullptr;
+  if (!alt_format && format_type != LOG_FORMAT_TEXT) {
+    program = LogBuffer::ascii_program(fieldlist_str, printf_str);
+  }
+
   while ((entry_header = iter.next())) {
     fmt_entry_count = 0;
     fmt_buf_bytes   = 0;
@@ -626,8 +682,14 @@ LogFile::write_ascii_logbuffer3(LogBufferHeader *buffer_header, const char *alt_
         Warning("Log is too long(%" PRIu32 "), it would be truncated. max_len:%zu", entry_header->entry_len, m_max_line_size);
       }
 
-      int bytes = LogBuffer::to_ascii(entry_header, format_type, &ascii_buffer[fmt_buf_bytes], m_max_line_size - 1, fieldlist_str,
-                                      printf_str, buffer_header->version, alt_format);
+      int bytes;
+      if (program) {
+        bytes = program->run(reinterpret_cast<char *>(entry_header) + sizeof(LogEntryHeader), &ascii_buffer[fmt_buf_bytes],
+                             m_max_line_size - 1);
+      } else {
+        bytes = LogBuffer::to_ascii(entry_header, format_type, &ascii_buffer[fmt_buf_bytes], m_max_line_size - 1, fieldlist_str,
+                                    printf_str, buffer_header->version, alt_format);
+      }
 
       if (bytes > 0) {
         fmt_buf_bytes += bytes;
@@ -662,9 +724,7 @@ LogFile::write_ascii_logbuffer3(LogBufferHeader *buffer_header, const char *alt_
 
     RecIncrRawStat(log_rsb, mutex->thread_holding, log_stat_bytes_flush_to_disk_stat, fmt_buf_bytes);
 
-    ink_atomiclist_push(Log::flush_data_list, flush_data);
-
-    Log::flush_notify->signal();
+    Log::push_flush_data(flush_data);
 
     total_bytes += fmt_buf_bytes;
   }
@@ -741,8 +801,8 @@ LogFile::writeln(char *data, int len, int fd, const char *path)
 void
 LogFile::check_fd()
 {
-  static bool failure_last_call    = false;
-  static unsigned stat_check_count = 1;
+  static thread_local bool failure_last_call    = false;
+  static thread_local unsigned stat_check_count = 1;
 
   if ((stat_check_count % Log::config->file_stat_frequency) == 0) {
     //
@@ -86,13 +86,23 @@ public:
   const char *
   get_format_name() const
   {
-    return (m_file_format == LOG_FILE_BINARY ? "binary" : (m_file_format == LOG_FILE_PIPE ? "ascii_pipe" : "ascii"));
+    switch (m_file_format) {
+    case LOG_FILE_BINARY:
+      return "binary";
+    case LOG_FILE_PIPE:
+      return "ascii_pipe";
+    case LOG_FILE_COLUMNAR:
+      return "columnar";
+    default:
+      return "ascii";
+    }
   }
 
   static int write_ascii_logbuffer(LogBufferHeader *buffer_header, int fd, const char *path, const char *alt_format = nullptr);
   int write_ascii_logbuffer3(LogBufferHeader *buffer_header, const char *alt_format = nullptr);
   static bool rolled_logfile(char *file);
   static bool exists(const char *pathname);
+  static unsigned flush_index(const char *path);
 
   void display(FILE *fd = stdout);
   int open_file();
@@ -129,6 +139,8 @@ public:
   size_t m_max_line_size;     // size of longest log line (record)
   int m_pipe_buffer_size;     // this is the size of the pipe buffer set by fcntl
   int m_fd;                   // this could back m_log or a pipe, depending on the situation
+  unsigned m_flush_idx;       // the flush thread that writes this file, modulo Log::flush_threads, see flush_index()
+  ink_mutex m_flush_mutex;    // held by the flush thread while writing, and while rolling or reopening
 
 public:
   Link<LogFile> link;
@@ -38,9 +38,10 @@
 #include "LogConfig.h"
 #include "Log.h"
 #include "tscore/SimpleTokenizer.h"
+#include "tscore/HashFNV.h"
 
 const char *LogFilter::OPERATOR_NAME[] = {"MATCH", "CASE_INSENSITIVE_MATCH", "CONTAIN", "CASE_INSENSITIVE_CONTAIN"};
-const char *LogFilter::ACTION_NAME[]   = {"REJECT", "ACCEPT", "WIPE_FIELD_VALUE"};
+const char *LogFilter::ACTION_NAME[]   = {"REJECT", "ACCEPT", "WIPE_FIELD_VALUE", "SAMPLE"};
 
 /*-------------------------------------------------------------------------
   LogFilter::LogFilter
@@ -73,13 +74,14 @@ LogFilter::parse(const char *name, Action action, const char *condition)
 
   ink_release_assert(action != N_ACTIONS);
 
-  if (tok.getNumTokensRemaining() < 3) {
+  // a sample filter has no operator
+  if (tok.getNumTokensRemaining() < (action == SAMPLE ? 2 : 3)) {
     Error("Invalid condition syntax '%s'; cannot create filter '%s'", condition, name);
     return nullptr;
   }
 
   char *field_str = tok.getNext();
-  char *oper_str  = tok.getNext();
+  char *oper_str  = (action == SAMPLE) ? nullptr : tok.getNext();
   char *val_str   = tok.getRest();
 
   // validate field symbol
@@ -137,6 +139,16 @@ LogFilter::parse(const char *name, Action action, const char *condition)
     return nullptr;
   }
 
+  if (action == SAMPLE) {
+    char *end    = nullptr;
+    int64_t rate = strtoll(val_str, &end, 10);
+    if (rate < 1 || end == val_str || *end != '\0') {
+      Error("'%s' is not a valid sample rate; cannot create filter '%s'", val_str, name);
+      return nullptr;
+    }
+    return new LogFilterSample(name, logfield, rate);
+  }
+
   // convert the operator string to an enum value and validate it
   LogFilter::Operator oper = LogFilter::N_OPERATORS;
   for (unsigned i = 0; i < LogFilter::N_OPERATORS; ++i) {
@@ -907,6 +919,73 @@ LogFilterIP::display(FILE *fd)
   }
 }
 
+/*-------------------------------------------------------------------------
+  LogFilterSample::LogFilterSample
+  -------------------------------------------------------------------------*/
+LogFilterSample::LogFilterSample(const char *name, LogField *field, int64_t rate)
+  : LogFilter(name, field, LogFilter::SAMPLE, LogFilter::MATCH), m_rate(rate)
+{
+  m_type       = SAMPLE_FILTER;
+  m_num_values = 1;
+}
+
+LogFilterSample::LogFilterSample(const LogFilterSample &rhs) : LogFilterSample(rhs.m_name, rhs.m_field, rhs.m_rate) {}
+
+LogFilterSample::~LogFilterSample() = default;
+
+bool
+LogFilterSample::operator==(LogFilterSample &rhs)
+{
+  return m_type == rhs.m_type && *m_field == *rhs.m_field && m_rate == rhs.m_rate;
+}
+
+/*-------------------------------------------------------------------------
+  LogFilterSample::toss_this_entry
+
+  The text of the field is hashed rather than its marshalled form, which
+  can have padding that is not initialized.
+  -------------------------------------------------------------------------*/
+bool
+LogFilterSample::toss_this_entry(LogAccess *lad)
+{
+  if (m_rate <= 1 || m_field == nullptr || lad == nullptr) {
+    return false;
+  }
+
+  char text[1024];
+  int len = m_field->to_text(lad, text, sizeof(text));
+  if (len < 0) {
+    len = 0;
+  }
+  return toss_this_text(text, len);
+}
+
+bool
+LogFilterSample::toss_this_text(const char *text, int len) const
+{
+  if (m_rate <= 1) {
+    return false;
+  }
+
+  ATSHash64FNV1a hash;
+  hash.update(text, len);
+  hash.final();
+  return hash.get() % m_rate != 0;
+}
+
+bool
+LogFilterSample::wipe_this_entry(LogAccess * /* lad ATS_UNUSED */)
+{
+  return false;
+}
+
+void
+LogFilterSample::display(FILE *fd)
+{
+  ink_assert(fd != nullptr);
+  fprintf(fd, "Filter \"%s\" KEEPS one in %" PRId64 " records by the hash of %s\n", m_name, m_rate, m_field->symbol());
+}
+
 bool
 filters_are_equal(LogFilter *filt1, LogFilter *filt2)
 {
@@ -921,6 +1000,8 @@ filters_are_equal(LogFilter *filt1, LogFilter *filt2)
       ret = (*((LogFilterIP *)filt1) == *((LogFilterIP *)filt2));
     } else if (filt1->type() == LogFilter::STRING_FILTER) {
       ret = (*((LogFilterString *)filt1) == *((LogFilterString *)filt2));
+    } else if (filt1->type() == LogFilter::SAMPLE_FILTER) {
+      ret = (*((LogFilterSample *)filt1) == *((LogFilterSample *)filt2));
     } else {
       ink_assert(!"invalid filter type");
     }
@@ -1002,6 +1083,9 @@ LogFilterList::add(LogFilter *filter, bool copy)
     } else if (filter->type() == LogFilter::IP_FILTER) {
       LogFilterIP *f = new LogFilterIP(*((LogFilterIP *)filter));
       m_filter_list.enqueue(f);
+    } else if (filter->type() == LogFilter::SAMPLE_FILTER) {
+      LogFilterSample *f = new LogFilterSample(*((LogFilterSample *)filter));
+      m_filter_list.enqueue(f);
     } else {
       LogFilterString *f = new LogFilterString(*((LogFilterString *)filter));
       m_filter_list.enqueue(f);
@@ -1125,6 +1209,16 @@ REGRESSION_TEST(Log_FilterParse)(RegressionTest *t, int /* atype */, int *pstatu
   CHECK_FORMAT_PARSE("pssc MATCH 200");
   CHECK_FORMAT_PARSE("shn CASE_INSENSITIVE_CONTAIN unwanted.com");
 
+  retfilter = LogFilter::parse("t6", LogFilter::SAMPLE, "chi 100");
+  box.check(retfilter != nullptr && retfilter->type() == LogFilter::SAMPLE_FILTER, "failed to parse sample filter");
+  delete retfilter;
+  retfilter = LogFilter::parse("t7", LogFilter::SAMPLE, "chi 0");
+  box.check(retfilter == nullptr, "Invalid sample rate");
+  delete retfilter;
+  retfilter = LogFilter::parse("t8", LogFilter::SAMPLE, "chi");
+  box.check(retfilter == nullptr, "A sample rate is required");
+  delete retfilter;
+
 #undef CHECK_FORMAT_PARSE
 }
 
@@ -45,6 +45,7 @@ public:
     INT_FILTER = 0,
     STRING_FILTER,
     IP_FILTER,
+    SAMPLE_FILTER,
     N_TYPES,
   };
 
@@ -52,6 +53,7 @@ public:
     REJECT = 0,
     ACCEPT,
     WIPE_FIELD_VALUE,
+    SAMPLE,
     N_ACTIONS,
   };
 
@@ -248,6 +250,42 @@ private:
   LogFilterIP();
 };
 
+/*-------------------------------------------------------------------------
+  LogFilterSample
+
+  Keeps one in N records, chosen by a hash of the text of a field, so that
+  the same records are kept on every run and all the records with a given
+  field value are either kept or tossed. The condition is "<field> <N>".
+  -------------------------------------------------------------------------*/
+
+class LogFilterSample : public LogFilter
+{
+public:
+  LogFilterSample(const char *name, LogField *field, int64_t rate);
+  LogFilterSample(const LogFilterSample &rhs);
+  ~LogFilterSample() override;
+
+  bool operator==(LogFilterSample &rhs);
+
+  bool toss_this_entry(LogAccess *lad) override;
+  bool wipe_this_entry(LogAccess *lad) override;
+  void display(FILE *fd = stdout) override;
+
+  /** Whether an entry whose field has the text @a text is tossed. The same
+      text always gets the same answer, in every process.
+   */
+  bool toss_this_text(const char *text, int len) const;
+
+  // noncopyable
+  LogFilterSample &operator=(LogFilterSample &rhs) = delete;
+
+private:
+  int64_t m_rate; // keep one record in m_rate
+
+  // -- member functions that are not allowed --
+  LogFilterSample();
+};
+
 bool filters_are_equal(LogFilter *filt1, LogFilter *filt2);
 
 /*-------------------------------------------------------------------------
@@ -115,6 +115,8 @@ LogObject::LogObject(LogConfig *cfg, const LogFormat *format, const char *log_di
     m_flags |= BINARY;
   } else if (file_format == LOG_FILE_PIPE) {
     m_flags |= WRITES_TO_PIPE;
+  } else if (file_format == LOG_FILE_COLUMNAR) {
+    m_flags |= COLUMNAR;
   }
 
   generate_filenames(log_dir, basename, file_format);
@@ -147,6 +149,7 @@ LogObject::~LogObject()
   ats_free(m_filename);
   ats_free(m_alt_filename);
   delete m_format;
+  delete m_aggregator;
   delete[] m_buffer_manager;
   delete static_cast<LogBuffer *>(FREELIST_POINTER(m_log_buffer));
 }
@@ -210,6 +213,10 @@ LogObject::generate_filenames(const char *log_dir, const char *basename, LogFile
       ext     = LOG_FILE_PIPE_OBJECT_FILENAME_EXTENSION;
       ext_len = 5;
       break;
+    case LOG_FILE_COLUMNAR:
+      ext     = LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION;
+      ext_len = 5;
+      break;
     default:
       ink_assert(!"unknown file format");
     }
@@ -268,6 +275,13 @@ LogObject::set_filter_list(const LogFilterList &list, bool copy)
   m_filter_list.set_conjunction(list.does_conjunction());
 }
 
+void
+LogObject::set_aggregator(LogAggregator *aggregator)
+{
+  delete m_aggregator;
+  m_aggregator = aggregator;
+}
+
 // we compute the object signature from the fieldlist_str and the printf_str
 // of the LogFormat rather than from the format_str because the format_str
 // is not part of a LogBuffer header
@@ -287,8 +301,12 @@ LogObject::compute_signature(LogFormat *format, char *filename, unsigned int fla
     int buf_size = strlen(fl) + strlen(ps) + strlen(filename) + 2;
     char *buffer = static_cast<char *>(ats_malloc(buf_size));
 
-    ink_string_concatenate_strings(buffer, fl, ps, filename,
-                                   flags & LogObject::BINARY ? "B" : (flags & LogObject::WRITES_TO_PIPE ? "P" : "A"), NULL);
+    const char *type = (flags & LogObject::BINARY)         ? "B" :
+                       (flags & LogObject::WRITES_TO_PIPE) ? "P" :
+                       (flags & LogObject::COLUMNAR)       ? "C" :
+                                                             "A";
+
+    ink_string_concatenate_strings(buffer, fl, ps, filename, type, NULL);
 
     CryptoHash hash;
     CryptoContext().hash_immediate(hash, buffer, buf_size - 1);
@@ -519,6 +537,11 @@ LogObject::log(LogAccess *lad, std::string_view text_entry)
     Debug("log", "entry wiped, ...");
   }
 
+  if (lad && m_aggregator) {
+    m_aggregator->add(lad);
+    return Log::AGGR;
+  }
+
   if (lad && m_format->is_aggregate()) {
     // marshal the field data into the temp space provided by the
     // LogFormat object for aggregate formats
@@ -750,6 +773,10 @@ LogObject::_roll_files(long last_roll_time, long time_now)
 void
 LogObject::check_buffer_expiration(long time_now)
 {
+  if (m_aggregator) {
+    m_aggregator->emit(this, time_now);
+  }
+
   LogBuffer *b = static_cast<LogBuffer *>(FREELIST_POINTER(m_log_buffer));
   if (b && time_now > b->expiration_time()) {
     force_new_buffer();
@@ -31,6 +31,7 @@
 #include "LogBuffer.h"
 #include "LogAccess.h"
 #include "LogFilter.h"
+#include "LogAggregator.h"
 #include <vector>
 
 /*-------------------------------------------------------------------------
@@ -48,6 +49,7 @@
 #define LOG_FILE_ASCII_OBJECT_FILENAME_EXTENSION ".log"
 #define LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION ".blog"
 #define LOG_FILE_PIPE_OBJECT_FILENAME_EXTENSION ".pipe"
+#define LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION ".clog"
 
 #define FLUSH_ARRAY_SIZE (512 * 4)
 
@@ -88,10 +90,12 @@ public:
     BINARY                   = 1,
     WRITES_TO_PIPE           = 4,
     LOG_OBJECT_FMT_TIMESTAMP = 8, // always format a timestamp into each log line (for raw text logs)
+    COLUMNAR                 = 16,
   };
 
   // BINARY: log is written in binary format (rather than ascii)
   // WRITES_TO_PIPE: object writes to a named pipe rather than to a file
+  // COLUMNAR: log is written in columnar blocks (see LogColumnar.h)
 
   LogObject(LogConfig *cfg, const LogFormat *format, const char *log_dir, const char *basename, LogFileFormat file_format,
             const char *header, Log::RollingEnabledValues rolling_enabled, int flush_threads, int rolling_interval_sec = 0,
@@ -102,6 +106,11 @@ public:
   void add_filter(LogFilter *filter, bool copy = true);
   void set_filter_list(const LogFilterList &list, bool copy = true);
 
+  /** Aggregate the entries with @a aggregator instead of logging them,
+      the object takes ownership of it.
+   */
+  void set_aggregator(LogAggregator *aggregator);
+
   inline void
   set_fmt_timestamps()
   {
@@ -288,6 +297,8 @@ private:
 
   int m_pipe_buffer_size;
 
+  LogAggregator *m_aggregator = nullptr;
+
   void generate_filenames(const char *log_dir, const char *basename, LogFileFormat file_format);
   void _setup_rolling(LogConfig *cfg, Log::RollingEnabledValues rolling_enabled, int rolling_interval_sec, int rolling_offset_hr,
                       int rolling_size_mb);
@@ -415,7 +426,8 @@ LogObject::operator==(LogObject &old)
           strcmp(m_logFile->get_name(), old.m_logFile->get_name()) == 0 && (m_filter_list == old.m_filter_list) &&
           (m_rolling_interval_sec == old.m_rolling_interval_sec && m_rolling_offset_hr == old.m_rolling_offset_hr &&
            m_rolling_size_mb == old.m_rolling_size_mb && m_reopen_after_rolling == old.m_reopen_after_rolling &&
-           m_max_rolled == old.m_max_rolled && m_min_rolled == old.m_min_rolled));
+           m_max_rolled == old.m_max_rolled && m_min_rolled == old.m_min_rolled) &&
+          (m_aggregator == nullptr ? old.m_aggregator == nullptr : old.m_aggregator && *m_aggregator == *old.m_aggregator));
 }
 
 inline off_t
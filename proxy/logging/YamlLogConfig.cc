@@ -24,6 +24,7 @@
 
 #include "LogConfig.h"
 #include "LogObject.h"
+#include "LogAggregator.h"
 
 #include "tscore/EnumDescriptor.h"
 
@@ -121,7 +122,54 @@ std::set<std::string> valid_log_object_keys = {"filename",
                                                "rolling_min_count",
                                                "rolling_max_count",
                                                "rolling_allow_empty",
-                                               "pipe_buffer_size"};
+                                               "pipe_buffer_size",
+                                               "aggregate"};
+
+std::set<std::string> valid_aggregate_keys = {"interval", "group_by", "values", "histogram", "max_groups"};
+
+LogAggregator *
+YamlLogConfig::decodeAggregator(const YAML::Node &node)
+{
+  for (auto const &item : node) {
+    if (std::none_of(valid_aggregate_keys.begin(), valid_aggregate_keys.end(),
+                     [&item](const std::string &s) { return s == item.first.as<std::string>(); })) {
+      throw YAML::ParserException(item.first.Mark(), "aggregate: unsupported key '" + item.first.as<std::string>() + "'");
+    }
+  }
+
+  if (!node["interval"]) {
+    throw YAML::ParserException(node.Mark(), "aggregate: missing 'interval' argument");
+  }
+  int interval   = node["interval"].as<int>();
+  int max_groups = node["max_groups"] ? node["max_groups"].as<int>() : 10000;
+  if (interval < 1 || max_groups < 1) {
+    throw YAML::ParserException(node.Mark(), "aggregate: 'interval' and 'max_groups' must be positive");
+  }
+
+  auto aggregator = std::make_unique<LogAggregator>(interval, max_groups);
+
+  for (auto const &field : node["group_by"]) {
+    std::string symbol = field.as<std::string>();
+    if (!aggregator->add_group_by(symbol.c_str())) {
+      throw YAML::ParserException(field.Mark(), "aggregate: unknown field '" + symbol + "'");
+    }
+  }
+  for (auto const &field : node["values"]) {
+    std::string symbol = field.as<std::string>();
+    if (!aggregator->add_value(symbol.c_str())) {
+      throw YAML::ParserException(field.Mark(), "aggregate: '" + symbol + "' is not an integer field");
+    }
+  }
+  if (node["histogram"]) {
+    auto bounds = node["histogram"].as<std::vector<int64_t>>();
+    if (!std::is_sorted(bounds.begin(), bounds.end()) || std::adjacent_find(bounds.begin(), bounds.end()) != bounds.end()) {
+      throw YAML::ParserException(node["histogram"].Mark(), "aggregate: the histogram bounds must be increasing");
+    }
+    aggregator->set_histogram(bounds);
+  }
+
+  return aggregator.release();
+}
 
 LogObject *
 YamlLogConfig::decodeLogObject(const YAML::Node &node)
@@ -133,10 +181,13 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
     }
   }
 
-  if (!node["format"]) {
+  // an aggregating object logs its own lines and has no format.
+  std::unique_ptr<LogAggregator> aggregator;
+  if (node["aggregate"]) {
+    aggregator.reset(decodeAggregator(node["aggregate"]));
+  } else if (!node["format"]) {
     throw YAML::ParserException(node.Mark(), "missing 'format' argument");
   }
-  std::string format = node["format"].as<std::string>();
 
   if (!node["filename"]) {
     throw YAML::ParserException(node.Mark(), "missing 'filename' argument");
@@ -148,19 +199,34 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
   }
 
   std::string filename = node["filename"].as<std::string>();
-  LogFormat *fmt       = cfg->format_list.find_by_name(format.c_str());
-  if (!fmt) {
-    Error("Format %s is not a known format; cannot create LogObject", format.c_str());
-    return nullptr;
+  const LogFormat *fmt = nullptr;
+  if (aggregator) {
+    static const LogFormat *aggregate_fmt = MakeTextLogFormat("aggregate");
+    fmt                                   = aggregate_fmt;
+  } else {
+    std::string format = node["format"].as<std::string>();
+    fmt                = cfg->format_list.find_by_name(format.c_str());
+    if (!fmt) {
+      Error("Format %s is not a known format; cannot create LogObject", format.c_str());
+      return nullptr;
+    }
   }
 
   // file format
   LogFileFormat file_type = LOG_FILE_ASCII; // default value
   if (node["mode"]) {
     std::string mode = node["mode"].as<std::string>();
-    file_type        = (0 == strncasecmp(mode.c_str(), "bin", 3) || (1 == mode.size() && mode[0] == 'b') ?
-                   LOG_FILE_BINARY :
-                   (0 == strcasecmp(mode.c_str(), "ascii_pipe") ? LOG_FILE_PIPE : LOG_FILE_ASCII));
+    if (0 == strncasecmp(mode.c_str(), "bin", 3) || (1 == mode.size() && mode[0] == 'b')) {
+      file_type = LOG_FILE_BINARY;
+    } else if (0 == strcasecmp(mode.c_str(), "ascii_pipe")) {
+      file_type = LOG_FILE_PIPE;
+    } else if (0 == strcasecmp(mode.c_str(), "columnar")) {
+      file_type = LOG_FILE_COLUMNAR;
+    }
+  }
+  if (aggregator && file_type != LOG_FILE_ASCII && file_type != LOG_FILE_PIPE) {
+    Warning("Aggregating log object %s can only be ascii or ascii_pipe; using ascii", filename.c_str());
+    file_type = LOG_FILE_ASCII;
   }
 
   int obj_rolling_enabled      = cfg->rolling_enabled;
@@ -221,6 +287,9 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
                                  obj_rolling_interval_sec, obj_rolling_offset_hr, obj_rolling_size_mb, /* auto_created */ false,
                                  /* rolling_max_count */ obj_rolling_max_count, /* rolling_min_count */ obj_rolling_min_count,
                                  /* reopen_after_rolling */ obj_rolling_allow_empty > 0, pipe_buffer_size);
+  if (aggregator) {
+    logObject->set_aggregator(aggregator.release());
+  }
 
   // Generate LogDeletingInfo entry for later use
   std::string ext;
@@ -234,6 +303,9 @@ YamlLogConfig::decodeLogObject(const YAML::Node &node)
   case LOG_FILE_BINARY:
     ext = LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION;
     break;
+  case LOG_FILE_COLUMNAR:
+    ext = LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION;
+    break;
   default:
     break;
   }
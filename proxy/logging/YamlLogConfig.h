@@ -21,6 +21,7 @@
 
 #pragma once
 
+class LogAggregator;
 class LogConfig;
 class LogObject;
 namespace YAML
@@ -38,6 +39,7 @@ private:
   bool loadLogConfig(const char *cfgFilename);
 
   LogObject *decodeLogObject(const YAML::Node &node);
+  LogAggregator *decodeAggregator(const YAML::Node &node);
 
   YamlLogConfig(const YamlLogConfig &) = delete;
   YamlLogConfig &operator=(const YamlLogConfig &) = delete;
@@ -0,0 +1,214 @@
+/** @file
+
+  Unit tests for the aggregation of log entries.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_RUNNER
+#include "catch.hpp"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tscore/I_Layout.h"
+
+#include "LogStandalone.cc"
+
+#include "LogAggregator.h"
+#include "Log.h"
+
+namespace
+{
+// the lines of the groups, sorted since the groups are not in any order
+std::vector<std::string>
+emit(LogAggregator &agg, long time_now)
+{
+  std::vector<std::string> lines;
+  agg.emit(time_now, [&lines](const std::string &line) { lines.push_back(line); });
+  std::sort(lines.begin(), lines.end());
+  return lines;
+}
+} // namespace
+
+TEST_CASE("LogAggregator", "[logging][aggregate]")
+{
+  LogAggregator agg(10, 100);
+  REQUIRE(agg.add_group_by("cqhm"));
+  REQUIRE(agg.add_value("ttms"));
+  agg.set_histogram({10, 100});
+
+  SECTION("fields")
+  {
+    LogAggregator other(10, 100);
+    CHECK_FALSE(other.add_group_by("nosuchfield"));
+    CHECK_FALSE(other.add_value("nosuchfield"));
+    // only integer fields can be aggregated
+    CHECK_FALSE(other.add_value("cqhm"));
+  }
+
+  SECTION("groups and values")
+  {
+    CHECK(emit(agg, 103).empty());
+
+    agg.add({"GET"}, {5});
+    agg.add({"GET"}, {10});
+    agg.add({"GET"}, {50});
+    agg.add({"POST"}, {500});
+    agg.add({"POST"}, {-1});
+
+    auto lines = emit(agg, 110);
+    REQUIRE(lines.size() == 2);
+    CHECK(lines[0] == "100 10 cqhm=GET count=3 ttms.sum=65 ttms.min=5 ttms.max=50 ttms.le10=2 ttms.le100=1 ttms.inf=0");
+    CHECK(lines[1] == "100 10 cqhm=POST count=2 ttms.sum=499 ttms.min=-1 ttms.max=500 ttms.le10=1 ttms.le100=0 ttms.inf=1");
+  }
+
+  SECTION("interval windows")
+  {
+    // the first call starts the interval the entries are counted in
+    CHECK(emit(agg, 100).empty());
+    agg.add({"GET"}, {1});
+
+    // nothing is logged before the interval ends
+    CHECK(emit(agg, 105).empty());
+    CHECK(emit(agg, 109).empty());
+
+    auto lines = emit(agg, 110);
+    REQUIRE(lines.size() == 1);
+    CHECK(lines[0].rfind("100 10 cqhm=GET count=1 ", 0) == 0);
+
+    // the groups were flushed, an empty interval logs nothing
+    CHECK(emit(agg, 120).empty());
+
+    // a late call logs the interval it started in and starts the current one
+    agg.add({"PUT"}, {2});
+    lines = emit(agg, 145);
+    REQUIRE(lines.size() == 1);
+    CHECK(lines[0].rfind("120 10 cqhm=PUT count=1 ", 0) == 0);
+    agg.add({"PUT"}, {3});
+    CHECK(emit(agg, 149).empty());
+    lines = emit(agg, 150);
+    REQUIRE(lines.size() == 1);
+    CHECK(lines[0].rfind("140 10 cqhm=PUT count=1 ttms.sum=3 ", 0) == 0);
+  }
+
+  SECTION("group by several fields")
+  {
+    LogAggregator by_two(60, 100);
+    REQUIRE(by_two.add_group_by("cqhm"));
+    REQUIRE(by_two.add_group_by("pssc"));
+    REQUIRE(by_two.add_value("ttms"));
+    REQUIRE(by_two.add_value("psql"));
+    emit(by_two, 60);
+
+    by_two.add({"GET", "200"}, {1, 100});
+    by_two.add({"GET", "404"}, {2, 200});
+    by_two.add({"GET", "200"}, {3, 300});
+    // an empty text is a group of its own
+    by_two.add({"", "200"}, {4, 400});
+
+    auto lines = emit(by_two, 120);
+    REQUIRE(lines.size() == 3);
+    CHECK(lines[0] == "60 60 cqhm= pssc=200 count=1 ttms.sum=4 ttms.min=4 ttms.max=4 ttms.inf=1 psql.sum=400 psql.min=400 "
+                      "psql.max=400 psql.inf=1");
+    CHECK(lines[1] == "60 60 cqhm=GET pssc=200 count=2 ttms.sum=4 ttms.min=1 ttms.max=3 ttms.inf=2 psql.sum=400 psql.min=100 "
+                      "psql.max=300 psql.inf=2");
+    CHECK(lines[2] == "60 60 cqhm=GET pssc=404 count=1 ttms.sum=2 ttms.min=2 ttms.max=2 ttms.inf=1 psql.sum=200 psql.min=200 "
+                      "psql.max=200 psql.inf=1");
+  }
+
+  SECTION("too many groups")
+  {
+    LogAggregator small(10, 2);
+    REQUIRE(small.add_group_by("cqhm"));
+    REQUIRE(small.add_value("ttms"));
+    emit(small, 100);
+
+    small.add({"GET"}, {1});
+    small.add({"POST"}, {2});
+    small.add({"PUT"}, {3});
+    small.add({"DELETE"}, {4});
+    small.add({"GET"}, {5});
+
+    auto lines = emit(small, 110);
+    REQUIRE(lines.size() == 3);
+    CHECK(lines[0] == "100 10 cqhm=- count=2 ttms.sum=7 ttms.min=3 ttms.max=4 ttms.inf=2");
+    CHECK(lines[1] == "100 10 cqhm=GET count=2 ttms.sum=6 ttms.min=1 ttms.max=5 ttms.inf=2");
+    CHECK(lines[2] == "100 10 cqhm=POST count=1 ttms.sum=2 ttms.min=2 ttms.max=2 ttms.inf=1");
+
+    // the flush frees the room of the groups for the next interval
+    small.add({"PUT"}, {3});
+    small.add({"DELETE"}, {4});
+    lines = emit(small, 120);
+    REQUIRE(lines.size() == 2);
+    CHECK(lines[0].rfind("110 10 cqhm=DELETE count=1 ", 0) == 0);
+    CHECK(lines[1].rfind("110 10 cqhm=PUT count=1 ", 0) == 0);
+  }
+
+  SECTION("entries added from several threads")
+  {
+    constexpr int N_THREADS = 8;
+    constexpr int N_ENTRIES = 10000;
+    const char *methods[]   = {"GET", "POST", "PUT", "HEAD"};
+
+    emit(agg, 100);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < N_THREADS; t++) {
+      threads.emplace_back([&agg, &methods]() {
+        for (int i = 0; i < N_ENTRIES; i++) {
+          agg.add({methods[i % 4]}, {i % 200});
+        }
+      });
+    }
+    for (auto &t : threads) {
+      t.join();
+    }
+
+    // each method got N_ENTRIES / 4 entries of each thread, values i % 200
+    // with i % 4 fixed, their sum is the same for every method but the
+    // offset of the method.
+    auto lines = emit(agg, 110);
+    REQUIRE(lines.size() == 4);
+    for (int m = 0; m < 4; m++) {
+      int64_t sum = 0, le10 = 0, le100 = 0, inf = 0;
+      for (int i = m; i < N_ENTRIES; i += 4) {
+        int v = i % 200;
+        sum += v;
+        (v <= 10 ? le10 : v <= 100 ? le100 : inf)++;
+      }
+      std::string expected = std::string("100 10 cqhm=") + methods[m] + " count=" + std::to_string(N_THREADS * N_ENTRIES / 4) +
+                             " ttms.sum=" + std::to_string(N_THREADS * sum) + " ttms.min=" + std::to_string(m) +
+                             " ttms.max=" + std::to_string(196 + m) + " ttms.le10=" + std::to_string(N_THREADS * le10) +
+                             " ttms.le100=" + std::to_string(N_THREADS * le100) + " ttms.inf=" + std::to_string(N_THREADS * inf);
+      CHECK(std::find(lines.begin(), lines.end(), expected) != lines.end());
+    }
+  }
+}
+
+int
+main(int argc, char *argv[])
+{
+  Layout::create();
+  init_log_standalone_basic("test_LogAggregator");
+  Log::init(Log::NO_REMOTE_MANAGEMENT | Log::LOGCAT);
+
+  return Catch::Session().run(argc, argv);
+}
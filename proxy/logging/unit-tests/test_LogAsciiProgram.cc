@@ -0,0 +1,225 @@
+/** @file
+
+  Unit tests for the compiled ascii log formats.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_RUNNER
+#include "catch.hpp"
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "tscore/I_Layout.h"
+
+#include "LogStandalone.cc"
+
+#include "LogField.h"
+#include "LogFormat.h"
+#include "Log.h"
+
+#include "test_LogBuffer.h"
+
+namespace
+{
+// A format parsed as LogFormat does, rendered through LogAsciiProgram and
+// through resolve_custom_entry().
+struct Format {
+  explicit Format(const char *format)
+  {
+    bool contains_aggregates = false;
+    LogFormat::parse_format_string(format, &printf_str, &symbol_str);
+    LogFormat::parse_symbol_string(symbol_str, &fieldlist, &contains_aggregates);
+    program = new LogAsciiProgram(symbol_str, printf_str);
+  }
+
+  ~Format()
+  {
+    delete program;
+    ats_free(printf_str);
+    ats_free(symbol_str);
+  }
+
+  // renders each entry of buf both ways, checks they agree and returns the
+  // lines.
+  std::vector<std::string>
+  render(TestLogBuffer &buf, int len = LOG_MAX_FORMATTED_LINE)
+  {
+    std::vector<std::string> lines;
+    std::vector<char> compiled(len), resolved(len);
+    LogBufferIterator iter(buf.header());
+
+    for (LogEntryHeader *entry; (entry = iter.next());) {
+      char *read_from = reinterpret_cast<char *>(entry) + sizeof(LogEntryHeader);
+      int n_resolved  = LogBuffer::resolve_custom_entry(&fieldlist, printf_str, read_from, resolved.data(), len, entry->timestamp,
+                                                        entry->timestamp_usec, LOG_SEGMENT_VERSION);
+      int n_compiled  = program->run(read_from, compiled.data(), len);
+
+      REQUIRE(n_compiled == n_resolved);
+      REQUIRE(n_compiled < len);
+      CHECK(memcmp(compiled.data(), resolved.data(), n_compiled) == 0);
+      lines.emplace_back(compiled.data(), n_compiled);
+    }
+    return lines;
+  }
+
+  char *printf_str = nullptr;
+  char *symbol_str = nullptr;
+  LogFieldList fieldlist;
+  LogAsciiProgram *program = nullptr;
+};
+
+std::string
+ip_text(const char *addr)
+{
+  TestLogBuffer buf("chi", "\377");
+  buf.add_entry(1);
+  buf.add_ip(addr);
+
+  char text[INET6_ADDRSTRLEN];
+  char *read_from = buf.entries() + sizeof(LogEntryHeader);
+  int len         = LogAccess::unmarshal_ip_to_str(&read_from, text, sizeof(text));
+  REQUIRE(len > 0);
+  CHECK(read_from == buf.entries() + reinterpret_cast<LogEntryHeader *>(buf.entries())->entry_len);
+  return std::string(text, len);
+}
+} // namespace
+
+TEST_CASE("LogAsciiProgram renders like resolve_custom_entry", "[logging][ascii]")
+{
+  SECTION("quoting and escaping")
+  {
+    Format format(R"("%<cqhm> %<cqup>" \042%<chi>\042\x09%<pssc> %<psql>\\%<cqtq>)");
+    REQUIRE(format.program->valid());
+
+    TestLogBuffer buf(format.symbol_str, format.printf_str);
+    buf.add_entry(1000);
+    buf.add_str("GET");
+    buf.add_str("/a \"quoted\" path");
+    buf.add_ip("10.0.0.1");
+    buf.add_int(200);
+    buf.add_int(1234);
+    buf.add_int(1500123);
+    buf.add_entry(1001);
+    buf.add_str("POST");
+    buf.add_str(nullptr);
+    buf.add_ip("2001:db8::1");
+    buf.add_int(5);
+    buf.add_int(-7);
+    buf.add_int(0);
+
+    auto lines = format.render(buf);
+    REQUIRE(lines.size() == 2);
+    CHECK(lines[0] == "\"GET /a \"quoted\" path\" \"10.0.0.1\"\t200 1234\\1500.123");
+    CHECK(lines[1] == "\"POST -\" \"2001:db8::1\"\t005 -7\\0.000");
+  }
+
+  SECTION("text only")
+  {
+    Format format("static text \\x41\\102");
+    TestLogBuffer buf(format.symbol_str, format.printf_str);
+    buf.add_entry(1000);
+
+    auto lines = format.render(buf);
+    REQUIRE(lines.size() == 1);
+    CHECK(lines[0] == "static text AB");
+  }
+
+  SECTION("entries that do not fit")
+  {
+    Format format("%<cqhm> %<chi> %<psql>");
+    TestLogBuffer buf(format.symbol_str, format.printf_str);
+    buf.add_entry(1000);
+    buf.add_str("OPTIONS");
+    buf.add_ip("192.168.100.200");
+    buf.add_int(INT64_MIN);
+
+    std::string line = format.render(buf)[0];
+    CHECK(line == "OPTIONS 192.168.100.200 -9223372036854775808");
+
+    // both give up on the entry at the same length, the IP and integer
+    // converters are given less room than they need on the way.
+    for (int len = 1; len <= static_cast<int>(line.size()) + 1; ++len) {
+      auto lines = format.render(buf, len);
+      CHECK(lines[0] == (len > static_cast<int>(line.size()) ? line : std::string()));
+    }
+  }
+
+  SECTION("more field markers than fields")
+  {
+    Format format("%<cqhm> %<nosuchfield>");
+    CHECK_FALSE(format.program->valid());
+
+    TestLogBuffer buf(format.symbol_str, format.printf_str);
+    buf.add_entry(1000);
+    buf.add_str("GET");
+
+    char line[256];
+    char *read_from = buf.entries() + sizeof(LogEntryHeader);
+    CHECK(LogBuffer::resolve_custom_entry(&format.fieldlist, format.printf_str, read_from, line, sizeof(line), 1000, 0,
+                                          LOG_SEGMENT_VERSION) == 0);
+  }
+}
+
+TEST_CASE("LogAccess integer to text", "[logging][ascii]")
+{
+  for (int64_t value : {int64_t(0), int64_t(7), int64_t(-1), int64_t(1000000), int64_t(-123456789), INT64_MAX, INT64_MIN}) {
+    char marshalled[INK_MIN_ALIGN];
+    char text[32], expected[32];
+    char *read_from = marshalled;
+
+    LogAccess::marshal_int(marshalled, value);
+    int len = LogAccess::unmarshal_int_to_str(&read_from, text, sizeof(text));
+    snprintf(expected, sizeof(expected), "%" PRId64, value);
+
+    REQUIRE(len == static_cast<int>(strlen(expected)));
+    CHECK(memcmp(text, expected, len) == 0);
+    CHECK(read_from == marshalled + INK_MIN_ALIGN);
+
+    // the digits need len + 1 bytes
+    read_from = marshalled;
+    CHECK(LogAccess::unmarshal_int_to_str(&read_from, text, len) == -1);
+  }
+}
+
+TEST_CASE("LogAccess IP to text", "[logging][ascii]")
+{
+  // the IPv4 addresses do not go through inet_ntop, they must read the same
+  for (const char *addr : {"0.0.0.0", "1.2.3.4", "10.0.0.1", "127.0.0.1", "192.168.100.200", "255.255.255.255"}) {
+    IpEndpoint ip;
+    char expected[INET6_ADDRSTRLEN];
+    ats_ip_pton(addr, &ip);
+    ats_ip_ntop(&ip, expected, sizeof(expected));
+    CHECK(ip_text(addr) == expected);
+  }
+  CHECK(ip_text("::1") == "::1");
+  CHECK(ip_text("2001:db8::ff00:42:8329") == "2001:db8::ff00:42:8329");
+}
+
+int
+main(int argc, char *argv[])
+{
+  Layout::create();
+  init_log_standalone_basic("test_LogAsciiProgram");
+  Log::init(Log::NO_REMOTE_MANAGEMENT | Log::LOGCAT);
+
+  return Catch::Session().run(argc, argv);
+}
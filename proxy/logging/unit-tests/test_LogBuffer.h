@@ -0,0 +1,154 @@
+/** @file
+
+  Builds LogBuffer segments for the logging unit tests.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "tscore/ink_align.h"
+#include "tscore/ink_inet.h"
+
+#include "LogAccess.h"
+#include "LogBuffer.h"
+
+/** A LogBuffer segment laid out as LogBuffer writes it, the entries are
+    marshalled with the LogAccess routines the fields use.
+ */
+class TestLogBuffer
+{
+public:
+  TestLogBuffer(const char *fieldlist, const char *printf_str) : _data(sizeof(LogBufferHeader), 0)
+  {
+    LogBufferHeader h;
+    memset(&h, 0, sizeof(h));
+    h.cookie      = LOG_SEGMENT_COOKIE;
+    h.version     = LOG_SEGMENT_VERSION;
+    h.format_type = LOG_FORMAT_CUSTOM;
+
+    h.fmt_name_offset      = add_string("test");
+    h.fmt_fieldlist_offset = add_string(fieldlist);
+    h.fmt_printf_offset    = add_string(printf_str);
+    h.src_hostname_offset  = add_string("localhost");
+    h.log_filename_offset  = add_string("test.blog");
+    h.data_offset          = INK_ALIGN_DEFAULT(_data.size());
+    _data.resize(h.data_offset, 0);
+    memcpy(_data.data(), &h, sizeof(h));
+  }
+
+  void
+  add_entry(int64_t timestamp, int32_t timestamp_usec = 0)
+  {
+    LogEntryHeader entry;
+    entry.timestamp      = timestamp;
+    entry.timestamp_usec = timestamp_usec;
+    entry.entry_len      = sizeof(entry);
+    _entry               = _data.size();
+    append(&entry, sizeof(entry));
+
+    if (_entry_count++ == 0 || timestamp < _low_timestamp) {
+      _low_timestamp = timestamp;
+    }
+    _high_timestamp = std::max(_high_timestamp, timestamp);
+  }
+
+  void
+  add_int(int64_t value)
+  {
+    LogAccess::marshal_int(grow(INK_MIN_ALIGN), value);
+  }
+
+  void
+  add_str(const char *str)
+  {
+    int len = LogAccess::strlen(str);
+    LogAccess::marshal_str(grow(len), str, len);
+  }
+
+  void
+  add_ip(const char *addr)
+  {
+    IpEndpoint ip;
+    ats_ip_pton(addr, &ip);
+    LogAccess::marshal_ip(grow(LogAccess::marshal_ip(nullptr, &ip.sa)), &ip.sa);
+  }
+
+  /// The segment, valid until the next entry or field is added.
+  LogBufferHeader *
+  header()
+  {
+    LogBufferHeader *h = reinterpret_cast<LogBufferHeader *>(_data.data());
+    h->byte_count      = _data.size();
+    h->entry_count     = _entry_count;
+    h->low_timestamp   = _low_timestamp;
+    h->high_timestamp  = _high_timestamp;
+    return h;
+  }
+
+  /// The first entry of the segment.
+  char *
+  entries()
+  {
+    return _data.data() + header()->data_offset;
+  }
+
+  size_t
+  entries_size()
+  {
+    return _data.size() - header()->data_offset;
+  }
+
+private:
+  uint32_t
+  add_string(const char *str)
+  {
+    uint32_t offset = _data.size();
+    append(str, ::strlen(str) + 1);
+    return offset;
+  }
+
+  void
+  append(const void *src, size_t len)
+  {
+    memcpy(grow(len), src, len);
+  }
+
+  // adds len zeroed bytes to the current entry
+  char *
+  grow(size_t len)
+  {
+    size_t at = _data.size();
+    _data.resize(at + len, 0);
+    if (_entry_count) {
+      reinterpret_cast<LogEntryHeader *>(_data.data() + _entry)->entry_len = _data.size() - _entry;
+    }
+    return _data.data() + at;
+  }
+
+  std::vector<char> _data;
+  size_t _entry           = 0;
+  uint32_t _entry_count   = 0;
+  int64_t _low_timestamp  = 0;
+  int64_t _high_timestamp = 0;
+};
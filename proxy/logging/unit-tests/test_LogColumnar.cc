@@ -0,0 +1,351 @@
+/** @file
+
+  Unit tests for the columnar binary log blocks.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_RUNNER
+#include "catch.hpp"
+
+#include <cstdio>
+#include <vector>
+
+#include "tscore/I_Layout.h"
+
+#include "LogStandalone.cc"
+
+#include "LogField.h"
+#include "LogFormat.h"
+#include "LogColumnar.h"
+#include "Log.h"
+
+#include "test_LogBuffer.h"
+
+namespace
+{
+const char *const FIELDS = "cqtq,pssc,psql,cqhm,chi";
+const char *const PRINTF = "\377 \377 \377 \377 \377";
+
+// entries with a variable width column (cqhm) and an IP column
+TestLogBuffer
+make_buffer(int64_t timestamp, const std::vector<int64_t> &statuses)
+{
+  static const char *methods[] = {"GET", "POST", "OPTIONS"};
+  TestLogBuffer buf(FIELDS, PRINTF);
+  int i = 0;
+
+  for (int64_t status : statuses) {
+    buf.add_entry(timestamp + i, 1000 * i);
+    buf.add_int((timestamp + i) * 1000);
+    buf.add_int(status);
+    buf.add_int(100 + i);
+    buf.add_str(methods[i % 3]);
+    buf.add_ip(i % 2 ? "::1" : "10.0.0.1");
+    ++i;
+  }
+  return buf;
+}
+
+// a columnar log file, read back through a LogColumnarReader
+class ColumnarFile
+{
+public:
+  ColumnarFile() : _file(tmpfile()) { REQUIRE(_file != nullptr); }
+  ~ColumnarFile() { fclose(_file); }
+
+  void
+  write(const char *data, size_t len)
+  {
+    REQUIRE(::write(fd(), data, len) == static_cast<ssize_t>(len));
+  }
+
+  void
+  write(LogBufferHeader *header, LogFieldList *fieldlist)
+  {
+    int block_len = 0;
+    char *block   = LogColumnar::encode(header, fieldlist, &block_len);
+    REQUIRE(block != nullptr);
+    write(block, block_len);
+    ats_free(block);
+  }
+
+  int
+  fd()
+  {
+    return fileno(_file);
+  }
+
+  void
+  rewind()
+  {
+    lseek(fd(), 0, SEEK_SET);
+  }
+
+private:
+  FILE *_file;
+};
+
+void
+check_entries(LogBufferHeader *decoded, TestLogBuffer &buf)
+{
+  REQUIRE(decoded != nullptr);
+  LogBufferHeader *header = buf.header();
+  CHECK(decoded->cookie == LOG_SEGMENT_COOKIE);
+  CHECK(decoded->entry_count == header->entry_count);
+  CHECK(decoded->low_timestamp == header->low_timestamp);
+  CHECK(decoded->high_timestamp == header->high_timestamp);
+  CHECK(strcmp(decoded->fmt_fieldlist(), FIELDS) == 0);
+  REQUIRE(decoded->byte_count == header->byte_count);
+  CHECK(memcmp(reinterpret_cast<char *>(decoded) + decoded->data_offset, buf.entries(), buf.entries_size()) == 0);
+}
+} // namespace
+
+TEST_CASE("LogColumnar round trip", "[logging][columnar]")
+{
+  LogFieldList fieldlist;
+  bool contains_aggregates = false;
+  REQUIRE(LogFormat::parse_symbol_string(FIELDS, &fieldlist, &contains_aggregates) == 5);
+
+  TestLogBuffer buf = make_buffer(1000, {200, 404, 200, 304});
+  ColumnarFile file;
+  LogColumnarReader reader;
+
+  SECTION("entries split in columns")
+  {
+    file.write(buf.header(), &fieldlist);
+    file.rewind();
+
+    REQUIRE(reader.read(file.fd(), nullptr, 0) == 1);
+    CHECK(reader.block()->column_count == 7);
+    CHECK(reader.block()->entry_count == 4);
+    check_entries(reader.decode(), buf);
+    CHECK(reader.read(file.fd(), nullptr, 0) == 0);
+  }
+
+  SECTION("compressed column data")
+  {
+    // enough entries for the column data to compress when zstd is built in
+    TestLogBuffer big = make_buffer(1000, std::vector<int64_t>(500, 200));
+    file.write(big.header(), &fieldlist);
+    file.rewind();
+
+    REQUIRE(reader.read(file.fd(), nullptr, 0) == 1);
+#if HAVE_ZSTD_H
+    CHECK(reader.block()->compression == LOG_COLUMNAR_ZSTD);
+    CHECK(reader.block()->payload_bytes < reader.block()->raw_bytes);
+#endif
+    check_entries(reader.decode(), big);
+  }
+
+  SECTION("entries kept whole")
+  {
+    file.write(buf.header(), nullptr);
+    file.rewind();
+
+    REQUIRE(reader.read(file.fd(), nullptr, 0) == 1);
+    CHECK(reader.block()->column_count == 2);
+    check_entries(reader.decode(), buf);
+  }
+
+  SECTION("start of the block already read")
+  {
+    // logcat reads the cookie before it knows the kind of block
+    file.write(buf.header(), &fieldlist);
+    file.write(buf.header(), &fieldlist);
+    file.rewind();
+
+    char start[8];
+    REQUIRE(::read(file.fd(), start, sizeof(start)) == sizeof(start));
+    REQUIRE(reader.read(file.fd(), start, sizeof(start)) == 1);
+    check_entries(reader.decode(), buf);
+    REQUIRE(reader.read(file.fd(), nullptr, 0) == 1);
+    check_entries(reader.decode(), buf);
+    CHECK(reader.blocks_read == 2);
+  }
+
+  SECTION("empty buffer")
+  {
+    TestLogBuffer empty(FIELDS, PRINTF);
+    int block_len = 0;
+    CHECK(LogColumnar::encode(empty.header(), &fieldlist, &block_len) == nullptr);
+  }
+}
+
+TEST_CASE("LogColumnar predicates", "[logging][columnar]")
+{
+  LogFieldList fieldlist;
+  bool contains_aggregates = false;
+  LogFormat::parse_symbol_string(FIELDS, &fieldlist, &contains_aggregates);
+
+  TestLogBuffer first  = make_buffer(1000, {200, 404, 200});
+  TestLogBuffer second = make_buffer(2000, {500, 503});
+  ColumnarFile file;
+  file.write(first.header(), &fieldlist);
+  file.write(second.header(), &fieldlist);
+  file.rewind();
+
+  LogColumnarReader reader;
+
+  SECTION("entries of a field value")
+  {
+    REQUIRE(reader.add_predicates("pssc=200"));
+    REQUIRE(reader.read(file.fd(), nullptr, 0) == 1);
+    LogBufferHeader *decoded = reader.decode();
+    REQUIRE(decoded != nullptr);
+    CHECK(decoded->entry_count == 2);
+    CHECK(decoded->low_timestamp == 1000);
+    CHECK(decoded->high_timestamp == 1002);
+
+    LogBufferIterator iter(decoded);
+    for (LogEntryHeader *entry; (entry = iter.next());) {
+      char *field = reinterpret_cast<char *>(entry) + sizeof(LogEntryHeader) + INK_MIN_ALIGN;
+      CHECK(LogAccess::unmarshal_int(&field) == 200);
+    }
+
+    // the second block has no 200, its index tells without decompressing
+    REQUIRE(reader.read(file.fd(), nullptr, 0) == 1);
+    CHECK(reader.decode() == nullptr);
+    CHECK(reader.blocks_read == 2);
+    CHECK(reader.blocks_skipped == 1);
+    CHECK(reader.entries_matched == 2);
+  }
+
+  SECTION("timestamp range")
+  {
+    REQUIRE(reader.add_predicates("timestamp >= 1001, timestamp<2001"));
+    REQUIRE(reader.read(file.fd(), nullptr, 0) == 1);
+    LogBufferHeader *decoded = reader.decode();
+    REQUIRE(decoded != nullptr);
+    CHECK(decoded->entry_count == 2);
+    REQUIRE(reader.read(file.fd(), nullptr, 0) == 1);
+    decoded = reader.decode();
+    REQUIRE(decoded != nullptr);
+    CHECK(decoded->entry_count == 1);
+    CHECK(reader.blocks_skipped == 0);
+    CHECK(reader.entries_matched == 3);
+  }
+
+  SECTION("no entry can match")
+  {
+    REQUIRE(reader.add_predicates("psql>200"));
+    REQUIRE(reader.read(file.fd(), nullptr, 0) == 1);
+    CHECK(reader.decode() == nullptr);
+    REQUIRE(reader.read(file.fd(), nullptr, 0) == 1);
+    CHECK(reader.decode() == nullptr);
+    CHECK(reader.blocks_skipped == 2);
+  }
+
+  SECTION("field that is not an integer")
+  {
+    REQUIRE(reader.add_predicates("cqhm=1"));
+    REQUIRE(reader.read(file.fd(), nullptr, 0) == 1);
+    CHECK(reader.decode() == nullptr);
+    CHECK(reader.blocks_skipped == 1);
+  }
+
+  SECTION("bad -W predicates")
+  {
+    CHECK_FALSE(reader.add_predicates("pssc"));
+    CHECK_FALSE(reader.add_predicates("=200"));
+    CHECK_FALSE(reader.add_predicates("pssc="));
+    CHECK_FALSE(reader.add_predicates("pssc=abc"));
+    CHECK_FALSE(reader.add_predicates("pssc=200x"));
+    CHECK_FALSE(reader.add_predicates("pssc!200"));
+    CHECK_FALSE(reader.add_predicates("pssc=200,ttms"));
+    CHECK(reader.add_predicates(" pssc != 200 , psql<=101 "));
+  }
+}
+
+TEST_CASE("Bad columnar log block", "[logging][columnar]")
+{
+  TestLogBuffer buf = make_buffer(1000, {200, 404});
+  int block_len     = 0;
+  char *block       = LogColumnar::encode(buf.header(), nullptr, &block_len);
+  REQUIRE(block != nullptr);
+  LogColumnarBlockHeader *bh = reinterpret_cast<LogColumnarBlockHeader *>(block);
+
+  ColumnarFile file;
+  LogColumnarReader reader;
+
+  SECTION("empty file")
+  {
+    CHECK(reader.read(file.fd(), nullptr, 0) == 0);
+  }
+
+  SECTION("bad cookie")
+  {
+    bh->cookie = LOG_SEGMENT_COOKIE;
+    file.write(block, block_len);
+    file.rewind();
+    CHECK(reader.read(file.fd(), nullptr, 0) == -1);
+  }
+
+  SECTION("bad version")
+  {
+    bh->version = LOG_COLUMNAR_VERSION + 1;
+    file.write(block, block_len);
+    file.rewind();
+    CHECK(reader.read(file.fd(), nullptr, 0) == -1);
+  }
+
+  SECTION("block size does not match the header")
+  {
+    bh->block_bytes += 8;
+    file.write(block, block_len);
+    file.write(block, 8);
+    file.rewind();
+    CHECK(reader.read(file.fd(), nullptr, 0) == -1);
+  }
+
+  SECTION("truncated block header")
+  {
+    file.write(block, sizeof(LogColumnarBlockHeader) / 2);
+    file.rewind();
+    CHECK(reader.read(file.fd(), nullptr, 0) == -1);
+  }
+
+  SECTION("truncated block")
+  {
+    file.write(block, block_len - 1);
+    file.rewind();
+    CHECK(reader.read(file.fd(), nullptr, 0) == -1);
+  }
+
+  SECTION("bad compression")
+  {
+    bh->compression = LOG_COLUMNAR_ZSTD + 1;
+    file.write(block, block_len);
+    file.rewind();
+    REQUIRE(reader.read(file.fd(), nullptr, 0) == 1);
+    CHECK(reader.decode() == nullptr);
+  }
+
+  ats_free(block);
+}
+
+int
+main(int argc, char *argv[])
+{
+  Layout::create();
+  init_log_standalone_basic("test_LogColumnar");
+  Log::init(Log::NO_REMOTE_MANAGEMENT | Log::LOGCAT);
+
+  return Catch::Session().run(argc, argv);
+}
@@ -0,0 +1,92 @@
+/** @file
+
+  Unit tests for LogFile.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_RUNNER
+#include "catch.hpp"
+
+#include <set>
+#include <string>
+
+#include "tscore/I_Layout.h"
+
+#include "LogStandalone.cc"
+
+#include "LogFile.h"
+#include "Log.h"
+
+TEST_CASE("LogFile flush thread", "[logging][logfile]")
+{
+  const char *path = "/var/log/trafficserver/squid.log";
+
+  SECTION("the same path is written by the same thread")
+  {
+    Ptr<LogFile> file(new LogFile(path, nullptr, LOG_FILE_ASCII, 0));
+    Ptr<LogFile> again(new LogFile(path, nullptr, LOG_FILE_ASCII, 0));
+    Ptr<LogFile> binary(new LogFile(path, nullptr, LOG_FILE_BINARY, 1));
+
+    CHECK(file->m_flush_idx == LogFile::flush_index(path));
+    CHECK(again->m_flush_idx == file->m_flush_idx);
+    CHECK(binary->m_flush_idx == file->m_flush_idx);
+  }
+
+  SECTION("a copy keeps the thread of the file")
+  {
+    // reconfiguration copies the LogFile of an object that did not change,
+    // the buffers still queued for the original must not be overtaken.
+    Ptr<LogFile> file(new LogFile(path, nullptr, LOG_FILE_ASCII, 0));
+    for (int i = 0; i < 8; i++) {
+      Ptr<LogFile> copy(new LogFile(*file));
+      CHECK(copy->m_flush_idx == file->m_flush_idx);
+      file = copy;
+    }
+  }
+
+  SECTION("renaming a file moves it with its path")
+  {
+    Ptr<LogFile> file(new LogFile(path, nullptr, LOG_FILE_ASCII, 0));
+    file->change_name("/var/log/trafficserver/squid_1.log");
+    CHECK(file->m_flush_idx == LogFile::flush_index("/var/log/trafficserver/squid_1.log"));
+  }
+
+  SECTION("files are spread over the threads")
+  {
+    for (int threads : {2, 4, 8}) {
+      std::set<unsigned> used;
+      for (int i = 0; i < 64; i++) {
+        std::string name = "/var/log/trafficserver/custom_" + std::to_string(i) + ".log";
+        used.insert(LogFile::flush_index(name.c_str()) % threads);
+      }
+      CHECK(used.size() == static_cast<size_t>(threads));
+    }
+  }
+}
+
+int
+main(int argc, char *argv[])
+{
+  Layout::create();
+  init_log_standalone_basic("test_LogFile");
+  Log::init(Log::NO_REMOTE_MANAGEMENT | Log::LOGCAT);
+
+  return Catch::Session().run(argc, argv);
+}
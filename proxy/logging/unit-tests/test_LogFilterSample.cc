@@ -0,0 +1,144 @@
+/** @file
+
+  Unit tests for the sampling log filter.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define CATCH_CONFIG_RUNNER
+#include "catch.hpp"
+
+#include <string>
+#include <vector>
+
+#include "tscore/I_Layout.h"
+
+#include "LogStandalone.cc"
+
+#include "LogField.h"
+#include "LogFilter.h"
+#include "Log.h"
+
+namespace
+{
+bool
+tossed(const LogFilterSample &filter, const std::string &text)
+{
+  return filter.toss_this_text(text.data(), text.size());
+}
+
+std::vector<std::string>
+client_ips(int count)
+{
+  std::vector<std::string> ips;
+  for (int i = 0; i < count; i++) {
+    ips.push_back("10." + std::to_string((i >> 16) & 255) + '.' + std::to_string((i >> 8) & 255) + '.' + std::to_string(i & 255));
+  }
+  return ips;
+}
+} // namespace
+
+TEST_CASE("LogFilterSample", "[logging][filter]")
+{
+  LogField *chi = Log::global_field_list.find_by_symbol("chi");
+  REQUIRE(chi != nullptr);
+
+  SECTION("the hash is FNV-1a")
+  {
+    // the decisions must not change between releases or hosts, so that the
+    // logs sampled by each of them hold the same clients.
+    LogFilterSample filter("sample", chi, 10);
+    CHECK(tossed(filter, "a") == (0xaf63dc4c8601ec8cULL % 10 != 0));
+    CHECK(tossed(filter, "10.0.0.1") == (0x87f7ef5de06ff78dULL % 10 != 0));
+    CHECK(tossed(filter, "") == (0xcbf29ce484222325ULL % 10 != 0));
+  }
+
+  SECTION("the same text gets the same decision")
+  {
+    LogFilterSample filter("sample", chi, 7);
+    LogFilterSample copy(filter);
+    LogFilterSample other("other name", chi, 7);
+
+    for (const std::string &ip : client_ips(1000)) {
+      bool toss = tossed(filter, ip);
+      CHECK(tossed(filter, ip) == toss);
+      CHECK(tossed(copy, ip) == toss);
+      CHECK(tossed(other, ip) == toss);
+    }
+  }
+
+  SECTION("one in rate is kept")
+  {
+    std::vector<std::string> ips = client_ips(20000);
+    for (int64_t rate : {2, 10, 100}) {
+      LogFilterSample filter("sample", chi, rate);
+      size_t kept = 0;
+      for (const std::string &ip : ips) {
+        kept += !tossed(filter, ip);
+      }
+      CHECK(kept > ips.size() / rate * 8 / 10);
+      CHECK(kept < ips.size() / rate * 12 / 10);
+    }
+  }
+
+  SECTION("the kept entries of a rate are kept at its divisors")
+  {
+    // hash % 100 == 0 implies hash % 10 == 0
+    LogFilterSample one_in_10("sample", chi, 10);
+    LogFilterSample one_in_100("sample", chi, 100);
+    for (const std::string &ip : client_ips(20000)) {
+      if (!tossed(one_in_100, ip)) {
+        CHECK_FALSE(tossed(one_in_10, ip));
+      }
+    }
+  }
+
+  SECTION("a rate of one keeps everything")
+  {
+    LogFilterSample filter("sample", chi, 1);
+    for (const std::string &ip : client_ips(100)) {
+      CHECK_FALSE(tossed(filter, ip));
+    }
+    CHECK_FALSE(filter.toss_this_entry(nullptr));
+  }
+
+  SECTION("filters compare by field and rate")
+  {
+    LogField *cqhm = Log::global_field_list.find_by_symbol("cqhm");
+    REQUIRE(cqhm != nullptr);
+
+    LogFilterSample filter("sample", chi, 10);
+    LogFilterSample same("another name", chi, 10);
+    LogFilterSample rate("sample", chi, 20);
+    LogFilterSample field("sample", cqhm, 10);
+    CHECK(filters_are_equal(&filter, &same));
+    CHECK_FALSE(filters_are_equal(&filter, &rate));
+    CHECK_FALSE(filters_are_equal(&filter, &field));
+  }
+}
+
+int
+main(int argc, char *argv[])
+{
+  Layout::create();
+  init_log_standalone_basic("test_LogFilterSample");
+  Log::init(Log::NO_REMOTE_MANAGEMENT | Log::LOGCAT);
+
+  return Catch::Session().run(argc, argv);
+}
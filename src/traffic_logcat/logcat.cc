@@ -41,6 +41,7 @@
 #include "LogObject.h"
 #include "LogConfig.h"
 #include "LogBuffer.h"
+#include "LogColumnar.h"
 #include "LogUtils.h"
 #include "Log.h"
 
@@ -53,8 +54,11 @@ static int elf2_flag               = 0;
 static int auto_filenames          = 0;
 static int overwrite_existing_file = 0;
 static char output_file[1024];
+static char where[1024];
 int auto_clear_cache_flag = 0;
 
+static LogColumnarReader columnar_reader;
+
 static const ArgumentDescription argument_descriptions[] = {
 
   {"output_file", 'o', "Specify output file", "S1023", &output_file, NULL, NULL},
@@ -66,6 +70,7 @@ static const ArgumentDescription argument_descriptions[] = {
   {"debug_tags", 'T', "Colon-Separated Debug Tags", "S1023", error_tags, NULL, NULL},
   {"overwrite_output", 'w', "Overwrite existing output file(s)", "T", &overwrite_existing_file, NULL, NULL},
   {"elf2", '2', "Convert to Extended2 Logging Format", "T", &elf2_flag, NULL, NULL},
+  {"where", 'W', "Only show columnar log entries matching <field><op><value>[,...]", "S1023", &where, NULL, NULL},
   HELP_ARGUMENT_DESCRIPTION(),
   VERSION_ARGUMENT_DESCRIPTION(),
   RUNROOT_ARGUMENT_DESCRIPTION()};
@@ -139,6 +144,24 @@ process_file(int in_fd, int out_fd)
       return 0;
     }
 
+    // columnar blocks are rebuilt as a logbuffer with the entries that
+    // match the -W predicates
+    //
+    if (header->cookie == LOG_COLUMNAR_COOKIE) {
+      if (columnar_reader.read(in_fd, buffer, nread) <= 0) {
+        if (follow_flag) {
+          return 0;
+        }
+        fprintf(stderr, "Bad columnar log block!\n");
+        return 1;
+      }
+      LogBufferHeader *rows = columnar_reader.decode();
+      if (rows) {
+        bytes += LogFile::write_ascii_logbuffer(rows, out_fd, ".", nullptr);
+      }
+      continue;
+    }
+
     // ensure that this is a valid logbuffer header
     //
     if (header->cookie != LOG_SEGMENT_COOKIE) {
@@ -277,6 +300,11 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
 
   Log::init(Log::NO_REMOTE_MANAGEMENT | Log::LOGCAT);
 
+  if (where[0] != 0 && !columnar_reader.add_predicates(where)) {
+    fprintf(stderr, "Error: invalid -W predicates '%s'\n", where);
+    ::exit(CMD_LINE_OPTION_ERROR);
+  }
+
   // setup output file
   //
   int out_fd = STDOUT_FILENO;
@@ -294,8 +322,9 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
   int error = NO_ERROR;
 
   if (n_file_arguments) {
-    int bin_ext_len   = strlen(LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION);
-    int ascii_ext_len = strlen(LOG_FILE_ASCII_OBJECT_FILENAME_EXTENSION);
+    int bin_ext_len      = strlen(LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION);
+    int columnar_ext_len = strlen(LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION);
+    int ascii_ext_len    = strlen(LOG_FILE_ASCII_OBJECT_FILENAME_EXTENSION);
 
     for (unsigned i = 0; i < n_file_arguments; ++i) {
       int in_fd = open(file_arguments[i], O_RDONLY);
@@ -316,13 +345,16 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
         posix_fadvise(in_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
 #endif
         if (auto_filenames) {
-          // change .blog to .log
+          // change .blog or .clog to .log
           //
-          int n = strlen(file_arguments[i]);
-          int copy_len =
-            (n >= bin_ext_len ?
-               (strcmp(&file_arguments[i][n - bin_ext_len], LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION) == 0 ? n - bin_ext_len : n) :
-               n);
+          int n        = strlen(file_arguments[i]);
+          int copy_len = n;
+          if (n >= bin_ext_len && strcmp(&file_arguments[i][n - bin_ext_len], LOG_FILE_BINARY_OBJECT_FILENAME_EXTENSION) == 0) {
+            copy_len = n - bin_ext_len;
+          } else if (n >= columnar_ext_len &&
+                     strcmp(&file_arguments[i][n - columnar_ext_len], LOG_FILE_COLUMNAR_OBJECT_FILENAME_EXTENSION) == 0) {
+            copy_len = n - columnar_ext_len;
+          }
 
           char *out_filename = (char *)ats_malloc(copy_len + ascii_ext_len + 1);
 
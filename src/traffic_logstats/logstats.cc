@@ -35,6 +35,7 @@
 #include "LogStandalone.cc"
 
 #include "LogObject.h"
+#include "LogColumnar.h"
 #include "hdrs/HTTP.h"
 
 #include <sys/utsname.h>
@@ -605,6 +606,7 @@ struct CommandLineArgs {
   char origin_list[MAX_ORIG_STRING];
   int max_origins = 0;
   char state_tag[1024];
+  char where[1024];
   int64_t min_hits = 0;
   int max_age      = 0;
   int line_len;
@@ -627,6 +629,7 @@ struct CommandLineArgs {
     origin_file[0] = '\0';
     origin_list[0] = '\0';
     state_tag[0]   = '\0';
+    where[0]       = '\0';
   }
 
   void parse_arguments(const char **argv);
@@ -655,6 +658,7 @@ static ArgumentDescription argument_descriptions[] = {
   {"debug_tags", 'T', "Colon-Separated Debug Tags", "S1023", &error_tags, nullptr, nullptr},
   {"report_per_user", 'r', "Report stats per user instead of host", "T", &cl.report_per_user, nullptr, nullptr},
   {"no_format_check", 'n', "Don't validate the log format field names", "T", &cl.no_format_check, nullptr, nullptr},
+  {"where", 'W', "Only count columnar log entries matching <field><op><value>[,...]", "S1023", cl.where, nullptr, nullptr},
   HELP_ARGUMENT_DESCRIPTION(),
   VERSION_ARGUMENT_DESCRIPTION(),
   RUNROOT_ARGUMENT_DESCRIPTION()};
@@ -1760,6 +1764,32 @@ parse_log_buff(LogBufferHeader *buf_header, bool summary = false, bool aggregate
   return 0;
 }
 
+static LogColumnarReader columnar_reader;
+
+///////////////////////////////////////////////////////////////////////////////
+// Process a columnar block, whose first bytes are already read
+int
+process_columnar_block(int in_fd, const char *start, int have, unsigned max_age)
+{
+  if (columnar_reader.read(in_fd, start, have) <= 0) {
+    Debug("logstats", "Failed to read columnar log block.");
+    return 1;
+  }
+
+  // Possibly skip too old entries (the entire block is skipped, without decompressing it)
+  if (columnar_reader.block()->high_timestamp < max_age) {
+    Debug("logstats", "Skipping old columnar block (age=%d, max=%d)", columnar_reader.block()->high_timestamp, max_age);
+    return 0;
+  }
+
+  LogBufferHeader *header = columnar_reader.decode();
+  if (header && parse_log_buff(header, cl.summary != 0, cl.report_per_user != 0) != 0) {
+    Debug("logstats", "Failed to parse columnar log block.");
+    return 1;
+  }
+  return 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Process a file (FD)
 int
@@ -1794,7 +1824,7 @@ process_file(int in_fd, off_t offset, unsigned max_age)
           return 0;
         }
         // ensure that this is a valid logbuffer header
-        if (header->cookie && (LOG_SEGMENT_COOKIE == header->cookie)) {
+        if (header->cookie && (LOG_SEGMENT_COOKIE == header->cookie || LOG_COLUMNAR_COOKIE == header->cookie)) {
           offset = 0;
           break;
         }
@@ -1810,12 +1840,19 @@ process_file(int in_fd, off_t offset, unsigned max_age)
       }
 
       // ensure that this is a valid logbuffer header
-      if (header->cookie != LOG_SEGMENT_COOKIE) {
+      if (header->cookie != LOG_SEGMENT_COOKIE && header->cookie != LOG_COLUMNAR_COOKIE) {
         Debug("logstats", "Invalid segment cookie (expected %d, got %d)", LOG_SEGMENT_COOKIE, header->cookie);
         return 1;
       }
     }
 
+    if (LOG_COLUMNAR_COOKIE == header->cookie) {
+      if (process_columnar_block(in_fd, buffer, first_read_size, max_age) != 0) {
+        return 1;
+      }
+      continue;
+    }
+
     Debug("logstats", "LogBuffer version %d, current = %d", header->version, LOG_SEGMENT_VERSION);
     if (header->version != LOG_SEGMENT_VERSION) {
       return 1;
@@ -2467,6 +2504,12 @@ main(int /* argc ATS_UNUSED */, const char *argv[])
   init_log_standalone_basic(PROGRAM_NAME);
   Log::init(Log::NO_REMOTE_MANAGEMENT | Log::LOGCAT);
 
+  if (cl.where[0] != '\0' && !columnar_reader.add_predicates(cl.where)) {
+    std::cerr << "invalid -W predicates " << cl.where << std::endl;
+    usage(argument_descriptions, countof(argument_descriptions), USAGE_LINE);
+    ::exit(0);
+  }
+
   // Do we have a list of Origins on the command line?
   if (cl.origin_list[0] != '\0') {
     char *tok;
@@ -414,6 +414,20 @@ public:
   }
 };
 
+// Periodically gives the freelist memory that is not in use anymore back to the OS, if the allocator can.
+class FreelistReclaimContinuation : public Continuation
+{
+public:
+  FreelistReclaimContinuation() : Continuation(new_ProxyMutex()) { SET_HANDLER(&FreelistReclaimContinuation::periodic); }
+
+  int
+  periodic(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    ink_freelists_reclaim();
+    return EVENT_CONT;
+  }
+};
+
 class MemoryLimit : public Continuation
 {
 public:
@@ -2038,6 +2052,11 @@ main(int /* argc ATS_UNUSED */, const char **argv)
   eventProcessor.schedule_every(new SignalContinuation, HRTIME_MSECOND * 500, ET_CALL);
   eventProcessor.schedule_every(new DiagsLogContinuation, HRTIME_SECOND, ET_TASK);
   eventProcessor.schedule_every(new MemoryLimit, HRTIME_SECOND * 10, ET_TASK);
+  int32_t reclaim_interval = 0;
+  REC_ReadConfigInt32(reclaim_interval, "proxy.config.allocator.reclaim_interval");
+  if (reclaim_interval > 0) {
+    eventProcessor.schedule_every(new FreelistReclaimContinuation, HRTIME_SECONDS(reclaim_interval), ET_TASK);
+  }
   REC_RegisterConfigUpdateFunc("proxy.config.dump_mem_info_frequency", init_memory_tracker, nullptr);
   init_memory_tracker(nullptr, RECD_NULL, RecData(), nullptr);
 
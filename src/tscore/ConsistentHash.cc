@@ -26,6 +26,14 @@
 #include <cmath>
 #include <climits>
 #include <cstdio>
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+// Upper bound of the index size, 2^MAX_INDEX_BITS ring positions.
+constexpr int MAX_INDEX_BITS = 20;
+} // namespace
 
 std::ostream &
 operator<<(std::ostream &os, ATSConsistentHashNode &thing)
@@ -55,6 +63,13 @@ ATSConsistentHash::insert(ATSConsistentHashNode *node, float weight, ATSHash64 *
   string_stream << *node;
   std_string = string_stream.str();
 
+  if (std::find(nodes.begin(), nodes.end(), node) == nodes.end()) {
+    node->load  = 0;
+    node->share = 0;
+    nodes.push_back(node);
+  }
+  index_built = false;
+
   for (i = 0; i < static_cast<int>(roundf(replicas * weight)); i++) {
     snprintf(numstr, 256, "%d-", i);
     thash->update(numstr, strlen(numstr));
@@ -99,7 +114,7 @@ ATSConsistentHash::lookup(const char *url, ATSConsistentHashIter *i, bool *w, AT
     url_hash = thash->get();
     thash->clear();
 
-    *iter = NodeMap.lower_bound(url_hash);
+    *iter = find(url_hash);
 
     if (*iter == NodeMap.end()) {
       *wptr = true;
@@ -155,7 +170,7 @@ ATSConsistentHash::lookup_available(const char *url, ATSConsistentHashIter *i, b
     url_hash = thash->get();
     thash->clear();
 
-    *iter = NodeMap.lower_bound(url_hash);
+    *iter = find(url_hash);
   }
 
   if (*iter == NodeMap.end()) {
@@ -195,16 +210,118 @@ ATSConsistentHash::lookup_by_hashval(uint64_t hashval, ATSConsistentHashIter *i,
     iter = &NodeMapIterUp;
   }
 
-  *iter = NodeMap.lower_bound(hashval);
+  *iter = find(hashval);
 
   if (*iter == NodeMap.end()) {
     *wptr = true;
     *iter = NodeMap.begin();
   }
 
+  if (load_bound > 0 && *iter != NodeMap.end()) {
+    ATSConsistentHashIter start = *iter;
+    uint64_t total              = total_load.load(std::memory_order_relaxed);
+
+    // Walk the ring to the first node with room, or take the original one if all are overloaded
+    while (overloaded((*iter)->second, total)) {
+      if (++(*iter) == NodeMap.end()) {
+        *wptr = true;
+        *iter = NodeMap.begin();
+      }
+      if (*iter == start) {
+        break;
+      }
+    }
+    add_load((*iter)->second);
+  }
+
   return (*iter)->second;
 }
 
+void
+ATSConsistentHash::set_load_bound(float factor)
+{
+  load_bound = factor > 0 ? std::max(factor, 1.0f) : 0;
+  total_load = 0;
+  for (auto node : nodes) {
+    node->load = 0;
+  }
+}
+
+/*
+  Equivalent to NodeMap.lower_bound(hashval), starting from the index entry covering hashval. With about one ring
+  entry per index entry this only looks at a few map nodes.
+ */
+ATSConsistentHashIter
+ATSConsistentHash::find(uint64_t hashval)
+{
+  if (!index_built.load(std::memory_order_acquire)) {
+    build_index();
+  }
+
+  ATSConsistentHashIter iter = index[hashval >> index_shift];
+  while (iter != NodeMap.end() && iter->first < hashval) {
+    ++iter;
+  }
+  return iter;
+}
+
+void
+ATSConsistentHash::build_index()
+{
+  std::lock_guard<std::mutex> lock(index_mutex);
+
+  if (index_built.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  int bits = 1;
+  while (bits < MAX_INDEX_BITS && (size_t(1) << bits) < NodeMap.size()) {
+    ++bits;
+  }
+  index_shift = 64 - bits;
+  index.resize(size_t(1) << bits);
+
+  ATSConsistentHashIter iter = NodeMap.begin();
+  for (size_t i = 0; i < index.size(); ++i) {
+    uint64_t start = static_cast<uint64_t>(i) << index_shift;
+    while (iter != NodeMap.end() && iter->first < start) {
+      ++iter;
+    }
+    index[i] = iter;
+  }
+
+  std::unordered_map<ATSConsistentHashNode *, size_t> entries;
+  for (auto const &entry : NodeMap) {
+    entries[entry.second]++;
+  }
+  for (auto node : nodes) {
+    node->share = NodeMap.empty() ? 0 : static_cast<float>(entries[node]) / NodeMap.size();
+  }
+
+  index_built.store(true, std::memory_order_release);
+}
+
+bool
+ATSConsistentHash::overloaded(const ATSConsistentHashNode *node, uint64_t total) const
+{
+  return node->load.load(std::memory_order_relaxed) >= load_bound * (total + 1) * node->share;
+}
+
+void
+ATSConsistentHash::add_load(ATSConsistentHashNode *node)
+{
+  node->load.fetch_add(1, std::memory_order_relaxed);
+
+  // Halve all the loads from time to time so that they reflect the recent lookups. Concurrent lookups can make this
+  // slightly inaccurate, which the bound tolerates.
+  uint64_t total = total_load.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (total >= LOAD_DECAY_LOOKUPS * nodes.size() && total_load.compare_exchange_strong(total, total / 2)) {
+    for (auto n : nodes) {
+      n->load.store(n->load.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+    }
+  }
+}
+
 ATSConsistentHash::~ATSConsistentHash()
 {
   if (hash) {
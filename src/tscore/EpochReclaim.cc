@@ -0,0 +1,102 @@
+/** @file
+
+  Epoch based reclamation for structures read without locks.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <atomic>
+#include <algorithm>
+
+#include "tscore/EpochReclaim.h"
+
+namespace
+{
+// Each thread that reads gets a slot holding the epoch it entered its
+// outermost guard in, or 0 when it is not reading. Threads beyond the slots
+// are counted instead, and nothing is reclaimed while one of them reads.
+constexpr int MAX_READERS = 1024;
+
+struct alignas(64) ReaderSlot {
+  std::atomic<uint64_t> epoch{0};
+};
+
+ReaderSlot readers[MAX_READERS];
+std::atomic<int> reader_count{0};
+std::atomic<int> overflow_readers{0};
+std::atomic<uint64_t> global_epoch{1};
+
+thread_local int reader_idx  = -1;
+thread_local int guard_depth = 0;
+} // namespace
+
+namespace ts
+{
+EpochReclaim::Guard::Guard()
+{
+  if (guard_depth++ > 0) {
+    return;
+  }
+  if (reader_idx < 0) {
+    reader_idx = std::min(reader_count.fetch_add(1), MAX_READERS);
+  }
+  if (reader_idx < MAX_READERS) {
+    readers[reader_idx].epoch.store(global_epoch.load());
+  } else {
+    ++overflow_readers;
+  }
+}
+
+EpochReclaim::Guard::~Guard()
+{
+  if (--guard_depth > 0) {
+    return;
+  }
+  if (reader_idx < MAX_READERS) {
+    readers[reader_idx].epoch.store(0, std::memory_order_release);
+  } else {
+    --overflow_readers;
+  }
+}
+
+uint64_t
+EpochReclaim::retire()
+{
+  return global_epoch.fetch_add(1);
+}
+
+uint64_t
+EpochReclaim::safe_epoch()
+{
+  if (overflow_readers.load() > 0) {
+    return 0;
+  }
+
+  uint64_t safe = global_epoch.load();
+  int n         = std::min(reader_count.load(), MAX_READERS);
+  for (int i = 0; i < n; ++i) {
+    uint64_t epoch = readers[i].epoch.load();
+    if (epoch != 0 && epoch < safe) {
+      safe = epoch;
+    }
+  }
+  return safe;
+}
+
+} // namespace ts
@@ -21,7 +21,9 @@
   limitations under the License.
  */
 
+#include <algorithm>
 #include <array>
+#include <cctype>
 
 #include "tscore/ink_platform.h"
 #include "tscore/ink_thread.h"
@@ -76,6 +78,10 @@ Regex::compile(const char *pattern, const unsigned flags)
     options |= PCRE_ANCHORED;
   }
 
+  if (flags & RE_NO_CAPTURE) {
+    options |= PCRE_NO_AUTO_CAPTURE;
+  }
+
   regex = pcre_compile(pattern, options, &error, &erroffset, nullptr);
   if (error) {
     regex = nullptr;
@@ -153,15 +159,77 @@ DFA::build(std::string_view const &pattern, unsigned flags)
   if (!rxp.compile(string.c_str(), flags)) {
     return false;
   }
-  _patterns.emplace_back(std::move(rxp), std::move(string));
+  _patterns.emplace_back(std::move(rxp), std::move(string), flags);
+  return true;
+}
+
+namespace
+{
+/** Check whether @a pattern keeps its meaning when it is one alternative among others.
+ *
+ * Numbered back references and subroutine calls would refer to the groups of other patterns.
+ */
+bool
+is_groupable(std::string_view pattern)
+{
+  for (size_t i = 0; i + 1 < pattern.size(); ++i) {
+    char c = pattern[i];
+    char n = pattern[i + 1];
+    if (c == '\\') {
+      if ((n >= '1' && n <= '9') || n == 'g' || n == 'k') {
+        return false;
+      }
+      ++i; // skip the escaped character
+    } else if (c == '(' && n == '?' && i + 2 < pattern.size()) {
+      char o = pattern[i + 2];
+      if (isdigit(o) || o == '+' || o == '-' || o == 'R' || o == 'P' || o == '&') {
+        return false;
+      }
+    }
+  }
   return true;
 }
+} // namespace
+
+void
+DFA::build_groups()
+{
+  _groups.clear();
+
+  size_t i = 0;
+  while (i < _patterns.size()) {
+    size_t first = i;
+    std::string alternation;
+
+    // Gather a run of patterns compiled with the same flags
+    while (i < _patterns.size() && i - first < MAX_GROUP_SIZE && _patterns[i]._flags == _patterns[first]._flags &&
+           is_groupable(_patterns[i]._p)) {
+      alternation.append(i == first ? "(?:" : "|(?:").append(_patterns[i]._p).append(")");
+      ++i;
+    }
+
+    if (i - first > 1) {
+      _groups.emplace_back(first, i - first);
+      Regex &re = _groups.back()._re;
+      // Named groups still capture, which Regex::exec() would report as a failed match if there are too many of them
+      if (!re.compile(alternation.c_str(), _patterns[first]._flags | RE_NO_CAPTURE) || re.get_capture_count() != 0) {
+        // Evaluate the first pattern on its own and try to group the following ones
+        _groups.back()._count = 1;
+        i                     = first + 1;
+      }
+    } else {
+      _groups.emplace_back(first, 1);
+      i = first + 1;
+    }
+  }
+}
 
 int
 DFA::compile(std::string_view const &pattern, unsigned flags)
 {
   ink_assert(_patterns.empty());
   this->build(pattern, flags);
+  this->build_groups();
   return _patterns.size();
 }
 
@@ -172,6 +240,7 @@ DFA::compile(std::string_view *patterns, int npatterns, unsigned flags)
   for (int i = 0; i < npatterns; ++i) {
     this->build(patterns[i], flags);
   }
+  this->build_groups();
   return _patterns.size();
 }
 
@@ -182,15 +251,32 @@ DFA::compile(const char **patterns, int npatterns, unsigned flags)
   for (int i = 0; i < npatterns; ++i) {
     this->build(patterns[i], flags);
   }
+  this->build_groups();
   return _patterns.size();
 }
 
 int
 DFA::match(std::string_view const &str) const
 {
-  for (auto spot = _patterns.begin(), limit = _patterns.end(); spot != limit; ++spot) {
-    if (spot->_re.exec(str)) {
-      return spot - _patterns.begin();
+  return this->match(str, 0);
+}
+
+int
+DFA::match(std::string_view const &str, size_t start) const
+{
+  for (auto const &group : _groups) {
+    size_t limit = group._first + group._count;
+    if (limit <= start) {
+      continue;
+    }
+    // No pattern of the group matches
+    if (group._count > 1 && !group._re.exec(str)) {
+      continue;
+    }
+    for (size_t i = std::max(start, group._first); i < limit; ++i) {
+      if (_patterns[i]._re.exec(str)) {
+        return i;
+      }
     }
   }
 
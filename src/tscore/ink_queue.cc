@@ -52,6 +52,7 @@
 #include "tscore/hugepages.h"
 #include "tscore/Diags.h"
 #include "tscore/JeAllocator.h"
+#include "tscore/ink_slab.h"
 
 #define DEBUG_TAG "freelist"
 
@@ -89,7 +90,12 @@ static void malloc_bulkfree(InkFreeList *f, void *head, void *tail, size_t num_i
 
 static const ink_freelist_ops malloc_ops   = {malloc_new, malloc_free, malloc_bulkfree};
 static const ink_freelist_ops freelist_ops = {freelist_new, freelist_free, freelist_bulkfree};
+static const ink_freelist_ops slab_ops     = {ink_slab_new, ink_slab_free, ink_slab_free_bulk};
+#if TS_USE_SLAB_ALLOCATOR
+static const ink_freelist_ops *default_ops = &slab_ops;
+#else
 static const ink_freelist_ops *default_ops = &freelist_ops;
+#endif
 
 static ink_freelist_list *freelists                = nullptr;
 static const ink_freelist_ops *freelist_global_ops = default_ops;
@@ -106,14 +112,26 @@ ink_freelist_freelist_ops()
   return &freelist_ops;
 }
 
+const InkFreeListOps *
+ink_freelist_slab_ops()
+{
+  return &slab_ops;
+}
+
 void
 ink_freelist_init_ops(int nofl_class, int nofl_proxy)
+{
+  ink_freelist_set_ops((nofl_class || nofl_proxy) ? ink_freelist_malloc_ops() : default_ops);
+}
+
+void
+ink_freelist_set_ops(const InkFreeListOps *ops)
 {
   // This *MUST* only be called at startup before any freelists allocate anything. We will certainly crash if object
   // allocated from the freelist are freed by malloc.
   ink_release_assert(freelist_global_ops == default_ops);
 
-  freelist_global_ops = (nofl_class || nofl_proxy) ? ink_freelist_malloc_ops() : ink_freelist_freelist_ops();
+  freelist_global_ops = ops;
 }
 
 void
@@ -415,6 +433,14 @@ ink_freelists_snap_baseline()
   }
 }
 
+void
+ink_freelists_reclaim()
+{
+  for (ink_freelist_list *fll = freelists; fll; fll = fll->next) {
+    ink_slab_reclaim(fll->fl);
+  }
+}
+
 void
 ink_freelists_dump_baselinerel(FILE *f)
 {
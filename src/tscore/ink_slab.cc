@@ -0,0 +1,556 @@
+/** @file
+
+  Slab allocator with per-thread magazines for the freelists
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+/*****************************************************************************
+  The magazine layer follows Bonwick & Adams, "Magazines and Vmem" (USENIX 2001).
+
+  A thread allocates from and frees to its loaded magazine, and swaps it with
+  its previous one when the loaded one runs empty or full. Only when both are
+  empty or full does it go to the depot of its NUMA node for a full or an empty
+  magazine, and the depot builds full magazines from its slabs when it has none.
+
+  Slabs are mapped aligned to their size, so the slab of an item, and the node
+  it belongs to, is found by masking the address of the item. Items freed by a
+  thread of another node go straight back to their slab, so the magazines of a
+  node only ever hold memory local to it.
+
+  ink_slab_reclaim keeps track of the fewest full magazines the depot held
+  between two calls. Those were not needed, their items go back to the slabs,
+  and slabs that stayed entirely free over a whole interval are unmapped.
+  ****************************************************************************/
+
+#include "tscore/ink_config.h"
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <vector>
+#include "tscore/ink_slab.h"
+#include "tscore/ink_atomic.h"
+#include "tscore/ink_memory.h"
+#include "tscore/ink_mutex.h"
+#include "tscore/ink_align.h"
+#include "tscore/ink_error.h"
+#include "tscore/ink_assert.h"
+#include "tscore/ink_defs.h"
+#include "tscore/List.h"
+#include "tscore/Diags.h"
+
+#if TS_USE_HWLOC
+#include <hwloc.h>
+#endif
+
+#define DEBUG_TAG "freelist_slab"
+
+namespace
+{
+// A slab is at least this large and holds at least a few items, which bounds the memory lost to rounding the slab
+// to a power of 2.
+constexpr size_t SLAB_MIN_BYTES   = 64 * 1024;
+constexpr size_t SLAB_MIN_ITEMS   = 4;
+constexpr size_t MAGAZINE_BYTES   = 64 * 1024;
+constexpr int MAGAZINE_MAX_ROUNDS = 64;
+constexpr int SLAB_MAX_NODES      = 8;
+
+struct Slab {
+  InkSlabCache *cache;
+  void *free_items;   ///< Items given back to the slab.
+  uint32_t n_free;    ///< Items in the slab, given back or never carved.
+  uint32_t n_carved;  ///< Items carved from the slab so far, the rest of the slab was never touched.
+  int node;           ///< NUMA node of the depot the slab belongs to.
+  uint64_t empty_gen; ///< Reclaim generation the slab became entirely free in.
+  LINK(Slab, link);
+};
+
+struct Magazine {
+  int rounds = 0;
+  LINK(Magazine, link);
+
+  void **
+  items()
+  {
+    return reinterpret_cast<void **>(this + 1);
+  }
+};
+
+struct SlabNode {
+  SlabNode() { ink_mutex_init(&lock); }
+
+  ink_mutex lock;
+  Que(Magazine, link) full;
+  Que(Magazine, link) empty;
+  int n_full   = 0;
+  int min_full = 0; ///< Fewest full magazines since the last reclaim.
+  uint64_t gen = 0; ///< Reclaim generation.
+
+  Que(Slab, link) partial;    ///< Slabs with items to give out.
+  Que(Slab, link) free_slabs; ///< Entirely free slabs, most recently freed first.
+};
+
+int
+node_count()
+{
+  static int n = [] {
+    int count = 1;
+#if TS_USE_HWLOC
+    count = hwloc_get_nbobjs_by_type(ink_get_topology(), HWLOC_OBJ_NODE);
+#endif
+    return std::clamp(count, 1, SLAB_MAX_NODES);
+  }();
+
+  return n;
+}
+
+/// The NUMA node the calling thread runs on, decided once per thread, after EThreads are bound to their CPUs.
+int
+current_node()
+{
+  int node = 0;
+
+#if TS_USE_HWLOC
+  if (node_count() > 1) {
+    hwloc_topology_t topology = ink_get_topology();
+    hwloc_bitmap_t cpus       = hwloc_bitmap_alloc();
+
+    if (hwloc_get_last_cpu_location(topology, cpus, HWLOC_CPUBIND_THREAD) == 0) {
+      hwloc_obj_t obj = hwloc_get_next_obj_covering_cpuset_by_type(topology, cpus, HWLOC_OBJ_NODE, nullptr);
+      if (obj != nullptr) {
+        node = obj->logical_index % node_count();
+      }
+    }
+    hwloc_bitmap_free(cpus);
+  }
+#endif
+
+  return node;
+}
+
+size_t
+next_power_of_2(size_t n)
+{
+  size_t p = 1;
+
+  while (p < n) {
+    p <<= 1;
+  }
+
+  return p;
+}
+
+} // namespace
+
+struct InkSlabCache {
+  explicit InkSlabCache(InkFreeList *f);
+
+  InkFreeList *fl;
+  int id;
+  size_t slab_size;
+  uint32_t offset; ///< Of the first item in a slab.
+  uint32_t n_items;
+  int rounds;
+  SlabNode nodes[SLAB_MAX_NODES];
+};
+
+namespace
+{
+std::atomic<int> next_cache_id{0};
+
+struct ThreadMagazines {
+  InkSlabCache *cache = nullptr;
+  Magazine *loaded    = nullptr;
+  Magazine *previous  = nullptr;
+};
+
+struct ThreadSlabState {
+  ThreadSlabState() : node(current_node()) {}
+  ~ThreadSlabState();
+
+  int node;
+  std::vector<ThreadMagazines> caches;
+};
+
+thread_local ThreadSlabState thread_slab_state;
+// Set once the magazines of the thread are gone, items freed during thread exit go straight to their slabs.
+thread_local bool thread_slab_state_gone = false;
+
+Magazine *
+magazine_create(InkSlabCache *c)
+{
+  void *p = ats_malloc(sizeof(Magazine) + c->rounds * sizeof(void *));
+
+  return new (p) Magazine;
+}
+
+void
+magazine_destroy(Magazine *m)
+{
+  m->~Magazine();
+  ats_free(m);
+}
+
+inline Slab *
+slab_of(InkSlabCache *c, void *item)
+{
+  return reinterpret_cast<Slab *>(reinterpret_cast<uintptr_t>(item) & ~(static_cast<uintptr_t>(c->slab_size) - 1));
+}
+
+Slab *
+slab_create(InkSlabCache *c, int node)
+{
+  // Map twice the size and trim it, for the slab to be aligned to its size.
+  size_t size = c->slab_size;
+  char *p     = static_cast<char *>(mmap(nullptr, size * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+
+  if (p == MAP_FAILED) {
+    ink_abort("couldn't allocate %zu bytes for a slab of %s", size, c->fl->name ? c->fl->name : "<unknown>");
+  }
+
+  char *start = reinterpret_cast<char *>(INK_ALIGN(reinterpret_cast<uintptr_t>(p), size));
+  if (start > p) {
+    munmap(p, start - p);
+  }
+  munmap(start + size, p + size - start);
+
+  if (c->fl->advice) {
+    ats_madvise(start, size, c->fl->advice);
+  }
+
+  Slab *s       = new (start) Slab;
+  s->cache      = c;
+  s->free_items = nullptr;
+  s->n_free     = c->n_items;
+  s->n_carved   = 0;
+  s->node       = node;
+  s->empty_gen  = 0;
+
+  ink_atomic_increment(reinterpret_cast<int *>(&c->fl->allocated), c->n_items);
+
+  return s;
+}
+
+void
+slab_destroy(Slab *s)
+{
+  InkSlabCache *c = s->cache;
+
+  ink_atomic_increment(reinterpret_cast<int *>(&c->fl->allocated), -static_cast<int>(c->n_items));
+  s->~Slab();
+  munmap(s, c->slab_size);
+}
+
+inline void *
+slab_take(InkSlabCache *c, Slab *s)
+{
+  void *item;
+
+  ink_assert(s->n_free > 0);
+  if (s->free_items != nullptr) {
+    item          = s->free_items;
+    s->free_items = *static_cast<void **>(item);
+  } else {
+    item = reinterpret_cast<char *>(s) + c->offset + static_cast<size_t>(s->n_carved++) * c->fl->type_size;
+  }
+  --s->n_free;
+
+  return item;
+}
+
+/// Give @a item back to its slab @a s, the lock of the node of the slab must be held.
+void
+slab_put(SlabNode &n, Slab *s, void *item)
+{
+  *static_cast<void **>(item) = s->free_items;
+  s->free_items               = item;
+
+  if (s->n_free++ == 0) {
+    n.partial.push(s);
+  }
+  if (s->n_free == s->cache->n_items) {
+    n.partial.remove(s);
+    s->empty_gen = n.gen;
+    n.free_slabs.push(s);
+  }
+}
+
+/// Take up to @a want items from the slabs of node @a node, mapping a new slab if needed.
+int
+slabs_take(InkSlabCache *c, int node, void **items, int want)
+{
+  SlabNode &n = c->nodes[node];
+  int got     = 0;
+
+  while (got < want) {
+    Slab *s = n.partial.head;
+    if (s == nullptr) {
+      s = n.free_slabs.pop();
+      if (s == nullptr) {
+        s = slab_create(c, node);
+      }
+      n.partial.push(s);
+    }
+    while (got < want && s->n_free > 0) {
+      items[got++] = slab_take(c, s);
+    }
+    if (s->n_free == 0) {
+      n.partial.remove(s);
+    }
+  }
+
+  return got;
+}
+
+ThreadMagazines &
+thread_magazines(InkSlabCache *c)
+{
+  ThreadSlabState &state = thread_slab_state;
+
+  if (static_cast<size_t>(c->id) >= state.caches.size()) {
+    state.caches.resize(c->id + 1);
+  }
+
+  ThreadMagazines &tm = state.caches[c->id];
+  if (tm.cache == nullptr) {
+    tm.cache    = c;
+    tm.loaded   = magazine_create(c);
+    tm.previous = magazine_create(c);
+  }
+
+  return tm;
+}
+
+ThreadSlabState::~ThreadSlabState()
+{
+  thread_slab_state_gone = true;
+
+  for (ThreadMagazines &tm : caches) {
+    if (tm.cache == nullptr) {
+      continue;
+    }
+
+    SlabNode &n = tm.cache->nodes[node];
+    {
+      ink_scoped_mutex_lock lock(n.lock);
+      for (Magazine *m : {tm.loaded, tm.previous}) {
+        for (int i = 0; i < m->rounds; ++i) {
+          slab_put(n, slab_of(tm.cache, m->items()[i]), m->items()[i]);
+        }
+      }
+    }
+    magazine_destroy(tm.loaded);
+    magazine_destroy(tm.previous);
+  }
+}
+
+InkSlabCache *
+cache_of(InkFreeList *f)
+{
+  InkSlabCache *c = f->slab;
+
+  if (likely(c != nullptr)) {
+    return c;
+  }
+
+  // Freelists are created before the allocator is chosen, so the cache is set up on first use.
+  c = new InkSlabCache(f);
+  if (!ink_atomic_cas(&f->slab, static_cast<InkSlabCache *>(nullptr), c)) {
+    delete c;
+    c = f->slab;
+  }
+
+  return c;
+}
+
+/// Both magazines of the thread are empty, get a full one from the depot or fill one from the slabs.
+void
+magazines_reload(InkSlabCache *c, int node, ThreadMagazines &tm)
+{
+  SlabNode &n = c->nodes[node];
+  ink_scoped_mutex_lock lock(n.lock);
+
+  if (Magazine *m = n.full.pop(); m != nullptr) {
+    n.min_full = std::min(n.min_full, --n.n_full);
+    n.empty.push(tm.previous);
+    tm.previous = tm.loaded;
+    tm.loaded   = m;
+  } else {
+    tm.loaded->rounds = slabs_take(c, node, tm.loaded->items(), c->rounds);
+  }
+}
+
+/// Both magazines of the thread are full, put one in the depot for an empty one.
+void
+magazines_unload(InkSlabCache *c, int node, ThreadMagazines &tm)
+{
+  SlabNode &n = c->nodes[node];
+  Magazine *m;
+
+  {
+    ink_scoped_mutex_lock lock(n.lock);
+    m = n.empty.pop();
+    n.full.push(tm.previous);
+    ++n.n_full;
+  }
+  if (m == nullptr) {
+    m = magazine_create(c);
+  }
+
+  tm.previous = tm.loaded;
+  tm.loaded   = m;
+}
+
+} // namespace
+
+InkSlabCache::InkSlabCache(InkFreeList *f) : fl(f), id(next_cache_id++)
+{
+  // The chunk size of the freelist is not used, slabs are as small as possible so that they can be given back.
+  offset    = INK_ALIGN(sizeof(Slab), f->alignment);
+  slab_size = next_power_of_2(std::max(SLAB_MIN_BYTES, offset + SLAB_MIN_ITEMS * f->type_size));
+  slab_size = std::max(slab_size, static_cast<size_t>(ats_pagesize()));
+  n_items   = (slab_size - offset) / f->type_size;
+  rounds    = std::clamp(static_cast<int>(MAGAZINE_BYTES / f->type_size), 1, MAGAZINE_MAX_ROUNDS);
+
+  Debug(DEBUG_TAG "_init", "<%s> slab size %zu with %" PRIu32 " items, %d items per magazine, %d nodes", f->name, slab_size,
+        n_items, rounds, node_count());
+}
+
+void *
+ink_slab_new(InkFreeList *f)
+{
+  InkSlabCache *c = cache_of(f);
+
+  if (unlikely(thread_slab_state_gone)) {
+    void *item  = nullptr;
+    SlabNode &n = c->nodes[0];
+    ink_scoped_mutex_lock lock(n.lock);
+    slabs_take(c, 0, &item, 1);
+    return item;
+  }
+
+  ThreadMagazines &tm = thread_magazines(c);
+  if (tm.loaded->rounds == 0) {
+    if (tm.previous->rounds > 0) {
+      std::swap(tm.loaded, tm.previous);
+    } else {
+      magazines_reload(c, thread_slab_state.node, tm);
+    }
+  }
+
+  return tm.loaded->items()[--tm.loaded->rounds];
+}
+
+void
+ink_slab_free(InkFreeList *f, void *item)
+{
+  InkSlabCache *c = f->slab;
+  ink_assert(c != nullptr);
+  Slab *s = slab_of(c, item);
+
+  ink_assert(s->cache == c);
+  if (unlikely(thread_slab_state_gone) || s->node != thread_slab_state.node) {
+    SlabNode &n = c->nodes[s->node];
+    ink_scoped_mutex_lock lock(n.lock);
+    slab_put(n, s, item);
+    return;
+  }
+
+  ThreadMagazines &tm = thread_magazines(c);
+  if (tm.loaded->rounds == c->rounds) {
+    if (tm.previous->rounds == 0) {
+      std::swap(tm.loaded, tm.previous);
+    } else {
+      magazines_unload(c, thread_slab_state.node, tm);
+    }
+  }
+
+  tm.loaded->items()[tm.loaded->rounds++] = item;
+}
+
+void
+ink_slab_free_bulk(InkFreeList *f, void *head, void * /* tail ATS_UNUSED */, size_t num_item)
+{
+  void *item = head;
+  void *next;
+
+  for (size_t i = 0; i < num_item && item; ++i, item = next) {
+    next = *static_cast<void **>(item); // find next item before freeing current item
+    ink_slab_free(f, item);
+  }
+}
+
+void
+ink_slab_reclaim(InkFreeList *f)
+{
+  InkSlabCache *c = f->slab;
+
+  if (c == nullptr) {
+    return;
+  }
+
+  for (int i = 0; i < node_count(); ++i) {
+    SlabNode &n = c->nodes[i];
+    Que(Magazine, link) magazines;
+    Que(Slab, link) slabs;
+    int drained = 0;
+
+    {
+      ink_scoped_mutex_lock lock(n.lock);
+
+      // Full magazines that stayed in the depot all along are beyond the working set.
+      for (; n.min_full > 0; --n.min_full, --n.n_full, ++drained) {
+        Magazine *m = n.full.pop();
+        for (int k = 0; k < m->rounds; ++k) {
+          slab_put(n, slab_of(c, m->items()[k]), m->items()[k]);
+        }
+        magazines.push(m);
+      }
+      while (Magazine *m = n.empty.pop()) {
+        magazines.push(m);
+      }
+
+      for (Slab *s = n.free_slabs.head; s != nullptr;) {
+        Slab *next = s->link.next;
+        if (s->empty_gen < n.gen) {
+          n.free_slabs.remove(s);
+          slabs.push(s);
+        }
+        s = next;
+      }
+
+      ++n.gen;
+      n.min_full = n.n_full;
+    }
+
+    int released = 0;
+    while (Magazine *m = magazines.pop()) {
+      magazine_destroy(m);
+    }
+    while (Slab *s = slabs.pop()) {
+      slab_destroy(s);
+      ++released;
+    }
+    if (drained || released) {
+      Debug(DEBUG_TAG, "<%s> node %d: drained %d magazines, released %d slabs", f->name, i, drained, released);
+    }
+  }
+}
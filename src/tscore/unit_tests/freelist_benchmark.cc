@@ -1,6 +1,6 @@
 /** @file
 
-  Micro Benchmark tool for global freelist - requires Catch2 v2.9.0+
+  Micro Benchmark tool for global freelist and slab allocator - requires Catch2 v2.9.0+
 
   @section license License
 
@@ -30,6 +30,7 @@
 #include "tscore/hugepages.h"
 
 #include <iostream>
+#include <string>
 
 #if TS_USE_HWLOC
 #include <hwloc.h>
@@ -44,6 +45,7 @@ int nloop                 = 1000000;
 int nthreads              = 1;
 int affinity              = 0;
 int thread_assiging_order = 0;
+int nburst                = 10000;
 bool debug_enabled        = false;
 
 #if TS_USE_HWLOC
@@ -163,6 +165,40 @@ setup_test_case_1(const int64_t n)
   }
 }
 
+// Each thread takes a burst of items before it frees them, like connections piling up during a traffic spike.
+void *
+test_case_2(void *d)
+{
+  int id       = (intptr_t)d;
+  void **items = static_cast<void **>(ats_malloc(nburst * sizeof(void *)));
+
+  for (int i = 0; i < nloop / nburst; ++i) {
+    for (int j = 0; j < nburst; ++j) {
+      items[j] = ink_freelist_new(flist);
+      memset(items[j], id, 64);
+    }
+    for (int j = 0; j < nburst; ++j) {
+      ink_freelist_free(flist, items[j]);
+    }
+  }
+  ats_free(items);
+
+  return nullptr;
+}
+
+void
+setup_test_case_2(const int64_t n)
+{
+  ink_thread list[n];
+
+  for (int i = 0; i < n; i++) {
+    ink_thread_create(&list[i], test_case_2, (void *)((intptr_t)i), 0, 0, nullptr);
+  }
+  for (int i = 0; i < n; i++) {
+    ink_thread_join(list[i]);
+  }
+}
+
 TEST_CASE("simple new and free", "")
 {
   flist = ink_freelist_create("woof", 64, 256, 8);
@@ -172,6 +208,23 @@ TEST_CASE("simple new and free", "")
   snprintf(name, sizeof(name), "nthreads = %d", nthreads);
   BENCHMARK(name) { return setup_test_case_1(nthreads); };
 }
+
+TEST_CASE("burst new and free", "")
+{
+  flist = ink_freelist_create("meow", 64, 256, 8);
+
+  char name[32];
+  snprintf(name, sizeof(name), "nthreads = %d burst = %d", nthreads, nburst);
+  BENCHMARK(name) { return setup_test_case_2(nthreads); };
+
+  // Memory kept once the threads are gone, the freelist keeps all of it, the slab allocator gives it back.
+  uint64_t allocated = static_cast<uint64_t>(flist->allocated) * flist->type_size;
+  for (int i = 0; i < 3; ++i) {
+    ink_freelists_reclaim();
+  }
+  std::cout << "allocated after burst: " << allocated << " bytes, after reclaim: "
+            << static_cast<uint64_t>(flist->allocated) * flist->type_size << " bytes" << std::endl;
+}
 } // namespace
 
 int
@@ -182,6 +235,7 @@ main(int argc, char *argv[])
   using namespace Catch::clara;
 
   bool opt_enable_hugepage = false;
+  std::string opt_allocator;
 
   auto cli = session.cli() |
              Opt(affinity, "type")["--ts-affinity"]("thread affinity type [0-4]\n"
@@ -194,6 +248,10 @@ main(int argc, char *argv[])
                                            "(default: 1000000)") |
              Opt(nthreads, "n")["--ts-nthreads"]("number of threads\n"
                                                  "(default: 1)") |
+             Opt(nburst, "n")["--ts-nburst"]("number of items a thread holds at once in the burst test\n"
+                                             "(default: 10000)") |
+             Opt(opt_allocator, "freelist|slab|malloc")["--ts-allocator"]("allocator behind the freelist\n"
+                                                                          "(default: as configured)") |
              Opt(opt_enable_hugepage, "yes|no")["--ts-hugepage"]("enable hugepage\n"
                                                                  "(default: no)") |
              Opt(thread_assiging_order, "n")["--ts-thread-order"]("thread assiging order [0-1]\n"
@@ -208,6 +266,17 @@ main(int argc, char *argv[])
     return returnCode;
   }
 
+  if (opt_allocator == "freelist") {
+    ink_freelist_set_ops(ink_freelist_freelist_ops());
+  } else if (opt_allocator == "slab") {
+    ink_freelist_set_ops(ink_freelist_slab_ops());
+  } else if (opt_allocator == "malloc") {
+    ink_freelist_set_ops(ink_freelist_malloc_ops());
+  } else if (!opt_allocator.empty()) {
+    std::cerr << "unknown allocator " << opt_allocator << std::endl;
+    return 1;
+  }
+
   if (debug_enabled) {
     std::cout << "nloop = " << nloop << std::endl;
 
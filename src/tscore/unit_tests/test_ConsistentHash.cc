@@ -0,0 +1,111 @@
+/**
+  @file Test for ConsistentHash.cc
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <array>
+#include <iterator>
+#include <map>
+#include <string>
+
+#include "tscore/ConsistentHash.h"
+#include "tscore/HashSip.h"
+#include "catch.hpp"
+
+namespace
+{
+struct Ring {
+  std::array<std::string, 4> names{{"p1.example.com", "p2.example.com", "p3.example.com", "p4.example.com"}};
+  std::array<ATSConsistentHashNode, 4> nodes;
+  ATSConsistentHash chash;
+
+  Ring()
+  {
+    ATSHash64Sip24 hash;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      nodes[i].available = true;
+      nodes[i].name      = const_cast<char *>(names[i].c_str());
+      chash.insert(&nodes[i], 1.0, &hash);
+    }
+  }
+};
+} // namespace
+
+TEST_CASE("ConsistentHash", "[libts][ConsistentHash]")
+{
+  SECTION("lookups follow the ring")
+  {
+    Ring ring;
+    ATSConsistentHashIter iter;
+    bool wrapped = false;
+
+    // A hash value past the last ring entry wraps around to the first one
+    ATSConsistentHashNode *last = ring.chash.lookup_by_hashval(UINT64_MAX, &iter, &wrapped);
+    REQUIRE(wrapped);
+    REQUIRE(last != nullptr);
+
+    // Every hash value maps to the first ring entry at or after it
+    ATSConsistentHashIter first;
+    ring.chash.lookup_by_hashval(0, &first, &wrapped);
+
+    uint64_t hashval = 0;
+    for (int i = 0; i < 1000; ++i) {
+      hashval += UINT64_MAX / 1000;
+      wrapped                     = false;
+      ATSConsistentHashNode *node = ring.chash.lookup_by_hashval(hashval, &iter, &wrapped);
+      REQUIRE(node == iter->second);
+      if (!wrapped) {
+        REQUIRE(iter->first >= hashval);
+      }
+      if (!wrapped && iter != first) {
+        REQUIRE(std::prev(iter)->first < hashval);
+      }
+    }
+  }
+
+  SECTION("bounded loads spread a hot key")
+  {
+    Ring ring;
+    ring.chash.set_load_bound(1.25);
+
+    std::map<ATSConsistentHashNode *, int> selected;
+    for (int i = 0; i < 1000; ++i) {
+      selected[ring.chash.lookup_by_hashval(42)]++;
+    }
+
+    REQUIRE(selected.size() > 1);
+    for (auto const &[node, count] : selected) {
+      // Each node is capped at 1.25 times a quarter of the lookups, plus rounding
+      REQUIRE(count <= 1000 * 1.25 / 4 + 1);
+    }
+  }
+
+  SECTION("unbounded loads keep a key on one node")
+  {
+    Ring ring;
+
+    std::map<ATSConsistentHashNode *, int> selected;
+    for (int i = 0; i < 1000; ++i) {
+      selected[ring.chash.lookup_by_hashval(42)]++;
+    }
+
+    REQUIRE(selected.size() == 1);
+  }
+}
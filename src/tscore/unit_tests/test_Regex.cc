@@ -21,7 +21,9 @@
 */
 
 #include <array>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "tscore/ink_assert.h"
 #include "tscore/ink_defs.h"
@@ -52,3 +54,48 @@ TEST_CASE("Regex", "[libts][Regex]")
     }
   }
 }
+
+TEST_CASE("DFA", "[libts][DFA]")
+{
+  SECTION("first matching pattern wins")
+  {
+    DFA dfa;
+    std::array<std::string_view, 4> patterns{{"foo", "ba(r|z)", "bar", "[0-9]+"}};
+    REQUIRE(dfa.compile(patterns.data(), patterns.size()) == 4);
+
+    REQUIRE(dfa.match("foobar") == 0);
+    REQUIRE(dfa.match("bar") == 1);
+    REQUIRE(dfa.match("bar", 2) == 2);
+    REQUIRE(dfa.match("bar", 3) == -1);
+    REQUIRE(dfa.match("42") == 3);
+    // Patterns are anchored by default
+    REQUIRE(dfa.match("xfoo") == -1);
+  }
+
+  SECTION("more patterns than fit in a group")
+  {
+    std::vector<std::string> strings;
+    for (size_t i = 0; i < DFA::MAX_GROUP_SIZE * 2 + 1; ++i) {
+      strings.push_back("host" + std::to_string(i) + "\\.example\\.com");
+    }
+    std::vector<std::string_view> patterns(strings.begin(), strings.end());
+
+    DFA dfa;
+    REQUIRE(dfa.compile(patterns.data(), patterns.size(), RE_UNANCHORED) == static_cast<int>(patterns.size()));
+    REQUIRE(dfa.match("www.host0.example.com") == 0);
+    REQUIRE(dfa.match("host40.example.com") == 40);
+    REQUIRE(dfa.match("host64.example.com") == 64);
+    REQUIRE(dfa.match("host65.example.com") == -1);
+  }
+
+  SECTION("back references are kept apart")
+  {
+    DFA dfa;
+    std::array<std::string_view, 3> patterns{{"(a)b", "(c)\\1", "d"}};
+    REQUIRE(dfa.compile(patterns.data(), patterns.size()) == 3);
+
+    REQUIRE(dfa.match("cc") == 1);
+    REQUIRE(dfa.match("ca") == -1);
+    REQUIRE(dfa.match("d") == 2);
+  }
+}
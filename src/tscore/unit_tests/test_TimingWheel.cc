@@ -0,0 +1,159 @@
+/** @file
+
+    Unit tests for TimingWheel and EpochReclaim.
+
+    @section license License
+
+    Licensed to the Apache Software Foundation (ASF) under one
+    or more contributor license agreements.  See the NOTICE file
+    distributed with this work for additional information
+    regarding copyright ownership.  The ASF licenses this file
+    to you under the Apache License, Version 2.0 (the
+    "License"); you may not use this file except in compliance
+    with the License.  You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <vector>
+#include <thread>
+
+#include "tscore/TimingWheel.h"
+#include "tscore/EpochReclaim.h"
+#include "catch.hpp"
+
+namespace
+{
+struct Timer {
+  explicit Timer(int64_t d) : deadline(d) {}
+  int64_t deadline;
+  int64_t fired = -1;
+  Timer *next   = nullptr;
+  Timer *prev   = nullptr;
+  int slot      = 0;
+};
+
+struct TimerLinkage {
+  using value_type = Timer;
+
+  static Timer *&
+  next_ptr(Timer *t)
+  {
+    return t->next;
+  }
+  static Timer *&
+  prev_ptr(Timer *t)
+  {
+    return t->prev;
+  }
+  static int &
+  slot_ref(Timer *t)
+  {
+    return t->slot;
+  }
+  static int64_t
+  deadline_of(Timer *t)
+  {
+    return t->deadline;
+  }
+};
+
+using Wheel = ts::TimingWheel<TimerLinkage>;
+} // namespace
+
+TEST_CASE("TimingWheel", "[libts][TimingWheel]")
+{
+  Wheel wheel(1000);
+  std::vector<Timer> timers;
+  // deadlines in each level, on level boundaries and past the range.
+  for (int64_t delta : {1, 2, 63, 64, 65, 100, 4095, 4096, 4097, 70000, 262144, 300000}) {
+    timers.emplace_back(1000 + delta);
+  }
+  timers.emplace_back(1000 + Wheel::RANGE + 5);
+  for (auto &t : timers) {
+    wheel.insert(&t);
+  }
+  REQUIRE(wheel.count() == timers.size());
+
+  // the wheel is at the tick being processed when a timer fires.
+  auto fire = [&wheel](Timer *t) { t->fired = wheel.now(); };
+  wheel.advance(1010, fire);
+  CHECK(timers[0].fired == 1001);
+  CHECK(timers[1].fired == 1002);
+  CHECK(timers[2].fired == -1);
+  wheel.advance(1000 + Wheel::RANGE + 10, fire);
+  CHECK(wheel.count() == 0);
+  for (auto &t : timers) {
+    CHECK(t.fired == t.deadline);
+    CHECK(!wheel.contains(&t));
+  }
+}
+
+TEST_CASE("TimingWheel erase and late deadlines", "[libts][TimingWheel]")
+{
+  Wheel wheel(50);
+  Timer a(60), b(60), c(5000), past(10);
+
+  wheel.insert(&a);
+  wheel.insert(&b);
+  wheel.insert(&c);
+  wheel.insert(&past);
+  wheel.erase(&b);
+  wheel.erase(&c);
+  REQUIRE(wheel.count() == 2);
+
+  int fired = 0;
+  wheel.advance(51, [&fired](Timer *t) {
+    t->fired = 51;
+    ++fired;
+  });
+  // a deadline that already passed is due at the next tick.
+  CHECK(fired == 1);
+  CHECK(past.fired == 51);
+
+  // advancing many ticks at once.
+  wheel.advance(10000, [&fired](Timer *t) {
+    t->fired = 10000;
+    ++fired;
+  });
+  CHECK(fired == 2);
+  CHECK(a.fired == 10000);
+  CHECK(b.fired == -1);
+  CHECK(c.fired == -1);
+  CHECK(wheel.now() == 10000);
+}
+
+TEST_CASE("EpochReclaim", "[libts][EpochReclaim]")
+{
+  uint64_t first = ts::EpochReclaim::retire();
+  // no reader, everything retired is reclaimable.
+  CHECK(ts::EpochReclaim::is_reclaimable(first, ts::EpochReclaim::safe_epoch()));
+
+  uint64_t second;
+  {
+    ts::EpochReclaim::Guard guard;
+    second = ts::EpochReclaim::retire();
+    CHECK(!ts::EpochReclaim::is_reclaimable(second, ts::EpochReclaim::safe_epoch()));
+    {
+      ts::EpochReclaim::Guard nested;
+    }
+    // leaving a nested guard does not leave the epoch.
+    CHECK(!ts::EpochReclaim::is_reclaimable(second, ts::EpochReclaim::safe_epoch()));
+
+    // the epoch of this thread is seen from other threads.
+    bool reclaimable = false;
+    std::thread other([&reclaimable, second]() {
+      ts::EpochReclaim::Guard other_guard;
+      reclaimable = ts::EpochReclaim::is_reclaimable(second, ts::EpochReclaim::safe_epoch());
+    });
+    other.join();
+    CHECK(!reclaimable);
+  }
+  CHECK(ts::EpochReclaim::is_reclaimable(second, ts::EpochReclaim::safe_epoch()));
+}
@@ -0,0 +1,100 @@
+/**
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+
+/**
+ * @file TransformationPipeline.cc
+ */
+
+#include "tscpp/api/TransformationPipeline.h"
+#include "logging_internal.h"
+
+using namespace atscppapi;
+
+void
+TransformationStage::handleInputComplete()
+{
+  setOutputComplete();
+}
+
+void
+TransformationStage::produce(std::string_view data)
+{
+  if (next_) {
+    next_->consume(data);
+  } else {
+    pipeline_->produce(data);
+  }
+}
+
+void
+TransformationStage::setOutputComplete()
+{
+  if (next_) {
+    next_->handleInputComplete();
+  } else {
+    pipeline_->setOutputComplete();
+  }
+}
+
+TransformationPipeline &
+TransformationStage::pipeline() const
+{
+  return *pipeline_;
+}
+
+TransformationPipeline::TransformationPipeline(Transaction &transaction, TransformationPlugin::Type type)
+  : TransformationPlugin(transaction, type)
+{
+  LOG_DEBUG("Creating TransformationPipeline=%p", this);
+}
+
+TransformationPipeline::~TransformationPipeline()
+{
+  LOG_DEBUG("Destroying TransformationPipeline=%p with %zu stages", this, stages_.size());
+}
+
+void
+TransformationPipeline::addStage(std::unique_ptr<TransformationStage> stage)
+{
+  stage->pipeline_ = this;
+  if (!stages_.empty()) {
+    stages_.back()->next_ = stage.get();
+  }
+  stages_.push_back(std::move(stage));
+}
+
+void
+TransformationPipeline::consume(std::string_view data)
+{
+  if (stages_.empty()) {
+    produce(data);
+  } else {
+    stages_.front()->consume(data);
+  }
+}
+
+void
+TransformationPipeline::handleInputComplete()
+{
+  if (stages_.empty()) {
+    setOutputComplete();
+  } else {
+    stages_.front()->handleInputComplete();
+  }
+}
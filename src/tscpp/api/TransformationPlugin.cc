@@ -23,7 +23,9 @@
 #include "tscpp/api/TransformationPlugin.h"
 
 #include "ts/ts.h"
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <cinttypes>
 #include "utils_internal.h"
 #include "logging_internal.h"
@@ -72,7 +74,14 @@ struct TransformationPluginState : noncopyable, public detail::ResumeAfterPauseC
   // sent the input end our write complete.
   bool input_complete_dispatched_;
 
-  std::string request_xform_output_; // in case of request xform, data produced is buffered here
+  TSIOBuffer request_xform_buffer_; // in case of request xform, data produced is buffered here
+
+  // The input block that is being handed to consume(), data produced from it can
+  // reference the block instead of being copied.
+  TSIOBufferReader input_reader_;
+  const char *input_block_start_;
+  int64_t input_block_avail_;
+  int64_t input_block_offset_; // offset of the block from the start of input_reader_
 
   TransformationPluginState(atscppapi::Transaction &transaction, TransformationPlugin &transformation_plugin,
                             TransformationPlugin::Type type, TSHttpTxn txn)
@@ -87,10 +96,18 @@ struct TransformationPluginState : noncopyable, public detail::ResumeAfterPauseC
       output_buffer_reader_(nullptr),
       bytes_written_(0),
       paused_(false),
-      input_complete_dispatched_(false)
+      input_complete_dispatched_(false),
+      request_xform_buffer_(nullptr),
+      input_reader_(nullptr),
+      input_block_start_(nullptr),
+      input_block_avail_(0),
+      input_block_offset_(0)
   {
     output_buffer_        = TSIOBufferCreate();
     output_buffer_reader_ = TSIOBufferReaderAlloc(output_buffer_);
+    if (type_ == TransformationPlugin::REQUEST_TRANSFORMATION) {
+      request_xform_buffer_ = TSIOBufferCreate();
+    }
   };
 
   ~TransformationPluginState() override
@@ -104,6 +121,11 @@ struct TransformationPluginState : noncopyable, public detail::ResumeAfterPauseC
       TSIOBufferDestroy(output_buffer_);
       output_buffer_ = nullptr;
     }
+
+    if (request_xform_buffer_) {
+      TSIOBufferDestroy(request_xform_buffer_);
+      request_xform_buffer_ = nullptr;
+    }
   }
 };
 
@@ -123,6 +145,86 @@ cleanupTransformation(TSCont contp)
   TSContDestroy(contp);
 }
 
+// Slices of the input at least this long are passed downstream by sharing the
+// input block, shorter ones are cheaper to copy than to clone a block for.
+constexpr int64_t MIN_SHARED_SLICE_LENGTH = 512;
+
+// Appends data to buffer, by reference if it lies within the input block that is being consumed.
+int64_t
+writeToBuffer(TransformationPluginState *state, TSIOBuffer buffer, std::string_view data)
+{
+  int64_t length  = static_cast<int64_t>(data.length());
+  uintptr_t start = reinterpret_cast<uintptr_t>(state->input_block_start_);
+  uintptr_t slice = reinterpret_cast<uintptr_t>(data.data());
+
+  if (state->input_block_start_ != nullptr && length >= MIN_SHARED_SLICE_LENGTH && slice >= start &&
+      slice + length <= start + state->input_block_avail_) {
+    return TSIOBufferCopy(buffer, state->input_reader_, length, state->input_block_offset_ + (slice - start));
+  }
+  return TSIOBufferWrite(buffer, data.data(), length);
+}
+
+// Calls fn with each block of the first length bytes of reader, while fn
+// returns true. The block is registered as the input so data produced from it
+// is shared rather than copied. Returns the number of bytes handed to fn.
+template <typename F>
+int64_t
+forEachInputBlock(TransformationPluginState *state, TSIOBufferReader reader, int64_t length, F &&fn)
+{
+  int64_t done = 0;
+  bool more    = true;
+
+  state->input_reader_ = reader;
+  for (TSIOBufferBlock block = TSIOBufferReaderStart(reader); block && done < length && more; block = TSIOBufferBlockNext(block)) {
+    int64_t avail     = 0;
+    const char *start = TSIOBufferBlockReadStart(block, reader, &avail);
+    avail             = std::min(avail, length - done);
+    if (avail <= 0) {
+      continue;
+    }
+
+    state->input_block_start_  = start;
+    state->input_block_avail_  = avail;
+    state->input_block_offset_ = done;
+    done += avail;
+    more = fn(std::string_view(start, avail));
+  }
+  state->input_reader_      = nullptr;
+  state->input_block_start_ = nullptr;
+  state->input_block_avail_ = 0;
+
+  return done;
+}
+
+// Hands the first length bytes of reader to consume() in a single call, like
+// before the input was streamed. The call gets a view of the read buffer when
+// the bytes are in one block, and a copy of them when they span blocks.
+void
+consumeInput(TransformationPluginState *state, TSIOBufferReader reader, int64_t length)
+{
+  TSIOBufferBlock block = TSIOBufferReaderStart(reader);
+  int64_t avail         = 0;
+
+  if (block) {
+    TSIOBufferBlockReadStart(block, reader, &avail);
+  }
+  if (avail >= length) {
+    forEachInputBlock(state, reader, length, [state](std::string_view data) {
+      state->transformation_plugin_.consume(data);
+      return true;
+    });
+    return;
+  }
+
+  std::string in_data;
+  in_data.reserve(length);
+  for (; block && static_cast<int64_t>(in_data.length()) < length; block = TSIOBufferBlockNext(block)) {
+    const char *start = TSIOBufferBlockReadStart(block, reader, &avail);
+    in_data.append(start, std::min(avail, length - static_cast<int64_t>(in_data.length())));
+  }
+  state->transformation_plugin_.consume(in_data);
+}
+
 int
 handleTransformationPluginRead(TSCont contp, TransformationPluginState *state)
 {
@@ -155,12 +257,9 @@ handleTransformationPluginRead(TSCont contp, TransformationPluginState *state)
       }
 
       if (to_read > 0) {
-        /* Create a buffer and a buffer reader */
-        TSIOBuffer input_buffer       = TSIOBufferCreate();
-        TSIOBufferReader input_reader = TSIOBufferReaderAlloc(input_buffer);
-
-        /* Copy the data from the read buffer to the input buffer. */
-        TSIOBufferCopy(input_buffer, TSVIOReaderGet(write_vio), to_read, 0);
+        LOG_DEBUG("Transformation contp=%p write_vio=%p consuming %" PRId64 " bytes from the input buffer", contp, write_vio,
+                  to_read);
+        consumeInput(state, TSVIOReaderGet(write_vio), to_read);
 
         /* Tell the read buffer that we have read the data and are no
          longer interested in it. */
@@ -168,18 +267,6 @@ handleTransformationPluginRead(TSCont contp, TransformationPluginState *state)
 
         /* Modify the read VIO to reflect how much data we've completed. */
         TSVIONDoneSet(write_vio, TSVIONDoneGet(write_vio) + to_read);
-
-        std::string in_data = utils::internal::consumeFromTSIOBufferReader(input_reader);
-        LOG_DEBUG("Transformation contp=%p write_vio=%p consumed %ld bytes from bufferreader", contp, write_vio, in_data.length());
-
-        /* Clean up the buffer and reader */
-        TSIOBufferReaderFree(input_reader);
-        TSIOBufferDestroy(input_buffer);
-
-        /* Now call the client to tell them about data */
-        if (in_data.length() > 0) {
-          state->transformation_plugin_.consume(in_data);
-        }
       }
 
       /* now that we've finished reading we will check if there is anything left to read. */
@@ -363,8 +450,8 @@ TransformationPlugin::doProduce(std::string_view data)
     }
   }
 
-  // Finally we can copy this data into the output_buffer
-  int64_t bytes_written = TSIOBufferWrite(state_->output_buffer_, data.data(), write_length);
+  // Finally we can add this data to the output_buffer
+  int64_t bytes_written = writeToBuffer(state_, state_->output_buffer_, data);
   state_->bytes_written_ += bytes_written; // So we can set BytesDone on outputComplete().
   LOG_DEBUG("TransformationPlugin=%p tshttptxn=%p write to TSIOBuffer %" PRId64 " bytes total bytes written %" PRId64, this,
             state_->txn_, bytes_written, state_->bytes_written_);
@@ -394,8 +481,7 @@ size_t
 TransformationPlugin::produce(std::string_view data)
 {
   if (state_->type_ == REQUEST_TRANSFORMATION) {
-    state_->request_xform_output_.append(data.data(), data.length());
-    return data.size();
+    return writeToBuffer(state_, state_->request_xform_buffer_, data);
   } else if (state_->type_ == SINK_TRANSFORMATION) {
     LOG_DEBUG("produce TransformationPlugin=%p tshttptxn=%p : This is a sink transform. Not producing any output", this,
               state_->txn_);
@@ -415,7 +501,12 @@ TransformationPlugin::setOutputComplete()
     // has a stubbed out shutdown/close implementation
     return 0;
   } else if (state_->type_ == REQUEST_TRANSFORMATION) {
-    doProduce(state_->request_xform_output_);
+    TSIOBufferReader reader = TSIOBufferReaderAlloc(state_->request_xform_buffer_);
+    forEachInputBlock(state_, reader, TSIOBufferReaderAvail(reader), [this](std::string_view data) {
+      doProduce(data);
+      return true;
+    });
+    TSIOBufferReaderFree(reader);
   }
 
   int connection_closed = TSVConnClosedGet(state_->vconn_);
@@ -0,0 +1,106 @@
+'''
+Test Range: requests against a response kept in cache as a partial object
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+Test.Summary = '''
+Test Range: requests against a response kept in cache as a partial object
+'''
+
+Test.SkipUnless(
+    Condition.PluginExists('xdebug.so'),
+)
+Test.ContinueOnFail = False
+
+# The origin closes the connection after 12000 of the 20000 bytes of its first
+# response, the body is '0123456789' repeated.
+Test.GetTcpPort("upstream_port")
+origin = Test.Processes.Process(
+    "origin", "python3 {}/truncating_origin.py {} --truncate-at 12000".format(Test.TestDirectory, Test.Variables.upstream_port))
+
+ts = Test.MakeATSProcess("ts")
+ts.Disk.plugin_config.AddLine('xdebug.so')
+ts.Disk.records_config.update({
+    'proxy.config.diags.debug.enabled': 1,
+    'proxy.config.diags.debug.tags': 'http|http_range',
+    'proxy.config.http.cache.range.partial': 4096,
+})
+ts.Disk.remap_config.AddLine(
+    'map / http://127.0.0.1:{}/'.format(Test.Variables.upstream_port)
+)
+
+curl = 'curl -s -D /dev/stdout -o /dev/stderr -x 127.0.0.1:{} -H "X-Debug: X-Cache" http://example.com/obj'.format(
+    ts.Variables.port)
+
+# The truncated response is kept in cache.
+tr = Test.AddTestRun("truncated response")
+tr.Processes.Default.StartBefore(origin, ready=When.PortOpen(Test.Variables.upstream_port))
+tr.Processes.Default.StartBefore(ts)
+tr.Processes.Default.Command = curl
+# curl reports the body that is shorter than its Content-Length.
+tr.Processes.Default.ReturnCode = 18
+tr.Processes.Default.Streams.stdout = Testers.ContainsExpression("X-Cache: miss", "expected a cache miss")
+tr.StillRunningAfter = ts
+tr.StillRunningAfter = origin
+
+# A range in the stored prefix is served from cache, with the full length.
+tr = Test.AddTestRun("range in the partial object")
+tr.Processes.Default.Command = curl + ' -r 100-109'
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = Testers.ContainsExpression("206 Partial Content", "expected a 206 response")
+tr.Processes.Default.Streams.stdout += Testers.ContainsExpression("Content-Range: bytes 100-109/20000", "expected the full length")
+tr.Processes.Default.Streams.stdout += Testers.ContainsExpression("X-Cache: hit-fresh", "expected a cache hit")
+tr.Processes.Default.Streams.stderr = Testers.ContainsExpression("0123456789", "expected the range of the body")
+tr.StillRunningAfter = ts
+tr.StillRunningAfter = origin
+
+# A range past the stored prefix goes to the origin.
+tr = Test.AddTestRun("range past the partial object")
+tr.Processes.Default.Command = curl + ' -r 15000-15009'
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = Testers.ContainsExpression("Content-Range: bytes 15000-15009/20000", "expected the range")
+tr.Processes.Default.Streams.stdout += Testers.ContainsExpression("X-Cache: miss", "expected the origin to serve the range")
+tr.Processes.Default.Streams.stderr = Testers.ContainsExpression("0123456789", "expected the range of the body")
+tr.StillRunningAfter = ts
+tr.StillRunningAfter = origin
+
+# A request for the whole response replaces the partial object.
+tr = Test.AddTestRun("whole response")
+tr.Processes.Default.Command = curl
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = Testers.ContainsExpression("200 OK", "expected a 200 response")
+tr.Processes.Default.Streams.stdout += Testers.ContainsExpression("Content-Length: 20000", "expected the whole response")
+tr.StillRunningAfter = ts
+tr.StillRunningAfter = origin
+
+tr = Test.AddTestRun("range in the whole response")
+tr.Processes.Default.Command = curl + ' -r 15000-15009'
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = Testers.ContainsExpression("Content-Range: bytes 15000-15009/20000", "expected the range")
+tr.Processes.Default.Streams.stdout += Testers.ContainsExpression("X-Cache: hit-fresh", "expected a cache hit")
+tr.Processes.Default.Streams.stderr = Testers.ContainsExpression("0123456789", "expected the range of the body")
+tr.StillRunningAfter = ts
+tr.StillRunningAfter = origin
+
+ts.Disk.traffic_out.Content = Testers.ContainsExpression(
+    "keeping 12000 of 20000 bytes in cache as a partial object", "expected the truncated response to be kept")
+ts.Disk.traffic_out.Content += Testers.ContainsExpression(
+    "cached object is partial", "expected the whole response to be fetched again")
+
+# The range in the stored prefix never reached the origin.
+origin.Streams.stdout = Testers.ExcludesExpression("bytes=100-109", "expected the range to be served from cache")
+origin.Streams.stdout += Testers.ContainsExpression("bytes=15000-15009", "expected the range past the prefix at the origin")
@@ -0,0 +1,81 @@
+'''
+An origin that truncates its first response.
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+import argparse
+import re
+import socket
+import sys
+
+# The body is the decimal digits repeated, so any range of it can be checked.
+BODY = b'0123456789' * 2000
+
+
+def read_request(conn):
+    data = b''
+    while b'\r\n\r\n' not in data:
+        chunk = conn.recv(4096)
+        if not chunk:
+            return None
+        data += chunk
+    return data.decode('ascii', 'replace')
+
+
+def respond(conn, request, truncate_at):
+    match = re.search(r'^Range: bytes=(\d+)-(\d+)\r$', request, re.MULTILINE | re.IGNORECASE)
+    if match:
+        start, end = int(match.group(1)), int(match.group(2))
+        header = ('HTTP/1.1 206 Partial Content\r\n'
+                  'Content-Range: bytes {}-{}/{}\r\n'
+                  'Content-Length: {}\r\n').format(start, end, len(BODY), end - start + 1)
+        body = BODY[start:end + 1]
+    else:
+        header = 'HTTP/1.1 200 OK\r\nContent-Length: {}\r\n'.format(len(BODY))
+        body = BODY[:truncate_at] if truncate_at else BODY
+    header += 'Cache-Control: max-age=300\r\nConnection: close\r\n\r\n'
+    conn.sendall(header.encode('ascii') + body)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('port', type=int)
+    parser.add_argument('--truncate-at', type=int, required=True,
+                        help='the number of body bytes sent for the first request before closing the connection')
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(('127.0.0.1', args.port))
+    sock.listen(8)
+
+    truncate_at = args.truncate_at
+    while True:
+        conn, _ = sock.accept()
+        with conn:
+            request = read_request(conn)
+            if request is None:
+                continue
+            range_header = re.search(r'^Range: (.*)\r$', request, re.MULTILINE | re.IGNORECASE)
+            print('request: {} range: {}'.format(request.split('\r\n', 1)[0], range_header.group(1) if range_header else 'none'))
+            sys.stdout.flush()
+            respond(conn, request, truncate_at)
+            truncate_at = 0
+
+
+if __name__ == '__main__':
+    main()
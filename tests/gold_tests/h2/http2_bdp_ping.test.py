@@ -0,0 +1,88 @@
+'''
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+import os
+
+Test.Summary = '''
+Test that the ACKs of the PINGs sent to estimate the BDP are not counted as PINGs from the client
+'''
+
+Test.SkipUnless(
+    Condition.HasCurlFeature('http2'),
+)
+Test.ContinueOnFail = True
+
+# ----
+# Setup Origin Server
+# ----
+server = Test.MakeOriginServer("server")
+
+# A body large enough for many BDP samples, each of which sends a PING
+post_body = "0123456789" * 524288
+server.addResponse("sessionlog.json",
+                   {"headers": "POST /upload HTTP/1.1\r\nHost: www.example.com\r\n\r\n",
+                    "timestamp": "1469733493.993",
+                    "body": post_body},
+                   {"headers": "HTTP/1.1 200 OK\r\nServer: microserver\r\nConnection: close\r\nContent-Length: 10\r\n\r\n",
+                       "timestamp": "1469733493.993",
+                       "body": "0123456789"})
+
+post_body_file = open(os.path.join(Test.RunDirectory, "bdp_post_body"), "w")
+post_body_file.write(post_body)
+post_body_file.close()
+
+# ----
+# Setup ATS
+# ----
+ts = Test.MakeATSProcess("ts", select_ports=True, enable_tls=True, enable_cache=False)
+
+ts.addDefaultSSLFiles()
+
+ts.Disk.remap_config.AddLine(
+    'map / http://127.0.0.1:{0}'.format(server.Variables.Port)
+)
+ts.Disk.ssl_multicert_config.AddLine(
+    'dest_ip=* ssl_cert_name=server.pem ssl_key_name=server.key'
+)
+ts.Disk.records_config.update({
+    'proxy.config.http2.max_window_size_in': 16777216,
+    'proxy.config.http2.max_ping_frames_per_minute': 1,
+    'proxy.config.ssl.server.cert.path': '{0}'.format(ts.Variables.SSLDir),
+    'proxy.config.ssl.server.private_key.path': '{0}'.format(ts.Variables.SSLDir),
+    'proxy.config.diags.debug.enabled': 1,
+    'proxy.config.diags.debug.tags': 'http2',
+})
+
+# More BDP samples are taken than PINGs are allowed from the client, and the connection survives them
+ts.Disk.traffic_out.Content = Testers.ContainsExpression("BDP sample", "The upload should take BDP samples")
+ts.Disk.traffic_out.Content += Testers.ExcludesExpression("too frequent PING", "ACKs of our PINGs should not be counted")
+
+# ----
+# Test Cases
+# ----
+
+# Test Case 0: Upload with BDP probing
+tr = Test.AddTestRun()
+tr.Processes.Default.Command = 'curl -s -k --http2 --data-binary @bdp_post_body https://127.0.0.1:{0}/upload'.format(
+    ts.Variables.ssl_port)
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.TimeOut = 10
+tr.Processes.Default.StartBefore(server, ready=When.PortOpen(server.Variables.Port))
+tr.Processes.Default.StartBefore(Test.Processes.ts)
+tr.Processes.Default.Streams.All = "gold/post_chunked.gold"
+tr.StillRunningAfter = server
@@ -0,0 +1,78 @@
+'''
+Verify that the log flush threads write every log in order.
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+import os
+
+Test.Summary = '''
+Verify that the log flush threads write every log in order.
+'''
+
+REQUEST_COUNT = 300
+LOG_COUNT = 8
+
+ts = Test.MakeATSProcess("ts")
+
+# Small log buffers, so that each log has many buffers queued for its
+# flush thread at a time, spread over several flush threads.
+ts.Disk.records_config.update({
+    'proxy.config.log.flush_threads': 4,
+    'proxy.config.log.log_buffer_size': 1024,
+    'proxy.config.log.max_secs_per_buffer': 1,
+    'proxy.config.log.periodic_tasks_interval': 1,
+})
+
+ts.Disk.remap_config.AddLine(
+    'map / http://www.example.com/ @action=deny'
+)
+
+log_lines = ['''
+logging:
+  formats:
+    - name: url_and_status
+      format: "%<cqhm> %<cqup> %<pssc>"
+  logs:''']
+log_paths = []
+for i in range(LOG_COUNT):
+    log_lines.append(f'''
+    - filename: flush_{i}
+      format: url_and_status''')
+    log_paths.append(os.path.join(ts.Variables.LOGDIR, f'flush_{i}.log'))
+ts.Disk.logging_yaml.AddLines(''.join(log_lines).split('\n'))
+
+# The requests are sent one after the other, so each log has them in the
+# order they were sent, as long as the buffers of a file are written in
+# the order they were queued.
+tr = Test.AddTestRun('Send requests')
+tr.Processes.Default.Command = (
+    f'for i in $(seq 1 {REQUEST_COUNT}); do '
+    f'curl --silent --output /dev/null http://127.0.0.1:{ts.Variables.port}/req/$i || exit 1; '
+    'done'
+)
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.StartBefore(ts)
+
+tr = Test.AddTestRun('Check that every log has all the requests in order')
+tr.Processes.Default.Command = 'python3 {0} --count {1} {2}'.format(
+    os.path.join(Test.TestDirectory, 'log_order_checker.py'), REQUEST_COUNT, ' '.join(log_paths))
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout += Testers.ExcludesExpression(
+    'out of order', 'The logs should have every request, in order')
+
+ts.Disk.diags_log.Content += Testers.ExcludesExpression(
+    'log flush queue is full', 'No log buffer should be dropped')
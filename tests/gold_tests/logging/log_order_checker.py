@@ -0,0 +1,64 @@
+'''
+Waits for the logs written by log-flush-threads.test.py and checks that
+each holds every request, in the order the requests were sent.
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+import argparse
+import os
+import re
+import sys
+import time
+
+
+def read_requests(path):
+    '''Returns the request numbers logged in path, in the order of the log.'''
+    if not os.path.exists(path):
+        return []
+    with open(path) as f:
+        return [int(m.group(1)) for m in (re.search(r'/req/(\d+)', line) for line in f) if m]
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--count', type=int, required=True, help='the number of requests sent')
+    parser.add_argument('--timeout', type=int, default=60, help='seconds to wait for the logs')
+    parser.add_argument('logs', nargs='+')
+    args = parser.parse_args()
+
+    expected = list(range(1, args.count + 1))
+    deadline = time.time() + args.timeout
+    while True:
+        pending = [path for path in args.logs if len(read_requests(path)) < args.count]
+        if not pending or time.time() > deadline:
+            break
+        time.sleep(1)
+
+    ok = True
+    for path in args.logs:
+        logged = read_requests(path)
+        if logged == expected:
+            print(f'{path}: {len(logged)} requests in order')
+        else:
+            ok = False
+            out_of_order = [(a, b) for a, b in zip(logged, logged[1:]) if b != a + 1]
+            print(f'{path}: {len(logged)} of {args.count} requests logged, out of order at {out_of_order[:5]}')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
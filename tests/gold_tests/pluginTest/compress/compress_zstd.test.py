@@ -0,0 +1,115 @@
+'''
+'''
+#  Licensed to the Apache Software Foundation (ASF) under one
+#  or more contributor license agreements.  See the NOTICE file
+#  distributed with this work for additional information
+#  regarding copyright ownership.  The ASF licenses this file
+#  to you under the Apache License, Version 2.0 (the
+#  "License"); you may not use this file except in compliance
+#  with the License.  You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+
+Test.Summary = '''
+Test zstd, task thread compression and precompressed variants of the compress plugin
+'''
+
+Test.SkipUnless(
+    Condition.PluginExists('compress.so'),
+    Condition.PluginExists('xdebug.so'),
+    Condition.HasATSFeature('TS_HAS_ZSTD')
+)
+Test.ContinueOnFail = False
+
+server = Test.MakeOriginServer("server")
+
+# Large enough for chunks of the body to reach the task-threshold of compress_zstd.config.
+body = "lets go surfin now everybodys learnin how\n" * 4096
+
+request_header = {"headers": "GET /obj HTTP/1.1\r\nHost: zstd.example.com\r\n\r\n", "timestamp": "1469733493.993", "body": ""}
+response_header = {
+    "headers": "HTTP/1.1 200 OK\r\nConnection: close\r\n" +
+    "Cache-Control: public, max-age=31536000\r\n" +
+    "Content-Type: text/plain\r\n" +
+    "Content-Length: {}\r\n".format(len(body)) +
+    "\r\n",
+    "timestamp": "1469733493.993",
+    "body": body
+}
+server.addResponse("sessionfile.log", request_header, response_header)
+
+ts = Test.MakeATSProcess("ts")
+
+ts.Disk.records_config.update({
+    'proxy.config.diags.debug.enabled': 1,
+    'proxy.config.diags.debug.tags': 'compress',
+    'proxy.config.http.normalize_ae': 0,
+    'proxy.config.http.cache.http': 1,
+})
+
+ts.Setup.Copy("compress_zstd.config")
+
+ts.Disk.plugin_config.AddLine('xdebug.so')
+ts.Disk.remap_config.AddLine(
+    'map http://zstd.example.com/ http://127.0.0.1:{}/'.format(server.Variables.Port) +
+    ' @plugin=compress.so @pparam={}/compress_zstd.config'.format(Test.RunDirectory)
+)
+
+curl = 'curl -s -D /dev/stdout -o /dev/null -x 127.0.0.1:{} -H "X-Debug: X-Cache"'.format(ts.Variables.port) + \
+    ' -H "Accept-Encoding: {}" http://zstd.example.com/obj'
+
+# The origin response is compressed on task threads and cached uncompressed.
+tr = Test.AddTestRun("zstd from the origin")
+tr.Processes.Default.StartBefore(server, ready=When.PortOpen(server.Variables.Port))
+tr.Processes.Default.StartBefore(ts)
+tr.Processes.Default.Command = curl.format("zstd, br, gzip")
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = Testers.ContainsExpression("X-Cache: miss", "expected a cache miss")
+tr.Processes.Default.Streams.stdout += Testers.ContainsExpression("Content-Encoding: zstd", "expected zstd, the preferred encoding")
+tr.StillRunningAfter = ts
+
+# The first hit compresses the cached response and caches the zstd variant.
+tr = Test.AddTestRun("zstd variant from the uncompressed cached response")
+tr.Processes.Default.Command = curl.format("zstd")
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = Testers.ContainsExpression("X-Cache: hit-fresh", "expected a cache hit")
+tr.Processes.Default.Streams.stdout += Testers.ContainsExpression("Content-Encoding: zstd", "expected a zstd response")
+tr.StillRunningAfter = ts
+
+# Later hits are served the cached zstd variant as is.
+tr = Test.AddTestRun("cached zstd variant")
+tr.Processes.Default.Command = curl.format("zstd")
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = Testers.ContainsExpression("X-Cache: hit-fresh", "expected a cache hit")
+tr.Processes.Default.Streams.stdout += Testers.ContainsExpression("Content-Encoding: zstd", "expected a zstd response")
+tr.StillRunningAfter = ts
+
+# Other encodings get their own variant.
+tr = Test.AddTestRun("gzip variant from the uncompressed cached response")
+tr.Processes.Default.Command = curl.format("gzip")
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = Testers.ContainsExpression("X-Cache: hit-fresh", "expected a cache hit")
+tr.Processes.Default.Streams.stdout += Testers.ContainsExpression("Content-Encoding: gzip", "expected a gzip response")
+tr.StillRunningAfter = ts
+
+tr = Test.AddTestRun("uncompressed response")
+tr.Processes.Default.Command = curl.format("identity")
+tr.Processes.Default.ReturnCode = 0
+tr.Processes.Default.Streams.stdout = Testers.ContainsExpression("X-Cache: hit-fresh", "expected a cache hit")
+tr.Processes.Default.Streams.stdout += Testers.ExcludesExpression("Content-Encoding", "expected an uncompressed response")
+tr.StillRunningAfter = ts
+
+ts.Disk.traffic_out.Content = Testers.ContainsExpression(
+    "compressing [0-9]+ bytes on a task thread", "expected chunks to be compressed on task threads")
+ts.Disk.traffic_out.Content += Testers.ContainsExpression(
+    "precompress enabled, caching the untransformed response", "expected the origin response to be cached uncompressed")
+ts.Disk.traffic_out.Content += Testers.ContainsExpression(
+    "precompress enabled, caching the transformed response", "expected a compressed variant to be cached")
+ts.Disk.traffic_out.Content += Testers.ContainsExpression(
+    "response is already content encoded", "expected the cached zstd variant to be served as is")